@@ -88,12 +88,30 @@ Halide::Func func_for_node_output(const onnx::NodeProto &node, int output_id) {
     return Halide::Func(sanitize_name(node.output(output_id)));
 }
 
+static bool offload_node(
+    const onnx::GraphProto &graph,
+    int index,
+    const std::vector<Tensor> &inputs,
+    const T2SOffload &offload,
+    std::unordered_map<std::string, Tensor> &reps,
+    std::unordered_set<int> &fused,
+    std::vector<Halide::Expr> &requirements,
+    std::vector<Halide::Func> &extern_inputs);
+
 static void convert_subgraph(
     const onnx::GraphProto &graph,
     std::unordered_map<std::string, Tensor> &reps,
-    std::vector<Halide::Expr> &requirements) {
+    std::vector<Halide::Expr> &requirements,
+    const T2SOffload &offload = T2SOffload(),
+    std::vector<Halide::Func> *extern_inputs = nullptr) {
+    // Nodes fused into the drain stage of a node offloaded to a T2S design.
+    std::unordered_set<int> fused;
     // The nodes are always stored in topological order in the ONNX model.
-    for (const onnx::NodeProto &node : graph.node()) {
+    for (int index = 0; index < graph.node_size(); ++index) {
+        if (fused.find(index) != fused.end()) {
+            continue;
+        }
+        const onnx::NodeProto &node = graph.node(index);
         std::vector<Tensor> inputs;
         for (const std::string &input_name : node.input()) {
             if (input_name.empty()) {
@@ -102,6 +120,10 @@ static void convert_subgraph(
                 inputs.push_back(reps.at(input_name));
             }
         }
+        if (extern_inputs != nullptr &&
+            offload_node(graph, index, inputs, offload, reps, fused, requirements, *extern_inputs)) {
+            continue;
+        }
         Node n = convert_node(node, inputs);
 
         for (int i = 0; i < node.output_size(); ++i) {
@@ -1169,6 +1191,385 @@ Node convert_conv_node(
     return result;
 }
 
+// The index of the only node consuming the tensor, or -1 if the tensor is consumed by several nodes or is
+// an output of the graph.
+static int single_consumer(const onnx::GraphProto &graph, const std::string &tensor) {
+    for (const auto &output : graph.output()) {
+        if (output.name() == tensor) {
+            return -1;
+        }
+    }
+    int consumer = -1;
+    for (int i = 0; i < graph.node_size(); ++i) {
+        for (const std::string &input : graph.node(i).input()) {
+            if (input == tensor) {
+                if (consumer >= 0) {
+                    return -1;
+                }
+                consumer = i;
+            }
+        }
+    }
+    return consumer;
+}
+
+static Halide::Buffer<int32_t> t2s_params(const T2SOffload &offload) {
+    Halide::Buffer<int32_t> params(T2SNumParams);
+    params.fill(0);
+    const T2SGemmTiling &g = offload.gemm_tiling;
+    const T2SConvTiling &c = offload.conv_tiling;
+    params(T2SGemmKKK) = g.kkk;
+    params(T2SGemmJJJ) = g.jjj;
+    params(T2SGemmIII) = g.iii;
+    params(T2SGemmKK) = g.kk;
+    params(T2SGemmJJ) = g.jj;
+    params(T2SGemmII) = g.ii;
+    params(T2SConvCII) = c.cii;
+    params(T2SConvCI) = c.ci;
+    params(T2SConvCOOO) = c.cooo;
+    params(T2SConvCOO) = c.coo;
+    params(T2SConvCO) = c.co;
+    params(T2SConvYYY) = c.yyy;
+    params(T2SConvXXX) = c.xxx;
+    params(T2SConvYY) = c.yy;
+    params(T2SConvXX) = c.xx;
+    params(T2SConvY) = c.y;
+    params(T2SConvX) = c.x;
+    params(T2SConvKernel) = c.kernel;
+    params(T2SConvStride) = c.stride;
+    return params;
+}
+
+// Fuse the Relu consuming the tensor, if any, into the drain stage of an offloaded node.
+static void fuse_relu(
+    const onnx::GraphProto &graph,
+    std::string &tensor,
+    Halide::Buffer<int32_t> &params,
+    std::unordered_set<int> &fused) {
+    int next = single_consumer(graph, tensor);
+    if (next >= 0 && graph.node(next).op_type() == "Relu") {
+        params(T2SRelu) = 1;
+        fused.insert(next);
+        tensor = graph.node(next).output(0);
+    }
+}
+
+// Offload a Gemm or MatMul node of 2-D float matrices to the gemm design, with the scaling by alpha and
+// the bias of rank 0 or 1 applied in the drain stage.
+static bool offload_gemm_node(
+    const onnx::GraphProto &graph,
+    int index,
+    const std::vector<Tensor> &inputs,
+    const T2SOffload &offload,
+    std::unordered_map<std::string, Tensor> &reps,
+    std::unordered_set<int> &fused,
+    std::vector<Halide::Expr> &requirements,
+    std::vector<Halide::Func> &extern_inputs) {
+    const onnx::NodeProto &node = graph.node(index);
+    if (!offload.gemm || inputs.size() < 2 || inputs.size() > 3 ||
+        (node.op_type() == "MatMul" && inputs.size() != 2)) {
+        return false;
+    }
+    const Tensor &A = inputs[0];
+    const Tensor &B = inputs[1];
+    if (A.shape.size() != 2 || B.shape.size() != 2 ||
+        A.type != onnx::TensorProto_DataType_FLOAT || B.type != onnx::TensorProto_DataType_FLOAT) {
+        return false;
+    }
+
+    Halide::Buffer<int32_t> params = t2s_params(offload);
+    float alpha = 1.0f;
+    float beta = 1.0f;
+    for (const auto &attr : node.attribute()) {
+        if (attr.name() == "transA") {
+            params(T2STransA) = attr.i() != 0;
+        }
+        if (attr.name() == "transB") {
+            params(T2STransB) = attr.i() != 0;
+        }
+        if (attr.name() == "alpha") {
+            alpha = attr.f();
+        }
+        if (attr.name() == "beta") {
+            beta = attr.f();
+        }
+    }
+    Halide::Expr dim_i = params(T2STransA) ? A.shape[1] : A.shape[0];
+    Halide::Expr dim_k = params(T2STransA) ? A.shape[0] : A.shape[1];
+    Halide::Expr dim_j = params(T2STransB) ? B.shape[0] : B.shape[1];
+    requirements.push_back(dim_k == (params(T2STransB) ? B.shape[1] : B.shape[0]));
+
+    Halide::Var j;
+    Halide::Func scale(name_for_node(node, "_t2s_scale"));
+    Halide::Func shift(name_for_node(node, "_t2s_shift"));
+    scale(j) = alpha;
+    shift(j) = 0.0f;
+    const Tensor *matrix_bias = nullptr;
+    if (inputs.size() == 3) {
+        const Tensor &C = inputs[2];
+        if (C.shape.size() == 0) {
+            shift(j) = beta * C.rep();
+        } else if (C.shape.size() == 1) {
+            Halide::Expr max_index = Halide::Internal::simplify(
+                Halide::cast<int32_t>(C.shape[0] - 1));
+            shift(j) = beta * C.rep(Halide::clamp(j, 0, max_index));
+        } else {
+            // Added on the CPU after the design, which leaves nothing to fuse.
+            matrix_bias = &C;
+        }
+    }
+
+    std::string output_name = node.output(0);
+    if (offload.fuse && matrix_bias == nullptr) {
+        fuse_relu(graph, output_name, params, fused);
+    }
+
+    Halide::Func product(sanitize_name(output_name) + (matrix_bias ? "_t2s" : ""));
+    product.define_extern(
+        "t2s_gemm_offload",
+        {params, A.rep, B.rep, scale, shift,
+         Halide::cast<int32_t>(dim_i), Halide::cast<int32_t>(dim_k), Halide::cast<int32_t>(dim_j)},
+        Halide::Float(32), 2);
+    extern_inputs.insert(extern_inputs.end(), {A.rep, B.rep, scale, shift});
+
+    Tensor out;
+    out.name = output_name;
+    out.type = A.type;
+    out.shape = {dim_i, dim_j};
+    out.rep = product;
+    if (matrix_bias != nullptr) {
+        Halide::Var x, y;
+        Halide::Expr max_i = Halide::Internal::simplify(
+            Halide::cast<int32_t>(matrix_bias->shape[0] - 1));
+        Halide::Expr max_j = Halide::Internal::simplify(
+            Halide::cast<int32_t>(matrix_bias->shape[1] - 1));
+        out.rep = func_for_node_output(node, 0);
+        out.rep(x, y) = product(x, y) +
+                        beta * matrix_bias->rep(Halide::clamp(x, 0, max_i), Halide::clamp(y, 0, max_j));
+    }
+    reps[output_name] = out;
+    return true;
+}
+
+// Offload a 2-D Conv node of float tensors to the conv design if its kernel and strides match the design,
+// or otherwise to the gemm design as a product of the filters and the patches of the input. The bias, and
+// a BatchNormalization, Relu and MaxPool or AveragePool consuming the result, are fused into the drain stage.
+static bool offload_conv_node(
+    const onnx::GraphProto &graph,
+    int index,
+    const std::vector<Tensor> &inputs,
+    const T2SOffload &offload,
+    std::unordered_map<std::string, Tensor> &reps,
+    std::unordered_set<int> &fused,
+    std::vector<Halide::Expr> &requirements,
+    std::vector<Halide::Func> &extern_inputs) {
+    const onnx::NodeProto &node = graph.node(index);
+    if (inputs.size() < 2) {
+        return false;
+    }
+    const Tensor &X = inputs[0];
+    const Tensor &W = inputs[1];
+    if (X.shape.size() != 4 || W.shape.size() != 4 ||
+        X.type != onnx::TensorProto_DataType_FLOAT || W.type != onnx::TensorProto_DataType_FLOAT) {
+        return false;
+    }
+
+    std::string padding = "NOTSET";
+    int groups = 1;
+    std::vector<int> dilations;
+    std::vector<int> pads;
+    std::vector<int> strides;
+    for (const auto &attr : node.attribute()) {
+        if (attr.name() == "auto_pad") {
+            padding = attr.s();
+        } else if (attr.name() == "group") {
+            groups = attr.i();
+        } else if (attr.name() == "dilations") {
+            for (int axis : attr.ints()) {
+                dilations.push_back(axis);
+            }
+        } else if (attr.name() == "pads") {
+            for (int axis : attr.ints()) {
+                pads.push_back(axis);
+            }
+        } else if (attr.name() == "strides") {
+            for (int axis : attr.ints()) {
+                strides.push_back(axis);
+            }
+        }
+    }
+    pads.resize(4, 0);
+    dilations.resize(2, 1);
+    strides.resize(2, 1);
+    const int64_t *kernel_h = Halide::Internal::as_const_int(Halide::Internal::simplify(W.shape[2]));
+    const int64_t *kernel_w = Halide::Internal::as_const_int(Halide::Internal::simplify(W.shape[3]));
+    if (padding != "NOTSET" || groups != 1 || dilations[0] != 1 || dilations[1] != 1 ||
+        kernel_h == nullptr || kernel_w == nullptr) {
+        return false;
+    }
+    const T2SConvTiling &tiling = offload.conv_tiling;
+    const bool use_conv = offload.conv && *kernel_h == tiling.kernel && *kernel_w == tiling.kernel &&
+                          strides[0] == tiling.stride && strides[1] == tiling.stride;
+    if (!use_conv && !offload.gemm) {
+        return false;
+    }
+
+    Halide::Buffer<int32_t> params = t2s_params(offload);
+    params(T2SUseConv) = use_conv;
+    params(T2SKernelH) = *kernel_h;
+    params(T2SKernelW) = *kernel_w;
+    params(T2SStrideH) = strides[0];
+    params(T2SStrideW) = strides[1];
+    params(T2SPadTop) = pads[0];
+    params(T2SPadLeft) = pads[1];
+    params(T2SPadBottom) = pads[2];
+    params(T2SPadRight) = pads[3];
+    requirements.push_back(W.shape[1] == X.shape[1]);
+
+    std::vector<Halide::Expr> shape = {X.shape[0], W.shape[0], X.shape[2], X.shape[3]};
+    for (int i = 2; i < 4; ++i) {
+        Halide::Expr dim = X.shape[i] + pads[i - 2] + pads[i] - (W.shape[i] - 1);
+        shape[i] = div_up(dim, strides[i - 2]);
+    }
+
+    // The drain stage computes scale(c) * conv(c) + shift(c), which covers the bias and a
+    // BatchNormalization: gamma * (conv + bias - mean) / sqrt(variance + epsilon) + beta.
+    Halide::Var c;
+    Halide::Expr s = 1.0f;
+    Halide::Expr t = 0.0f;
+    if (inputs.size() == 3) {
+        t = inputs[2].rep(c);
+    }
+    std::string output_name = node.output(0);
+    if (offload.fuse) {
+        int next = single_consumer(graph, output_name);
+        if (next >= 0 && graph.node(next).op_type() == "BatchNormalization" &&
+            graph.node(next).input_size() == 5 && graph.node(next).output_size() == 1 &&
+            graph.node(next).input(0) == output_name) {
+            const onnx::NodeProto &bn = graph.node(next);
+            bool available = true;
+            for (int i = 1; i < 5; ++i) {
+                available = available && reps.find(bn.input(i)) != reps.end();
+            }
+            float epsilon = 1e-5f;
+            bool spatial = true;
+            for (const auto &attr : bn.attribute()) {
+                if (attr.name() == "epsilon") {
+                    epsilon = attr.f();
+                }
+                if (attr.name() == "spatial") {
+                    spatial = static_cast<bool>(attr.i());
+                }
+            }
+            if (available && spatial) {
+                Halide::Expr g = reps.at(bn.input(1)).rep(c) /
+                                 Halide::sqrt(reps.at(bn.input(4)).rep(c) + epsilon);
+                s = g;
+                t = g * (t - reps.at(bn.input(3)).rep(c)) + reps.at(bn.input(2)).rep(c);
+                fused.insert(next);
+                output_name = bn.output(0);
+            }
+        }
+        fuse_relu(graph, output_name, params, fused);
+
+        next = single_consumer(graph, output_name);
+        if (next >= 0 && (graph.node(next).op_type() == "MaxPool" || graph.node(next).op_type() == "AveragePool") &&
+            graph.node(next).output_size() == 1) {
+            const onnx::NodeProto &pool = graph.node(next);
+            std::string pool_padding = "NOTSET";
+            std::vector<int> kernel_shape;
+            std::vector<int> pool_pads;
+            std::vector<int> pool_strides;
+            bool supported = true;
+            int count_include_pad = 0;
+            for (const auto &attr : pool.attribute()) {
+                if (attr.name() == "auto_pad") {
+                    pool_padding = attr.s();
+                } else if (attr.name() == "kernel_shape") {
+                    for (int dim : attr.ints()) {
+                        kernel_shape.push_back(dim);
+                    }
+                } else if (attr.name() == "pads") {
+                    for (int pad : attr.ints()) {
+                        pool_pads.push_back(pad);
+                    }
+                } else if (attr.name() == "strides") {
+                    for (int stride : attr.ints()) {
+                        pool_strides.push_back(stride);
+                    }
+                } else if (attr.name() == "count_include_pad") {
+                    count_include_pad = attr.i();
+                } else if ((attr.name() == "ceil_mode" || attr.name() == "storage_order") && attr.i() != 0) {
+                    supported = false;
+                } else if (attr.name() == "dilations") {
+                    for (int d : attr.ints()) {
+                        supported = supported && d == 1;
+                    }
+                }
+            }
+            pool_pads.resize(4, 0);
+            pool_strides.resize(2, 1);
+            if (supported && pool_padding == "NOTSET" && kernel_shape.size() == 2) {
+                params(T2SPool) = pool.op_type() == "MaxPool" ? 1 : 2;
+                params(T2SPoolKernelH) = kernel_shape[0];
+                params(T2SPoolKernelW) = kernel_shape[1];
+                params(T2SPoolStrideH) = pool_strides[0];
+                params(T2SPoolStrideW) = pool_strides[1];
+                params(T2SPoolPadTop) = pool_pads[0];
+                params(T2SPoolPadLeft) = pool_pads[1];
+                params(T2SPoolPadBottom) = pool_pads[2];
+                params(T2SPoolPadRight) = pool_pads[3];
+                params(T2SPoolCountIncludePad) = count_include_pad;
+                for (int i = 2; i < 4; ++i) {
+                    shape[i] = Halide::Internal::simplify(
+                        (shape[i] + pool_pads[i - 2] + pool_pads[i] - kernel_shape[i - 2]) / pool_strides[i - 2] + 1);
+                }
+                fused.insert(next);
+                output_name = pool.output(0);
+            }
+        }
+    }
+    Halide::Func scale(name_for_node(node, "_t2s_scale"));
+    Halide::Func shift(name_for_node(node, "_t2s_shift"));
+    scale(c) = Halide::cast<float>(s);
+    shift(c) = Halide::cast<float>(t);
+
+    Tensor out;
+    out.name = output_name;
+    out.type = X.type;
+    out.shape = shape;
+    out.rep = Halide::Func(sanitize_name(output_name));
+    out.rep.define_extern(
+        "t2s_conv_offload",
+        {params, X.rep, W.rep, scale, shift,
+         Halide::cast<int32_t>(X.shape[0]), Halide::cast<int32_t>(X.shape[1]),
+         Halide::cast<int32_t>(X.shape[2]), Halide::cast<int32_t>(X.shape[3]),
+         Halide::cast<int32_t>(W.shape[0])},
+        Halide::Float(32), 4);
+    extern_inputs.insert(extern_inputs.end(), {X.rep, W.rep, scale, shift});
+    reps[output_name] = out;
+    return true;
+}
+
+static bool offload_node(
+    const onnx::GraphProto &graph,
+    int index,
+    const std::vector<Tensor> &inputs,
+    const T2SOffload &offload,
+    std::unordered_map<std::string, Tensor> &reps,
+    std::unordered_set<int> &fused,
+    std::vector<Halide::Expr> &requirements,
+    std::vector<Halide::Func> &extern_inputs) {
+    const std::string &op = graph.node(index).op_type();
+    if (op == "Gemm" || op == "MatMul") {
+        return offload_gemm_node(graph, index, inputs, offload, reps, fused, requirements, extern_inputs);
+    }
+    if (op == "Conv") {
+        return offload_conv_node(graph, index, inputs, offload, reps, fused, requirements, extern_inputs);
+    }
+    return false;
+}
+
 Node convert_reduction_node(
     const onnx::NodeProto &node,
     const std::vector<Tensor> &inputs) {
@@ -4639,7 +5040,8 @@ std::vector<Halide::Expr> finalize_type_info(
 Model convert_model(
     const onnx::ModelProto &model,
     const std::unordered_map<std::string, int> &expected_dim_sizes,
-    IOLayout layout) {
+    IOLayout layout,
+    const T2SOffload &offload) {
     Model result;
     std::unordered_map<std::string, Tensor> &reps = result.tensors;
     std::unordered_map<std::string, Halide::Internal::Dimension> symbolic_dims;
@@ -4672,7 +5074,7 @@ Model convert_model(
                                     p};
     }
 
-    convert_subgraph(model.graph(), reps, result.requirements);
+    convert_subgraph(model.graph(), reps, result.requirements, offload, &result.offload_inputs);
 
     // Check if output tensors are also used as inputs to other nodes.
     std::unordered_map<std::string, bool> output_types;
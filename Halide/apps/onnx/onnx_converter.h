@@ -3,6 +3,7 @@
 
 #include "Halide.h"
 #include "onnx/onnx.pb.h"
+#include "t2s_offload.h"
 #include <unordered_map>
 #include <vector>
 
@@ -31,6 +32,10 @@ struct Model {
     std::unordered_map<std::string, Tensor> tensors;
 
     std::vector<Halide::Expr> requirements;
+
+    // The inputs of the extern stages of the nodes offloaded to T2S designs. An extern stage reads its
+    // inputs from buffers, so unless the pipeline is auto-scheduled, they must be scheduled compute_root().
+    std::vector<Halide::Func> offload_inputs;
 };
 
 // Layout of the inputs and outputs to the model.
@@ -38,7 +43,8 @@ enum IOLayout {
     Native = 0,
     NumPy = 1,
 };
-Model convert_model(const onnx::ModelProto &model, const std::unordered_map<std::string, int> &expected_dim_sizes, IOLayout layout);
+Model convert_model(const onnx::ModelProto &model, const std::unordered_map<std::string, int> &expected_dim_sizes, IOLayout layout,
+                    const T2SOffload &offload = T2SOffload());
 
 Halide::Type get_halide_type(const Tensor &tensor);
 
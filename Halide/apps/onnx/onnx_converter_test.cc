@@ -498,6 +498,155 @@ static void test_model() {
     EXPECT_EQ(7, output_shape(1));
 }
 
+static void add_constant(onnx::GraphProto *graph, const std::string &name, const std::vector<int> &dims, std::mt19937 &rnd) {
+    onnx::TensorProto *constant = graph->add_initializer();
+    constant->set_name(name);
+    constant->set_data_type(onnx::TensorProto_DataType_FLOAT);
+    int size = 1;
+    for (int dim : dims) {
+        constant->add_dims(dim);
+        size *= dim;
+    }
+    std::uniform_real_distribution<float> dis(0.5, 1.0);
+    for (int i = 0; i < size; ++i) {
+        constant->add_float_data(dis(rnd));
+    }
+}
+
+static void test_t2s_offload() {
+    // Conv + BatchNormalization + Relu + MaxPool, then Gemm + Relu, on designs with small tiles.
+    onnx::ModelProto model;
+    onnx::GraphProto *graph = model.mutable_graph();
+    onnx::ValueInfoProto *input_def = graph->add_input();
+    input_def->set_name("x");
+    input_def->mutable_type()->mutable_tensor_type()->set_elem_type(onnx::TensorProto_DataType_FLOAT);
+    for (int dim : {2, 5, 9, 11}) {
+        input_def->mutable_type()->mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+    }
+    graph->add_output()->set_name("y");
+
+    std::mt19937 rnd;
+    add_constant(graph, "w", {6, 5, 3, 3}, rnd);
+    add_constant(graph, "b", {6}, rnd);
+    for (const char *name : {"gamma", "beta", "mean", "var"}) {
+        add_constant(graph, name, {6}, rnd);
+    }
+    add_constant(graph, "fc", {6 * 4 * 5, 7}, rnd);
+    add_constant(graph, "fc_bias", {7}, rnd);
+
+    onnx::NodeProto *conv = graph->add_node();
+    conv->set_op_type("Conv");
+    for (const char *input : {"x", "w", "b"}) {
+        conv->add_input(input);
+    }
+    conv->add_output("conv");
+    onnx::AttributeProto *pads = conv->add_attribute();
+    pads->set_name("pads");
+    for (int pad : {1, 1, 1, 1}) {
+        pads->add_ints(pad);
+    }
+    onnx::NodeProto *bn = graph->add_node();
+    bn->set_op_type("BatchNormalization");
+    for (const char *input : {"conv", "gamma", "beta", "mean", "var"}) {
+        bn->add_input(input);
+    }
+    bn->add_output("bn");
+    onnx::NodeProto *relu = graph->add_node();
+    relu->set_op_type("Relu");
+    relu->add_input("bn");
+    relu->add_output("relu");
+    onnx::NodeProto *pool = graph->add_node();
+    pool->set_op_type("MaxPool");
+    pool->add_input("relu");
+    pool->add_output("pool");
+    onnx::AttributeProto *kernel_shape = pool->add_attribute();
+    kernel_shape->set_name("kernel_shape");
+    kernel_shape->add_ints(2);
+    kernel_shape->add_ints(2);
+    onnx::AttributeProto *strides = pool->add_attribute();
+    strides->set_name("strides");
+    strides->add_ints(2);
+    strides->add_ints(2);
+    onnx::NodeProto *flatten = graph->add_node();
+    flatten->set_op_type("Flatten");
+    flatten->add_input("pool");
+    flatten->add_output("flat");
+    onnx::NodeProto *gemm = graph->add_node();
+    gemm->set_op_type("Gemm");
+    for (const char *input : {"flat", "fc", "fc_bias"}) {
+        gemm->add_input(input);
+    }
+    gemm->add_output("gemm");
+    onnx::NodeProto *last = graph->add_node();
+    last->set_op_type("Relu");
+    last->add_input("gemm");
+    last->add_output("y");
+
+    Halide::Buffer<float> input_values(2, 5, 9, 11);
+    std::uniform_real_distribution<float> dis(-1.0, 1.0);
+    input_values.for_each_value([&](float &f) { f = dis(rnd); });
+
+    std::unordered_map<std::string, int> dummy;
+    Model reference = convert_model(model, dummy, IOLayout::Native);
+    reference.inputs.at("x").set(input_values);
+    Halide::Buffer<float> expected = reference.outputs.at("y").rep.realize({2, 7});
+
+    T2SOffload offload;
+    offload.gemm = offload.conv = true;
+    offload.gemm_tiling.kkk = offload.gemm_tiling.jjj = offload.gemm_tiling.kk = 2;
+    offload.gemm_tiling.jj = offload.gemm_tiling.ii = 2;
+    offload.gemm_tiling.iii = 3;
+    T2SConvTiling &tiling = offload.conv_tiling;
+    tiling.cii = tiling.ci = tiling.cooo = tiling.coo = tiling.yyy = tiling.xx = tiling.y = 2;
+    tiling.co = tiling.yy = tiling.x = 1;
+    tiling.xxx = 3;
+    int gemm_invocations = t2s_gemm_invocations();
+    int conv_invocations = t2s_conv_invocations();
+    Model converted = convert_model(model, dummy, IOLayout::Native, offload);
+    for (Halide::Func f : converted.offload_inputs) {
+        f.compute_root();
+    }
+    converted.inputs.at("x").set(input_values);
+    Halide::Buffer<float> output_values = converted.outputs.at("y").rep.realize({2, 7});
+    EXPECT_EQ(converted.tensors.count("conv"), 0);
+    EXPECT_EQ(t2s_gemm_invocations() - gemm_invocations, 1);
+    // The channels do not fit in a single invocation of the conv design.
+    EXPECT_EQ(t2s_conv_invocations() - conv_invocations, 4);
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 7; ++j) {
+            EXPECT_NEAR(output_values(i, j), expected(i, j), 1e-3f * std::abs(expected(i, j)) + 1e-3f);
+        }
+    }
+}
+
+static int failing_t2s_design(halide_buffer_t *, halide_buffer_t *, halide_buffer_t *) {
+    return halide_error_code_device_run_failed;
+}
+
+static void test_t2s_offload_error() {
+    // The error of a design is returned by the extern stages.
+    std::vector<int32_t> params(T2SNumParams, 1);
+    params[T2STransA] = params[T2STransB] = params[T2SRelu] = params[T2SPool] = params[T2SUseConv] = 0;
+    params[T2SPadTop] = params[T2SPadLeft] = params[T2SPadBottom] = params[T2SPadRight] = 0;
+    Halide::Buffer<int32_t> p(params.data(), T2SNumParams);
+    Halide::Buffer<float> a(2, 3), b(3, 2), scale(2), shift(2), gemm_out(2, 2);
+    for (Halide::Buffer<float> *buf : {&a, &b, &scale, &shift}) {
+        buf->fill(1.0f);
+    }
+    register_t2s_gemm(failing_t2s_design);
+    EXPECT_EQ(t2s_gemm_offload(p.raw_buffer(), a.raw_buffer(), b.raw_buffer(), scale.raw_buffer(),
+                               shift.raw_buffer(), 2, 3, 2, gemm_out.raw_buffer()),
+              halide_error_code_device_run_failed);
+    // A convolution as a GEMM
+    Halide::Buffer<float> x(1, 1, 2, 2), w(2, 1, 1, 1), conv_out(1, 2, 2, 2);
+    x.fill(1.0f);
+    w.fill(1.0f);
+    EXPECT_EQ(t2s_conv_offload(p.raw_buffer(), x.raw_buffer(), w.raw_buffer(), scale.raw_buffer(),
+                               shift.raw_buffer(), 1, 1, 2, 2, 2, conv_out.raw_buffer()),
+              halide_error_code_device_run_failed);
+    register_t2s_gemm(nullptr);
+}
+
 int main() {
     test_abs();
     test_activation_function();
@@ -511,6 +660,8 @@ int main() {
     test_concat();
     test_constant_fill();
     test_model();
+    test_t2s_offload();
+    test_t2s_offload_error();
     printf("Success!\n");
     return 0;
 }
@@ -0,0 +1,204 @@
+// ResNet-50 with the Conv and Gemm nodes offloaded to the T2S designs, emulated on the CPU, compared with
+// the whole model on the CPU. The weights are random, so only the speed and the agreement of the two
+// pipelines are meaningful.
+//
+// Usage: resnet50_offload_benchmark [image size, 224 by default]
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include "onnx_converter.h"
+#include <cmath>
+#include <random>
+
+namespace {
+
+class ResNet50Builder {
+public:
+    explicit ResNet50Builder(onnx::GraphProto *graph)
+        : graph_(graph) {
+    }
+
+    std::string conv_bn(const std::string &input, int in_channels, int out_channels, int kernel, int stride, bool relu) {
+        std::string name = "conv" + std::to_string(++count_);
+        std::string w = constant(name + "_w", {out_channels, in_channels, kernel, kernel},
+                                 std::sqrt(2.0f / (in_channels * kernel * kernel)));
+        onnx::NodeProto *conv = add_node("Conv", name, {input, w});
+        int pad = kernel / 2;
+        add_ints(conv, "kernel_shape", {kernel, kernel});
+        add_ints(conv, "strides", {stride, stride});
+        add_ints(conv, "pads", {pad, pad, pad, pad});
+
+        std::string bn = name + "_bn";
+        add_node("BatchNormalization", bn,
+                 {name, constant(bn + "_scale", {out_channels}, 1.0f, 1.0f),
+                  constant(bn + "_bias", {out_channels}, 0.1f), constant(bn + "_mean", {out_channels}, 0.1f),
+                  constant(bn + "_var", {out_channels}, 0.5f, 1.0f)});
+        if (!relu) {
+            return bn;
+        }
+        add_node("Relu", bn + "_relu", {bn});
+        return bn + "_relu";
+    }
+
+    std::string bottleneck(const std::string &input, int in_channels, int width, int stride) {
+        std::string x = conv_bn(input, in_channels, width, 1, 1, true);
+        x = conv_bn(x, width, width, 3, stride, true);
+        x = conv_bn(x, width, width * 4, 1, 1, false);
+        std::string shortcut = input;
+        if (stride != 1 || in_channels != width * 4) {
+            shortcut = conv_bn(input, in_channels, width * 4, 1, stride, false);
+        }
+        std::string sum = x + "_add";
+        add_node("Add", sum, {x, shortcut});
+        add_node("Relu", sum + "_relu", {sum});
+        return sum + "_relu";
+    }
+
+    void build(int size) {
+        onnx::ValueInfoProto *input = graph_->add_input();
+        input->set_name("image");
+        input->mutable_type()->mutable_tensor_type()->set_elem_type(onnx::TensorProto_DataType_FLOAT);
+        for (int dim : {1, 3, size, size}) {
+            input->mutable_type()->mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+        }
+
+        std::string x = conv_bn("image", 3, 64, 7, 2, true);
+        onnx::NodeProto *pool = add_node("MaxPool", "pool1", {x});
+        add_ints(pool, "kernel_shape", {3, 3});
+        add_ints(pool, "strides", {2, 2});
+        add_ints(pool, "pads", {1, 1, 1, 1});
+        x = "pool1";
+
+        const int blocks[] = {3, 4, 6, 3};
+        int channels = 64;
+        for (int stage = 0; stage < 4; stage++) {
+            int width = 64 << stage;
+            for (int b = 0; b < blocks[stage]; b++) {
+                x = bottleneck(x, channels, width, (b == 0 && stage > 0) ? 2 : 1);
+                channels = width * 4;
+            }
+        }
+        add_node("GlobalAveragePool", "pool5", {x});
+        add_node("Flatten", "flatten", {"pool5"});
+        onnx::NodeProto *fc = add_node("Gemm", "fc", {"flatten", constant("fc_w", {1000, channels}, std::sqrt(1.0f / channels)),
+                                                      constant("fc_b", {1000}, 0.1f)});
+        add_int(fc, "transB", 1);
+        graph_->add_output()->set_name("fc");
+    }
+
+private:
+    onnx::NodeProto *add_node(const std::string &op, const std::string &output, const std::vector<std::string> &inputs) {
+        onnx::NodeProto *node = graph_->add_node();
+        node->set_op_type(op);
+        node->set_name(output);
+        for (const std::string &input : inputs) {
+            node->add_input(input);
+        }
+        node->add_output(output);
+        return node;
+    }
+
+    void add_ints(onnx::NodeProto *node, const std::string &name, const std::vector<int> &values) {
+        onnx::AttributeProto *attr = node->add_attribute();
+        attr->set_name(name);
+        for (int value : values) {
+            attr->add_ints(value);
+        }
+    }
+
+    void add_int(onnx::NodeProto *node, const std::string &name, int value) {
+        onnx::AttributeProto *attr = node->add_attribute();
+        attr->set_name(name);
+        attr->set_i(value);
+    }
+
+    // A constant of uniformly distributed values in [offset - range, offset + range]
+    std::string constant(const std::string &name, const std::vector<int> &dims, float range, float offset = 0.0f) {
+        onnx::TensorProto *tensor = graph_->add_initializer();
+        tensor->set_name(name);
+        tensor->set_data_type(onnx::TensorProto_DataType_FLOAT);
+        int size = 1;
+        for (int dim : dims) {
+            tensor->add_dims(dim);
+            size *= dim;
+        }
+        std::uniform_real_distribution<float> dis(offset - range, offset + range);
+        for (int i = 0; i < size; i++) {
+            tensor->add_float_data(dis(rnd_));
+        }
+        return name;
+    }
+
+    onnx::GraphProto *graph_;
+    std::mt19937 rnd_;
+    int count_ = 0;
+};
+
+Halide::Pipeline compile(Model &model, const Halide::Target &target, int size) {
+    Halide::Func output = model.outputs.at("fc").rep;
+    model.inputs.at("image").set_estimates({{0, 1}, {0, 3}, {0, size}, {0, size}});
+    output.set_estimates({{0, 1}, {0, 1000}});
+    Halide::Pipeline pipeline(output);
+    for (const Halide::Expr &requirement : model.requirements) {
+        if (Halide::Internal::is_pure(requirement)) {
+            pipeline.add_requirement(requirement);
+        }
+    }
+    pipeline.auto_schedule(target);
+    pipeline.compile_jit(target);
+    return pipeline;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    const int size = argc > 1 ? atoi(argv[1]) : 224;
+    onnx::ModelProto onnx_model;
+    ResNet50Builder(onnx_model.mutable_graph()).build(size);
+
+    Halide::Buffer<float> image(1, 3, size, size);
+    std::mt19937 rnd;
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    image.for_each_value([&](float &f) { f = dis(rnd); });
+
+    const Halide::Target target = Halide::get_host_target();
+    std::unordered_map<std::string, int> expected_dim_sizes;
+    Model cpu_model = convert_model(onnx_model, expected_dim_sizes, IOLayout::Native);
+    Halide::Pipeline cpu = compile(cpu_model, target, size);
+    cpu_model.inputs.at("image").set(image);
+    Halide::Buffer<float> expected(1, 1000);
+
+    T2SOffload offload;
+    offload.gemm = offload.conv = true;
+    Model t2s_model = convert_model(onnx_model, expected_dim_sizes, IOLayout::Native, offload);
+    Halide::Pipeline t2s = compile(t2s_model, target, size);
+    t2s_model.inputs.at("image").set(image);
+    Halide::Buffer<float> actual(1, 1000);
+
+    Halide::Tools::BenchmarkConfig config;
+    config.accuracy = 0.1;
+    config.max_time = 10.0;
+    double cpu_time = Halide::Tools::benchmark([&]() { cpu.realize(expected); }, config).wall_time;
+    int gemm_invocations = t2s_gemm_invocations();
+    int conv_invocations = t2s_conv_invocations();
+    t2s.realize(actual);
+    gemm_invocations = t2s_gemm_invocations() - gemm_invocations;
+    conv_invocations = t2s_conv_invocations() - conv_invocations;
+    double t2s_time = Halide::Tools::benchmark([&]() { t2s.realize(actual); }, config).wall_time;
+
+    double max_error = 0.0;
+    for (int i = 0; i < 1000; i++) {
+        double error = std::abs(actual(0, i) - expected(0, i)) / std::max(1.0f, std::abs(expected(0, i)));
+        max_error = std::max(max_error, error);
+    }
+    printf("ResNet-50 on a %dx%d image\n", size, size);
+    printf("  CPU:              %10.3f ms\n", cpu_time * 1e3);
+    printf("  T2S (emulated):   %10.3f ms, %d invocations of gemm and %d of conv per inference\n",
+           t2s_time * 1e3, gemm_invocations, conv_invocations);
+    printf("  Max relative error: %g\n", max_error);
+    if (max_error > 1e-3) {
+        printf("Mismatch!\n");
+        return -1;
+    }
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,419 @@
+#include "t2s_offload.h"
+#include "HalideBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+using Halide::Runtime::Buffer;
+
+T2SDesign gemm_design = nullptr;
+T2SDesign conv_design = nullptr;
+int gemm_count = 0;
+int conv_count = 0;
+
+int round_up(int x, int m) {
+    return (x + m - 1) / m * m;
+}
+
+int div_up(int x, int m) {
+    return (x + m - 1) / m;
+}
+
+// Answer a bounds query of the extern stage: every input is needed as a whole.
+void query_shape(halide_buffer_t *buf, const std::vector<int> &shape) {
+    if (!buf->is_bounds_query()) {
+        return;
+    }
+    for (size_t d = 0; d < shape.size(); d++) {
+        buf->dim[d].min = 0;
+        buf->dim[d].extent = shape[d];
+    }
+}
+
+struct Params {
+    const int32_t *p;
+    int operator[](int i) const {
+        return p[i];
+    }
+};
+
+// A dense result in row-major order, e.g. (i, j) of a GEMM or (n, c, y, x) of a convolution.
+struct Dense {
+    std::vector<int> shape;
+    std::vector<float> data;
+
+    explicit Dense(const std::vector<int> &s)
+        : shape(s) {
+        size_t size = 1;
+        for (int e : s) {
+            size *= e;
+        }
+        data.assign(size, 0.0f);
+    }
+    float &at(int i, int j) {
+        return data[(size_t)i * shape[1] + j];
+    }
+    float &at(int n, int c, int y, int x) {
+        return data[(((size_t)n * shape[1] + c) * shape[2] + y) * shape[3] + x];
+    }
+};
+
+// The gemm design computes C(jjj, iii, jj, ii, j, i) = sum_k A(k, i) * B(j, k), for A(TOTAL_K, TOTAL_I) and
+// B(TOTAL_J, TOTAL_K) whose extents are multiples of the tiles.
+void emulate_gemm(const Params &t, Buffer<float> &a, Buffer<float> &b, Buffer<float> &c) {
+    const int total_i = a.dim(1).extent(), total_j = b.dim(0).extent(), total_k = a.dim(0).extent();
+    std::vector<float> row(total_j);
+    for (int i = 0; i < total_i; i++) {
+        std::fill(row.begin(), row.end(), 0.0f);
+        for (int k = 0; k < total_k; k++) {
+            float aik = a(k, i);
+            if (aik == 0.0f) {
+                continue;
+            }
+            const float *bk = &b(0, k);
+            for (int j = 0; j < total_j; j++) {
+                row[j] += aik * bk[j];
+            }
+        }
+        int iii = i % t[T2SGemmIII], ii = i / t[T2SGemmIII] % t[T2SGemmII], i_tile = i / (t[T2SGemmIII] * t[T2SGemmII]);
+        for (int j = 0; j < total_j; j++) {
+            int jjj = j % t[T2SGemmJJJ], jj = j / t[T2SGemmJJJ] % t[T2SGemmJJ], j_tile = j / (t[T2SGemmJJJ] * t[T2SGemmJJ]);
+            c(jjj, iii, jj, ii, j_tile, i_tile) = row[j];
+        }
+    }
+}
+
+// Pad A(rows, depth) and B(depth, cols) to the tiles of the gemm design, and invoke it. The result is
+// rows x cols. Returns the error of the design, if any.
+template<typename FA, typename FB>
+int run_gemm(const Params &t, int rows, int depth, int cols, FA get_a, FB get_b, Dense &result) {
+    const int i_tile = t[T2SGemmIII] * t[T2SGemmII];
+    const int j_tile = t[T2SGemmJJJ] * t[T2SGemmJJ];
+    const int k_tile = t[T2SGemmKKK] * t[T2SGemmKK];
+    const int total_i = round_up(rows, i_tile), total_j = round_up(cols, j_tile), total_k = round_up(depth, k_tile);
+
+    Buffer<float> a(total_k, total_i), b(total_j, total_k);
+    a.fill(0.0f);
+    b.fill(0.0f);
+    for (int i = 0; i < rows; i++) {
+        for (int k = 0; k < depth; k++) {
+            a(k, i) = get_a(i, k);
+        }
+    }
+    for (int k = 0; k < depth; k++) {
+        for (int j = 0; j < cols; j++) {
+            b(j, k) = get_b(k, j);
+        }
+    }
+    Buffer<float> c(t[T2SGemmJJJ], t[T2SGemmIII], t[T2SGemmJJ], t[T2SGemmII], total_j / j_tile, total_i / i_tile);
+    gemm_count++;
+    if (gemm_design != nullptr) {
+        int ret = gemm_design(a.raw_buffer(), b.raw_buffer(), c.raw_buffer());
+        if (ret != 0) {
+            return ret;
+        }
+        c.copy_to_host();
+    } else {
+        emulate_gemm(t, a, b, c);
+    }
+
+    for (int i = 0; i < rows; i++) {
+        int iii = i % t[T2SGemmIII], ii = i / t[T2SGemmIII] % t[T2SGemmII], i_t = i / i_tile;
+        for (int j = 0; j < cols; j++) {
+            int jjj = j % t[T2SGemmJJJ], jj = j / t[T2SGemmJJJ] % t[T2SGemmJJ], j_t = j / j_tile;
+            result.at(i, j) = c(jjj, iii, jj, ii, j_t, i_t);
+        }
+    }
+    return 0;
+}
+
+// The conv design computes O(cooo, yyy, xxx, coo, yy, xx, y, x, co, n) for n patches of input
+// I(ci + TOTAL_CI * n, iy + TOTAL_IY * ix) and filters K(co + TOTAL_CO * kx, ci + TOTAL_CI * ky).
+void emulate_conv(const Params &t, Buffer<float> &in, Buffer<float> &k, Buffer<float> &o) {
+    const int kernel = t[T2SConvKernel], stride = t[T2SConvStride];
+    const int total_ci = t[T2SConvCII] * t[T2SConvCI];
+    const int total_co = t[T2SConvCOOO] * t[T2SConvCOO] * t[T2SConvCO];
+    const int total_oy = t[T2SConvYYY] * t[T2SConvYY] * t[T2SConvY];
+    const int total_ox = t[T2SConvXXX] * t[T2SConvXX] * t[T2SConvX];
+    const int total_iy = stride * (total_oy - 1) + kernel;
+    const int patches = o.dim(9).extent();
+    std::vector<float> acc((size_t)total_ox * total_oy);
+    for (int n = 0; n < patches; n++) {
+        for (int c = 0; c < total_co; c++) {
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            for (int ci = 0; ci < total_ci; ci++) {
+                for (int kx = 0; kx < kernel; kx++) {
+                    for (int ky = 0; ky < kernel; ky++) {
+                        float w = k(c + total_co * kx, ci + total_ci * ky);
+                        if (w == 0.0f) {
+                            continue;
+                        }
+                        for (int ox = 0; ox < total_ox; ox++) {
+                            const float *col = &in(ci + total_ci * n, ky + total_iy * (stride * ox + kx));
+                            float *a = &acc[(size_t)ox * total_oy];
+                            for (int oy = 0; oy < total_oy; oy++) {
+                                a[oy] += w * col[stride * oy * in.dim(1).stride()];
+                            }
+                        }
+                    }
+                }
+            }
+            int cooo = c % t[T2SConvCOOO], coo = c / t[T2SConvCOOO] % t[T2SConvCOO], co = c / (t[T2SConvCOOO] * t[T2SConvCOO]);
+            for (int ox = 0; ox < total_ox; ox++) {
+                int xxx = ox % t[T2SConvXXX], xx = ox / t[T2SConvXXX] % t[T2SConvXX], x = ox / (t[T2SConvXXX] * t[T2SConvXX]);
+                for (int oy = 0; oy < total_oy; oy++) {
+                    int yyy = oy % t[T2SConvYYY], yy = oy / t[T2SConvYYY] % t[T2SConvYY], y = oy / (t[T2SConvYYY] * t[T2SConvYY]);
+                    o(cooo, yyy, xxx, coo, yy, xx, y, x, co, n) = acc[(size_t)ox * total_oy + oy];
+                }
+            }
+        }
+    }
+}
+
+// Convolve X with W through the conv design. The output is cut into patches of the output tile of the
+// design, which are batched along n. The channels are blocked into the channels of the design, and the
+// partial sums over the blocks of input channels are added up on the host. The result must be zero. Returns
+// the error of the design, if any.
+int run_conv_design(const Params &t, Buffer<float> &x, Buffer<float> &w, int batch, int channels,
+                    int height, int width, int out_channels, int out_h, int out_w, Dense &result) {
+    const int kernel = t[T2SConvKernel], stride = t[T2SConvStride];
+    const int total_ci = t[T2SConvCII] * t[T2SConvCI];
+    const int total_co = t[T2SConvCOOO] * t[T2SConvCOO] * t[T2SConvCO];
+    const int total_oy = t[T2SConvYYY] * t[T2SConvYY] * t[T2SConvY];
+    const int total_ox = t[T2SConvXXX] * t[T2SConvXX] * t[T2SConvX];
+    const int total_iy = stride * (total_oy - 1) + kernel;
+    const int total_ix = stride * (total_ox - 1) + kernel;
+    const int tiles_y = div_up(out_h, total_oy), tiles_x = div_up(out_w, total_ox);
+    const int patches = batch * tiles_y * tiles_x;
+    const int pad_top = t[T2SPadTop], pad_left = t[T2SPadLeft];
+
+    for (int cob = 0; cob < div_up(out_channels, total_co); cob++) {
+        for (int cib = 0; cib < div_up(channels, total_ci); cib++) {
+            Buffer<float> in(total_ci * patches, total_iy * total_ix), k(total_co * kernel, total_ci * kernel);
+            in.fill(0.0f);
+            k.fill(0.0f);
+            for (int p = 0; p < patches; p++) {
+                int n = p / (tiles_y * tiles_x), ty = p / tiles_x % tiles_y, tx = p % tiles_x;
+                for (int ci = 0; ci < total_ci && cib * total_ci + ci < channels; ci++) {
+                    for (int ix = 0; ix < total_ix; ix++) {
+                        int sx = tx * total_ox * stride + ix - pad_left;
+                        if (sx < 0 || sx >= width) {
+                            continue;
+                        }
+                        for (int iy = 0; iy < total_iy; iy++) {
+                            int sy = ty * total_oy * stride + iy - pad_top;
+                            if (sy >= 0 && sy < height) {
+                                in(ci + total_ci * p, iy + total_iy * ix) = x(n, cib * total_ci + ci, sy, sx);
+                            }
+                        }
+                    }
+                }
+            }
+            for (int co = 0; co < total_co && cob * total_co + co < out_channels; co++) {
+                for (int ci = 0; ci < total_ci && cib * total_ci + ci < channels; ci++) {
+                    for (int kx = 0; kx < kernel; kx++) {
+                        for (int ky = 0; ky < kernel; ky++) {
+                            k(co + total_co * kx, ci + total_ci * ky) = w(cob * total_co + co, cib * total_ci + ci, ky, kx);
+                        }
+                    }
+                }
+            }
+            Buffer<float> o(t[T2SConvCOOO], t[T2SConvYYY], t[T2SConvXXX], t[T2SConvCOO], t[T2SConvYY], t[T2SConvXX],
+                            t[T2SConvY], t[T2SConvX], t[T2SConvCO], patches);
+            conv_count++;
+            if (conv_design != nullptr) {
+                int ret = conv_design(in.raw_buffer(), k.raw_buffer(), o.raw_buffer());
+                if (ret != 0) {
+                    return ret;
+                }
+                o.copy_to_host();
+            } else {
+                emulate_conv(t, in, k, o);
+            }
+            o.for_each_element([&](const int *pos) {
+                int oy = pos[1] + t[T2SConvYYY] * (pos[4] + t[T2SConvYY] * pos[6]);
+                int ox = pos[2] + t[T2SConvXXX] * (pos[5] + t[T2SConvXX] * pos[7]);
+                int c = cob * total_co + pos[0] + t[T2SConvCOOO] * (pos[3] + t[T2SConvCOO] * pos[8]);
+                int p = pos[9], n = p / (tiles_y * tiles_x);
+                oy += p / tiles_x % tiles_y * total_oy;
+                ox += p % tiles_x * total_ox;
+                if (c < out_channels && oy < out_h && ox < out_w) {
+                    result.at(n, c, oy, ox) += o(pos);
+                }
+            });
+        }
+    }
+    return 0;
+}
+
+// Convolve X with W as a GEMM of the filters and the patches of X (im2col) through the gemm design.
+// Returns the error of the design, if any.
+int run_conv_as_gemm(const Params &t, Buffer<float> &x, Buffer<float> &w, int batch, int channels,
+                     int height, int width, int out_channels, int out_h, int out_w, Dense &result) {
+    const int kh = t[T2SKernelH], kw = t[T2SKernelW], sh = t[T2SStrideH], sw = t[T2SStrideW];
+    const int pad_top = t[T2SPadTop], pad_left = t[T2SPadLeft];
+    const int pixels = batch * out_h * out_w, depth = channels * kh * kw;
+    Dense g({pixels, out_channels});
+    int ret = run_gemm(
+        t, pixels, depth, out_channels,
+        [&](int i, int k) {
+            int n = i / (out_h * out_w), oy = i / out_w % out_h, ox = i % out_w;
+            int ci = k / (kh * kw), ky = k / kw % kh, kx = k % kw;
+            int sy = oy * sh + ky - pad_top, sx = ox * sw + kx - pad_left;
+            return (sy >= 0 && sy < height && sx >= 0 && sx < width) ? x(n, ci, sy, sx) : 0.0f;
+        },
+        [&](int k, int j) { return w(j, k / (kh * kw), k / kw % kh, k % kw); }, g);
+    if (ret != 0) {
+        return ret;
+    }
+
+    for (int i = 0; i < pixels; i++) {
+        int n = i / (out_h * out_w), oy = i / out_w % out_h, ox = i % out_w;
+        for (int c = 0; c < out_channels; c++) {
+            result.at(n, c, oy, ox) = g.at(i, c);
+        }
+    }
+    return 0;
+}
+
+// The ops fused into the drain stage, applied per element while the results are unpacked
+void scale_shift_relu(const Params &t, Dense &d, int channel_dim, Buffer<float> &scale, Buffer<float> &shift) {
+    size_t inner = 1;
+    for (size_t i = channel_dim + 1; i < d.shape.size(); i++) {
+        inner *= d.shape[i];
+    }
+    const int channels = d.shape[channel_dim];
+    const bool relu = t[T2SRelu] != 0;
+    for (size_t i = 0; i < d.data.size(); i++) {
+        int c = (int)(i / inner % channels);
+        float v = scale(c) * d.data[i] + shift(c);
+        d.data[i] = relu ? std::max(v, 0.0f) : v;
+    }
+}
+
+Dense pool(const Params &t, Dense &d) {
+    const int kh = t[T2SPoolKernelH], kw = t[T2SPoolKernelW], sh = t[T2SPoolStrideH], sw = t[T2SPoolStrideW];
+    const int pt = t[T2SPoolPadTop], pl = t[T2SPoolPadLeft];
+    const int h = d.shape[2], w = d.shape[3];
+    const int ph = (h + pt + t[T2SPoolPadBottom] - kh) / sh + 1;
+    const int pw = (w + pl + t[T2SPoolPadRight] - kw) / sw + 1;
+    const bool is_max = t[T2SPool] == 1;
+    Dense result({d.shape[0], d.shape[1], ph, pw});
+    for (int n = 0; n < d.shape[0]; n++)
+    for (int c = 0; c < d.shape[1]; c++)
+    for (int y = 0; y < ph; y++)
+    for (int x = 0; x < pw; x++) {
+        float v = is_max ? -std::numeric_limits<float>::infinity() : 0.0f;
+        int count = 0;
+        for (int ky = 0; ky < kh; ky++) {
+            for (int kx = 0; kx < kw; kx++) {
+                int sy = y * sh + ky - pt, sx = x * sw + kx - pl;
+                if (sy < 0 || sy >= h || sx < 0 || sx >= w) {
+                    continue;
+                }
+                float e = d.at(n, c, sy, sx);
+                v = is_max ? std::max(v, e) : v + e;
+                count++;
+            }
+        }
+        if (!is_max) {
+            v /= t[T2SPoolCountIncludePad] ? kh * kw : std::max(count, 1);
+        }
+        result.at(n, c, y, x) = v;
+    }
+    return result;
+}
+
+// Copy the region of the result requested by the pipeline.
+void copy_out(Dense &d, halide_buffer_t *out) {
+    Buffer<float> o(*out);
+    o.for_each_element([&](const int *pos) {
+        if (d.shape.size() == 2) {
+            o(pos) = d.at(pos[0], pos[1]);
+        } else {
+            o(pos) = d.at(pos[0], pos[1], pos[2], pos[3]);
+        }
+    });
+}
+
+}  // namespace
+
+extern "C" {
+
+void register_t2s_gemm(T2SDesign gemm) {
+    gemm_design = gemm;
+}
+
+void register_t2s_conv(T2SDesign conv) {
+    conv_design = conv;
+}
+
+int t2s_gemm_invocations() {
+    return gemm_count;
+}
+
+int t2s_conv_invocations() {
+    return conv_count;
+}
+
+int t2s_gemm_offload(halide_buffer_t *params, halide_buffer_t *a, halide_buffer_t *b,
+                     halide_buffer_t *scale, halide_buffer_t *shift,
+                     int rows, int depth, int cols, halide_buffer_t *out) {
+    Params t{(const int32_t *)params->host};
+    const bool trans_a = t[T2STransA] != 0, trans_b = t[T2STransB] != 0;
+    if (a->is_bounds_query() || b->is_bounds_query() || scale->is_bounds_query() || shift->is_bounds_query()) {
+        query_shape(a, trans_a ? std::vector<int>{depth, rows} : std::vector<int>{rows, depth});
+        query_shape(b, trans_b ? std::vector<int>{cols, depth} : std::vector<int>{depth, cols});
+        query_shape(scale, {cols});
+        query_shape(shift, {cols});
+        return 0;
+    }
+    Buffer<float> A(*a), B(*b), Scale(*scale), Shift(*shift);
+    Dense d({rows, cols});
+    int ret = run_gemm(
+        t, rows, depth, cols,
+        [&](int i, int k) { return trans_a ? A(k, i) : A(i, k); },
+        [&](int k, int j) { return trans_b ? B(j, k) : B(k, j); }, d);
+    if (ret != 0) {
+        return ret;
+    }
+    scale_shift_relu(t, d, 1, Scale, Shift);
+    copy_out(d, out);
+    return 0;
+}
+
+int t2s_conv_offload(halide_buffer_t *params, halide_buffer_t *x, halide_buffer_t *w,
+                     halide_buffer_t *scale, halide_buffer_t *shift,
+                     int batch, int channels, int height, int width, int out_channels,
+                     halide_buffer_t *out) {
+    Params t{(const int32_t *)params->host};
+    if (x->is_bounds_query() || w->is_bounds_query() || scale->is_bounds_query() || shift->is_bounds_query()) {
+        query_shape(x, {batch, channels, height, width});
+        query_shape(w, {out_channels, channels, t[T2SKernelH], t[T2SKernelW]});
+        query_shape(scale, {out_channels});
+        query_shape(shift, {out_channels});
+        return 0;
+    }
+    Buffer<float> X(*x), W(*w), Scale(*scale), Shift(*shift);
+    const int out_h = (height + t[T2SPadTop] + t[T2SPadBottom] - t[T2SKernelH]) / t[T2SStrideH] + 1;
+    const int out_w = (width + t[T2SPadLeft] + t[T2SPadRight] - t[T2SKernelW]) / t[T2SStrideW] + 1;
+    Dense d({batch, out_channels, out_h, out_w});
+    int ret = t[T2SUseConv] ? run_conv_design(t, X, W, batch, channels, height, width, out_channels, out_h, out_w, d)
+                            : run_conv_as_gemm(t, X, W, batch, channels, height, width, out_channels, out_h, out_w, d);
+    if (ret != 0) {
+        return ret;
+    }
+    scale_shift_relu(t, d, 1, Scale, Shift);
+    if (t[T2SPool] != 0) {
+        Dense pooled = pool(t, d);
+        copy_out(pooled, out);
+    } else {
+        copy_out(d, out);
+    }
+    return 0;
+}
+
+}  // extern "C"
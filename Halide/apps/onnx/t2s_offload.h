@@ -0,0 +1,92 @@
+#ifndef T2S_OFFLOAD_H_
+#define T2S_OFFLOAD_H_
+
+// Offload of Gemm, MatMul and Conv nodes to the pre-built T2S systolic designs in t2s/tests/performance
+// (gemm and conv). An offloaded node becomes an extern stage of the Halide pipeline, which pads its
+// operands to multiples of the tiles of a design, invokes the design, and applies the ops fused into the
+// drain stage (a per-channel scale and shift for the bias and BatchNormalization, Relu, and MaxPool or
+// AveragePool) while unpacking the results. The other nodes stay on the CPU pipeline.
+//
+// A design is invoked through its generated interface, registered with register_t2s_gemm() or
+// register_t2s_conv(). Without a registered interface, the design is emulated on the CPU with the same
+// data layout and tiling, which is useful for testing a model before the bitstreams are ready.
+
+#include "HalideRuntime.h"
+
+// The extern stages are looked up by name when a pipeline is JIT-compiled, so they are visible even if the
+// library is built with -fvisibility=hidden.
+#ifdef _WIN32
+#define T2S_OFFLOAD_EXPORT __declspec(dllexport)
+#else
+#define T2S_OFFLOAD_EXPORT __attribute__((visibility("default")))
+#endif
+
+// The tiling of the gemm design, as in t2s/tests/performance/gemm/const-parameters.h. The defaults are for A10.
+struct T2SGemmTiling {
+    int kkk = 16, jjj = 8, iii = 10, kk = 32, jj = 32, ii = 32;
+};
+
+// The tiling of the conv design, as in t2s/tests/performance/conv/const-parameters.h. The defaults are for
+// A10. The design convolves with a kernel x kernel filter at the given stride, without groups.
+struct T2SConvTiling {
+    int cii = 16, ci = 16, cooo = 8, coo = 16, co = 2;
+    int yyy = 10, xxx = 16, yy = 2, xx = 2, y = 3, x = 2;
+    int kernel = 3, stride = 1;
+};
+
+struct T2SOffload {
+    bool gemm = false;  // Offload Gemm and MatMul nodes, and the Conv nodes the conv design does not fit
+    bool conv = false;  // Offload Conv nodes to the conv design
+    bool fuse = true;   // Fuse BatchNormalization, Relu and pooling following an offloaded node
+    T2SGemmTiling gemm_tiling;
+    T2SConvTiling conv_tiling;
+};
+
+// The static parameters of an offloaded node, passed to the extern stage in a buffer.
+enum T2SParam {
+    // Tiling of the designs
+    T2SGemmKKK, T2SGemmJJJ, T2SGemmIII, T2SGemmKK, T2SGemmJJ, T2SGemmII,
+    T2SConvCII, T2SConvCI, T2SConvCOOO, T2SConvCOO, T2SConvCO,
+    T2SConvYYY, T2SConvXXX, T2SConvYY, T2SConvXX, T2SConvY, T2SConvX,
+    T2SConvKernel, T2SConvStride, T2SUseConv,
+    // The node
+    T2STransA, T2STransB,
+    T2SKernelH, T2SKernelW, T2SStrideH, T2SStrideW,
+    T2SPadTop, T2SPadLeft, T2SPadBottom, T2SPadRight,
+    // The fused ops
+    T2SRelu,
+    T2SPool,  // 0: none, 1: MaxPool, 2: AveragePool
+    T2SPoolKernelH, T2SPoolKernelW, T2SPoolStrideH, T2SPoolStrideW,
+    T2SPoolPadTop, T2SPoolPadLeft, T2SPoolPadBottom, T2SPoolPadRight,
+    T2SPoolCountIncludePad,
+    T2SNumParams
+};
+
+// The generated interfaces: gemm(A, B, C) and conv(I, K, O). A non-zero result is an error, which the extern
+// stages return.
+typedef int (*T2SDesign)(halide_buffer_t *, halide_buffer_t *, halide_buffer_t *);
+
+extern "C" {
+
+void register_t2s_gemm(T2SDesign gemm);
+void register_t2s_conv(T2SDesign conv);
+
+// The number of invocations of the designs so far, for testing
+int t2s_gemm_invocations();
+int t2s_conv_invocations();
+
+// The extern stages. out(i, j) = relu(scale(j) * sum_k A(i, k) * B(k, j) + shift(j)), where A and B are
+// transposed as in the params.
+T2S_OFFLOAD_EXPORT int t2s_gemm_offload(halide_buffer_t *params, halide_buffer_t *a, halide_buffer_t *b,
+                                        halide_buffer_t *scale, halide_buffer_t *shift,
+                                        int rows, int depth, int cols, halide_buffer_t *out);
+
+// out(n, c, y, x) = pool(relu(scale(c) * conv(X, W)(n, c, y, x) + shift(c))), for X(n, ci, h, w) and
+// W(c, ci, kh, kw).
+T2S_OFFLOAD_EXPORT int t2s_conv_offload(halide_buffer_t *params, halide_buffer_t *x, halide_buffer_t *w,
+                                        halide_buffer_t *scale, halide_buffer_t *shift,
+                                        int batch, int channels, int height, int width, int out_channels,
+                                        halide_buffer_t *out);
+}
+
+#endif
@@ -152,6 +152,10 @@ void define_enums(py::module &m) {
         .value("SVE2", Target::Feature::SVE2)
         .value("IntelFPGA", Target::Feature::IntelFPGA)
         .value("IntelGPU", Target::Feature::IntelGPU)
+        .value("ProfileDevice", Target::Feature::ProfileDevice)
+        .value("WidenChannels", Target::Feature::WidenChannels)
+        .value("PredicateChannels", Target::Feature::PredicateChannels)
+        .value("DisableGPUMicroKernel", Target::Feature::DisableGPUMicroKernel)
         .value("FeatureEnd", Target::Feature::FeatureEnd);
 
     py::enum_<halide_type_code_t>(m, "TypeCode")
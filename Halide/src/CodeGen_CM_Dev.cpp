@@ -344,6 +344,9 @@ void CodeGen_CM_Dev::CodeGen_CM_C::print_media_block_rw(Type t, vector<Expr> arg
     int bytes = t.bits() / 8;
     int max_cols_at_once = (cols < 8 ? cols : 8);
     int max_rows_at_once = 256 / (max_cols_at_once*bytes);
+    // The base is not a constant when the buffer is double buffered
+    auto ramp = args[4].as<Ramp>();
+    string ramp_base = print_expr(ramp->base);
 
     for (int i = 0; i < rows; i += max_rows_at_once) {
         int rows_at_once = i + max_rows_at_once <= rows ? max_rows_at_once : rows-i;
@@ -354,9 +357,8 @@ void CodeGen_CM_Dev::CodeGen_CM_C::print_media_block_rw(Type t, vector<Expr> arg
             stream << print_name(print_expr(args[0])) << ", ";
             stream << print_expr(args[1] * bytes) << ", ";
             stream << print_expr(args[2] + i) << ", ";
-            auto ramp = args[4].as<Ramp>();
             stream << print_expr(args[3]) << ".select<"
-               << ramp->lanes << ", " << ramp->stride << ">(" << ramp->base << ")"
+               << ramp->lanes << ", " << ramp->stride << ">(" << ramp_base << ")"
                << ".format<" << print_type(t) << ", " << rows << ", " << cols << ">()"
                << ".select<" << rows_at_once << ", 1, " << cols_at_once << ", 1>("
                << i << ", " << j << "));\n";
@@ -1728,15 +1728,18 @@ void CodeGen_Clear_C::compile(const Module &input) {
             f.body.accept(&g);
         }
 
-        stream << "int MAX_DEVICES = 4;\n"
+        stream << "int MAX_DEVICES = " << max_devices << ";\n"
                << "int NUM_QUEUES_TO_CREATE = " << g.kernel_names.size() << ";\n"
                << "int NUM_KERNELS_TO_CREATE = " << g.kernel_names.size() << ";\n"
-               << "cl_int status;\n"
+               << "thread_local cl_int status;\n"
                << "cl_context context = NULL;\n"
-               << "cl_command_queue cmdQueue[" << g.kernel_names.size() + 1 << "]; // extra queue for reading buffer D\n"
-               << "cl_device_id devices[4];\n"
-               << "int current_kernel = 0;\n"
-               << "cl_kernel kernel[" << g.kernel_names.size() << "];\n\n";
+               << "// For every device, a queue per kernel, and an extra queue for reading buffer D\n"
+               << "cl_command_queue cmdQueue[" << max_devices << " * " << g.kernel_names.size() + 1 << "];\n"
+               << "cl_device_id devices[" << max_devices << "];\n"
+               << "// The device and the kernel the calling thread is working on\n"
+               << "thread_local int current_device = 0;\n"
+               << "thread_local int current_kernel = 0;\n"
+               << "cl_kernel kernel[" << max_devices << " * " << g.kernel_names.size() << "];\n\n";
 
         stream << "const char *kernel_name[] = {\n";
         for (auto name : g.kernel_names) {
@@ -2910,7 +2913,7 @@ void CodeGen_Clear_C::visit(const For *op) {
         for (size_t i = 0; i < closure_args.size(); i++) {
             auto &arg = closure_args[i];
             stream << get_indent() << "status = clSetKernelArg("
-                   << "kernel[current_kernel], "
+                   << "kernel[current_device * NUM_KERNELS_TO_CREATE + current_kernel], "
                    << i << ", ";
             if (arg.is_buffer) {
                 stream << "sizeof(cl_mem), "
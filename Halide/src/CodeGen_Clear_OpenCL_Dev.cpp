@@ -13,6 +13,7 @@
 #include "IROperator.h"
 #include "Simplify.h"
 #include "Substitute.h"
+#include "../../t2s/src/BitstreamCache.h"
 #include "../../t2s/src/DebugPrint.h"
 #include "../../t2s/src/Utilities.h"
 
@@ -2356,8 +2357,8 @@ std::string CodeGen_Clear_OpenCL_Dev::print_gpu_name(const std::string &name) {
 
 /* Methods only for generating OpenCL code for Intel FPGAs */
 void CodeGen_Clear_OpenCL_Dev::compile_to_aocx(std::ostringstream &src_stream) {
-    // If BITSTREAM env var or $HOME/tmp/a.aocx indicates an existing file, do nothing.
-    // Otherwise, dump the source code to ~/tmp/a.cl and compile it to ~/tmp/a.aocx.
+    // The bitstream is named by the BITSTREAM env var, or $HOME/tmp/a.aocx by default. Its source code is
+    // dumped to the .cl file of the same name.
     char *aocx_name = getenv("BITSTREAM");
     std::string bitstream_file = (aocx_name != NULL) ? std::string(aocx_name) : (std::string(getenv("HOME")) + "/tmp/a.aocx");
     user_assert(ends_with(bitstream_file, ".aocx")) << " Bitstream file name expected to end with \".aocx\"\n";
@@ -2376,48 +2377,9 @@ void CodeGen_Clear_OpenCL_Dev::compile_to_aocx(std::ostringstream &src_stream) {
         return;
     }
 
-    // Bitstream was generated ahead of time. Check the file exists.
-    // Note that we do not check if the aocx file is really good or up to date with the
-    // source code. So if you want to regenerate the aocx file, delete it before invoking Halide.
-    std::ifstream file(bitstream_file, std::ios::in);
-    if (file.good()) {
-        user_warning << "Bitstream " << bitstream_file << " exists. No re-compilation.\n";
-        return;
-    }
-
-    // Create the source file
-    std::string cl_name = replace_all(bitstream_file, ".aocx", ".cl");
-    {
-        std::string str = src_stream.str();
-        std::ofstream fp(cl_name.c_str(), std::ios::out);
-        internal_assert(fp) << "Error: failed to open file " << cl_name << " for output.\n";
-        fp << str << "\n";
-        fp.close();
-
-        if (!clc.get_target().has_feature(Target::EnableSynthesis)) {
-            return;
-        }
-    }
-
-    // If environment var WAIT is set, give the programmer a chance to modify a.cl
-    char *wait = getenv("WAIT");
-    if (wait) {
-        std::cout << "Modify " << cl_name << ". Then press c to continue\n";
-        {
-            char c = getchar();
-            while (c != 'c') {
-                c = getchar();
-            }
-        }
-    }
-
-    // Compile the OpenCL file into a bitstream.
-    std::stringstream command;
-    char *aoc_option = getenv("AOC_OPTION");
-    command << "aoc " << ((aoc_option == NULL) ? "" : aoc_option) << " -g " << cl_name << " -o " << bitstream_file;
-    debug(4) << "Compiling for bitstream: " << command.str() << "\n";
-    int ret = system(command.str().c_str());
-    user_assert(ret != -1) << "Failed in compiling " << cl_name;
+    // Reuse the bitstream if it is up to date with the source code, or copy it from the bitstream cache.
+    // Otherwise, dump the source code and compile it. See t2s/src/BitstreamCache.h.
+    compile_to_bitstream(src_stream.str(), bitstream_file, clc.get_target().has_feature(Target::EnableSynthesis));
 }
 
 void CodeGen_Clear_OpenCL_Dev::CodeGen_Clear_OpenCL_C::print_global_data_structures_before_kernel(const Stmt *op) {
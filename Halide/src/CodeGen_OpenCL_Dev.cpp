@@ -13,6 +13,7 @@
 #include "IROperator.h"
 #include "Simplify.h"
 #include "Substitute.h"
+#include "../../t2s/src/BitstreamCache.h"
 #include "../../t2s/src/DebugPrint.h"
 #include "../../t2s/src/Utilities.h"
 
@@ -1168,6 +1169,27 @@ void CodeGen_OpenCL_Dev::CodeGen_OpenCL_C::visit(const Call *op) {
 }
 
 string CodeGen_OpenCL_Dev::CodeGen_OpenCL_C::print_extern_call(const Call *op) {
+    if (op->name == device_clock_call) {
+        // Read the device clock over the channel of the current kernel (See DeviceProfiling.h). Without arguments,
+        // retry until the clock is read. With the previous count, sample the clock once.
+        auto k = std::find(clock_kernels.begin(), clock_kernels.end(), kernel_name);
+        if (k == clock_kernels.end()) {
+            k = clock_kernels.insert(k, kernel_name);
+        }
+        string channel = "_t2s_device_clock[" + std::to_string(k - clock_kernels.begin()) + "]";
+        string id = "_" + unique_name('_');
+        stream << get_indent() << "ulong " << id << ";\n"
+               << get_indent() << "bool " << id << "_ok = false;\n";
+        if (op->args.empty()) {
+            stream << get_indent() << "do {\n"
+                   << get_indent() << "    " << id << " = read_channel_nb_intel(" << channel << ", &" << id << "_ok);\n"
+                   << get_indent() << "} while (!" << id << "_ok);\n";
+            return id;
+        }
+        string previous = print_expr(op->args[0]);
+        stream << get_indent() << id << " = read_channel_nb_intel(" << channel << ", &" << id << "_ok);\n";
+        return "(" + id + "_ok ? " + id + " : " + previous + ")";
+    }
     internal_assert(!function_takes_user_context(op->name));
     vector<string> args(op->args.size());
     for (size_t i = 0; i < op->args.size(); i++) {
@@ -1896,6 +1918,7 @@ void CodeGen_OpenCL_Dev::CodeGen_OpenCL_C::add_kernel(Stmt s,
     s.accept(&da);
     stream << da.arrays.str();
 
+    kernel_name = name;
     print(s);
     close_scope("kernel " + name);
 
@@ -2048,6 +2071,7 @@ void CodeGen_OpenCL_Dev::init_module() {
     if (target.has_feature(Target::IntelFPGA)) {
         //enable channels support
         src_stream << "#pragma OPENCL EXTENSION cl_intel_channels : enable\n";
+        clock_declaration_at = src_stream.str().size();
     }
 
     char *kernel_num = getenv("HL_KERNEL_NUM");
@@ -2281,6 +2305,29 @@ __kernel void scheduler() {
 
 vector<char> CodeGen_OpenCL_Dev::compile_to_src() {
     const Target &target = clc.get_target();
+    if (!clc.clock_kernels.empty()) {
+        // The device clock of the profiled kernels: a count offered to every kernel in every cycle over a channel
+        // of depth 0, so that a read gets the current count. The channels are declared before the kernels.
+        int n = (int)clc.clock_kernels.size();
+        string src = src_stream.str();
+        src.insert(clock_declaration_at, "channel ulong _t2s_device_clock[" + std::to_string(n) + "] __attribute__((depth(0)));\n");
+        src += "__attribute__((max_global_work_dim(0)))\n"
+               "__attribute__((autorun))\n"
+               "__kernel void kernel_t2s_device_clock()\n"
+               "{\n"
+               " ulong _clock = 0;\n"
+               " while (1) {\n"
+               "  #pragma unroll\n"
+               "  for (int _k = 0; _k < " + std::to_string(n) + "; _k++) {\n"
+               "   write_channel_nb_intel(_t2s_device_clock[_k], _clock);\n"
+               "  }\n"
+               "  _clock++;\n"
+               " }\n"
+               "}\n";
+        src_stream.str(src);
+        src_stream.seekp(0, std::ios_base::end);
+        clc.clock_kernels.clear();
+    }
     if (target.has_feature(Target::IntelFPGA)) {
         compile_to_aocx(src_stream);
     }
@@ -2307,8 +2354,8 @@ std::string CodeGen_OpenCL_Dev::print_gpu_name(const std::string &name) {
 
 /* Methods only for generating OpenCL code for Intel FPGAs */
 void CodeGen_OpenCL_Dev::compile_to_aocx(std::ostringstream &src_stream) {
-    // If BITSTREAM env var or $HOME/tmp/a.aocx indicates an existing file, do nothing.
-    // Otherwise, dump the source code to ~/tmp/a.cl and compile it to ~/tmp/a.aocx.
+    // The bitstream is named by the BITSTREAM env var, or $HOME/tmp/a.aocx by default. Its source code is
+    // dumped to the .cl file of the same name.
     char *aocx_name = getenv("BITSTREAM");
     std::string bitstream_file = (aocx_name != NULL) ? std::string(aocx_name) : (std::string(getenv("HOME")) + "/tmp/a.aocx");
     user_assert(ends_with(bitstream_file, ".aocx")) << " Bitstream file name expected to end with \".aocx\"\n";
@@ -2327,48 +2374,9 @@ void CodeGen_OpenCL_Dev::compile_to_aocx(std::ostringstream &src_stream) {
         return;
     }
 
-    // Bitstream was generated ahead of time. Check the file exists.
-    // Note that we do not check if the aocx file is really good or up to date with the
-    // source code. So if you want to regenerate the aocx file, delete it before invoking Halide.
-    std::ifstream file(bitstream_file, std::ios::in);
-    if (file.good()) {
-        user_warning << "Bitstream " << bitstream_file << " exists. No re-compilation.\n";
-        return;
-    }
-
-    // Create the source file
-    std::string cl_name = replace_all(bitstream_file, ".aocx", ".cl");
-    {
-        std::string str = src_stream.str();
-        std::ofstream fp(cl_name.c_str(), std::ios::out);
-        internal_assert(fp) << "Error: failed to open file " << cl_name << " for output.\n";
-        fp << str << "\n";
-        fp.close();
-
-        if (!clc.get_target().has_feature(Target::EnableSynthesis)) {
-            return;
-        }
-    }
-
-    // If environment var WAIT is set, give the programmer a chance to modify a.cl
-    char *wait = getenv("WAIT");
-    if (wait) {
-        std::cout << "Modify " << cl_name << ". Then press c to continue\n";
-        {
-            char c = getchar();
-            while (c != 'c') {
-                c = getchar();
-            }
-        }
-    }
-
-    // Compile the OpenCL file into a bitstream.
-    std::stringstream command;
-    char *aoc_option = getenv("AOC_OPTION");
-    command << "aoc " << ((aoc_option == NULL) ? "" : aoc_option) << " -g " << cl_name << " -o " << bitstream_file;
-    debug(4) << "Compiling for bitstream: " << command.str() << "\n";
-    int ret = system(command.str().c_str());
-    user_assert(ret != -1) << "Failed in compiling " << cl_name;
+    // Reuse the bitstream if it is up to date with the source code, or copy it from the bitstream cache.
+    // Otherwise, dump the source code and compile it. See t2s/src/BitstreamCache.h.
+    compile_to_bitstream(src_stream.str(), bitstream_file, clc.get_target().has_feature(Target::EnableSynthesis));
 }
 
 void CodeGen_OpenCL_Dev::CodeGen_OpenCL_C::print_global_data_structures_before_kernel(const Stmt *op) {
@@ -11,6 +11,7 @@
 #include "CodeGen_GPU_Dev.h"
 #include "Target.h"
 #include "IRMutator.h"
+#include "../../t2s/src/DeviceProfiling.h"
 
 namespace Halide {
 namespace Internal {
@@ -64,6 +65,8 @@ protected:
                         const std::vector<DeviceArgument> &args);
         void print_global_data_structures_before_kernel(const Stmt *op);
         void gather_shift_regs_allocates(const Stmt *op);
+        // The profiled kernels that read the device clock, in the order of their clock channels
+        std::vector<std::string> clock_kernels;
 
     protected:
         using CodeGen_C::visit;
@@ -160,6 +163,8 @@ protected:
         std::map<std::string, std::vector<Expr>> space_vars; // For shift regs with irregular bounds
         // For saving the pointer args streamed from scehduler
         std::map<std::string, std::string> pointer_args;
+        // The kernel being generated
+        std::string kernel_name;
 
         void visit(const For *) override;
         void visit(const Ramp *op) override;
@@ -194,6 +199,8 @@ protected:
     std::ostringstream src_stream;
     std::string cur_kernel_name;
     CodeGen_OpenCL_C clc;
+    // Where the channels of the device clock are declared in the source (Target::ProfileDevice)
+    size_t clock_declaration_at = 0;
 
 private:
     // Methods only for generating OpenCL code for Intel FPGAs
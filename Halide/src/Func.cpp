@@ -2644,8 +2644,11 @@ Func &Func::fold_storage(Var dim, Expr factor, bool fold_forward) {
     return *this;
 }
 
-Func &Func::gpu_fetch(Var loop_level, MemoryType mem_type, vector<Var> outs, vector<Expr> reuse_args) {
+Func &Func::gpu_fetch(Var loop_level, MemoryType mem_type, vector<Var> outs, vector<Expr> reuse_args, int num_buffers) {
     invalidate_cache();
+    user_assert(num_buffers == 1 || num_buffers == 2)
+        << "gpu_fetch of " << name() << " supports single or double buffering only, "
+        << "but " << num_buffers << " buffers are requested.\n";
 
     FetchParams &fp = func.definition().schedule().fetch_params();
     fp.store_at = loop_level.name();
@@ -2653,6 +2656,7 @@ Func &Func::gpu_fetch(Var loop_level, MemoryType mem_type, vector<Var> outs, vec
     // TODO: remove rw_len
     fp.rw_len = 8;
     fp.reuse_args = reuse_args;
+    fp.num_buffers = num_buffers;
 
     vector<string> out_dims;
     for (auto &v : outs) {
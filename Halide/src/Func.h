@@ -2231,7 +2231,11 @@ public:
      * a given LoopLevel. */
     Func &compute_at(LoopLevel loop_level);
 
-    Func &gpu_fetch(Var loop_level, MemoryType mem_type, vector<Var> outs, vector<Expr> reuse_args);
+    /** Fetch the input into a buffer of the given memory type at the loop level on GPUs.
+     * With num_buffers = 2, the buffer is ping-ponged: the tile for the next iteration of
+     * the loop is prefetched while the current tile is being computed. The iterations of a GPU loop
+     * run in parallel, and a buffer fetched at a GPU loop has only 1 buffer. */
+    Func &gpu_fetch(Var loop_level, MemoryType mem_type, vector<Var> outs, vector<Expr> reuse_args, int num_buffers = 1);
     Func &gpu_store(const vector<Expr> &args, size_t sz = 16);
 
     /** Schedule the iteration over the initial definition of this function
@@ -2705,6 +2709,18 @@ public:
     */
     Func &buffer(Func f, VarOrRVar loop, BufferStrategy strategy = BufferStrategy::Double, BufferReadStrategy read_strategy = BufferReadStrategy::Block);
 
+    /** Insert num_buffers (>= 2) buffers for func "f" at loop level "loop". Every period of the loop, a tile
+     * of incoming data is written into one buffer, and a tile written before is read from another buffer.
+     *  g(x,y) = f(x,y);
+     *  g.buffer(f, x, 3, BufferPrefetch::Partial, BufferLayout::Banked)
+     * With more than 2 buffers, a tile is read num_buffers - 1 periods after it starts to be written.
+     * With BufferPrefetch::Partial, reading a tile starts as soon as the data to read first are written,
+     * instead of a period later. With BufferLayout::Banked, every PE has its own memory bank.
+     * These options are supported when g also scatters the data of f.
+    */
+    Func &buffer(Func f, VarOrRVar loop, int num_buffers, BufferPrefetch prefetch = BufferPrefetch::Tile,
+                 BufferLayout layout = BufferLayout::Default);
+
     /**   the values of f along the given loop with the given strategy.
      * For example,
      \code
@@ -2745,8 +2761,33 @@ public:
 
     Func &gather(Func f, VarOrRVar loop, GatherStrategy strategy = GatherStrategy::Up);
 
+    /** Gather the values of f along the given loop through a tree with the given fan-in
+     * (GatherStrategy::Tree). For example, with
+     \code
+     c1.gather(B, j, GatherStrategy::Tree, 4, GatherOp::Add);
+     \endcode
+     * all the iterations of loop j hand over their values of B at once, and an adder tree
+     * of fan-in 4 sums them up in ceil(log4(extent of j)) levels. Func c1 receives the sum
+     * once, instead of one value per iteration of loop j. With GatherOp::Pack, c1 receives
+     * a vector of 4 values every 4 iterations of loop j, and with GatherOp::None, one value
+     * every iteration, selected through the tree.
+     */
+    Func &gather(Func f, VarOrRVar loop, GatherStrategy strategy, int fan_in, GatherOp op = GatherOp::None);
+
     Func &relay(Func f, VarOrRVar loop);
 
+    /** Relay the output of f out of the systolic array with one pipe per iteration of the
+     * bank loop, and cut every pipe into segments of the given number of PEs. For example,
+     \code
+     C.relay(Z, jjj, 4);
+     \endcode
+     * With 16 PEs along the other PE loops, every pipe has 4 segments, and the head of every
+     * segment writes into its own channel, so the results of a PE need to pass at most 3 other
+     * PEs instead of 15 to leave the array. The consumer reads the channels in turn, in the
+     * same order as reading an unsegmented pipe. The segment must divide the number of PEs.
+     */
+    Func &relay(Func f, VarOrRVar loop, int segment);
+
     Func &command(int index, std::vector<Argument> inputs, std::vector<Argument> outputs, std::vector<Argument> inouts);
 
     Func &depend(Func &f, std::vector<Expr> &vars);
@@ -79,6 +79,7 @@
 #include "../../t2s/src/CombineChannels.h"
 #include "../../t2s/src/DebugPrint.h"
 #include "../../t2s/src/Devectorize.h"
+#include "../../t2s/src/DeviceProfiling.h"
 #include "../../t2s/src/FlattenLoops.h"
 #include "../../t2s/src/Gather.h"
 #include "../../t2s/src/LateFuse.h"
@@ -330,7 +331,7 @@ Module lower(const vector<Function> &output_funcs,
 
     if (t.has_feature(Target::IntelGPU)) {
         debug(1) << "Applying memory schedule...\n";
-        s = do_memory_schedule(s, env);
+        s = do_memory_schedule(s, env, t);
         debug(2) << "Lowering after memory schedule:\n" << s << "\n\n";
     }
 
@@ -575,7 +576,7 @@ Module lower(const vector<Function> &output_funcs,
              << s << "\n\n";
 
     debug(1) << "Promoting channels...\n";
-    s = channel_promotion(s);
+    s = channel_promotion(s, t);
     debug(2) << "Lowering after channel promotion:\n"
              << s << "\n\n";
 
@@ -604,6 +605,15 @@ Module lower(const vector<Function> &output_funcs,
         }
     }
 
+    // After autorun_kernels, so that the autorun kernels are known, and measure their runs. The clear code
+    // generator does not generate the device clock.
+    if (t.has_feature(Target::IntelFPGA) && t.has_feature(Target::ProfileDevice)) {
+        debug(1) << "Injecting profiling counters into device kernels...\n";
+        s = inject_device_profiling(s, pipeline_name, getenv("CLEARCODE") == NULL);
+        debug(2) << "Lowering after injecting profiling counters into device kernels:\n"
+                 << s << "\n\n";
+    }
+
     debug(1) << "Creating overlay scheduler...\n";
     s = simplify(create_overlay_schedule(s, env));
     debug(2) << "Lowering after creating overlay scheduler:\n" << s << "\n\n";
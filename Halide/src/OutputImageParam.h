@@ -120,8 +120,8 @@ public:
 
     OutputImageParam &set_bounds(const vector<int> &bounds);
 
-    void gpu_fetch(Var loop_level, MemoryType mem_type, vector<Var> outs, vector<Expr> reuse_args) {
-        func.gpu_fetch(loop_level, mem_type, outs, reuse_args);
+    void gpu_fetch(Var loop_level, MemoryType mem_type, vector<Var> outs, vector<Expr> reuse_args, int num_buffers = 1) {
+        func.gpu_fetch(loop_level, mem_type, outs, reuse_args, num_buffers);
     }
     void gpu_fetch(Var loop_level, MemoryType mem_type, vector<Var> outs) {
         func.gpu_fetch(loop_level, mem_type, outs, {});
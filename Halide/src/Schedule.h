@@ -18,10 +18,12 @@ class Func;
 struct VarOrRVar;
 
 /** Place where a Func is run.
- * ISSUE: for now, we assume a single host and device.
+ * ISSUE: for now, we assume a single host and device type.
+ *        A design can be replicated across multiple devices
+ *        of the same type attached to the host, with the host
+ *        sharding the outermost loops (See t2s/src/ShardedExecution.h).
  *        We need revisit this assumption when we extend
- *        to multiple hosts and devices of possibly multiple
- *        types.
+ *        to multiple hosts and devices of multiple types.
  */
 enum class Place {
     /** Run on the host (i.e. CPU). */
@@ -66,9 +68,32 @@ enum class GatherStrategy {
      * to iteration N-1, then from iteration N-1 to iteration N-2, etc.*/
     Down,
 
-    FPGAReg
+    FPGAReg,
+
+    /** Gather data through a tree. All the iterations of the loop hand over their
+     * data at once, and the data flow to the consumer through the levels of a tree,
+     * each node of which merges the data of up to fan_in iterations. So draining
+     * the iterations costs the depth of the tree, instead of the extent of the loop.
+     * The tree may also reduce or pack the data on the way (see GatherOp). */
+    Tree
+};
 
-    /** TODO: add some other gathering styles, e.g. tree style. */
+/** What the nodes of a gathering tree do with the data of their children. */
+enum class GatherOp {
+    /** Select the data of one child. The consumer receives the data of the iterations
+     * of the loop one by one, as with the other strategies. */
+    None,
+
+    /** Combine the data of the children. The consumer receives the combined data of
+     * all the iterations of the loop once, at the first iteration of the loop,
+     * and every iteration of the loop in the consumer sees the combined data. */
+    Add,
+    Max,
+    Min,
+
+    /** Pack the data of fan_in iterations into a vector. The consumer receives one
+     * vector every fan_in iterations of the loop, and unpacks it. */
+    Pack
 };
 
 
@@ -78,8 +103,30 @@ enum class BufferStrategy {
     Single,
 
     /** buffer data with a double buffer*/
-    Double
-   
+    Double,
+
+    /** buffer data with a triple buffer, which reads a tile two periods after writing it. */
+    Triple
+};
+
+/** When to start reading a tile in a buffer. */
+enum class BufferPrefetch {
+    /** Read a tile after it is completely written. */
+    Tile,
+
+    /** Read a tile as soon as the data to read first are written, e.g. after the
+     * first K-slice of the tile. This shortens the time to fill the buffers from
+     * a period to a fraction of it. */
+    Partial
+};
+
+/** How to lay out a buffer in the on-chip memory. */
+enum class BufferLayout {
+    /** Bank the buffer along the scatter loop. The PEs of the other unrolled loops share the banks. */
+    Default,
+
+    /** Bank the buffer along all the unrolled loops, so that every PE reads its own bank every cycle. */
+    Banked
 };
 
 enum class BufferReadStrategy {
@@ -470,6 +517,9 @@ struct FetchParams {
     size_t rw_len;
     std::vector<std::string> out_dims;
     std::vector<Expr> reuse_args;
+    // With 2 buffers, the tile for the next iteration of the store_at loop is
+    // loaded into one buffer while the tile in the other buffer is consumed.
+    int num_buffers = 1;
 };
  
 struct StoreParams {
@@ -522,6 +572,8 @@ public:
     std::string func_name;
     std::string loop_name;
     GatherStrategy strategy;
+    int fan_in = 2;              // Fan-in of a tree for GatherStrategy::Tree
+    GatherOp op = GatherOp::None;
     bool valid = false;
     GatherItem (std::string _func_name, std::string _loop_name, GatherStrategy _strategy){
         func_name = _func_name;
@@ -529,6 +581,11 @@ public:
         strategy = _strategy;
         valid = true;
     }
+    GatherItem (std::string _func_name, std::string _loop_name, GatherStrategy _strategy, int _fan_in, GatherOp _op)
+        : GatherItem(_func_name, _loop_name, _strategy) {
+        fan_in = _fan_in;
+        op = _op;
+    }
 };
 
 class RelayItem {
@@ -536,6 +593,7 @@ public:
     std::string from_func;
     std::string to_func;
     std::string bank_loop;
+    int segment = 0;        // PEs in a segment of a relay pipe. 0: the pipe is not segmented
     RelayItem(std::string _from_func, std::string _to_func, std::string _bank_loop)
         : from_func(_from_func), to_func(_to_func), bank_loop(_bank_loop) {}
 };
@@ -546,6 +604,9 @@ public:
     std::string loop_name;
     BufferStrategy strategy;
     BufferReadStrategy read_strategy;
+    int num_buffers = 2;                             // Number of buffers to rotate through
+    BufferPrefetch prefetch = BufferPrefetch::Tile;
+    BufferLayout layout = BufferLayout::Default;
     BufferItem(std::string _func_name,
                 std::string _loop_name,
                 BufferStrategy _strategy,BufferReadStrategy _read_strategy):
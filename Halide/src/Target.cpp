@@ -373,7 +373,11 @@ const std::map<std::string, Target::Feature> feature_name_map = {
     {"sve2", Target::SVE2},
     {"intel_fpga", Target::IntelFPGA},
     {"intel_gpu", Target::IntelGPU},
-    {"enable_synthesis", Target::EnableSynthesis}
+    {"enable_synthesis", Target::EnableSynthesis},
+    {"profile_device", Target::ProfileDevice},
+    {"widen_channels", Target::WidenChannels},
+    {"predicate_channels", Target::PredicateChannels},
+    {"disable_gpu_micro_kernel", Target::DisableGPUMicroKernel}
     // NOTE: When adding features to this map, be sure to update
     // PyEnums.cpp and halide.cmake as well.
 };
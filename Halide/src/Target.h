@@ -128,6 +128,10 @@ struct Target {
         OneAPI = halide_target_feature_one_api,
         IntelGPU = halide_target_feature_intel_gpu,
         EnableSynthesis = halide_target_feature_enable_synthesis,
+        ProfileDevice = halide_target_feature_profile_device,
+        WidenChannels = halide_target_feature_widen_channels,
+        PredicateChannels = halide_target_feature_predicate_channels,
+        DisableGPUMicroKernel = halide_target_feature_disable_gpu_micro_kernel,
         FeatureEnd = halide_target_feature_end
     };
     Target()
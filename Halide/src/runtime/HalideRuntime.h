@@ -1310,6 +1310,10 @@ typedef enum halide_target_feature_t {
     halide_target_feature_one_api, ///< Enable Intel OneAPI dpcpp program generation
     halide_target_feature_intel_gpu, ///< Enable Intel Graphics
     halide_target_feature_enable_synthesis, ///< Enable synthesizing binaries. Currently used only for Intel FPGAs.
+    halide_target_feature_profile_device, ///< Measure the cycles and count the loop iterations of the kernels of Intel FPGAs.
+    halide_target_feature_widen_channels, ///< Widen scalar channels between Intel FPGA kernels to exchange a loop's values in one handshake.
+    halide_target_feature_predicate_channels, ///< Promote conditional channel reads of Intel FPGA kernels under a predicate.
+    halide_target_feature_disable_gpu_micro_kernel, ///< Keep the scalar systolic arrays of Intel GPU kernels, instead of vectorizing them into micro-kernels.
     halide_target_feature_end ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
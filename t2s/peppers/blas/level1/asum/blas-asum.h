@@ -0,0 +1,15 @@
+#ifndef blas_asum_h
+#define blas_asum_h
+
+#include "../reduction/blas-reduction.h"
+
+// use template
+// The absolute values are summed up in multiple lanes and a final tree (See blas-reduction.h).
+template<class T>
+void asum(int n, T *x, int incx, T *out,
+          SummationOrder order = SummationOrder::Deterministic, int threads = 0) {
+    assert(incx >= 1);
+    *out = reduce_asum<T>(n, x, incx, order, threads);
+}
+
+#endif
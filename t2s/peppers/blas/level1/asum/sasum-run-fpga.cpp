@@ -0,0 +1,58 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "blas-asum.h"
+
+#include <stdio.h>
+#include <iostream>
+#include <assert.h>
+
+using namespace std;
+
+int main()
+{
+    // Several chunks, and a partial one
+    const int TOTAL_I = 3 * REDUCTION_CHUNK + 5;
+
+    float *x = new float[TOTAL_I];
+    for (size_t i = 0; i < TOTAL_I; i++) {
+        x[i] = random() / (float)RAND_MAX - 0.5;
+    }
+
+    for (int incx = 1; incx <= 2; incx++) {
+        const int n = TOTAL_I / incx;
+        long double golden = 0;
+        for (int i = 0; i < n; i++) golden += fabsl(x[i * incx]);
+
+        float out = 0;
+        asum<float>(n, x, incx, &out);
+        assert(fabsl(golden - out) < 1e-5 * golden);
+
+        // The same bits with any number of threads
+        for (int threads = 1; threads <= 8; threads++) {
+            float other = 0;
+            asum<float>(n, x, incx, &other, SummationOrder::Deterministic, threads);
+            assert(other == out);
+            asum<float>(n, x, incx, &other, SummationOrder::Fast, threads);
+            assert(fabsl(golden - other) < 1e-5 * golden);
+        }
+    }
+
+    printf("Success\n");
+    return 0;
+}
@@ -2,19 +2,15 @@
 #define blas_dot_h
 
 #include "const-parameters.h"
+#include "../reduction/blas-reduction.h"
 
 // use template
+// The products are summed up in multiple lanes and a final tree (See blas-reduction.h).
 template<class T>
-void dot(int n, T *x, int incx, T *y, int incy, T *out) {
-    assert(incy >= 1);
-    const int I = (n + III * II - 1) / (III * II);
-
-    T o = 0;
-    for (int iterI = 0; iterI < n; iterI++) {
-        o += x[iterI * incx] * y[iterI * incy];
-    }
-    
-    *out = o;
+void dot(int n, T *x, int incx, T *y, int incy, T *out,
+         SummationOrder order = SummationOrder::Deterministic, int threads = 0) {
+    assert(incx >= 1 && incy >= 1);
+    *out = reduce_dot<T>(n, x, incx, y, incy, order, threads);
 }
 
 #endif
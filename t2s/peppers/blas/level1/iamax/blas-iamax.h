@@ -0,0 +1,16 @@
+#ifndef blas_iamax_h
+#define blas_iamax_h
+
+#include "../reduction/blas-reduction.h"
+
+// use template
+// The index (from 0) of the first element of the largest absolute value, or 0 if n < 1. Every lane keeps
+// its largest element, and the lanes are compared by a final tree (See blas-reduction.h). A maximum does
+// not depend on the order of the comparisons, so the result is always deterministic.
+template<class T>
+void iamax(int n, T *x, int incx, int *out, int threads = 0) {
+    assert(incx >= 1);
+    *out = (int)reduce_iamax<T>(n, x, incx, threads);
+}
+
+#endif
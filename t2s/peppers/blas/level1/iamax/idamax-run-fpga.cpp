@@ -0,0 +1,55 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "blas-iamax.h"
+
+#include <stdio.h>
+#include <iostream>
+#include <assert.h>
+
+using namespace std;
+
+int main()
+{
+    // Several chunks, and a partial one
+    const int TOTAL_I = 3 * REDUCTION_CHUNK + 5;
+
+    double *x = new double[TOTAL_I];
+    for (size_t i = 0; i < TOTAL_I; i++) {
+        x[i] = random() / (double)RAND_MAX - 0.5;
+    }
+    // The largest value appears twice, in different chunks and lanes. The first one is expected.
+    const int first = REDUCTION_CHUNK + 7, second = 2 * REDUCTION_CHUNK + 2;
+    x[first] = -2;
+    x[second] = 2;
+
+    for (int threads = 0; threads <= 8; threads++) {
+        int out = -1;
+        iamax<double>(TOTAL_I, x, 1, &out, threads);
+        assert(out == first);
+    }
+    // Only the odd elements, which include the first largest one
+    int out = -1;
+    iamax<double>(TOTAL_I / 2, x + 1, 2, &out);
+    assert(out == (first - 1) / 2);
+    iamax<double>(0, x, 1, &out);
+    assert(out == 0);
+
+    printf("Success\n");
+    return 0;
+}
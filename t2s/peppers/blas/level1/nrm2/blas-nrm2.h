@@ -0,0 +1,16 @@
+#ifndef blas_nrm2_h
+#define blas_nrm2_h
+
+#include "../reduction/blas-reduction.h"
+
+// use template
+// The squares are summed up in multiple lanes and a final tree, scaled so that the norm neither overflows
+// nor underflows (See blas-reduction.h).
+template<class T>
+void nrm2(int n, T *x, int incx, T *out,
+          SummationOrder order = SummationOrder::Deterministic, int threads = 0) {
+    assert(incx >= 1);
+    *out = reduce_nrm2<T>(n, x, incx, order, threads);
+}
+
+#endif
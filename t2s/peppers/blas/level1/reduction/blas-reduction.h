@@ -0,0 +1,290 @@
+#ifndef blas_reduction_h
+#define blas_reduction_h
+
+#include <assert.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Level-1 reductions (dot, asum, nrm2 and iamax) as multi-lane partial accumulators and a final adder tree.
+//
+// A single accumulator would add every element to the sum of the previous one, so the loop runs at the
+// latency of an add. Instead, element k is added to lane k % REDUCTION_LANES, and the lanes are independent:
+// the compiler vectorizes them, and an add issues every cycle. The lanes are summed up by a fixed binary
+// tree. The same structure is on the device (reduction.cpp), where the lanes are III vector lanes times II
+// interleaved accumulators, and the tree is applied to their partial sums by the host.
+//
+// A vector longer than REDUCTION_CHUNK elements is split into chunks, which are reduced by threads. With
+// SummationOrder::Deterministic, the results of the chunks are summed up by a fixed tree, so a reduction
+// gives the same bits in every run, with any number of threads. With SummationOrder::Fast, the threads
+// take chunks dynamically and add them up in the order they finish, so the last bits may vary from run to
+// run. A vector of a single chunk is reduced by the calling thread in either order.
+//
+// Compile with -O3 for the lanes to be vectorized.
+
+#ifndef REDUCTION_LANES
+    #define REDUCTION_LANES 32          // A power of 2
+#endif
+#ifndef REDUCTION_CHUNK
+    #define REDUCTION_CHUNK (1 << 16)   // A multiple of REDUCTION_LANES
+#endif
+
+enum class SummationOrder {
+    Deterministic,  // A fixed order of summation, independent of the threads
+    Fast            // The chunks are summed up in the order the threads finish them
+};
+
+// Sum up lanes[0, L) in place by a fixed binary tree, and return the sum. L is a power of 2.
+template<typename T>
+T tree_sum(T *lanes, int L) {
+    for (int w = L / 2; w > 0; w /= 2) {
+        for (int l = 0; l < w; l++) {
+            lanes[l] += lanes[l + w];
+        }
+    }
+    return lanes[0];
+}
+
+// Sum up term(k) for k in [begin, end) in REDUCTION_LANES lanes. begin is a multiple of REDUCTION_LANES.
+template<typename T, typename Term>
+T lane_sum(int64_t begin, int64_t end, Term term) {
+    static_assert((REDUCTION_LANES & (REDUCTION_LANES - 1)) == 0, "REDUCTION_LANES must be a power of 2");
+    T lanes[REDUCTION_LANES] = {};
+    int64_t k = begin;
+    for (; k + REDUCTION_LANES <= end; k += REDUCTION_LANES) {
+        for (int l = 0; l < REDUCTION_LANES; l++) {
+            lanes[l] += term(k + l);
+        }
+    }
+    for (int l = 0; k + l < end; l++) {
+        lanes[l] += term(k + l);
+    }
+    return tree_sum(lanes, REDUCTION_LANES);
+}
+
+// Reduce [0, n) chunk by chunk with reduce(begin, end), and combine the results of the chunks.
+template<typename R>
+R reduce_chunks(int64_t n, std::function<R(int64_t, int64_t)> reduce, std::function<R(const R &, const R &)> combine,
+                R identity, SummationOrder order, int threads) {
+    const int64_t chunks = (n + REDUCTION_CHUNK - 1) / REDUCTION_CHUNK;
+    if (chunks <= 1) {
+        return n > 0 ? reduce(0, n) : identity;
+    }
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = (int)std::min<int64_t>(threads, chunks);
+    auto chunk = [&](int64_t c) { return reduce(c * REDUCTION_CHUNK, std::min(n, (c + 1) * REDUCTION_CHUNK)); };
+
+    std::atomic<int64_t> next(0);
+    std::vector<std::thread> pool;
+    if (order == SummationOrder::Deterministic) {
+        std::vector<R> partials(chunks, identity);
+        for (int t = 0; t < threads; t++) {
+            pool.emplace_back([&]() {
+                for (int64_t c = next++; c < chunks; c = next++) {
+                    partials[c] = chunk(c);
+                }
+            });
+        }
+        for (auto &t : pool) {
+            t.join();
+        }
+        // A fixed tree over the chunks, pairing neighbours
+        for (int64_t w = 1; w < chunks; w *= 2) {
+            for (int64_t c = 0; c + w < chunks; c += 2 * w) {
+                partials[c] = combine(partials[c], partials[c + w]);
+            }
+        }
+        return partials[0];
+    }
+
+    R total = identity;
+    std::mutex mutex;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&]() {
+            R local = identity;
+            for (int64_t c = next++; c < chunks; c = next++) {
+                local = combine(local, chunk(c));
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            total = combine(total, local);
+        });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+    return total;
+}
+
+template<typename T>
+T reduce_sum(int64_t n, std::function<T(int64_t, int64_t)> reduce, SummationOrder order, int threads) {
+    return reduce_chunks<T>(n, reduce, [](const T &a, const T &b) { return a + b; }, T(0), order, threads);
+}
+
+// Sum of x * y
+template<typename T>
+T reduce_dot(int64_t n, const T *x, int incx, const T *y, int incy, SummationOrder order, int threads) {
+    return reduce_sum<T>(n, [=](int64_t begin, int64_t end) {
+        if (incx == 1 && incy == 1) {
+            return lane_sum<T>(begin, end, [=](int64_t k) { return x[k] * y[k]; });
+        }
+        return lane_sum<T>(begin, end, [=](int64_t k) { return x[k * incx] * y[k * incy]; });
+    }, order, threads);
+}
+
+// Sum of |x|
+template<typename T>
+T reduce_asum(int64_t n, const T *x, int incx, SummationOrder order, int threads) {
+    return reduce_sum<T>(n, [=](int64_t begin, int64_t end) {
+        if (incx == 1) {
+            return lane_sum<T>(begin, end, [=](int64_t k) { return std::abs(x[k]); });
+        }
+        return lane_sum<T>(begin, end, [=](int64_t k) { return std::abs(x[k * incx]); });
+    }, order, threads);
+}
+
+// The Euclidean norm is computed by Blue's algorithm [1], as in LAPACK 3.10: the squares of big and small
+// elements are scaled into range, and summed up separately from the others, without any division. So the
+// norm neither overflows nor underflows, and the lanes stay independent.
+//
+// [1] James L. Blue. A portable Fortran program to find the Euclidean norm of a vector. ACM Transactions
+//     on Mathematical Software, 4(1):15-23, 1978.
+template<typename T>
+struct BlueConstants {
+    static constexpr int radix = std::numeric_limits<T>::radix;
+    static constexpr int digits = std::numeric_limits<T>::digits;
+    static constexpr int min_exp = std::numeric_limits<T>::min_exponent;
+    static constexpr int max_exp = std::numeric_limits<T>::max_exponent;
+    // Thresholds of small and big elements, and their scales
+    static T tsml() { return std::pow((T)radix, std::ceil((min_exp - 1) * (T)0.5)); }
+    static T tbig() { return std::pow((T)radix, std::floor((max_exp - digits + 1) * (T)0.5)); }
+    static T ssml() { return std::pow((T)radix, -std::floor((min_exp - digits) * (T)0.5)); }
+    static T sbig() { return std::pow((T)radix, -std::ceil((max_exp + digits - 1) * (T)0.5)); }
+};
+
+// The scaled sums of the squares of the small, medium and big elements
+template<typename T>
+struct SumOfSquares {
+    T sml, med, big;
+
+    SumOfSquares operator+(const SumOfSquares &o) const { return {sml + o.sml, med + o.med, big + o.big}; }
+};
+
+// The norm from the sums of squares
+template<typename T>
+T finish_nrm2(SumOfSquares<T> s) {
+    typedef BlueConstants<T> C;
+    T scale = 1, sumsq = s.med;
+    if (s.big > 0) {
+        // Scale the medium sum down to the big one. A NaN in it is kept.
+        if (s.med > 0 || std::isnan(s.med)) {
+            s.big += (s.med * C::sbig()) * C::sbig();
+        }
+        scale = 1 / C::sbig();
+        sumsq = s.big;
+    } else if (s.sml > 0) {
+        if (s.med > 0 || std::isnan(s.med)) {
+            T med = std::sqrt(s.med), sml = std::sqrt(s.sml) / C::ssml();
+            T ymin = std::min(med, sml), ymax = std::max(med, sml);
+            sumsq = ymax * ymax * (1 + (ymin / ymax) * (ymin / ymax));
+        } else {
+            scale = 1 / C::ssml();
+            sumsq = s.sml;
+        }
+    }
+    return scale * std::sqrt(sumsq);
+}
+
+template<typename T>
+T reduce_nrm2(int64_t n, const T *x, int incx, SummationOrder order, int threads) {
+    typedef BlueConstants<T> C;
+    const T tsml = C::tsml(), tbig = C::tbig(), ssml = C::ssml(), sbig = C::sbig();
+    // Every element is added to one of the three sums of its lane
+    SumOfSquares<T> s = reduce_chunks<SumOfSquares<T>>(n, [=](int64_t begin, int64_t end) {
+        T sml[REDUCTION_LANES] = {}, med[REDUCTION_LANES] = {}, big[REDUCTION_LANES] = {};
+        // Every element is clamped into the range of one of the sums, and multiplied by 1 for that sum
+        // and by 0 for the others, without branches
+        auto add = [=](T &sml, T &med, T &big, T xk) {
+            T ax = std::abs(xk);
+            T is_sml = (T)(ax < tsml), is_big = (T)(ax > tbig);
+            T xs = std::min(ax, tsml) * is_sml * ssml;
+            T xb = std::max(ax, tbig) * is_big * sbig;
+            T xm = std::min(std::max(ax, tsml), tbig) * (1 - is_sml - is_big);
+            sml += xs * xs;
+            big += xb * xb;
+            med += xm * xm;     // NaN is kept here
+        };
+        int64_t k = begin;
+        for (; k + REDUCTION_LANES <= end; k += REDUCTION_LANES) {
+            for (int l = 0; l < REDUCTION_LANES; l++) {
+                add(sml[l], med[l], big[l], x[(k + l) * incx]);
+            }
+        }
+        for (int l = 0; k + l < end; l++) {
+            add(sml[l], med[l], big[l], x[(k + l) * incx]);
+        }
+        return SumOfSquares<T>{tree_sum(sml, REDUCTION_LANES), tree_sum(med, REDUCTION_LANES), tree_sum(big, REDUCTION_LANES)};
+    }, [](const SumOfSquares<T> &a, const SumOfSquares<T> &b) { return a + b; }, SumOfSquares<T>{0, 0, 0}, order, threads);
+    return finish_nrm2(s);
+}
+
+// The largest |x| and its index. The first of equal values is kept, and NaN is ignored.
+template<typename T>
+struct IndexedMax {
+    T value;
+    int64_t index;
+
+    static IndexedMax max(const IndexedMax &a, const IndexedMax &b) {
+        return (b.value > a.value || (b.value == a.value && b.index < a.index)) ? b : a;
+    }
+};
+
+template<typename T>
+int64_t reduce_iamax(int64_t n, const T *x, int incx, int threads) {
+    typedef IndexedMax<T> M;
+    // The maximum is exact, so it does not depend on the order, and the chunks are combined in any order.
+    M m = reduce_chunks<M>(n, [=](int64_t begin, int64_t end) {
+        // Every lane keeps its largest value, and the block of REDUCTION_LANES elements where it is
+        T value[REDUCTION_LANES];
+        int32_t block[REDUCTION_LANES];
+        for (int l = 0; l < REDUCTION_LANES; l++) {
+            value[l] = -1;
+            block[l] = 0;
+        }
+        int32_t b = 0;
+        int64_t k = begin;
+        for (; k + REDUCTION_LANES <= end; k += REDUCTION_LANES, b++) {
+            for (int l = 0; l < REDUCTION_LANES; l++) {
+                // Without branches. NaN is never larger.
+                T v = std::abs(x[(k + l) * incx]), old = value[l];
+                int32_t larger = -(int32_t)(old < v);
+                value[l] = std::max(old, v);
+                block[l] = (block[l] & ~larger) | (b & larger);
+            }
+        }
+        for (int l = 0; k + l < end; l++) {
+            T v = std::abs(x[(k + l) * incx]);
+            if (v > value[l]) {
+                value[l] = v;
+                block[l] = b;
+            }
+        }
+        M best = {-1, n};
+        for (int l = 0; l < REDUCTION_LANES; l++) {
+            if (value[l] >= 0) {
+                best = M::max(best, {value[l], begin + (int64_t)block[l] * REDUCTION_LANES + l});
+            }
+        }
+        return best;
+    }, M::max, M{-1, n}, SummationOrder::Fast, threads);
+    return m.index < n ? m.index : 0;
+}
+
+#endif
@@ -0,0 +1,36 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef REDUCTION_CONST_PARAMS_H
+#define REDUCTION_CONST_PARAMS_H
+
+// Inner loop bounds, which are static constant parameters of the design: III vector lanes, each with II
+// interleaved accumulators. II should cover the latency of an add, so that an accumulator is updated every
+// II cycles, and a new element is added every cycle.
+#ifdef TINY // For verifying correctness only
+    #define III         4
+    #define II          4
+#elif S10
+    #define III         32
+    #define II          8
+#else   // For A10
+    #define III         16
+    #define II          8
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// The header file generated by reduction.cpp
+#include "reduction-interface.h"
+
+#include "const-parameters.h"
+#include "device-reduction.h"
+#include "blas-reduction.h"
+#include "HalideBuffer.h"
+
+static_assert(((III * II) & (III * II - 1)) == 0, "The accumulators of the design must be a power of 2");
+
+namespace {
+
+// n elements of x, padded with 0 to whole iterations of loop i
+Halide::Runtime::Buffer<float> pad(int n, const float *x, int incx) {
+    int iterations = std::max(1, (n + III * II - 1) / (III * II));
+    Halide::Runtime::Buffer<float> buf(iterations * III * II);
+    buf.fill(0);
+    for (int k = 0; k < n; k++) {
+        buf(k) = x[k * incx];
+    }
+    return buf;
+}
+
+// The partial sums of the accumulators, summed up by the tree of blas-reduction.h
+float tree(const Halide::Runtime::Buffer<float> &partials) {
+    float lanes[III * II];
+    for (int ii = 0; ii < II; ii++) {
+        for (int iii = 0; iii < III; iii++) {
+            lanes[iii + III * ii] = partials(iii, ii);
+        }
+    }
+    return tree_sum(lanes, III * II);
+}
+
+}
+
+#ifdef DOT
+int sdot_device(int n, const float *x, int incx, const float *y, int incy, float *out) {
+    Halide::Runtime::Buffer<float> bx = pad(n, x, incx), by = pad(n, y, incy), partials(III, II);
+    int error = sdot(bx, by, partials);
+    *out = (error == 0) ? tree(partials) : 0;
+    return error;
+}
+#endif
+
+#ifdef ASUM
+int sasum_device(int n, const float *x, int incx, float *out) {
+    Halide::Runtime::Buffer<float> bx = pad(n, x, incx), partials(III, II);
+    int error = sasum(bx, partials);
+    *out = (error == 0) ? tree(partials) : 0;
+    return error;
+}
+#endif
+
+#ifdef NRM2
+int snrm2_device(int n, const float *x, int incx, float *out) {
+    Halide::Runtime::Buffer<float> bx = pad(n, x, incx), sml(III, II), med(III, II), big(III, II);
+    int error = snrm2(bx, sml, med, big);
+    *out = (error == 0) ? finish_nrm2(SumOfSquares<float>{tree(sml), tree(med), tree(big)}) : 0;
+    return error;
+}
+#endif
+
+#ifdef IAMAX
+int isamax_device(int n, const float *x, int incx, int *out) {
+    Halide::Runtime::Buffer<float> bx = pad(n, x, incx), value(III, II);
+    Halide::Runtime::Buffer<int> block(III, II);
+    int error = isamax(bx, value, block);
+    // The first of the largest values of the accumulators, out of the padding
+    IndexedMax<float> best = {-1, n};
+    for (int ii = 0; ii < II; ii++) {
+        for (int iii = 0; iii < III; iii++) {
+            int64_t index = iii + III * ii + (int64_t)III * II * block(iii, ii);
+            if (index < n) {
+                best = IndexedMax<float>::max(best, {value(iii, ii), index});
+            }
+        }
+    }
+    *out = (error == 0 && best.index < n) ? (int)best.index : 0;
+    return error;
+}
+#endif
@@ -0,0 +1,13 @@
+#ifndef device_reduction_h
+#define device_reduction_h
+
+// Level-1 reductions of single precision on the device, with the design of reduction.cpp. Every routine is
+// a separate bitstream, so only the routine the design is compiled for (-DDOT, -DASUM, -DNRM2 or -DIAMAX) is
+// defined. They return 0, or the error of the design, and write the result into out.
+int sdot_device(int n, const float *x, int incx, const float *y, int incy, float *out);
+int sasum_device(int n, const float *x, int incx, float *out);
+int snrm2_device(int n, const float *x, int incx, float *out);
+// The index (from 0) of the first element of the largest absolute value, or 0 if n < 1
+int isamax_device(int n, const float *x, int incx, int *out);
+
+#endif
@@ -0,0 +1,112 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "const-parameters.h"
+#include "device-reduction.h"
+#include "blas-reduction.h"
+
+// Benchmark harness
+#include "Benchmark.h"
+
+#include <stdio.h>
+#include <iostream>
+#include <vector>
+#include <assert.h>
+
+using namespace std;
+
+// A vector of several iterations of the design, and a partial one
+#ifdef TINY
+    #define N       (5 * III * II + 3)
+#else
+    #define N       (1 << 26)
+#endif
+
+int main()
+{
+    vector<float> x(2 * N), y(N);
+    for (auto &v : x) v = random() / (float)RAND_MAX - 0.5f;
+    for (auto &v : y) v = random() / (float)RAND_MAX - 0.5f;
+    // The largest element appears twice, and the first one is expected from iamax
+    x[N / 3] = 2;
+    x[N / 2] = -2;
+
+    // Both contiguous and strided vectors, compared with the CPU
+    for (int incx = 1; incx <= 2; incx++) {
+#if defined(DOT)
+        float out, golden = reduce_dot<float>(N, x.data(), incx, y.data(), 1, SummationOrder::Deterministic, 0);
+        assert(sdot_device(N, x.data(), incx, y.data(), 1, &out) == 0);
+        assert(fabs(out - golden) <= 1e-4 * reduce_dot<float>(N, x.data(), incx, x.data(), incx, SummationOrder::Deterministic, 0));
+#elif defined(ASUM)
+        float out, golden = reduce_asum<float>(N, x.data(), incx, SummationOrder::Deterministic, 0);
+        assert(sasum_device(N, x.data(), incx, &out) == 0);
+        assert(fabs(out - golden) <= 1e-4 * golden);
+#elif defined(NRM2)
+        float out, golden = reduce_nrm2<float>(N, x.data(), incx, SummationOrder::Deterministic, 0);
+        assert(snrm2_device(N, x.data(), incx, &out) == 0);
+        assert(fabs(out - golden) <= 1e-4 * golden);
+#elif defined(IAMAX)
+        int out, golden = (int)reduce_iamax<float>(N, x.data(), incx, 0);
+        assert(isamax_device(N, x.data(), incx, &out) == 0);
+        assert(out == golden);
+#endif
+    }
+
+#ifndef TINY
+    // Throughput of the design, compared with the vectorized CPU implementation
+    DesignBenchmark benchmark;
+    benchmark.kernel = NULL;
+    benchmark.number_ops = 2.0 * N;
+#if defined(DOT)
+    benchmark.name = "sdot";
+    benchmark.number_bytes = 8.0 * N;
+    float out;
+    auto device = [&]() { return sdot_device(N, x.data(), 1, y.data(), 1, &out); };
+    auto cpu = [&]() { out = reduce_dot<float>(N, x.data(), 1, y.data(), 1, SummationOrder::Deterministic, 0); };
+#elif defined(ASUM)
+    benchmark.name = "sasum";
+    benchmark.number_bytes = 4.0 * N;
+    float out;
+    auto device = [&]() { return sasum_device(N, x.data(), 1, &out); };
+    auto cpu = [&]() { out = reduce_asum<float>(N, x.data(), 1, SummationOrder::Deterministic, 0); };
+#elif defined(NRM2)
+    benchmark.name = "snrm2";
+    benchmark.number_bytes = 4.0 * N;
+    float out;
+    auto device = [&]() { return snrm2_device(N, x.data(), 1, &out); };
+    auto cpu = [&]() { out = reduce_nrm2<float>(N, x.data(), 1, SummationOrder::Deterministic, 0); };
+#elif defined(IAMAX)
+    benchmark.name = "isamax";
+    benchmark.number_bytes = 4.0 * N;
+    int out;
+    auto device = [&]() { return isamax_device(N, x.data(), 1, &out); };
+    auto cpu = [&]() { out = (int)reduce_iamax<float>(N, x.data(), 1, 0); };
+#endif
+    benchmark.parameters = {{"N", N}, {"III", III}, {"II", II}};
+    BenchmarkReport report = benchmark_and_report(benchmark, device);
+    assert(report.result == 0);
+    DesignBenchmark host = benchmark;
+    host.name += "-cpu";
+    host.backend = BenchmarkBackend::Emulation;
+    BenchmarkReport cpu_report = benchmark_and_report(host, [&]() { cpu(); return 0; });
+    cout << "Device: " << report.gflops << " GFLOPS, CPU: " << cpu_report.gflops << " GFLOPS\n";
+#endif
+
+    printf("Success\n");
+    return 0;
+}
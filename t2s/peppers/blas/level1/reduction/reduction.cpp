@@ -0,0 +1,132 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "Halide.h"
+
+// Constant parameters (inner loop bounds) of the design
+#include "const-parameters.h"
+
+// The thresholds and scales of nrm2
+#include "blas-reduction.h"
+
+using namespace Halide;
+
+// A level-1 reduction, chosen with -DDOT, -DASUM, -DNRM2 or -DIAMAX, as III x II partial accumulators:
+// element iii + III * ii + III * II * i is added to accumulator (iii, ii). Loop iii is vectorized, and
+// accumulator (iii, ii) is updated every II iterations, so the adds are pipelined without waiting for each
+// other. The partial results are summed up (or compared) by the host with the same tree as blas-reduction.h.
+int main(void) {
+    #define P               iii, ii, i
+    #define P_i_minus_1     iii, ii, i - 1
+    #define P_Out           iii, ii
+    #define total_i         (iii + III * ii + III * II * i)
+    #define I               (X.dim(0).extent() / (III * II))
+    #define FUNC_DECL(t)    t, {P}, Place::Device
+
+    ImageParam X("X", Float(32), 1);
+    Var P;
+    Func uX("uX", FUNC_DECL(Float(32)));
+    uX(P) = X(total_i);
+    Expr ax = abs(uX(P));
+    std::vector<Func> ures, outs;
+
+#if defined(DOT)
+    ImageParam Y("Y", Float(32), 1);
+    Func uY("uY", FUNC_DECL(Float(32))), Z("Z", FUNC_DECL(Float(32))), Out("Out", Place::Device);
+    uY(P) = Y(total_i);
+    Z(P) = select(i == 0, 0, Z(P_i_minus_1)) + uX(P) * uY(P);
+    Out(P_Out) = select(i == I - 1, Z(P));
+    ures = {uY, Z, Out};
+    outs = {Out};
+#elif defined(ASUM)
+    Func Z("Z", FUNC_DECL(Float(32))), Out("Out", Place::Device);
+    Z(P) = select(i == 0, 0, Z(P_i_minus_1)) + ax;
+    Out(P_Out) = select(i == I - 1, Z(P));
+    ures = {Z, Out};
+    outs = {Out};
+#elif defined(NRM2)
+    // Blue's algorithm: the squares of small, medium and big elements are scaled and summed up separately
+    typedef BlueConstants<float> C;
+    Func Zs("Zs", FUNC_DECL(Float(32))), Zm("Zm", FUNC_DECL(Float(32))), Zb("Zb", FUNC_DECL(Float(32)));
+    Func Sml("Sml", Place::Device), Med("Med", Place::Device), Big("Big", Place::Device);
+    Expr is_sml = ax < C::tsml(), is_big = ax > C::tbig();
+    Expr xs = select(is_sml, ax * C::ssml(), 0), xb = select(is_big, ax * C::sbig(), 0);
+    Expr xm = select(is_sml || is_big, 0, ax);
+    Zs(P) = select(i == 0, 0, Zs(P_i_minus_1)) + xs * xs;
+    Zm(P) = select(i == 0, 0, Zm(P_i_minus_1)) + xm * xm;
+    Zb(P) = select(i == 0, 0, Zb(P_i_minus_1)) + xb * xb;
+    Sml(P_Out) = select(i == I - 1, Zs(P));
+    Med(P_Out) = select(i == I - 1, Zm(P));
+    Big(P_Out) = select(i == I - 1, Zb(P));
+    ures = {Zs, Zm, Zb, Sml, Med, Big};
+    outs = {Sml, Med, Big};
+#elif defined(IAMAX)
+    // The largest |x| of every accumulator, and the iteration of i where it is. NaN is never larger.
+    Func Zv("Zv", FUNC_DECL(Float(32))), Zi("Zi", FUNC_DECL(Int(32)));
+    Func Value("Value", Place::Device), Block("Block", Place::Device);
+    Expr prev = select(i == 0, -1.0f, Zv(P_i_minus_1));
+    Expr larger = ax > prev;
+    Zv(P) = select(larger, ax, prev);
+    Zi(P) = select(larger, i, select(i == 0, 0, Zi(P_i_minus_1)));
+    Value(P_Out) = select(i == I - 1, Zv(P));
+    Block(P_Out) = select(i == I - 1, Zi(P));
+    ures = {Zv, Zi, Value, Block};
+    outs = {Value, Block};
+#endif
+
+    // Put all the UREs inside the same loop nest of X.
+    uX.merge_ures(ures, outs)
+      .set_bounds(iii, 0, III, ii, 0, II, i, 0, I);
+    uX.vectorize(iii);
+
+    // I/O network
+    Func xSerializer("xSerializer", Place::Host), xLoader("xLoader", Place::Device);
+    uX.isolate_producer_chain(X, xSerializer, xLoader);
+    xLoader.min_depth(256);
+    std::vector<Argument> args = {X};
+#ifdef DOT
+    Func ySerializer("ySerializer", Place::Host), yLoader("yLoader", Place::Device);
+    uX.isolate_producer_chain(Y, ySerializer, yLoader);
+    yLoader.min_depth(256);
+    args.push_back(Y);
+#endif
+    std::vector<Func> deserializers;
+    for (auto &o : outs) {
+        Func unloader(o.name() + "Unloader", Place::Device), deserializer(o.name() + "Deserializer", Place::Host);
+        o.min_depth(256);
+        o.isolate_consumer_chain(unloader, deserializer);
+        unloader.min_depth(256);
+        deserializers.push_back(deserializer);
+    }
+
+    // Compile the kernel to an FPGA bitstream, and expose a C interface for the host to invoke
+    Target acc = get_host_target();
+    acc.set_feature(Target::IntelFPGA);
+    acc.set_feature(Target::EnableSynthesis);
+#if defined(DOT)
+    Pipeline(deserializers).compile_to_host("reduction-interface", args, "sdot", acc);
+#elif defined(ASUM)
+    Pipeline(deserializers).compile_to_host("reduction-interface", args, "sasum", acc);
+#elif defined(NRM2)
+    Pipeline(deserializers).compile_to_host("reduction-interface", args, "snrm2", acc);
+#elif defined(IAMAX)
+    Pipeline(deserializers).compile_to_host("reduction-interface", args, "isamax", acc);
+#endif
+    printf("Success\n");
+    return 0;
+}
@@ -0,0 +1,22 @@
+# Usage: source test.sh [emulator|hw]. The emulator validates tiny designs, and hw large ones.
+# Every routine is a separate design: a bitstream is compiled and tested for each of them in turn.
+cd $T2S_PATH
+source ./setenv.sh local fpga
+cd $T2S_PATH/t2s/peppers/blas/level1/reduction
+if [ "$1" == "hw" ]; then
+    size=LARGE
+    aoc_option="-v -profile -fpc -fp-relaxed -board=$FPGA_BOARD"
+    platform="$HW_PLATFORM"
+else
+    size=TINY
+    aoc_option="-march=emulator -board=$FPGA_BOARD -emulator-channel-depth-model=strict"
+    platform="$EMULATOR_PLATFORM"
+    export CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=1
+fi
+for routine in DOT ASUM NRM2 IAMAX; do
+    # Compile the specification into reduction-interface.h/cpp and the bitstream a.aocx
+    g++ reduction.cpp -g -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin -lHalide -lz -lpthread -ldl -std=c++11 -D$size -D$routine -o ./a.out
+    env BITSTREAM=a.aocx AOC_OPTION="$aoc_option" ./a.out
+    g++ reduction-run-fpga.cpp device-reduction.cpp reduction-interface.cpp $T2S_PATH/t2s/src/AOT-OpenCL-Runtime.cpp $T2S_PATH/t2s/src/SharedUtilsInC.cpp $T2S_PATH/t2s/src/Roofline.cpp -I $T2S_PATH/Halide/tools -O3 -g -DLINUX -DALTERA_CL -fPIC -I$T2S_PATH/t2s/src -I $T2S_PATH/Halide/include -I$INTELFPGAOCLSDKROOT/examples_aoc/common/inc $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/opencl.cpp $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/options.cpp -I$INTELFPGAOCLSDKROOT/host/include -L$INTELFPGAOCLSDKROOT/linux64/lib -L$AOCL_BOARD_PACKAGE_ROOT/linux64/lib -L$INTELFPGAOCLSDKROOT/host/linux64/lib -lOpenCL -L $T2S_PATH/Halide/bin -lelf -lHalide -D$size -D$routine -lz -lpthread -ldl -std=c++11 -o ./b.out
+    env BITSTREAM=a.aocx INTEL_FPGA_OCL_PLATFORM_NAME="$platform" ./b.out
+done
@@ -0,0 +1,12 @@
+#include "blas-gemm.h"
+#include "gemm-dispatch.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+void sgemm(char transa, char transb, int m, int n, int k, float alpha, float *a, int lda,  float *b, int ldb, float beta, float *c, int ldc) {
+    static GemmDispatcher dispatcher(getenv("GEMM_VARIANTS") ? getenv("GEMM_VARIANTS") : "variants/gemm");
+    int result = dispatcher.sgemm(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+    if (result != 0) {
+        fprintf(stderr, "sgemm of %d x %d x %d failed with error %d\n", m, n, k, result);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef blas_gemm_h
+#define blas_gemm_h
+
+// The same interface as ../release/a10/blas-gemm.h, but every call is dispatched to the best of a library of
+// variants of the design, from the directory in the environment variable GEMM_VARIANTS (variants/gemm by
+// default). See gemm-dispatch.h.
+void sgemm(char transa, char transb, int m, int n, int k, float alpha, float *a, int lda,  float *b, int ldb, float beta, float *c, int ldc);
+
+#endif
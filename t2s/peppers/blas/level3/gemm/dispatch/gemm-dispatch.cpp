@@ -0,0 +1,167 @@
+#include "gemm-dispatch.h"
+#include "HalideBuffer.h"
+#include <limits>
+
+namespace {
+
+// Tiles of a variant, i.e. the granularity of the extents it computes
+int tile_i(const DesignVariant &v) { return v.param("III") * v.param("II"); }
+int tile_j(const DesignVariant &v) { return v.param("JJJ") * v.param("JJ"); }
+int tile_k(const DesignVariant &v) { return v.param("KKK") * v.param("KK"); }
+
+int64_t round_up(int64_t x, int64_t tile) {
+    return (x + tile - 1) / tile * tile;
+}
+
+bool same_variant(const DesignVariant *a, const DesignVariant *b) {
+    return a != NULL && b != NULL && a->name == b->name;
+}
+
+// Sum up the cost of the pieces of a plan, run in order from the current variant
+void estimate(GemmPlan &plan, int k, const DesignVariant *current, const GemmCostModel &model) {
+    const DesignVariant *last = current;
+    for (auto &p : plan.pieces) {
+        const DesignVariant &v = *p.variant;
+        plan.seconds += gemm_piece_seconds(v, p.m, p.n, k, model);
+        plan.padded_work += (double)round_up(p.m, tile_i(v)) * round_up(p.n, tile_j(v)) * round_up(k, tile_k(v));
+        if (!same_variant(last, p.variant)) {
+            plan.reconfigurations++;
+            plan.seconds += model.reconfiguration_seconds;
+        }
+        last = p.variant;
+    }
+}
+
+} // namespace
+
+double gemm_piece_seconds(const DesignVariant &v, int m, int n, int k, const GemmCostModel &model) {
+    double pm = round_up(m, tile_i(v)), pn = round_up(n, tile_j(v)), pk = round_up(k, tile_k(v));
+    double cycles = pm * pn * pk / ((double)v.param("III") * v.param("JJJ") * v.param("KKK"));
+    double bytes = sizeof(float) * (pm * pk + pk * pn + pm * pn);
+    return cycles / model.frequency + model.invocation_seconds + bytes / model.host_bytes_per_second;
+}
+
+GemmPlan plan_gemm(int m, int n, int k, const std::vector<DesignVariant> &variants, const DesignVariant *current,
+                   const GemmCostModel &model) {
+    GemmPlan best;
+    best.seconds = std::numeric_limits<double>::infinity();
+    auto consider = [&](GemmPlan &plan) {
+        estimate(plan, k, current, model);
+        if (plan.seconds < best.seconds) {
+            best = plan;
+        }
+    };
+
+    // The whole GEMM with one variant
+    for (auto &v : variants) {
+        GemmPlan plan;
+        plan.pieces.push_back({&v, 0, 0, m, n});
+        consider(plan);
+    }
+
+    // The whole tiles of a body variant, and the edges with another variant
+    for (auto &body : variants) {
+        int mb = m / tile_i(body) * tile_i(body), nb = n / tile_j(body) * tile_j(body);
+        if (mb == 0 || nb == 0 || (mb == m && nb == n)) {
+            continue;
+        }
+        for (auto &edge : variants) {
+            std::vector<GemmPiece> edges;
+            if (nb < n) {
+                edges.push_back({&edge, 0, nb, mb, n - nb});
+            }
+            if (mb < m) {
+                edges.push_back({&edge, mb, 0, m - mb, n});
+            }
+            GemmPlan plan;
+            plan.pieces.push_back({&body, 0, 0, mb, nb});
+            // Run the edges first if the device is already programmed with their variant
+            plan.pieces.insert(same_variant(current, &edge) ? plan.pieces.begin() : plan.pieces.end(),
+                               edges.begin(), edges.end());
+            consider(plan);
+        }
+    }
+    return best;
+}
+
+GemmDispatcher::GemmDispatcher(const std::string &dir, const GemmCostModel &model, const std::string &only)
+    : library(dir, "gemm"), model(model) {
+    for (auto &v : library.variants()) {
+        if (only.empty() || v.name == only) {
+            variants.push_back(v);
+        }
+    }
+}
+
+int GemmDispatcher::sgemm(char transa, char transb, int m, int n, int k, float alpha, const float *a, int lda,
+                          const float *b, int ldb, float beta, float *c, int ldc) {
+    bool ta = (transa == 'T' || transa == 't'), tb = (transb == 'T' || transb == 't');
+    lda = lda > 0 ? lda : (ta ? m : k);
+    ldb = ldb > 0 ? ldb : (tb ? k : n);
+    ldc = ldc > 0 ? ldc : n;
+    auto A = [&](int i, int kk) { return ta ? a[(size_t)kk * lda + i] : a[(size_t)i * lda + kk]; };
+    auto B = [&](int kk, int j) { return tb ? b[(size_t)j * ldb + kk] : b[(size_t)kk * ldb + j]; };
+
+    plan = GemmPlan();
+    if (m <= 0 || n <= 0) {
+        return 0;
+    }
+    if (k <= 0 || alpha == 0) {
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < n; j++) {
+                c[(size_t)i * ldc + j] = (beta == 0) ? 0 : beta * c[(size_t)i * ldc + j];
+            }
+        }
+        return 0;
+    }
+
+    const DesignVariant *current = NULL;
+    if (const DesignVariant *programmed = library.programmed()) {
+        for (auto &v : variants) {
+            if (v.name == programmed->name) {
+                current = &v;
+            }
+        }
+    }
+    plan = plan_gemm(m, n, k, variants, current, model);
+    if (plan.pieces.empty()) {
+        return -1;
+    }
+
+    for (auto &p : plan.pieces) {
+        const DesignVariant &v = *p.variant;
+        const int III = v.param("III"), JJJ = v.param("JJJ"), II = v.param("II"), JJ = v.param("JJ");
+        const int TI = tile_i(v), TJ = tile_j(v);
+        const int pm = round_up(p.m, TI), pn = round_up(p.n, TJ), pk = round_up(k, tile_k(v));
+
+        // Pad the block of the operands with zeros to whole tiles of the variant
+        Halide::Runtime::Buffer<float> bufferA(pk, pm), bufferB(pn, pk), bufferO(JJJ, III, JJ, II, pn / TJ, pm / TI);
+        bufferA.fill(0.0f);
+        bufferB.fill(0.0f);
+        for (int i = 0; i < p.m; i++) {
+            for (int kk = 0; kk < k; kk++) {
+                bufferA(kk, i) = A(p.i0 + i, kk);
+            }
+        }
+        for (int kk = 0; kk < k; kk++) {
+            for (int j = 0; j < p.n; j++) {
+                bufferB(j, kk) = B(kk, p.j0 + j);
+            }
+        }
+
+        int result = library.run(v, bufferA.raw_buffer(), bufferB.raw_buffer(), bufferO.raw_buffer());
+        if (result != 0) {
+            return result;
+        }
+        bufferO.copy_to_host();
+
+        for (int i = 0; i < p.m; i++) {
+            for (int j = 0; j < p.n; j++) {
+                float product = bufferO(j % JJJ, i % III, j / JJJ % JJ, i / III % II, j / TJ, i / TI);
+                float &r = c[(size_t)(p.i0 + i) * ldc + p.j0 + j];
+                r = alpha * product + ((beta == 0) ? 0 : beta * r);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef gemm_dispatch_h
+#define gemm_dispatch_h
+
+#include <string>
+#include <vector>
+#include "VariantLibrary.h"
+
+// Dispatch of a GEMM to a library of variants of the gemm design (t2s/tests/performance/gemm), which differ
+// in their tiles (params III, II, JJJ, JJ, KKK, KK). A variant computes A(k, i) * B(j, k) for extents that
+// are multiples of its tiles, so a small or skinny GEMM wastes most of a large variant on padding, while a
+// small variant runs a large GEMM far below the peak. Switching to another variant costs reprogramming the
+// device. Every call is planned by a cost model of both.
+
+// The estimated time of running variants. The defaults are for A10.
+struct GemmCostModel {
+    double frequency = 250e6;               // Of the designs, in Hz. A PE does a multiply-add per cycle
+    double invocation_seconds = 1e-4;       // Launching a design, and the fixed cost on the host
+    double host_bytes_per_second = 2e9;     // Packing the operands and unpacking the results on the host
+    double reconfiguration_seconds = 1.5;   // Programming the device with another bitstream
+};
+
+// A block of the output, C[i0, i0 + m) x [j0, j0 + n), computed by a variant over the whole reduction.
+struct GemmPiece {
+    const DesignVariant *variant;
+    int i0, j0, m, n;
+};
+
+struct GemmPlan {
+    std::vector<GemmPiece> pieces;          // In the order to run
+    double seconds = 0;                     // Estimated by the cost model
+    double padded_work = 0;                 // Multiply-adds including the padding
+    int reconfigurations = 0;               // Times the device is programmed with another variant
+};
+
+// The estimated seconds of a variant computing an m x n block of the output with a reduction of k
+double gemm_piece_seconds(const DesignVariant &v, int m, int n, int k, const GemmCostModel &model);
+
+// The cheapest plan of an m x n x k GEMM, when the device is programmed with the current variant (NULL if
+// none). A plan either runs the whole GEMM with a variant, or splits it into a body of whole tiles of a
+// large variant, and the edges left (the right and the bottom strips) with another variant.
+GemmPlan plan_gemm(int m, int n, int k, const std::vector<DesignVariant> &variants, const DesignVariant *current,
+                   const GemmCostModel &model);
+
+class GemmDispatcher {
+public:
+    // Load the variants of gemm from their directory (See t2s/tests/performance/Makefile.variants). If only
+    // is not empty, only the variant of that name is used, as a single compiled design would be.
+    GemmDispatcher(const std::string &dir, const GemmCostModel &model = GemmCostModel(), const std::string &only = "");
+    bool ok() const { return !variants.empty(); }
+
+    // C = alpha * op(A) * op(B) + beta * C, where op(A) is m x k, op(B) is k x n, the matrices are row-major
+    // with leading dimensions lda, ldb and ldc (0 for dense), and op() transposes if trans is 'T' or 't'.
+    // Returns 0, or the error of a variant.
+    int sgemm(char transa, char transb, int m, int n, int k, float alpha, const float *a, int lda,
+              const float *b, int ldb, float beta, float *c, int ldc);
+
+    const GemmPlan &last_plan() const { return plan; }
+    int reconfigurations() const { return library.reconfigurations(); }
+
+private:
+    VariantLibrary library;
+    std::vector<DesignVariant> variants;
+    GemmCostModel model;
+    GemmPlan plan;
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "gemm-dispatch.h"
+#include "Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Usage: sgemm-benchmark <variants dir> [trace] [--plan]
+// Compare dispatching every GEMM of a trace to the best variant of the library, with running the whole trace
+// with a single variant, i.e. a single compiled design, for every variant. The plans of the calls are
+// compared by the cost model: the estimated time, the useful fraction of the work including the padding, and
+// the reconfigurations of the device. Unless --plan, the trace is also run on the device.
+
+struct GemmCall {
+    int m, n, k, calls;
+};
+
+vector<GemmCall> read_trace(const string &file) {
+    vector<GemmCall> trace;
+    ifstream in(file);
+    string line;
+    while (getline(in, line)) {
+        istringstream words(line.substr(0, line.find('#')));
+        GemmCall call;
+        if (words >> call.m >> call.n >> call.k) {
+            if (!(words >> call.calls)) {
+                call.calls = 1;
+            }
+            trace.push_back(call);
+        }
+    }
+    return trace;
+}
+
+struct PolicyStats {
+    double seconds = 0, work = 0, padded_work = 0;
+    int reconfigurations = 0, invocations = 0;
+};
+
+// Plan the calls of the trace in order, each from the variant the previous call left on the device
+PolicyStats plan_trace(const vector<GemmCall> &trace, const vector<DesignVariant> &variants, const GemmCostModel &model) {
+    PolicyStats stats;
+    const DesignVariant *current = NULL;
+    for (auto &call : trace) {
+        for (int c = 0; c < call.calls; c++) {
+            GemmPlan plan = plan_gemm(call.m, call.n, call.k, variants, current, model);
+            stats.seconds += plan.seconds;
+            stats.work += (double)call.m * call.n * call.k;
+            stats.padded_work += plan.padded_work;
+            stats.reconfigurations += plan.reconfigurations;
+            stats.invocations += plan.pieces.size();
+            current = plan.pieces.back().variant;
+        }
+    }
+    return stats;
+}
+
+void print_policy(const string &name, const PolicyStats &stats) {
+    printf("%-24s %12.3f ms %10.1f%% %18d %12d\n", name.c_str(), stats.seconds * 1e3,
+           100 * stats.work / stats.padded_work, stats.reconfigurations, stats.invocations);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("Usage: %s <variants dir> [trace] [--plan]\n", argv[0]);
+        return 1;
+    }
+    string dir = argv[1];
+    string trace_file = (argc > 2 && strcmp(argv[2], "--plan") != 0) ? argv[2] : "gemm-shapes.trace";
+    bool plan_only = (strcmp(argv[argc - 1], "--plan") == 0);
+
+    vector<GemmCall> trace = read_trace(trace_file);
+    GemmCostModel model;
+    GemmDispatcher dispatcher(dir, model);
+    VariantLibrary library(dir, "gemm");
+    if (trace.empty() || !dispatcher.ok()) {
+        printf("Cannot read the trace %s or the variants in %s\n", trace_file.c_str(), dir.c_str());
+        return 1;
+    }
+
+    // Estimated by the cost model, with the cost of reconfiguring the device, and without, which bounds the
+    // gain of dispatching if switching variants were free (e.g. kernels of a GPU)
+    for (double reconfiguration : {model.reconfiguration_seconds, 0.0}) {
+        GemmCostModel m = model;
+        m.reconfiguration_seconds = reconfiguration;
+        printf("\nReconfiguration: %g s\n", reconfiguration);
+        printf("%-24s %15s %11s %18s %12s\n", "Policy", "Time (model)", "Useful", "Reconfigurations", "Invocations");
+        PolicyStats dispatch = plan_trace(trace, library.variants(), m);
+        print_policy("dispatch", dispatch);
+        double best_single = 0;
+        for (auto &v : library.variants()) {
+            PolicyStats single = plan_trace(trace, {v}, m);
+            print_policy("only " + v.name, single);
+            best_single = (best_single == 0) ? single.seconds : std::min(best_single, single.seconds);
+        }
+        printf("Speedup of dispatch over the best single variant: %.2fx\n", best_single / dispatch.seconds);
+    }
+    if (plan_only) {
+        return 0;
+    }
+
+    // Run the trace on the device with random operands
+    size_t max_a = 0, max_b = 0, max_c = 0;
+    double ops = 0;
+    for (auto &call : trace) {
+        max_a = std::max(max_a, (size_t)call.m * call.k);
+        max_b = std::max(max_b, (size_t)call.k * call.n);
+        max_c = std::max(max_c, (size_t)call.m * call.n);
+        ops += 2.0 * call.m * call.n * call.k * call.calls;
+    }
+    vector<float> a(max_a), b(max_b), c(max_c);
+    for (auto &x : a) x = random() / (float)RAND_MAX;
+    for (auto &x : b) x = random() / (float)RAND_MAX;
+
+    auto run_trace = [&](GemmDispatcher &d) {
+        for (auto &call : trace) {
+            for (int i = 0; i < call.calls; i++) {
+                int result = d.sgemm('N', 'N', call.m, call.n, call.k, 1.0f, a.data(), 0, b.data(), 0, 0.0f, c.data(), 0);
+                if (result != 0) {
+                    return result;
+                }
+            }
+        }
+        return 0;
+    };
+
+    DesignBenchmark config;
+    config.name = "sgemm-dispatch";
+    config.number_ops = ops;
+    config.number_bytes = 0;
+    config.backend = BenchmarkBackend::Emulation;   // The wall clock, including the host and the reconfigurations
+    config.parameters = {{"calls", (double)trace.size()}};
+    BenchmarkReport report = benchmark_and_report(config, [&]() { return run_trace(dispatcher); });
+    if (report.result != 0) {
+        printf("The trace failed with error %d\n", report.result);
+        return 1;
+    }
+    for (auto &v : library.variants()) {
+        GemmDispatcher single(dir, model, v.name);
+        config.name = "sgemm-" + v.name;
+        BenchmarkReport single_report = benchmark_and_report(config, [&]() { return run_trace(single); });
+        if (single_report.result != 0) {
+            printf("The trace failed with error %d\n", single_report.result);
+            return 1;
+        }
+    }
+    printf("Success\n");
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "gemm-dispatch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <assert.h>
+
+using namespace std;
+
+// Run C = alpha * op(A) * op(B) + beta * C with the dispatcher and compare with the same on the CPU.
+// Returns the number of pieces the GEMM has been split into.
+size_t test(GemmDispatcher &dispatcher, char transa, char transb, int m, int n, int k, float alpha, float beta,
+            int pad)
+{
+    bool ta = (transa == 'T'), tb = (transb == 'T');
+    int lda = (ta ? m : k) + pad, ldb = (tb ? k : n) + pad, ldc = n + pad;
+    vector<float> a((size_t)(ta ? k : m) * lda), b((size_t)(tb ? n : k) * ldb), c((size_t)m * ldc);
+    for (auto *x : {&a, &b, &c}) {
+        for (auto &e : *x) {
+            e = random() % 8 - 4;
+        }
+    }
+    vector<float> golden = c;
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            float sum = 0;
+            for (int kk = 0; kk < k; kk++) {
+                sum += (ta ? a[(size_t)kk * lda + i] : a[(size_t)i * lda + kk]) *
+                       (tb ? b[(size_t)j * ldb + kk] : b[(size_t)kk * ldb + j]);
+            }
+            golden[(size_t)i * ldc + j] = alpha * sum + beta * golden[(size_t)i * ldc + j];
+        }
+    }
+
+    int result = dispatcher.sgemm(transa, transb, m, n, k, alpha, a.data(), lda, b.data(), ldb, beta, c.data(), ldc);
+    assert(result == 0);
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < ldc; j++) {
+            // Beyond the n columns, C is left untouched
+            float expected = golden[(size_t)i * ldc + j];
+            assert(fabs(c[(size_t)i * ldc + j] - expected) <= 1e-4 * fmax(1.0, fabs(expected)));
+        }
+    }
+    return dispatcher.last_plan().pieces.size();
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = argc > 1 ? argv[1] : "variants/gemm";
+
+    // Without the fixed costs, irregular shapes are split into a body and edges of different variants
+    GemmCostModel free_switching;
+    free_switching.reconfiguration_seconds = 0;
+    free_switching.invocation_seconds = 0;
+    free_switching.host_bytes_per_second = 1e30;
+    GemmDispatcher dispatcher(dir, free_switching);
+    assert(dispatcher.ok());
+    size_t split = 0;
+    int shapes[][3] = {{1, 1, 1}, {5, 3, 7}, {17, 17, 17}, {35, 18, 9}, {64, 64, 64}, {66, 65, 3}, {1, 70, 33}};
+    for (auto &s : shapes) {
+        for (char transa : {'N', 'T'}) {
+            for (char transb : {'N', 'T'}) {
+                split += test(dispatcher, transa, transb, s[0], s[1], s[2], 1.0f, 0.0f, 0) > 1;
+            }
+        }
+        test(dispatcher, 'N', 'N', s[0], s[1], s[2], 2.0f, 0.5f, 3);
+    }
+    assert(split > 0);
+    // Degenerate cases do not touch the device
+    test(dispatcher, 'N', 'N', 7, 5, 0, 1.0f, 2.0f, 1);
+    test(dispatcher, 'N', 'N', 7, 5, 9, 0.0f, 2.0f, 1);
+
+    // Reprogramming the device for a small GEMM costs more than padding it for the programmed variant
+    GemmDispatcher sticky(dir);
+    test(sticky, 'N', 'N', 64, 64, 64, 1.0f, 0.0f, 0);
+    test(sticky, 'N', 'N', 5, 3, 7, 1.0f, 0.0f, 0);
+    assert(sticky.last_plan().reconfigurations == 0 && sticky.reconfigurations() == 1);
+
+    printf("Success\n");
+    return 0;
+}
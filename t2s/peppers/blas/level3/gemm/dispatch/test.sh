@@ -0,0 +1,27 @@
+# Usage: source test.sh [emulator|hw]. The emulator validates the dispatch with the tiny variants of gemm, and
+# hw benchmarks the variants for A10 on the shapes in gemm-shapes.trace.
+cd $T2S_PATH
+source ./setenv.sh local fpga
+cd $T2S_PATH/t2s/peppers/blas/level3/gemm/dispatch
+if [ "$1" == "hw" ]; then
+    variants=gemm/a10.variants
+    platform="$HW_PLATFORM"
+    make_platform=hw
+else
+    variants=gemm/tiny.variants
+    platform="$EMULATOR_PLATFORM"
+    make_platform=emulator
+    export CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=1
+fi
+# Compile the variants into variants/gemm: the manifest gemm.variants, and libv.so and v.aocx for every variant v
+make -C $T2S_PATH/t2s/tests/performance -f Makefile.variants DESIGN=gemm VARIANTS=$variants PLATFORM=$make_platform OUT=$PWD/variants/gemm
+g++ sgemm-run-fpga.cpp gemm-dispatch.cpp -g -I$T2S_PATH/t2s/src -I $T2S_PATH/Halide/include -ldl -std=c++11 -o ./a.out
+env INTEL_FPGA_OCL_PLATFORM_NAME="$platform" ./a.out variants/gemm
+# The cost of dispatching the shapes of the trace against every variant alone, estimated by the cost model,
+# and measured on the device for hw
+g++ sgemm-benchmark.cpp gemm-dispatch.cpp $T2S_PATH/t2s/src/Roofline.cpp $T2S_PATH/t2s/src/SharedUtilsInC.cpp -g -I$T2S_PATH/t2s/src -I $T2S_PATH/Halide/include -I $T2S_PATH/Halide/tools -ldl -lpthread -std=c++11 -o ./b.out
+if [ "$1" == "hw" ]; then
+    env INTEL_FPGA_OCL_PLATFORM_NAME="$platform" ./b.out variants/gemm gemm-shapes.trace
+else
+    ./b.out variants/gemm gemm-shapes.trace --plan
+fi
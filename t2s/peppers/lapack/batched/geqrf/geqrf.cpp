@@ -0,0 +1,106 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Batched QR factorization A = Q * R by Givens rotations, on a linear array of SIZE PEs [1].
+//
+// PE k keeps row k of R. The rows of a matrix stream through the PEs one after another. When a row
+// arrives at PE k, the PE computes the rotation that zeroes element k of the row against R(k, k),
+// applies the rotation to the row and to row k of R, and sends the row, with elements 0..k zeroed,
+// to PE k + 1. After all the rows, PE k has row k of R.
+//
+// Every row is extended by SIZE columns, holding row j of a matrix B. The rotations apply to B as
+// well, and the extended R is [R | Q^T * B]. The host sets B to the identity, which gives Q^T.
+//
+// The input is A(i, j, b): column i (0 <= i < 2 * SIZE) and row j of the extended matrix b, i.e.
+// row-major matrices. The output is O(bb, i, k, b): column i of row k of the extended R of matrix
+// bb + BATCH_TILE * b.
+//
+// Compile and generate the bitstream and the interface (geqrf-interface.h/cpp):
+//    g++ geqrf.cpp -g -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin -lHalide -lz -lpthread -ldl -std=c++11 -DSIZE=32
+//    env BITSTREAM=geqrf.aocx AOC_OPTION="$EMULATOR_AOC_OPTION -board=$FPGA_BOARD -emulator-channel-depth-model=strict" ./a.out
+//
+// [1] W. M. Gentleman and H. T. Kung. Matrix triangularization by systolic arrays. In Real-Time Signal
+//     Processing IV, SPIE vol. 298, pages 19-26, 1981.
+#include "Halide.h"
+
+// Constant parameters of the design
+#include "const-parameters.h"
+
+using namespace Halide;
+
+int main(void) {
+    ImageParam A(Float(32), 3);
+
+    // Macros: for convenient use.
+    #define X                      bb,    i,     k,     j,     b
+    #define X_no_j                 bb,    i,     k,            b
+    #define X_k_minus_1            bb,    i,     k - 1, j,     b
+    #define X_j_minus_1            bb,    i,     k,     j - 1, b
+    #define X_i_minus_1            bb,    i - 1, k,     j,     b
+    #define FUNC_DECL              Float(32), {X}, Place::Device
+    #define BATCH                  (A.dim(2).extent() / BATCH_TILE)
+
+    Var  X;
+    Func Xin(FUNC_DECL), Xout(FUNC_DECL), R(FUNC_DECL), C(FUNC_DECL), S(FUNC_DECL),
+         O(Place::Device);
+
+    // Element i of row j at PE k, and element (k, i) of R before the row arrives
+    Expr r = select(j == 0, 0, R(X_j_minus_1));
+    Expr norm = sqrt(r * r + Xin(X) * Xin(X));
+
+    Xin(X)    = select(k == 0, A(i, j, bb + BATCH_TILE * b), Xout(X_k_minus_1));
+    // The rotation is computed at the diagonal (i == k), and then passed along the row. Elements
+    // i < k of the row are 0 already, and the rotation there is the identity.
+    C(X)      = select(i > k, C(X_i_minus_1), select(norm == 0, 1, r / norm));
+    S(X)      = select(i > k, S(X_i_minus_1), select(norm == 0, 0, Xin(X) / norm));
+    R(X)      = select(i < k, 0, select(i == k, norm, C(X) * r + S(X) * Xin(X)));
+    Xout(X)   = select(i <= k, 0, C(X) * Xin(X) - S(X) * r);
+    O(X_no_j) = select(j == SIZE - 1, R(X));
+
+    Xin.merge_ures(C, S, R, Xout, O) // Put all the UREs into the same loop nest
+       .set_bounds(bb, 0, BATCH_TILE, i, 0, 2 * SIZE)
+       .set_bounds(k, 0, SIZE, j, 0, SIZE)
+       .set_bounds(b, 0, BATCH)
+       .space_time_transform(k);
+
+    // Only PE 0 reads the matrices. The loader streams the next matrices while the PEs factorize the current ones.
+    Func serializer(Place::Host), loader(Place::Device);
+    Xin.isolate_producer_chain(A, serializer, loader);
+    serializer.set_bounds(k, 0, 1);
+    loader.set_bounds(k, 0, 1);
+    loader.min_depth(256);
+
+    O.min_depth(256);
+    Func deserializer(Place::Host), collector(Place::Device), unloader(Place::Device);
+    O.isolate_consumer_chain(collector);
+    collector.space_time_transform(k)
+             .set_bounds(i, 0, 2 * SIZE)
+             .set_bounds(k, 0, SIZE)
+             .set_bounds(bb, 0, BATCH_TILE, b, 0, BATCH);
+    collector.isolate_consumer_chain(unloader);
+    collector.gather(O, k);
+    unloader.isolate_consumer_chain(deserializer);
+    collector.min_depth(256);
+    unloader.min_depth(256);
+
+    Target target = get_host_target();
+    target.set_feature(Target::IntelFPGA);
+    deserializer.compile_to_host("geqrf-interface", { A }, "geqrf", target);
+    printf("Success\n");
+    return 0;
+}
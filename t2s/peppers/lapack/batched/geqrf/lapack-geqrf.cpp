@@ -0,0 +1,84 @@
+#include "geqrf-interface.h"
+#include "lapack-geqrf.h"
+#include "const-parameters.h"
+#include "HalideBuffer.h"
+#include "StreamingExecution.h"
+
+#include <assert.h>
+
+using namespace std;
+
+struct GeqrfChunk {
+    vector<float> matrices;                 // The matrices of the chunk as read, and then their Q
+    vector<float> r;                        // R of the matrices
+    Halide::Runtime::Buffer<float> a, o;    // Inputs and outputs of the design
+};
+
+int sgeqrf_stream(int n, function<int(float *a, int max)> read,
+                  function<void(const float *q, const float *r, int count)> write) {
+    assert(n >= 1 && n <= SIZE);
+    return stream_batches<GeqrfChunk>(
+        [=]() {
+            auto chunk = make_shared<GeqrfChunk>();
+            chunk->matrices.resize((size_t)CHUNK * n * n);
+            chunk->r.resize((size_t)CHUNK * n * n);
+            return chunk;
+        },
+        [=](GeqrfChunk &chunk) {
+            int count = read(chunk.matrices.data(), CHUNK);
+            // Pad every matrix into the bottom-right corner with an identity, and the batch with identities.
+            // Then extend every matrix with an identity on the right, which the design turns into Q^T.
+            int batch = (count + BATCH_TILE - 1) / BATCH_TILE * BATCH_TILE;
+            chunk.a = Halide::Runtime::Buffer<float>(2 * SIZE, SIZE, batch);
+            for (int m = 0; m < batch; m++)
+            for (int j = 0; j < SIZE; j++)
+            for (int i = 0; i < 2 * SIZE; i++) {
+                bool original = (m < count && i < n && j < n);
+                bool one = (i == j && !original) || i == j + SIZE;
+                chunk.a(i, j, m) = original ? chunk.matrices[(size_t)m * n * n + j * n + i] : (one ? 1.0f : 0.0f);
+            }
+            return count;
+        },
+        [=](GeqrfChunk &chunk, int count) {
+            int batch = chunk.a.dim(2).extent();
+            chunk.o = Halide::Runtime::Buffer<float>(BATCH_TILE, 2 * SIZE, SIZE, batch / BATCH_TILE);
+            int result = geqrf(chunk.a, chunk.o);
+            release_device(chunk.a);
+            release_device(chunk.o);
+            return result;
+        },
+        [=](GeqrfChunk &chunk, int count) {
+            for (int m = 0; m < count; m++)
+            for (int k = 0; k < n; k++)
+            for (int i = 0; i < n; i++) {
+                size_t base = (size_t)m * n * n;
+                chunk.r[base + k * n + i] = chunk.o(m % BATCH_TILE, i, k, m / BATCH_TILE);
+                // Q(i, k) = Q^T(k, i)
+                chunk.matrices[base + i * n + k] = chunk.o(m % BATCH_TILE, SIZE + i, k, m / BATCH_TILE);
+            }
+            write(chunk.matrices.data(), chunk.r.data(), count);
+        });
+}
+
+int sgeqrf_batched(int n, const float *a, int lda, long stridea, float *q, int ldq, long strideq,
+                   float *r, int ldr, long strider, int batch) {
+    int next = 0, done = 0;
+    return sgeqrf_stream(n,
+        [&](float *m, int max) {
+            int count = min(max, batch - next);
+            for (int c = 0; c < count; c++, next++)
+            for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++) {
+                m[(size_t)c * n * n + j * n + i] = a[next * stridea + j * lda + i];
+            }
+            return count;
+        },
+        [&](const float *qs, const float *rs, int count) {
+            for (int c = 0; c < count; c++, done++)
+            for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++) {
+                q[done * strideq + j * ldq + i] = qs[(size_t)c * n * n + j * n + i];
+                r[done * strider + j * ldr + i] = rs[(size_t)c * n * n + j * n + i];
+            }
+        });
+}
@@ -0,0 +1,19 @@
+#ifndef lapack_geqrf_h
+#define lapack_geqrf_h
+
+#include <functional>
+
+// QR factorization A = Q * R of a batch of n x n matrices, n <= SIZE, where Q is orthogonal and R is upper
+// triangular with a non-negative diagonal. Matrix m is row-major at a + m * stridea with leading dimension
+// lda, and so are its Q and R at q + m * strideq and r + m * strider. Returns 0, or the error of the device.
+int sgeqrf_batched(int n, const float *a, int lda, long stridea, float *q, int ldq, long strideq,
+                   float *r, int ldr, long strider, int batch);
+
+// QR factorization of a stream of n x n matrices, with no fixed batch size. read(a, max) stores up to max
+// matrices into a, row-major and contiguous, and returns how many it stored, or 0 at the end of the stream.
+// write(q, r, count) receives Q and R of the matrices read, in the same layout. The next matrices are read
+// and the previous factors are written while the device factorizes the current matrices.
+int sgeqrf_stream(int n, std::function<int(float *a, int max)> read,
+                  std::function<void(const float *q, const float *r, int count)> write);
+
+#endif
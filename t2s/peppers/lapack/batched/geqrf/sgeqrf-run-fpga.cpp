@@ -0,0 +1,62 @@
+#include "lapack-geqrf.h"
+#include "const-parameters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+#include <vector>
+#include <iostream>
+#include <assert.h>
+
+using namespace std;
+
+int main()
+{
+    // A batch that does not fill the last chunk, of matrices smaller than the design
+    const int N = SIZE - 3;
+    const int BATCH = CHUNK * 2 + 5;
+
+    vector<float> a((size_t)BATCH * N * N), q((size_t)BATCH * N * N), r((size_t)BATCH * N * N);
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = random() / (float)RAND_MAX;
+    }
+
+    int info = sgeqrf_batched(N, a.data(), N, N * N, q.data(), N, N * N, r.data(), N, N * N, BATCH);
+    assert(info == 0);
+
+    for (int m = 0; m < BATCH; m++) {
+        const float *A = &a[(size_t)m * N * N], *Q = &q[(size_t)m * N * N], *R = &r[(size_t)m * N * N];
+        for (int i = 0; i < N; i++)
+        for (int j = 0; j < N; j++) {
+            // A = Q * R, Q^T * Q = I, and R is upper triangular
+            float qr = 0, qtq = 0;
+            for (int k = 0; k < N; k++) {
+                qr += Q[i * N + k] * R[k * N + j];
+                qtq += Q[k * N + i] * Q[k * N + j];
+            }
+            assert(fabs(A[i * N + j] - qr) < 0.005 * fabs(A[i * N + j]) + 1e-3);
+            assert(fabs((i == j ? 1 : 0) - qtq) < 1e-3);
+            assert(i <= j || R[i * N + j] == 0);
+        }
+    }
+
+    // The same batch in the streaming interface, a few matrices at a time
+    int next = 0, done = 0;
+    info = sgeqrf_stream(N,
+        [&](float *m, int max) {
+            int count = min(min(max, 7), BATCH - next);
+            copy(a.begin() + (size_t)next * N * N, a.begin() + (size_t)(next + count) * N * N, m);
+            next += count;
+            return count;
+        },
+        [&](const float *Q, const float *R, int count) {
+            for (int x = 0; x < count * N * N; x++) {
+                assert(Q[x] == q[(size_t)done * N * N + x] && R[x] == r[(size_t)done * N * N + x]);
+            }
+            done += count;
+        });
+    assert(info == 0 && done == BATCH);
+
+    printf("Success\n");
+    return 0;
+}
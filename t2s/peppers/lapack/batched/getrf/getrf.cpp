@@ -0,0 +1,111 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Batched LU factorization with pairwise pivoting [1], M * A = U, on a linear array of SIZE PEs, like the
+// Givens rotations of geqrf.cpp.
+//
+// PE k keeps row k of U. The rows of a matrix stream through the PEs one after another. When a row arrives
+// at PE k, the PE compares element k of the row with U(k, k), and keeps the row with the larger magnitude
+// of the two as row k of U. The other row is eliminated against it, i.e. element k is zeroed by subtracting
+// a multiple, at most 1 in magnitude, of the kept row, and is sent to PE k + 1. After all the rows, PE k has
+// row k of U. Partial pivoting would choose the pivot among all the remaining rows before eliminating any of
+// them, which depends on the data of a whole column; pairwise pivoting chooses between two rows at a time,
+// in a fixed order, so the dependences stay uniform.
+//
+// Every row is extended by SIZE columns, holding row j of a matrix B. The interchanges and the eliminations
+// apply to B as well, and the extended U is [U | M * B]. The host sets B to the identity, which gives M.
+//
+// The input is A(i, j, b): column i (0 <= i < 2 * SIZE) and row j of the extended matrix b, i.e.
+// row-major matrices. The output is O(bb, i, k, b): column i of row k of the extended U of matrix
+// bb + BATCH_TILE * b.
+//
+// Compile and generate the bitstream and the interface (getrf-interface.h/cpp):
+//    g++ getrf.cpp -g -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin -lHalide -lz -lpthread -ldl -std=c++11 -DSIZE=32
+//    env BITSTREAM=getrf.aocx AOC_OPTION="$EMULATOR_AOC_OPTION -board=$FPGA_BOARD -emulator-channel-depth-model=strict" ./a.out
+//
+// [1] D. C. Sorensen. Analysis of pairwise pivoting in Gaussian elimination. IEEE Transactions on Computers,
+//     C-34(3), pages 274-278, 1985.
+#include "Halide.h"
+
+// Constant parameters of the design
+#include "const-parameters.h"
+
+using namespace Halide;
+
+int main(void) {
+    ImageParam A(Float(32), 3);
+
+    // Macros: for convenient use.
+    #define X                      bb,    i,     k,     j,     b
+    #define X_no_j                 bb,    i,     k,            b
+    #define X_k_minus_1            bb,    i,     k - 1, j,     b
+    #define X_j_minus_1            bb,    i,     k,     j - 1, b
+    #define X_i_minus_1            bb,    i - 1, k,     j,     b
+    #define FUNC_DECL              Float(32), {X}, Place::Device
+    #define BATCH                  (A.dim(2).extent() / BATCH_TILE)
+
+    Var  X;
+    Func Xin(FUNC_DECL), Xout(FUNC_DECL), U(FUNC_DECL), L(FUNC_DECL), Swap(Bool(), {X}, Place::Device),
+         O(Place::Device);
+
+    // Element i of row j at PE k, and element (k, i) of U before the row arrives
+    Expr u = select(j == 0, 0, U(X_j_minus_1));
+    // The row kept and the row eliminated
+    Expr kept = select(Swap(X), Xin(X), u), eliminated = select(Swap(X), u, Xin(X));
+
+    Xin(X)    = select(k == 0, A(i, j, bb + BATCH_TILE * b), Xout(X_k_minus_1));
+    // The interchange and the multiplier are decided at the diagonal (i == k), and then passed along the
+    // row. Elements i < k of both rows are 0 already.
+    Swap(X)   = select(i > k, Swap(X_i_minus_1), abs(Xin(X)) > abs(u));
+    L(X)      = select(i > k, L(X_i_minus_1), select(kept == 0, 0, eliminated / kept));
+    U(X)      = select(i < k, 0, kept);
+    Xout(X)   = select(i <= k, 0, eliminated - L(X) * kept);
+    O(X_no_j) = select(j == SIZE - 1, U(X));
+
+    Xin.merge_ures(Swap, L, U, Xout, O) // Put all the UREs into the same loop nest
+       .set_bounds(bb, 0, BATCH_TILE, i, 0, 2 * SIZE)
+       .set_bounds(k, 0, SIZE, j, 0, SIZE)
+       .set_bounds(b, 0, BATCH)
+       .space_time_transform(k);
+
+    // Only PE 0 reads the matrices. The loader streams the next matrices while the PEs factorize the current ones.
+    Func serializer(Place::Host), loader(Place::Device);
+    Xin.isolate_producer_chain(A, serializer, loader);
+    serializer.set_bounds(k, 0, 1);
+    loader.set_bounds(k, 0, 1);
+    loader.min_depth(256);
+
+    O.min_depth(256);
+    Func deserializer(Place::Host), collector(Place::Device), unloader(Place::Device);
+    O.isolate_consumer_chain(collector);
+    collector.space_time_transform(k)
+             .set_bounds(i, 0, 2 * SIZE)
+             .set_bounds(k, 0, SIZE)
+             .set_bounds(bb, 0, BATCH_TILE, b, 0, BATCH);
+    collector.isolate_consumer_chain(unloader);
+    collector.gather(O, k);
+    unloader.isolate_consumer_chain(deserializer);
+    collector.min_depth(256);
+    unloader.min_depth(256);
+
+    Target target = get_host_target();
+    target.set_feature(Target::IntelFPGA);
+    deserializer.compile_to_host("getrf-interface", { A }, "getrf", target);
+    printf("Success\n");
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "getrf-interface.h"
+#include "lapack-getrf.h"
+#include "const-parameters.h"
+#include "HalideBuffer.h"
+#include "StreamingExecution.h"
+
+#include <assert.h>
+
+using namespace std;
+
+struct GetrfChunk {
+    vector<float> matrices;                 // The matrices of the chunk as read, and then their M
+    vector<float> u;                        // U of the matrices
+    int info = 0;                           // The index + 1 of the first singular matrix in the chunk, or 0
+    Halide::Runtime::Buffer<float> a, o;    // Inputs and outputs of the design
+};
+
+int sgetrf_stream(int n, function<int(float *a, int max)> read,
+                  function<void(const float *w, const float *u, int count, int info)> write) {
+    assert(n >= 1 && n <= SIZE);
+    return stream_batches<GetrfChunk>(
+        [=]() {
+            auto chunk = make_shared<GetrfChunk>();
+            chunk->matrices.resize((size_t)CHUNK * n * n);
+            chunk->u.resize((size_t)CHUNK * n * n);
+            return chunk;
+        },
+        [=](GetrfChunk &chunk) {
+            int count = read(chunk.matrices.data(), CHUNK);
+            // Pad every matrix into the bottom-right corner with an identity, and the batch with identities.
+            // Then extend every matrix with an identity on the right, which the design turns into M.
+            int batch = (count + BATCH_TILE - 1) / BATCH_TILE * BATCH_TILE;
+            chunk.a = Halide::Runtime::Buffer<float>(2 * SIZE, SIZE, batch);
+            for (int m = 0; m < batch; m++)
+            for (int j = 0; j < SIZE; j++)
+            for (int i = 0; i < 2 * SIZE; i++) {
+                bool original = (m < count && i < n && j < n);
+                bool one = (i == j && !original) || i == j + SIZE;
+                chunk.a(i, j, m) = original ? chunk.matrices[(size_t)m * n * n + j * n + i] : (one ? 1.0f : 0.0f);
+            }
+            return count;
+        },
+        [=](GetrfChunk &chunk, int count) {
+            int batch = chunk.a.dim(2).extent();
+            chunk.o = Halide::Runtime::Buffer<float>(BATCH_TILE, 2 * SIZE, SIZE, batch / BATCH_TILE);
+            int result = getrf(chunk.a, chunk.o);
+            release_device(chunk.a);
+            release_device(chunk.o);
+            return result;
+        },
+        [=](GetrfChunk &chunk, int count) {
+            chunk.info = 0;
+            for (int m = 0; m < count; m++)
+            for (int k = 0; k < n; k++) {
+                size_t base = (size_t)m * n * n;
+                for (int i = 0; i < n; i++) {
+                    chunk.u[base + k * n + i] = chunk.o(m % BATCH_TILE, i, k, m / BATCH_TILE);
+                    chunk.matrices[base + k * n + i] = chunk.o(m % BATCH_TILE, SIZE + i, k, m / BATCH_TILE);
+                }
+                if (chunk.info == 0 && chunk.u[base + k * n + k] == 0) {
+                    chunk.info = m + 1;
+                }
+            }
+            write(chunk.matrices.data(), chunk.u.data(), count, chunk.info);
+        });
+}
+
+int sgetrf_batched(int n, const float *a, int lda, long stridea, float *w, int ldw, long stridew,
+                   float *u, int ldu, long strideu, int batch) {
+    int next = 0, done = 0, info = 0;
+    int result = sgetrf_stream(n,
+        [&](float *m, int max) {
+            int count = min(max, batch - next);
+            for (int c = 0; c < count; c++, next++)
+            for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++) {
+                m[(size_t)c * n * n + j * n + i] = a[next * stridea + j * lda + i];
+            }
+            return count;
+        },
+        [&](const float *ws, const float *us, int count, int chunk_info) {
+            if (info == 0 && chunk_info != 0) {
+                info = done + chunk_info;
+            }
+            for (int c = 0; c < count; c++, done++)
+            for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++) {
+                w[done * stridew + j * ldw + i] = ws[(size_t)c * n * n + j * n + i];
+                u[done * strideu + j * ldu + i] = us[(size_t)c * n * n + j * n + i];
+            }
+        });
+    return (result != 0) ? result : info;
+}
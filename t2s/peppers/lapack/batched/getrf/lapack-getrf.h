@@ -0,0 +1,22 @@
+#ifndef lapack_getrf_h
+#define lapack_getrf_h
+
+#include <functional>
+
+// LU factorization with pairwise pivoting M * A = U of a batch of n x n matrices, n <= SIZE, where U is upper
+// triangular, and M is the product of the interchanges of pairs of rows and the eliminations, with multipliers
+// at most 1 in magnitude. A * x = b is solved by U * x = M * b. Matrix m is row-major at a + m * stridea with
+// leading dimension lda, and so are its M and U at w + m * stridew and u + m * strideu. Returns 0, the index + 1
+// of the first matrix that is singular, i.e. whose U has a 0 on the diagonal, or the error of the device.
+int sgetrf_batched(int n, const float *a, int lda, long stridea, float *w, int ldw, long stridew,
+                   float *u, int ldu, long strideu, int batch);
+
+// LU factorization of a stream of n x n matrices, with no fixed batch size. read(a, max) stores up to max
+// matrices into a, row-major and contiguous, and returns how many it stored, or 0 at the end of the stream.
+// write(w, u, count, info) receives M and U of the matrices read, in the same layout, and the index + 1 of
+// the first singular matrix among them, or 0. The next matrices are read and the previous factors are written
+// while the device factorizes the current matrices.
+int sgetrf_stream(int n, std::function<int(float *a, int max)> read,
+                  std::function<void(const float *w, const float *u, int count, int info)> write);
+
+#endif
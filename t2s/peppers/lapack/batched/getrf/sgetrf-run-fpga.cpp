@@ -0,0 +1,80 @@
+#include "lapack-getrf.h"
+#include "const-parameters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+#include <vector>
+#include <iostream>
+#include <assert.h>
+
+using namespace std;
+
+int main()
+{
+    const int N = SIZE - 1;
+    const int BATCH = CHUNK * 2 + 5;
+
+    vector<float> a((size_t)BATCH * N * N), w(a.size()), u(a.size());
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = random() / (float)RAND_MAX;
+    }
+
+    int info = sgetrf_batched(N, a.data(), N, N * N, w.data(), N, N * N, u.data(), N, N * N, BATCH);
+    assert(info == 0);
+
+    for (int m = 0; m < BATCH; m++) {
+        const float *A = &a[(size_t)m * N * N], *W = &w[(size_t)m * N * N], *U = &u[(size_t)m * N * N];
+        // M * A = U, with U upper triangular
+        for (int i = 0; i < N; i++)
+        for (int j = 0; j < N; j++) {
+            float sum = 0, magnitude = 0;
+            for (int k = 0; k < N; k++) {
+                sum += W[i * N + k] * A[k * N + j];
+                magnitude += fabs(W[i * N + k] * A[k * N + j]);
+            }
+            assert(fabs(sum - U[i * N + j]) <= 0.005 * magnitude + 1e-4);
+            assert(j >= i || U[i * N + j] == 0);
+        }
+        // Solve A * x = b by U * x = M * b, for b = A * x0, and check the residual of x
+        vector<float> x0(N), b(N, 0), x(N);
+        for (int i = 0; i < N; i++) {
+            x0[i] = random() / (float)RAND_MAX;
+        }
+        for (int i = 0; i < N; i++)
+        for (int k = 0; k < N; k++) {
+            b[i] += A[i * N + k] * x0[k];
+        }
+        for (int i = N - 1; i >= 0; i--) {
+            float y = 0;
+            for (int k = 0; k < N; k++) {
+                y += W[i * N + k] * b[k];
+            }
+            for (int k = i + 1; k < N; k++) {
+                y -= U[i * N + k] * x[k];
+            }
+            x[i] = y / U[i * N + i];
+        }
+        for (int i = 0; i < N; i++) {
+            float residual = -b[i], magnitude = 0;
+            for (int k = 0; k < N; k++) {
+                residual += A[i * N + k] * x[k];
+                magnitude += fabs(A[i * N + k] * x[k]);
+            }
+            assert(fabs(residual) <= 1e-3 * magnitude);
+        }
+    }
+
+    // A singular matrix is reported, and the others are still factorized
+    vector<float> s(a.begin(), a.begin() + 3 * N * N), sw(s.size()), su(s.size());
+    for (int i = 0; i < N; i++) {
+        s[N * N + i * N + 2] = 0;
+    }
+    assert(sgetrf_batched(N, s.data(), N, N * N, sw.data(), N, N * N, su.data(), N, N * N, 3) == 2);
+    for (int x = 0; x < N * N; x++) {
+        assert(su[2 * N * N + x] == u[2 * N * N + x] && sw[2 * N * N + x] == w[2 * N * N + x]);
+    }
+
+    printf("Success\n");
+    return 0;
+}
@@ -0,0 +1,42 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef POTRF_CONST_PARAMS_H
+#define POTRF_CONST_PARAMS_H
+
+// The size of the matrices of the design. A design of size SIZE factorizes any n x n matrix with n <= SIZE,
+// which is padded into the bottom-right corner with an identity. The supported sizes are 4 to 256.
+#ifndef SIZE
+    #ifdef TINY // For verifying correctness only
+        #define SIZE        8
+    #else
+        #define SIZE        32
+    #endif
+#endif
+
+// The number of matrices interleaved in the pipeline of every PE, to hide the latency of sqrt and division.
+#define BATCH_TILE      8
+
+// The number of matrices in every invocation of the design. The batch is streamed chunk by chunk.
+#ifdef TINY
+    #define CHUNK       (BATCH_TILE * 2)
+#else
+    #define CHUNK       (BATCH_TILE * 512)
+#endif
+
+#endif
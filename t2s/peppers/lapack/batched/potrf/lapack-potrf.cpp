@@ -0,0 +1,74 @@
+#include "potrf-interface.h"
+#include "lapack-potrf.h"
+#include "const-parameters.h"
+#include "HalideBuffer.h"
+#include "StreamingExecution.h"
+
+#include <assert.h>
+
+using namespace std;
+
+struct PotrfChunk {
+    vector<float> matrices;                 // The matrices of the chunk as read, and then their factors
+    Halide::Runtime::Buffer<float> a, l;    // Inputs and outputs of the design
+};
+
+int spotrf_stream(int n, function<int(float *a, int max)> read, function<void(const float *l, int count)> write) {
+    assert(n >= 1 && n <= SIZE);
+    return stream_batches<PotrfChunk>(
+        [=]() {
+            auto chunk = make_shared<PotrfChunk>();
+            chunk->matrices.resize((size_t)CHUNK * n * n);
+            return chunk;
+        },
+        [=](PotrfChunk &chunk) {
+            int count = read(chunk.matrices.data(), CHUNK);
+            // Pad every matrix into the bottom-right corner with an identity, and the batch with identities
+            int batch = (count + BATCH_TILE - 1) / BATCH_TILE * BATCH_TILE;
+            chunk.a = Halide::Runtime::Buffer<float>(SIZE, SIZE, batch);
+            for (int m = 0; m < batch; m++)
+            for (int j = 0; j < SIZE; j++)
+            for (int i = 0; i < SIZE; i++) {
+                chunk.a(i, j, m) = (m < count && i < n && j < n) ? chunk.matrices[(size_t)m * n * n + j * n + i]
+                                                                 : (i == j ? 1.0f : 0.0f);
+            }
+            return count;
+        },
+        [=](PotrfChunk &chunk, int count) {
+            int batch = chunk.a.dim(2).extent();
+            chunk.l = Halide::Runtime::Buffer<float>(SIZE, BATCH_TILE, SIZE, batch / BATCH_TILE);
+            int result = potrf(chunk.a, chunk.l);
+            release_device(chunk.a);
+            release_device(chunk.l);
+            return result;
+        },
+        [=](PotrfChunk &chunk, int count) {
+            for (int m = 0; m < count; m++)
+            for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++) {
+                chunk.matrices[(size_t)m * n * n + j * n + i] = chunk.l(i, m % BATCH_TILE, j, m / BATCH_TILE);
+            }
+            write(chunk.matrices.data(), count);
+        });
+}
+
+int spotrf_batched(int n, float *a, int lda, long stridea, int batch) {
+    int next = 0, done = 0;
+    return spotrf_stream(n,
+        [&](float *m, int max) {
+            int count = min(max, batch - next);
+            for (int c = 0; c < count; c++, next++)
+            for (int j = 0; j < n; j++)
+            for (int i = 0; i <= j; i++) {
+                m[(size_t)c * n * n + j * n + i] = m[(size_t)c * n * n + i * n + j] = a[next * stridea + j * lda + i];
+            }
+            return count;
+        },
+        [&](const float *l, int count) {
+            for (int c = 0; c < count; c++, done++)
+            for (int j = 0; j < n; j++)
+            for (int i = 0; i <= j; i++) {
+                a[done * stridea + j * lda + i] = l[(size_t)c * n * n + j * n + i];
+            }
+        });
+}
@@ -0,0 +1,19 @@
+#ifndef lapack_potrf_h
+#define lapack_potrf_h
+
+#include <functional>
+
+// Cholesky factorization A = L * L^T of a batch of n x n symmetric positive definite matrices, n <= SIZE.
+// Matrix m is row-major at a + m * stridea, with leading dimension lda. Only its lower triangle is read,
+// and L overwrites it. Returns 0, or the error of the device.
+int spotrf_batched(int n, float *a, int lda, long stridea, int batch);
+
+// Cholesky factorization of a stream of n x n matrices, with no fixed batch size. read(a, max) stores up
+// to max full matrices into a, row-major and contiguous, and returns how many it stored, or 0 at the end
+// of the stream. write(l, count) receives the factors of the matrices read, in the same layout, with 0 in
+// the upper triangles. The next matrices are read and the previous factors are written while the device
+// factorizes the current matrices.
+int spotrf_stream(int n, std::function<int(float *a, int max)> read,
+                  std::function<void(const float *l, int count)> write);
+
+#endif
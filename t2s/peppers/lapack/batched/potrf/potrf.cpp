@@ -0,0 +1,101 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Batched Cholesky factorization A = L * L^T of symmetric positive definite matrices.
+//
+// The UREs are those of LU factorization without pivoting (as in t2s/tests/correctness/LU), which is
+// stable for symmetric positive definite matrices: at step k, row k is the pivot row, and the other
+// rows are updated by the pivot row. For such a matrix, L(j, k) = U(k, j) / sqrt(U(k, k)), i.e. the
+// multiplier of row j scaled by the square root of the pivot. So the design outputs only the lower
+// triangle, scaled, and 0 in the upper triangle.
+//
+// The input is A(i, j, b): column i and row j of matrix b, i.e. row-major matrices. The output is
+// L(i, bb, j, b): column i and row j of matrix bb + BATCH_TILE * b.
+//
+// Compile and generate the bitstream and the interface (potrf-interface.h/cpp):
+//    g++ potrf.cpp -g -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin -lHalide -lz -lpthread -ldl -std=c++11 -DSIZE=32
+//    env BITSTREAM=potrf.aocx AOC_OPTION="$EMULATOR_AOC_OPTION -board=$FPGA_BOARD -emulator-channel-depth-model=strict" ./a.out
+#include "Halide.h"
+
+// Constant parameters of the design
+#include "const-parameters.h"
+
+using namespace Halide;
+
+int main(void) {
+    ImageParam A(Float(32), 3);
+
+    // Macros: for convenient use.
+    #define X                      i,     bb,    j,     k,     b
+    #define X_no_k                 i,     bb,    j,            b
+    #define X_k_minus_1            i,     bb,    j,     k - 1, b
+    #define X_j_minus_1            i,     bb,    j - 1, k,     b
+    #define X_i_minus_1            i - 1, bb,    j,     k,     b
+    #define FUNC_DECL              Float(32), {X}, Place::Device
+    #define BATCH                  (A.dim(2).extent() / BATCH_TILE)
+
+    Var  X;
+    Func PrevV(FUNC_DECL), V(FUNC_DECL), L(FUNC_DECL), PreU(FUNC_DECL), U(FUNC_DECL), Z(FUNC_DECL),
+         O(Place::Device);
+
+    PrevV(X)  = select(i >= k && j >= k, select(k == 0, A(i, j, bb + BATCH_TILE * b), V(X_k_minus_1)), 0);
+    PreU(X)   = select(i >= k && j > k, U(X_j_minus_1), 0);
+    U(X)      = select(i >= k && j >= k, select(j == k, PrevV(X), PreU(X)), 0);
+    L(X)      = select(i < k || j <= k, 0 /*Arbitrary value, as it is undefined in this case.*/,
+                               select(i == k, PrevV(X) / PreU(X), L(X_i_minus_1)));
+    V(X)      = select(i < k || j <= k, 0 /*Arbitrary value, as it is undefined in this case.*/,
+                               PrevV(X) - L(X) * PreU(X));
+    // Column k of the result is produced at step k: sqrt of the pivot on the diagonal, and the
+    // remaining column divided by it below the diagonal. Row j of the result is complete at step j.
+    Z(X)      = select(j >= k, select(i < k, Z(X_k_minus_1),
+                                      select(j == k, select(i == k, sqrt(PrevV(X)), 0),
+                                                     select(i == k, PrevV(X) / sqrt(PreU(X)), 0))), 0);
+    O(X_no_k) = select(j == k, Z(X));
+
+    PrevV.merge_ures(PreU, U, L, V, Z, O) // Put all the UREs into the same loop nest
+         .reorder(j, bb, k, i, b)
+         .set_bounds(k, 0, SIZE, j, 0, SIZE, i, 0, SIZE)
+         .set_bounds(bb, 0, BATCH_TILE, b, 0, BATCH)
+         .space_time_transform(j);
+
+    // The loader streams the next matrices while the PEs factorize the current ones.
+    Func serializer(Place::Host), feeder(Place::Device), loader(Place::Device);
+    PrevV.isolate_producer_chain(A, serializer, loader, feeder);
+    feeder.scatter(loader, j);
+    feeder.min_depth(256);
+    loader.min_depth(256);
+
+    O.min_depth(256);
+    Func deserializer(Place::Host), collector(Place::Device), unloader(Place::Device);
+    O.isolate_consumer_chain(collector);
+    collector.space_time_transform(j)
+             .set_bounds(i, 0, SIZE)
+             .set_bounds(j, 0, SIZE)
+             .set_bounds(bb, 0, BATCH_TILE, b, 0, BATCH);
+    collector.isolate_consumer_chain(unloader);
+    collector.gather(O, j);
+    unloader.isolate_consumer_chain(deserializer);
+    collector.min_depth(256);
+    unloader.min_depth(256);
+
+    Target target = get_host_target();
+    target.set_feature(Target::IntelFPGA);
+    deserializer.compile_to_host("potrf-interface", { A }, "potrf", target);
+    printf("Success\n");
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "lapack-potrf.h"
+#include "const-parameters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+#include <vector>
+#include <iostream>
+#include <assert.h>
+
+using namespace std;
+
+int main()
+{
+    // A batch that does not fill the last chunk, of matrices smaller than the design
+    const int N = SIZE - 3;
+    const int BATCH = CHUNK * 2 + 5;
+
+    vector<float> a((size_t)BATCH * N * N), c((size_t)BATCH * N * N);
+    for (int m = 0; m < BATCH; m++) {
+        // A = B * B^T + N * I is symmetric positive definite
+        vector<float> b(N * N);
+        for (int i = 0; i < N * N; i++) {
+            b[i] = random() / (float)RAND_MAX;
+        }
+        for (int i = 0; i < N; i++)
+        for (int j = 0; j < N; j++) {
+            float sum = (i == j) ? N : 0;
+            for (int k = 0; k < N; k++) {
+                sum += b[i * N + k] * b[j * N + k];
+            }
+            a[(size_t)m * N * N + i * N + j] = c[(size_t)m * N * N + i * N + j] = sum;
+        }
+    }
+
+    int info = spotrf_batched(N, c.data(), N, N * N, BATCH);
+    assert(info == 0);
+
+    for (int m = 0; m < BATCH; m++) {
+        const float *l = &c[(size_t)m * N * N];
+        for (int i = 0; i < N; i++)
+        for (int j = 0; j <= i; j++) {
+            float golden = a[(size_t)m * N * N + i * N + j];
+            float sum = 0;
+            for (int k = 0; k <= j; k++) {
+                sum += l[i * N + k] * l[j * N + k];
+            }
+            assert(fabs(golden - sum) < 0.005 * fabs(golden) + 1e-3);
+        }
+    }
+
+    // The same batch in the streaming interface, a few matrices at a time
+    int next = 0, done = 0;
+    info = spotrf_stream(N,
+        [&](float *m, int max) {
+            int count = min(min(max, 7), BATCH - next);
+            copy(a.begin() + (size_t)next * N * N, a.begin() + (size_t)(next + count) * N * N, m);
+            next += count;
+            return count;
+        },
+        [&](const float *l, int count) {
+            for (int x = 0; x < count * N * N; x++) {
+                // Only the lower triangles were compared above
+                int i = (x % (N * N)) / N, j = x % N;
+                if (j <= i) {
+                    assert(l[x] == c[(size_t)done * N * N + x]);
+                }
+            }
+            done += count;
+        });
+    assert(info == 0 && done == BATCH);
+
+    printf("Success\n");
+    return 0;
+}
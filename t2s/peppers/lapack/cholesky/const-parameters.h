@@ -0,0 +1,30 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef CHOLESKY_CONST_PARAMS_H
+#define CHOLESKY_CONST_PARAMS_H
+
+// The size of the tiles of the blocked factorization. A diagonal tile is factorized by the batched potrf design
+// with the device kernels, so NB must not be larger than the SIZE of that design.
+#ifdef TINY // For verifying correctness only
+    #define NB          8
+#else
+    #define NB          32
+#endif
+
+#endif
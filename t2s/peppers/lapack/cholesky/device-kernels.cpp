@@ -0,0 +1,64 @@
+#include "lapack-cholesky.h"
+#include "const-parameters.h"
+#include "../batched/potrf/lapack-potrf.h"
+#include "../../blas/level3/gemm/dispatch/gemm-dispatch.h"
+
+#include <stdlib.h>
+#include <mutex>
+#include <vector>
+
+// The kernels share the device, and the dispatcher is not thread-safe, so the tasks of the graph invoke the
+// device one at a time. The host tasks keep running on the other threads meanwhile.
+static std::mutex device;
+
+// The variants of gemm are in the directory in the environment variable GEMM_VARIANTS, as for the dispatched
+// sgemm (t2s/peppers/blas/level3/gemm/dispatch/blas-gemm.cpp)
+static GemmDispatcher &dispatcher() {
+    static GemmDispatcher d(getenv("GEMM_VARIANTS") ? getenv("GEMM_VARIANTS") : "variants/gemm");
+    return d;
+}
+
+CholeskyKernels device_cholesky_kernels() {
+    CholeskyKernels kernels = host_cholesky_kernels();
+    // A diagonal tile is a batch of 1 matrix of size NB or less for the batched design
+    kernels.potrf = [](int n, float *a, int lda) {
+        int result;
+        {
+            std::lock_guard<std::mutex> lock(device);
+            result = spotrf_batched(n, a, lda, 0, 1);
+        }
+        if (result != 0) {
+            return result;
+        }
+        // The design does not check the pivots, which are NaN or not positive if A is not positive definite
+        for (int j = 0; j < n; j++) {
+            if (!(a[j * lda + j] > 0)) {
+                return j + 1;
+            }
+        }
+        return 0;
+    };
+    // The upper triangle of a diagonal tile is not to be written, so the product is computed into a scratch
+    // tile, and only its lower triangle is subtracted
+    kernels.syrk = [](int n, int k, const float *a, int lda, float *c, int ldc) {
+        std::vector<float> product((size_t)n * n);
+        int result;
+        {
+            std::lock_guard<std::mutex> lock(device);
+            result = dispatcher().sgemm('N', 'T', n, n, k, 1.0f, a, lda, a, lda, 0.0f, product.data(), n);
+        }
+        if (result != 0) {
+            return result;
+        }
+        for (int i = 0; i < n; i++)
+        for (int j = 0; j <= i; j++) {
+            c[i * ldc + j] -= product[(size_t)i * n + j];
+        }
+        return 0;
+    };
+    kernels.gemm = [](int m, int n, int k, const float *a, int lda, const float *b, int ldb, float *c, int ldc) {
+        std::lock_guard<std::mutex> lock(device);
+        return dispatcher().sgemm('N', 'T', m, n, k, -1.0f, a, lda, b, ldb, 1.0f, c, ldc);
+    };
+    return kernels;
+}
@@ -0,0 +1,155 @@
+#include "lapack-cholesky.h"
+#include "const-parameters.h"
+#include "TaskGraph.h"
+
+#include <assert.h>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+CholeskyKernels host_cholesky_kernels() {
+    CholeskyKernels kernels;
+    kernels.potrf = [](int n, float *a, int lda) {
+        for (int j = 0; j < n; j++) {
+            float d = a[j * lda + j];
+            for (int k = 0; k < j; k++) {
+                d -= a[j * lda + k] * a[j * lda + k];
+            }
+            if (!(d > 0)) {
+                return j + 1;
+            }
+            a[j * lda + j] = sqrt(d);
+            for (int i = j + 1; i < n; i++) {
+                float s = a[i * lda + j];
+                for (int k = 0; k < j; k++) {
+                    s -= a[i * lda + k] * a[j * lda + k];
+                }
+                a[i * lda + j] = s / a[j * lda + j];
+            }
+        }
+        return 0;
+    };
+    kernels.trsm = [](int m, int n, const float *l, int ldl, float *b, int ldb) {
+        for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++) {
+            float s = b[i * ldb + j];
+            for (int k = 0; k < j; k++) {
+                s -= b[i * ldb + k] * l[j * ldl + k];
+            }
+            b[i * ldb + j] = s / l[j * ldl + j];
+        }
+        return 0;
+    };
+    kernels.syrk = [](int n, int k, const float *a, int lda, float *c, int ldc) {
+        for (int i = 0; i < n; i++)
+        for (int j = 0; j <= i; j++) {
+            float s = 0;
+            for (int p = 0; p < k; p++) {
+                s += a[i * lda + p] * a[j * lda + p];
+            }
+            c[i * ldc + j] -= s;
+        }
+        return 0;
+    };
+    kernels.gemm = [](int m, int n, int k, const float *a, int lda, const float *b, int ldb, float *c, int ldc) {
+        for (int i = 0; i < m; i++)
+        for (int j = 0; j < n; j++) {
+            float s = 0;
+            for (int p = 0; p < k; p++) {
+                s += a[i * lda + p] * b[j * ldb + p];
+            }
+            c[i * ldc + j] -= s;
+        }
+        return 0;
+    };
+    return kernels;
+}
+
+// Blocked right-looking Cholesky as a DAG of tasks on the tiles of the lower triangle. Step k factorizes
+// the diagonal tile (k, k) with potrf, solves the tiles (i, k) below it with trsm, and updates the trailing
+// tiles (i, j), k < j <= i, with syrk on the diagonal and gemm off the diagonal. A task depends on the
+// tasks that produce the tiles it reads, and on the previous update of the tile it writes.
+//
+// The tasks of the panel of step k + 1 are on the critical path. A task writing a tile of column j has
+// a higher priority than all the tasks writing columns right of j, so the updates of the next panel,
+// and then its potrf and trsm, run as soon as they are ready, while the rest of the trailing update
+// of step k continues on the other threads.
+int spotrf(int n, float *a, int lda, const CholeskyKernels &kernels, int num_threads) {
+    assert(n >= 0 && lda >= n);
+    const int T = (n + NB - 1) / NB;
+    auto tile = [=](int i, int j) { return a + (size_t)i * NB * lda + j * NB; };
+    auto extent = [=](int i) { return min(NB, n - i * NB); };
+    auto priority = [=](int column, int kind) { return (T - column) * 4 + kind; };
+
+    // The last task writing every tile of the lower triangle, and the first pivot that failed
+    vector<TaskGraph::Task> last(T * T, -1);
+    vector<int> info(T, 0);
+    TaskGraph graph;
+    for (int k = 0; k < T; k++) {
+        int nk = extent(k);
+        TaskGraph::Task factor = graph.add([=, &info]() {
+            int result = kernels.potrf(nk, tile(k, k), lda);
+            if (result > 0) {
+                info[k] = k * NB + result;
+            }
+            return result;
+        }, priority(k, 3), {last[k * T + k]});
+        last[k * T + k] = factor;
+        for (int i = k + 1; i < T; i++) {
+            int ni = extent(i);
+            last[i * T + k] = graph.add([=]() {
+                return kernels.trsm(ni, nk, tile(k, k), lda, tile(i, k), lda);
+            }, priority(k, 2), {factor, last[i * T + k]});
+        }
+        for (int i = k + 1; i < T; i++)
+        for (int j = k + 1; j <= i; j++) {
+            int ni = extent(i), nj = extent(j);
+            if (i == j) {
+                last[i * T + i] = graph.add([=]() {
+                    return kernels.syrk(ni, nk, tile(i, k), lda, tile(i, i), lda);
+                }, priority(j, 1), {last[i * T + k], last[i * T + i]});
+            } else {
+                last[i * T + j] = graph.add([=]() {
+                    return kernels.gemm(ni, nj, nk, tile(i, k), lda, tile(j, k), lda, tile(i, j), lda);
+                }, priority(j, 1), {last[i * T + k], last[j * T + k], last[i * T + j]});
+            }
+        }
+    }
+    int result = graph.run(num_threads > 0 ? num_threads : thread::hardware_concurrency());
+    for (int k = 0; k < T; k++) {
+        if (info[k] != 0) {
+            return info[k];
+        }
+    }
+    return result;
+}
+
+// Forward and backward substitution, L * Y = B and L^T * X = Y, a task per block of NB right-hand sides
+int spotrs(int n, int nrhs, const float *l, int ldl, float *b, int ldb, int num_threads) {
+    assert(n >= 0 && ldl >= n && ldb >= nrhs);
+    TaskGraph graph;
+    for (int c = 0; c < nrhs; c += NB) {
+        int nc = min(NB, nrhs - c);
+        graph.add([=]() {
+            for (int i = 0; i < n; i++)
+            for (int q = c; q < c + nc; q++) {
+                float s = b[(size_t)i * ldb + q];
+                for (int k = 0; k < i; k++) {
+                    s -= l[(size_t)i * ldl + k] * b[(size_t)k * ldb + q];
+                }
+                b[(size_t)i * ldb + q] = s / l[(size_t)i * ldl + i];
+            }
+            for (int i = n - 1; i >= 0; i--)
+            for (int q = c; q < c + nc; q++) {
+                float s = b[(size_t)i * ldb + q];
+                for (int k = i + 1; k < n; k++) {
+                    s -= l[(size_t)k * ldl + i] * b[(size_t)k * ldb + q];
+                }
+                b[(size_t)i * ldb + q] = s / l[(size_t)i * ldl + i];
+            }
+            return 0;
+        }, 0, {});
+    }
+    return graph.run(num_threads > 0 ? num_threads : thread::hardware_concurrency());
+}
@@ -0,0 +1,38 @@
+#ifndef lapack_cholesky_h
+#define lapack_cholesky_h
+
+#include <functional>
+
+// The kernels on the tiles of a blocked Cholesky factorization. All the tiles are row-major, with the given
+// leading dimensions. A kernel returns 0 or an error, except potrf as described below.
+struct CholeskyKernels {
+    // The lower triangle of the n x n tile a is overwritten by L of a = L * L^T. Returns 0, or i + 1 if
+    // the leading i + 1 x i + 1 minor of a is not positive definite.
+    std::function<int(int n, float *a, int lda)> potrf;
+    // b = b * L^-T, where b is m x n and L is the n x n lower triangle of l.
+    std::function<int(int m, int n, const float *l, int ldl, float *b, int ldb)> trsm;
+    // The lower triangle of the n x n tile c -= a * a^T, where a is n x k.
+    std::function<int(int n, int k, const float *a, int lda, float *c, int ldc)> syrk;
+    // c -= a * b^T, where c is m x n, a is m x k and b is n x k.
+    std::function<int(int m, int n, int k, const float *a, int lda, const float *b, int ldb, float *c, int ldc)> gemm;
+};
+
+// The kernels on the host
+CholeskyKernels host_cholesky_kernels();
+
+// The kernels with the diagonal tiles factorized on the device by the design in t2s/peppers/lapack/batched/potrf,
+// and the trailing updates on the device by the variants of gemm in the directory GEMM_VARIANTS, dispatched as
+// in t2s/peppers/blas/level3/gemm/dispatch. trsm remains on the host.
+CholeskyKernels device_cholesky_kernels();
+
+// Cholesky factorization A = L * L^T of an n x n symmetric positive definite matrix. A is row-major with
+// leading dimension lda, and only its lower triangle is read and overwritten by L. Returns 0, i + 1 if the
+// leading i + 1 x i + 1 minor of A is not positive definite, or the error of a kernel, which is negative.
+int spotrf(int n, float *a, int lda, const CholeskyKernels &kernels = host_cholesky_kernels(),
+           int num_threads = 0);
+
+// Solve A * X = B with A = L * L^T factorized by spotrf. B is n x nrhs, row-major with leading dimension
+// ldb, and is overwritten by X.
+int spotrs(int n, int nrhs, const float *l, int ldl, float *b, int ldb, int num_threads = 0);
+
+#endif
@@ -0,0 +1,76 @@
+#include "lapack-cholesky.h"
+#include "const-parameters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+#include <vector>
+#include <iostream>
+#include <assert.h>
+
+using namespace std;
+
+int main()
+{
+    // Tiles that do not divide the matrix
+    const int N = NB * 5 + 3;
+    const int NRHS = NB + 2;
+
+    // A = B * B^T + N * I is symmetric positive definite
+    vector<float> b(N * N), a(N * N), l(N * N);
+    for (int i = 0; i < N * N; i++) {
+        b[i] = random() / (float)RAND_MAX;
+    }
+    for (int i = 0; i < N; i++)
+    for (int j = 0; j < N; j++) {
+        float sum = (i == j) ? N : 0;
+        for (int k = 0; k < N; k++) {
+            sum += b[i * N + k] * b[j * N + k];
+        }
+        a[i * N + j] = sum;
+    }
+
+#ifdef DEVICE
+    CholeskyKernels kernels = device_cholesky_kernels();
+#else
+    CholeskyKernels kernels = host_cholesky_kernels();
+#endif
+    for (int threads : {1, 4}) {
+        l = a;
+        int info = spotrf(N, l.data(), N, kernels, threads);
+        assert(info == 0);
+        for (int i = 0; i < N; i++)
+        for (int j = 0; j <= i; j++) {
+            float sum = 0;
+            for (int k = 0; k <= j; k++) {
+                sum += l[i * N + k] * l[j * N + k];
+            }
+            assert(fabs(a[i * N + j] - sum) < 0.005 * fabs(a[i * N + j]) + 1e-3);
+        }
+    }
+
+    // Solve A * X = C for a known X
+    vector<float> x(N * NRHS), c(N * NRHS, 0);
+    for (int i = 0; i < N * NRHS; i++) {
+        x[i] = random() / (float)RAND_MAX;
+    }
+    for (int i = 0; i < N; i++)
+    for (int q = 0; q < NRHS; q++)
+    for (int k = 0; k < N; k++) {
+        c[i * NRHS + q] += a[i * N + k] * x[k * NRHS + q];
+    }
+    int info = spotrs(N, NRHS, l.data(), N, c.data(), NRHS);
+    assert(info == 0);
+    for (int i = 0; i < N * NRHS; i++) {
+        assert(fabs(x[i] - c[i]) < 0.005 * fabs(x[i]) + 1e-3);
+    }
+
+    // A matrix that is not positive definite is reported at its first failed pivot
+    l = a;
+    l[(NB * 2 + 1) * N + NB * 2 + 1] = -1;
+    info = spotrf(N, l.data(), N, kernels);
+    assert(info == NB * 2 + 2);
+
+    printf("Success\n");
+    return 0;
+}
@@ -0,0 +1,17 @@
+# Usage: source test.sh [device]. With device, the diagonal tiles are factorized by the batched potrf
+# design on the emulator, which ../batched/potrf/test.sh must have generated, and the trailing updates
+# are dispatched to the tiny variants of gemm, which are compiled into variants/gemm.
+cd $T2S_PATH/t2s/peppers/lapack/cholesky
+if [ "$1" == "device" ]; then
+    cd $T2S_PATH
+    source ./setenv.sh local fpga
+    cd $T2S_PATH/t2s/peppers/lapack/cholesky
+    potrf=$T2S_PATH/t2s/peppers/lapack/batched/potrf
+    dispatch=$T2S_PATH/t2s/peppers/blas/level3/gemm/dispatch
+    make -C $T2S_PATH/t2s/tests/performance -f Makefile.variants DESIGN=gemm VARIANTS=gemm/tiny.variants PLATFORM=emulator OUT=$PWD/variants/gemm
+    g++ spotrf-run.cpp lapack-cholesky.cpp device-kernels.cpp $dispatch/gemm-dispatch.cpp $potrf/lapack-potrf.cpp $potrf/potrf-interface.cpp $T2S_PATH/t2s/src/AOT-OpenCL-Runtime.cpp $T2S_PATH/t2s/src/SharedUtilsInC.cpp -g -DLINUX -DALTERA_CL -fPIC -I$potrf -I$T2S_PATH/t2s/src -I $T2S_PATH/Halide/include -I$INTELFPGAOCLSDKROOT/examples_aoc/common/inc $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/opencl.cpp $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/options.cpp -I$INTELFPGAOCLSDKROOT/host/include -L$INTELFPGAOCLSDKROOT/linux64/lib -L$AOCL_BOARD_PACKAGE_ROOT/linux64/lib -L$INTELFPGAOCLSDKROOT/host/linux64/lib -lOpenCL -L $T2S_PATH/Halide/bin -lelf -lHalide -DTINY -DDEVICE -lz -lpthread -ldl -std=c++11 -o ./b.out
+    env BITSTREAM=$potrf/a.aocx GEMM_VARIANTS=variants/gemm CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=1 INTEL_FPGA_OCL_PLATFORM_NAME="$EMULATOR_PLATFORM" ./b.out
+else
+    g++ spotrf-run.cpp lapack-cholesky.cpp -O2 -I$T2S_PATH/t2s/src -DTINY -lpthread -std=c++11 -o ./b.out
+    ./b.out
+fi
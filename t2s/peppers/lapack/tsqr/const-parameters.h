@@ -0,0 +1,54 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef TSQR_CONST_PARAMS_H
+#define TSQR_CONST_PARAMS_H
+
+// The number of columns of the design, i.e. the number of PEs. A design with COLS columns factorizes any
+// matrix with n <= COLS columns, which is padded with columns of 0. The supported sizes are 4 to 256.
+#ifndef COLS
+    #ifdef TINY // For verifying correctness only
+        #define COLS        8
+    #else
+        #define COLS        32
+    #endif
+#endif
+
+// The maximum number of right-hand sides, which are rotated along with the rows.
+#ifndef RHS
+    #define RHS             1
+#endif
+
+// The number of rows of a leaf of the reduction tree, i.e. of a block factorized independently.
+#ifdef TINY
+    #define ROW_BLOCK       32
+#else
+    #define ROW_BLOCK       1024
+#endif
+
+// The number of blocks interleaved in the pipeline of every PE, to hide the latency of computing a rotation.
+#define BATCH_TILE          8
+
+// The number of row blocks in every chunk streamed from the host.
+#ifdef TINY
+    #define CHUNK           (BATCH_TILE * 2)
+#else
+    #define CHUNK           (BATCH_TILE * 16)
+#endif
+
+#endif
@@ -0,0 +1,158 @@
+#include "tsqr-interface.h"
+#include "lapack-tsqr.h"
+#include "const-parameters.h"
+#include "HalideBuffer.h"
+#include "StreamingExecution.h"
+
+#include <assert.h>
+
+using namespace std;
+
+struct TsqrChunk {
+    vector<float> rows;                 // The rows of the chunk as read
+    Halide::Runtime::Buffer<float> a;   // The row blocks of the chunk, the input of the design
+};
+
+// Factorize the first count blocks of a, and return their extended R factors, R(i, k, block).
+static int factorize(Halide::Runtime::Buffer<float> &a, int count, Halide::Runtime::Buffer<float> &rs) {
+    int batch = a.dim(2).extent();
+    Halide::Runtime::Buffer<float> o(BATCH_TILE, COLS + RHS, COLS, batch / BATCH_TILE);
+    int result = tsqr(a, o);
+    release_device(a);
+    release_device(o);
+    rs = Halide::Runtime::Buffer<float>(COLS + RHS, COLS, count);
+    for (int m = 0; m < count; m++)
+    for (int k = 0; k < COLS; k++)
+    for (int i = 0; i < COLS + RHS; i++) {
+        rs(i, k, m) = o(m % BATCH_TILE, i, k, m / BATCH_TILE);
+    }
+    return result;
+}
+
+// Reduce the R factors to one with the reduction tree. At every level, pairs of R factors are stacked into
+// blocks of 2 * COLS rows, and all the blocks of the level are factorized in one invocation of the design.
+// A factor without a pair moves up to the next level as it is.
+static int reduce(Halide::Runtime::Buffer<float> &rs) {
+    while (rs.dim(2).extent() > 1) {
+        int count = rs.dim(2).extent(), pairs = count / 2;
+        int batch = (pairs + BATCH_TILE - 1) / BATCH_TILE * BATCH_TILE;
+        Halide::Runtime::Buffer<float> a(COLS + RHS, 2 * COLS, batch), parents;
+        a.fill(0.0f);
+        for (int p = 0; p < pairs; p++)
+        for (int j = 0; j < 2 * COLS; j++)
+        for (int i = 0; i < COLS + RHS; i++) {
+            a(i, j, p) = rs(i, j % COLS, 2 * p + j / COLS);
+        }
+        int result = factorize(a, pairs, parents);
+        if (result != 0) {
+            return result;
+        }
+        Halide::Runtime::Buffer<float> next(COLS + RHS, COLS, pairs + count % 2);
+        next.cropped(2, 0, pairs).copy_from(parents);
+        if (count % 2 != 0) {
+            Halide::Runtime::Buffer<float> last = rs.cropped(2, count - 1, 1);
+            last.translate(2, pairs - (count - 1));
+            next.copy_from(last);
+        }
+        rs = next;
+    }
+    return 0;
+}
+
+int stsqr_stream(int n, int nrhs, function<int(float *rows, int max)> read, float *r, float *qtb) {
+    assert(n >= 1 && n <= COLS && nrhs >= 0 && nrhs <= RHS);
+    const int width = n + nrhs;
+    // The R factor of all the rows so far, which joins the reduction tree of the next chunk
+    Halide::Runtime::Buffer<float> carry;
+    int result = stream_batches<TsqrChunk>(
+        [=]() {
+            auto chunk = make_shared<TsqrChunk>();
+            chunk->rows.resize((size_t)CHUNK * ROW_BLOCK * width);
+            return chunk;
+        },
+        [=](TsqrChunk &chunk) {
+            int count = read(chunk.rows.data(), CHUNK * ROW_BLOCK);
+            // Pad the columns of A to COLS with 0, and the last block and the batch of blocks with rows of 0,
+            // which do not change R.
+            int blocks = (count + ROW_BLOCK - 1) / ROW_BLOCK;
+            int batch = (blocks + BATCH_TILE - 1) / BATCH_TILE * BATCH_TILE;
+            chunk.a = Halide::Runtime::Buffer<float>(COLS + RHS, ROW_BLOCK, max(batch, BATCH_TILE));
+            chunk.a.fill(0.0f);
+            for (int t = 0; t < count; t++) {
+                const float *row = &chunk.rows[(size_t)t * width];
+                for (int i = 0; i < n; i++) {
+                    chunk.a(i, t % ROW_BLOCK, t / ROW_BLOCK) = row[i];
+                }
+                for (int q = 0; q < nrhs; q++) {
+                    chunk.a(COLS + q, t % ROW_BLOCK, t / ROW_BLOCK) = row[n + q];
+                }
+            }
+            return count;
+        },
+        [&](TsqrChunk &chunk, int count) {
+            int blocks = (count + ROW_BLOCK - 1) / ROW_BLOCK;
+            Halide::Runtime::Buffer<float> rs;
+            int result = factorize(chunk.a, blocks, rs);
+            if (result != 0) {
+                return result;
+            }
+            if (carry.data() != NULL) {
+                Halide::Runtime::Buffer<float> leaves(COLS + RHS, COLS, blocks + 1);
+                leaves.cropped(2, 0, blocks).copy_from(rs);
+                carry.translate(2, blocks);
+                leaves.copy_from(carry);
+                rs = leaves;
+            }
+            result = reduce(rs);
+            carry = rs;
+            return result;
+        },
+        [=](TsqrChunk &chunk, int count) {
+        });
+    for (int k = 0; k < n; k++) {
+        for (int i = 0; i < n; i++) {
+            r[k * n + i] = (carry.data() != NULL) ? carry(i, k, 0) : 0;
+        }
+        for (int q = 0; q < nrhs; q++) {
+            qtb[k * nrhs + q] = (carry.data() != NULL) ? carry(COLS + q, k, 0) : 0;
+        }
+    }
+    return result;
+}
+
+int sgels_tsqr(int m, int n, int nrhs, const float *a, int lda, const float *b, int ldb, float *x, int ldx) {
+    assert(m >= n);
+    int next = 0;
+    vector<float> r(n * n), qtb(n * nrhs);
+    int result = stsqr_stream(n, nrhs,
+        [&](float *rows, int max) {
+            int count = min(max, m - next);
+            for (int t = 0; t < count; t++, next++) {
+                for (int i = 0; i < n; i++) {
+                    rows[(size_t)t * (n + nrhs) + i] = a[(size_t)next * lda + i];
+                }
+                for (int q = 0; q < nrhs; q++) {
+                    rows[(size_t)t * (n + nrhs) + n + q] = b[(size_t)next * ldb + q];
+                }
+            }
+            return count;
+        },
+        r.data(), qtb.data());
+    if (result != 0) {
+        return result;
+    }
+    // Back substitution R * x = Q^T * B
+    for (int i = n - 1; i >= 0; i--) {
+        if (r[i * n + i] == 0) {
+            return i + 1;
+        }
+        for (int q = 0; q < nrhs; q++) {
+            float sum = qtb[i * nrhs + q];
+            for (int k = i + 1; k < n; k++) {
+                sum -= r[i * n + k] * x[k * ldx + q];
+            }
+            x[i * ldx + q] = sum / r[i * n + i];
+        }
+    }
+    return 0;
+}
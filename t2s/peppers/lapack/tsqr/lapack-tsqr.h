@@ -0,0 +1,19 @@
+#ifndef lapack_tsqr_h
+#define lapack_tsqr_h
+
+#include <functional>
+
+// Least squares: x minimizing ||A * x - B|| for an m x n matrix A, m >= n, n <= COLS, and nrhs <= RHS
+// right-hand sides B. A, B and x are row-major with leading dimensions lda, ldb and ldx. Returns 0, the
+// error of the device, or i + 1 if R(i, i) of A = Q * R is 0, i.e. A does not have full rank.
+int sgels_tsqr(int m, int n, int nrhs, const float *a, int lda, const float *b, int ldb, float *x, int ldx);
+
+// TSQR factorization of a stream of rows of a tall matrix [A | B] of n + nrhs columns, with no fixed
+// number of rows. read(rows, max) stores up to max rows into rows, row-major and contiguous, and returns
+// how many it stored, or 0 at the end of the stream. On return, r has R of A = Q * R, n x n and upper
+// triangular with a non-negative diagonal, and qtb has the first n rows of Q^T * B, n x nrhs, both
+// row-major. The next rows are read while the device factorizes the current ones. Returns 0, or the
+// error of the device.
+int stsqr_stream(int n, int nrhs, std::function<int(float *rows, int max)> read, float *r, float *qtb);
+
+#endif
@@ -0,0 +1,73 @@
+#include "lapack-tsqr.h"
+#include "const-parameters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+#include <vector>
+#include <iostream>
+#include <assert.h>
+
+using namespace std;
+
+int main()
+{
+    // A matrix with fewer columns than the design, and rows that fill neither the last block nor the last chunk
+    const int N = COLS - 3;
+    const int NRHS = RHS;
+    const int M = CHUNK * ROW_BLOCK * 3 + ROW_BLOCK * 2 + 7;
+
+    // B = A * x + noise, where x is the solution to find
+    vector<float> a((size_t)M * N), b((size_t)M * NRHS), x(N * NRHS), golden(N * NRHS);
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = random() / (float)RAND_MAX - 0.5f;
+    }
+    for (size_t i = 0; i < golden.size(); i++) {
+        golden[i] = random() / (float)RAND_MAX;
+    }
+    for (int t = 0; t < M; t++)
+    for (int q = 0; q < NRHS; q++) {
+        float sum = 1e-4f * (random() / (float)RAND_MAX - 0.5f);
+        for (int i = 0; i < N; i++) {
+            sum += a[(size_t)t * N + i] * golden[i * NRHS + q];
+        }
+        b[(size_t)t * NRHS + q] = sum;
+    }
+
+    int info = sgels_tsqr(M, N, NRHS, a.data(), N, b.data(), NRHS, x.data(), NRHS);
+    assert(info == 0);
+    for (int i = 0; i < N * NRHS; i++) {
+        assert(fabs(x[i] - golden[i]) < 0.005 * fabs(golden[i]) + 1e-3);
+    }
+
+    // R^T * R = A^T * A, and R is upper triangular with a non-negative diagonal
+    vector<float> r(N * N), qtb(N * NRHS);
+    int next = 0;
+    info = stsqr_stream(N, NRHS,
+        [&](float *rows, int max) {
+            // A few rows at a time
+            int count = min(min(max, ROW_BLOCK + 5), M - next);
+            for (int t = 0; t < count; t++, next++) {
+                copy(&a[(size_t)next * N], &a[(size_t)(next + 1) * N], &rows[(size_t)t * (N + NRHS)]);
+                copy(&b[(size_t)next * NRHS], &b[(size_t)(next + 1) * NRHS], &rows[(size_t)t * (N + NRHS) + N]);
+            }
+            return count;
+        },
+        r.data(), qtb.data());
+    assert(info == 0);
+    for (int i = 0; i < N; i++)
+    for (int j = 0; j < N; j++) {
+        double ata = 0, rtr = 0;
+        for (int t = 0; t < M; t++) {
+            ata += a[(size_t)t * N + i] * a[(size_t)t * N + j];
+        }
+        for (int k = 0; k < N; k++) {
+            rtr += r[k * N + i] * r[k * N + j];
+        }
+        assert(fabs(ata - rtr) < 0.005 * fabs(ata) + 1e-2);
+        assert(i < j || (i == j ? r[i * N + i] >= 0 : r[i * N + j] == 0));
+    }
+
+    printf("Success\n");
+    return 0;
+}
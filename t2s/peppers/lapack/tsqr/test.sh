@@ -0,0 +1,19 @@
+# Usage: source test.sh [emulator|hw]. The emulator validates a tiny design, and hw a large one.
+cd $T2S_PATH
+source ./setenv.sh local fpga
+cd $T2S_PATH/t2s/peppers/lapack/tsqr
+if [ "$1" == "hw" ]; then
+    size=LARGE
+    aoc_option="-v -profile -fpc -fp-relaxed -board=$FPGA_BOARD"
+    platform="$HW_PLATFORM"
+else
+    size=TINY
+    aoc_option="-march=emulator -board=$FPGA_BOARD -emulator-channel-depth-model=strict"
+    platform="$EMULATOR_PLATFORM"
+    export CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=1
+fi
+# Compile the specification into tsqr-interface.h/cpp and the bitstream a.aocx
+g++ tsqr.cpp -g -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin -lHalide -lz -lpthread -ldl -std=c++11 -D$size -o ./a.out
+env BITSTREAM=a.aocx AOC_OPTION="$aoc_option" ./a.out
+g++ stsqr-run-fpga.cpp lapack-tsqr.cpp tsqr-interface.cpp $T2S_PATH/t2s/src/AOT-OpenCL-Runtime.cpp $T2S_PATH/t2s/src/SharedUtilsInC.cpp -g -DLINUX -DALTERA_CL -fPIC -I$T2S_PATH/t2s/src -I $T2S_PATH/Halide/include -I$INTELFPGAOCLSDKROOT/examples_aoc/common/inc $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/opencl.cpp $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/options.cpp -I$INTELFPGAOCLSDKROOT/host/include -L$INTELFPGAOCLSDKROOT/linux64/lib -L$AOCL_BOARD_PACKAGE_ROOT/linux64/lib -L$INTELFPGAOCLSDKROOT/host/linux64/lib -lOpenCL -L $T2S_PATH/Halide/bin -lelf -lHalide -D$size -lz -lpthread -ldl -std=c++11 -o ./b.out
+env BITSTREAM=a.aocx INTEL_FPGA_OCL_PLATFORM_NAME="$platform" ./b.out
@@ -0,0 +1,107 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Tall-skinny QR (TSQR) factorization [1] of an m x n matrix with m >> n, on a linear array of COLS
+// PEs of Givens rotations, as in t2s/peppers/lapack/batched/geqrf.
+//
+// The rows of the matrix are split into blocks, which are factorized independently, BATCH_TILE blocks
+// interleaved in the pipeline of every PE. The R factors of the blocks are combined by a reduction
+// tree: every node stacks the R factors of two children and factorizes them again. A node is just a
+// block of 2 * COLS rows, so the same design factorizes the leaves and the nodes of every level of the
+// tree, with the number of rows of the blocks given at run time.
+//
+// Every row is extended by RHS columns, holding the same row of the right-hand sides B. The rotations
+// apply to B as well, and the extended R is [R | Q^T * B], which is all a least-squares solver needs.
+//
+// The input is A(i, j, b): column i (0 <= i < COLS + RHS) and row j of block b, i.e. row-major blocks.
+// The output is O(bb, i, k, b): column i of row k of the extended R of block bb + BATCH_TILE * b.
+//
+// Compile and generate the bitstream and the interface (tsqr-interface.h/cpp):
+//    g++ tsqr.cpp -g -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin -lHalide -lz -lpthread -ldl -std=c++11 -DCOLS=32
+//    env BITSTREAM=tsqr.aocx AOC_OPTION="$EMULATOR_AOC_OPTION -board=$FPGA_BOARD -emulator-channel-depth-model=strict" ./a.out
+//
+// [1] J. Demmel, L. Grigori, M. Hoemmen, and J. Langou. Communication-optimal parallel and sequential
+//     QR and LU factorizations. SIAM Journal on Scientific Computing, 34(1):A206-A239, 2012.
+#include "Halide.h"
+
+// Constant parameters of the design
+#include "const-parameters.h"
+
+using namespace Halide;
+
+int main(void) {
+    ImageParam A(Float(32), 3);
+
+    // Macros: for convenient use.
+    #define X                      bb,    i,     k,     j,     b
+    #define X_no_j                 bb,    i,     k,            b
+    #define X_k_minus_1            bb,    i,     k - 1, j,     b
+    #define X_j_minus_1            bb,    i,     k,     j - 1, b
+    #define X_i_minus_1            bb,    i - 1, k,     j,     b
+    #define FUNC_DECL              Float(32), {X}, Place::Device
+    #define ROWS                   A.dim(1).extent()
+    #define BATCH                  (A.dim(2).extent() / BATCH_TILE)
+
+    Var  X;
+    Func Xin(FUNC_DECL), Xout(FUNC_DECL), R(FUNC_DECL), C(FUNC_DECL), S(FUNC_DECL),
+         O(Place::Device);
+
+    // Element i of row j at PE k, and element (k, i) of R before the row arrives
+    Expr r = select(j == 0, 0, R(X_j_minus_1));
+    Expr norm = sqrt(r * r + Xin(X) * Xin(X));
+
+    Xin(X)    = select(k == 0, A(i, j, bb + BATCH_TILE * b), Xout(X_k_minus_1));
+    // The rotation is computed at the diagonal (i == k), and then passed along the row
+    C(X)      = select(i > k, C(X_i_minus_1), select(norm == 0, 1, r / norm));
+    S(X)      = select(i > k, S(X_i_minus_1), select(norm == 0, 0, Xin(X) / norm));
+    R(X)      = select(i < k, 0, select(i == k, norm, C(X) * r + S(X) * Xin(X)));
+    Xout(X)   = select(i <= k, 0, C(X) * Xin(X) - S(X) * r);
+    O(X_no_j) = select(j == ROWS - 1, R(X));
+
+    Xin.merge_ures(C, S, R, Xout, O) // Put all the UREs into the same loop nest
+       .set_bounds(bb, 0, BATCH_TILE, i, 0, COLS + RHS)
+       .set_bounds(k, 0, COLS, j, 0, ROWS)
+       .set_bounds(b, 0, BATCH)
+       .space_time_transform(k);
+
+    // Only PE 0 reads the blocks. The loader streams the next blocks while the PEs factorize the current ones.
+    Func serializer(Place::Host), loader(Place::Device);
+    Xin.isolate_producer_chain(A, serializer, loader);
+    serializer.set_bounds(k, 0, 1);
+    loader.set_bounds(k, 0, 1);
+    loader.min_depth(256);
+
+    O.min_depth(256);
+    Func deserializer(Place::Host), collector(Place::Device), unloader(Place::Device);
+    O.isolate_consumer_chain(collector);
+    collector.space_time_transform(k)
+             .set_bounds(i, 0, COLS + RHS)
+             .set_bounds(k, 0, COLS)
+             .set_bounds(bb, 0, BATCH_TILE, b, 0, BATCH);
+    collector.isolate_consumer_chain(unloader);
+    collector.gather(O, k);
+    unloader.isolate_consumer_chain(deserializer);
+    collector.min_depth(256);
+    unloader.min_depth(256);
+
+    Target target = get_host_target();
+    target.set_feature(Target::IntelFPGA);
+    deserializer.compile_to_host("tsqr-interface", { A }, "tsqr", target);
+    printf("Success\n");
+    return 0;
+}
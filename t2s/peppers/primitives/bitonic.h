@@ -0,0 +1,95 @@
+#ifndef peppers_bitonic_h
+#define peppers_bitonic_h
+
+#include "Halide.h"
+
+// Bitonic sorting network [1] for tiles of TILE = 2^L keys and their values, as UREs pipelined over the tiles.
+//
+// The network has S = L * (L + 1) / 2 layers of compare-exchanges. Layer s is a pair of UREs, K_s(i, t) and
+// V_s(i, t), for the key and the value at position i, and compares position i with position i ^ d of the
+// previous layer in the previous iteration of t, which is a uniform dependence of distance (d, 1) or (-d, 1).
+// So at iteration t, layer s works on tile t + S - s: loop i is meant to be space-time transformed into TILE
+// lanes of S comparators each, and a new tile enters the network every cycle. Loop t runs from -S, and the
+// sorted tile t is out(i, t) for t >= 0.
+//
+// A pair is moved only if its keys differ, so the keys and the values move together, and equal keys keep
+// their values, although not in any particular order.
+//
+// [1] K. E. Batcher. Sorting networks and their applications. In Proceedings of the AFIPS Spring Joint
+//     Computer Conference, pages 307-314, 1968.
+
+struct SortUREs {
+    Halide::Func head;      // The first URE, which the other UREs are merged into. Schedule the loop nest with it.
+    Halide::Func keys;      // The sorted keys, keys(i, t) for position i of tile t
+    Halide::Func values;    // The values of the sorted keys
+    int latency;            // The iterations of t from a tile in to the tile out, e.g. S, the number of layers
+};
+
+// Define the layers of the network, K[s] and V[s] for 0 <= s <= S, where layer 0 reads tile t + S.
+inline int bitonic_layers(Halide::Var i, Halide::Var t, int TILE, Halide::Expr tiles,
+                          std::function<Halide::Expr(Halide::Expr, Halide::Expr)> key,
+                          std::function<Halide::Expr(Halide::Expr, Halide::Expr)> value,
+                          Halide::Place place, std::vector<Halide::Func> &K, std::vector<Halide::Func> &V) {
+    using namespace Halide;
+    int L = 0;
+    while ((1 << L) < TILE) {
+        L++;
+    }
+    _halide_user_assert((1 << L) == TILE) << "The tile of a bitonic sort must be a power of 2, but is " << TILE << "\n";
+    const int S = L * (L + 1) / 2;
+    Type key_type = key(i, t).type(), value_type = value(i, t).type();
+
+    for (int s = 0; s <= S; s++) {
+        K.push_back(Func(key_type, {i, t}, place));
+        V.push_back(Func(value_type, {i, t}, place));
+    }
+
+    // Layer 0 reads tile t + S. The tile is guarded at both ends, in case loop t starts before -S in a longer
+    // loop nest, and clamped so that a guarded read stays in the input.
+    Expr in = t + S >= 0 && t + S < tiles;
+    Expr tile = clamp(t + S, 0, tiles - 1);
+    K[0](i, t) = select(in, key(i, tile), cast(key_type, 0));
+    V[0](i, t) = select(in, value(i, tile), cast(value_type, 0));
+
+    // Layer s merges bitonic sequences of 2^(k+1) keys, comparing keys at the distance d = 2^j
+    int s = 1;
+    for (int k = 0; k < L; k++) {
+        for (int j = k; j >= 0; j--, s++) {
+            int d = 1 << j;
+            Expr lower = (i & d) == 0;                  // Position i is the lower of its pair
+            Expr ascending = ((i >> (k + 1)) & 1) == 0; // The sequence of position i is sorted ascending
+            Expr self = K[s - 1](i, t - 1);
+            Expr partner = select(lower, K[s - 1](i + d, t - 1), K[s - 1](i - d, t - 1));
+            Expr partner_value = select(lower, V[s - 1](i + d, t - 1), V[s - 1](i - d, t - 1));
+            // The lower position takes the min of the pair if ascending, and the max otherwise
+            Expr take = select(lower == ascending, partner < self, partner > self);
+            K[s](i, t) = select(take, partner, self);
+            V[s](i, t) = select(take, partner_value, V[s - 1](i, t - 1));
+        }
+    }
+    return S;
+}
+
+// key(i, t) and value(i, t) are the inputs of position i of tile t, for 0 <= t < tiles.
+inline SortUREs bitonic_sort_ures(Halide::Var i, Halide::Var t, int TILE, Halide::Expr tiles,
+                                  std::function<Halide::Expr(Halide::Expr, Halide::Expr)> key,
+                                  std::function<Halide::Expr(Halide::Expr, Halide::Expr)> value,
+                                  Halide::Place place = Halide::Place::Device) {
+    using namespace Halide;
+    std::vector<Func> K, V;
+    const int S = bitonic_layers(i, t, TILE, tiles, key, value, place, K, V);
+    Func keys(place), values(place);
+    keys(i, t) = select(t >= 0, K[S](i, t));
+    values(i, t) = select(t >= 0, V[S](i, t));
+
+    std::vector<Func> ures;
+    ures.insert(ures.end(), V.begin(), V.end());
+    ures.insert(ures.end(), K.begin() + 1, K.end());
+    ures.push_back(keys);
+    ures.push_back(values);
+    K[0].merge_ures(ures, {keys, values})
+        .set_bounds(i, 0, TILE, t, -S, tiles + S);
+    return {K[0], keys, values, S};
+}
+
+#endif
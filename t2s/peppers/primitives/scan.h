@@ -0,0 +1,63 @@
+#ifndef peppers_scan_h
+#define peppers_scan_h
+
+#include "Halide.h"
+
+// Parallel prefix (scan) on a linear array of PEs, as UREs that compose with the rest of a design.
+//
+// The input is a sequence x(p + PES * t), given as an expression of the loops p and t. Loop p runs over the
+// PEs and is meant to be space-time transformed, and loop t over the tiles of PES elements, which are read
+// in one cycle each. Within a tile, the prefix of PE p is combined with x in PE p + 1 in the same cycle.
+// Across tiles, the last PE sends its prefix to PE 0 for the next tile, which is a dependence of distance
+// (PES - 1, 1), just like the jj + JJ - 1, j - 1 dependences of the tiled designs.
+//
+// After space_time_transform(p), the prefix ripples through the PEs of a tile in one cycle, i.e. the critical
+// path is a chain of PES applications of op. This is not a log-depth network (Kogge-Stone or Brent-Kung): its
+// levels depend on PE p - 2^l, not on a neighbor, and segmented scans would need the flags combined along
+// every level. Keep PES small enough, or op cheap enough, for the chain to fit in a cycle, and scan more
+// elements with more tiles instead.
+//
+// For example, an exclusive prefix sum of a(0..N), gathered from the PEs:
+//    Var p, t;
+//    ScanUREs s = scan_ures(p, t, PES, N / PES, a(p + PES * t), [](Expr x, Expr y) { return x + y; }, 0,
+//                           ScanMode::Exclusive);
+//    s.head.space_time_transform(p);
+//    Func collector(Place::Device), unloader(Place::Device);
+//    s.out.isolate_consumer_chain(collector, unloader);
+//    collector.gather(s.out, p);
+//
+// A segmented scan restarts at every element whose flag is true. An exclusive scan of the predicates of the
+// elements gives their addresses in a compacted output, and a segmented scan of 1s gives their ranks within
+// their segments, e.g. the buckets of a histogram or the digits of a radix sort.
+
+enum class ScanMode {
+    Inclusive,      // out(i) = x(0) op ... op x(i)
+    Exclusive       // out(i) = identity op x(0) op ... op x(i - 1)
+};
+
+struct ScanUREs {
+    Halide::Func head;  // The first URE, which the other UREs are merged into. Schedule the loop nest with it.
+    Halide::Func out;   // The result, out(p, t) for element p + PES * t
+};
+
+inline ScanUREs scan_ures(Halide::Var p, Halide::Var t, int PES, Halide::Expr tiles, Halide::Expr input,
+                          std::function<Halide::Expr(Halide::Expr, Halide::Expr)> op, Halide::Expr identity,
+                          ScanMode mode = ScanMode::Inclusive, Halide::Expr segment_start = Halide::Expr(false),
+                          Halide::Place place = Halide::Place::Device) {
+    using namespace Halide;
+    Type type = input.type();
+    identity = cast(type, identity);
+    Func X(type, {p, t}, place), S(type, {p, t}, place), O(place);
+
+    // The inclusive scan of the previous element
+    Expr prev = select(p == 0, select(t == 0, identity, S(p + PES - 1, t - 1)), S(p - 1, t));
+    X(p, t) = input;
+    S(p, t) = select(segment_start, X(p, t), op(prev, X(p, t)));
+    O(p, t) = (mode == ScanMode::Inclusive) ? Expr(S(p, t)) : select(segment_start, identity, prev);
+
+    X.merge_ures(S, O)
+     .set_bounds(p, 0, PES, t, 0, tiles);
+    return {X, O};
+}
+
+#endif
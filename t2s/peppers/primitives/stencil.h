@@ -0,0 +1,109 @@
+#ifndef peppers_stencil_h
+#define peppers_stencil_h
+
+#include "Halide.h"
+
+// Temporal blocking of a Jacobi-style stencil: T time steps fused into a linear array of PEs, as UREs.
+//
+// A step computes every interior point of a grid from the points of the previous step within radius r:
+//    A_s(x) = sum_k w_k * A_{s-1}(x + o_k)          if x is interior
+//    A_s(x) = A_{s-1}(x)                             otherwise (fixed boundary)
+// Loop s runs over the steps and is meant to be space-time transformed, so that PE s does step s on the
+// output stream of PE s - 1. To make the dependences uniform and causal, the space loops are skewed by r
+// per step: V(s, X) = A_s(X - r * s), and A_{s-1}(x + o) is V(s - 1, X + o - r), whose distance r - o is
+// between 0 and 2r along every space loop. After the transform, every such dependence is a shift register
+// between PE s - 1 and PE s, whose depth is its linearized distance: the line buffers of a 2-D stencil (2r
+// lines of the innermost loop), or the plane buffers of a 3-D one. Layer 0 only reads the input.
+//
+// The space loops are tile-local. A tile reads the input points X within the extents of the loops, including
+// a halo of r * T on every side, which is read again by the neighbouring tiles (overlapped tiling): after T
+// steps, only the results at least r * T away from the sides of the tile are right. out(X) is the result for
+// input point X - r * T, and is only written for X >= 2 * r * T along every space loop, so the extent of a
+// space loop should be the tile plus 2 * r * T.
+//
+// For example, 4 steps of a 5-point 2-D Jacobi on tiles of BX columns of a grid padded by 4 on every side:
+//    std::vector<StencilTap> taps = {{{0, 0}, 0.2f}, {{-1, 0}, 0.2f}, {{1, 0}, 0.2f}, {{0, -1}, 0.2f}, {{0, 1}, 0.2f}};
+//    StencilUREs st = stencil_ures(s, {x, y}, {xb}, 4, {BX + 8, H + 8}, taps,
+//                                  [&](std::vector<Expr> X) { return In(xb * BX + X[0], X[1]); },
+//                                  [&](std::vector<Expr> u) { return interior(xb * BX + u[0] - 4, u[1] - 4); });
+//    st.head.set_bounds(xb, 0, XB).space_time_transform(s);
+
+struct StencilTap {
+    std::vector<int> offset;    // o_k, along every space loop
+    Halide::Expr weight;        // w_k
+};
+
+struct StencilUREs {
+    Halide::Func head;  // The first URE, which the other UREs are merged into. Schedule the loop nest with it.
+    Halide::Func out;   // The result of the T steps, out(X..., outer...) for input point X - r * T
+    int radius;         // r, the largest offset of the taps
+};
+
+// input(X) is the input at point X of a tile, and interior(u) tells if point u of the tile (with the same
+// origin as X) is in the interior of the grid. The outer loops (e.g. the tiles) are bounded by the caller.
+inline StencilUREs stencil_ures(Halide::Var s, const std::vector<Halide::Var> &space,
+                                const std::vector<Halide::Var> &outer, int T,
+                                const std::vector<Halide::Expr> &extents, const std::vector<StencilTap> &taps,
+                                std::function<Halide::Expr(std::vector<Halide::Expr>)> input,
+                                std::function<Halide::Expr(std::vector<Halide::Expr>)> interior,
+                                Halide::Place place = Halide::Place::Device) {
+    using namespace Halide;
+    const size_t D = space.size();
+    _halide_user_assert(T > 0 && extents.size() == D && !taps.empty())
+        << "A stencil needs at least 1 step, an extent for every space loop and a tap\n";
+    int r = 0;
+    for (const auto &tap : taps) {
+        _halide_user_assert(tap.offset.size() == D) << "Every tap of a stencil needs an offset for every space loop\n";
+        for (int o : tap.offset) {
+            r = std::max(r, std::abs(o));
+        }
+    }
+
+    std::vector<Var> args{s}, out_args;
+    args.insert(args.end(), space.begin(), space.end());
+    args.insert(args.end(), outer.begin(), outer.end());
+    out_args.insert(out_args.end(), args.begin() + 1, args.end());
+    std::vector<Expr> X(space.begin(), space.end()), u, outer_e(outer.begin(), outer.end());
+    for (size_t d = 0; d < D; d++) {
+        u.push_back(X[d] - r * s);
+    }
+    Type type = input(X).type();
+    Func V(type, args, place), O(place);
+
+    // A point of the previous step at offset o
+    auto prev = [&](const std::vector<int> &o) -> Expr {
+        std::vector<Expr> p{s - 1};
+        for (size_t d = 0; d < D; d++) {
+            p.push_back(X[d] + (o[d] - r));
+        }
+        p.insert(p.end(), outer_e.begin(), outer_e.end());
+        return V(p);
+    };
+    Expr sum = cast(type, 0);
+    for (const auto &tap : taps) {
+        sum += cast(type, tap.weight) * prev(tap.offset);
+    }
+    // Every point the step reads is in the tile
+    Expr in_tile = X[0] >= 2 * r;
+    Expr written = X[0] >= 2 * r * T;
+    for (size_t d = 1; d < D; d++) {
+        in_tile = in_tile && X[d] >= 2 * r;
+        written = written && X[d] >= 2 * r * T;
+    }
+    std::vector<Expr> at_T{T};
+    at_T.insert(at_T.end(), X.begin(), X.end());
+    at_T.insert(at_T.end(), outer_e.begin(), outer_e.end());
+
+    V(args) = select(s == 0, input(X),
+                     select(in_tile, select(interior(u), sum, prev(std::vector<int>(D, 0))), cast(type, 0)));
+    O(out_args) = select(written, V(at_T));
+
+    V.merge_ures(O)
+     .set_bounds(s, 0, T + 1);
+    for (size_t d = 0; d < D; d++) {
+        V.set_bounds(space[d], 0, extents[d]);
+    }
+    return {V, O, r};
+}
+
+#endif
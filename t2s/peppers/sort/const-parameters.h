@@ -0,0 +1,40 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef SORT_CONST_PARAMS_H
+#define SORT_CONST_PARAMS_H
+
+#include <stdint.h>
+
+// The types of the keys and the values, 32 or 64 bits, e.g. -DKEY_TYPE=int64_t -DVALUE_TYPE=double
+#ifndef KEY_TYPE
+    #define KEY_TYPE        float
+#endif
+#ifndef VALUE_TYPE
+    #define VALUE_TYPE      int32_t
+#endif
+
+// The number of keys of a tile sorted by the bitonic network, a power of 2. The network has
+// log2(TILE) * (log2(TILE) + 1) / 2 layers of TILE / 2 compare-exchanges each.
+#ifdef TINY // For verifying correctness only
+    #define TILE            8
+#else
+    #define TILE            64
+#endif
+
+#endif
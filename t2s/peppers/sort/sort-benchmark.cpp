@@ -0,0 +1,61 @@
+#include "sort-pairs.h"
+#include "const-parameters.h"
+#include "Benchmark.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+// Throughput of sort_pairs against std::sort of the same pairs on the host, in millions of keys per second.
+// Both are timed by the wall clock, as the sort includes the copies of the pairs to and from the device.
+int main(int argc, char **argv)
+{
+    int64_t n = (argc > 1) ? atoll(argv[1]) : (int64_t)TILE * 4096;
+    vector<KEY_TYPE> keys(n), k;
+    vector<VALUE_TYPE> values(n), v;
+    vector<pair<KEY_TYPE, VALUE_TYPE>> pairs;
+    for (int64_t x = 0; x < n; x++) {
+        keys[x] = (KEY_TYPE)random();
+        values[x] = (VALUE_TYPE)x;
+    }
+
+    DesignBenchmark device;
+    device.name = "sort";
+    device.number_ops = n;
+    device.number_bytes = n * (sizeof(KEY_TYPE) + sizeof(VALUE_TYPE));
+    device.parameters = {{"n", (double)n}, {"TILE", TILE}, {"key_bytes", sizeof(KEY_TYPE)}, {"value_bytes", sizeof(VALUE_TYPE)}};
+    device.backend = BenchmarkBackend::Emulation;
+    BenchmarkReport device_report = benchmark_design(device, [&]() {
+        k = keys;
+        v = values;
+        return sort_pairs(k.data(), v.data(), n);
+    });
+
+    DesignBenchmark host = device;
+    host.name = "std::sort";
+    BenchmarkReport host_report = benchmark_design(host, [&]() {
+        pairs.clear();
+        for (int64_t x = 0; x < n; x++) {
+            pairs.push_back({keys[x], values[x]});
+        }
+        std::sort(pairs.begin(), pairs.end(),
+                  [](const pair<KEY_TYPE, VALUE_TYPE> &a, const pair<KEY_TYPE, VALUE_TYPE> &b) { return a.first < b.first; });
+        return 0;
+    });
+
+    if (device_report.result != 0) {
+        printf("The sort failed with error %d\n", device_report.result);
+        return 1;
+    }
+    // number_ops / ns is Gkeys/s
+    printf("%-10s n = %lld: %10.2f Mkeys/s (median), %10.2f Mkeys/s (best)\n", "sort", (long long)n,
+           device_report.gflops * 1e3, device_report.best_gflops * 1e3);
+    printf("%-10s n = %lld: %10.2f Mkeys/s (median), %10.2f Mkeys/s (best)\n", "std::sort", (long long)n,
+           host_report.gflops * 1e3, host_report.best_gflops * 1e3);
+    device_report.write_json("sort-benchmark.json");
+    host_report.write_json("std-sort-benchmark.json");
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "sort-interface.h"
+#include "sort-pairs.h"
+#include "HalideBuffer.h"
+#include "StreamingExecution.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+// The device sorts every tile of the input, and the host merges the sorted tiles pairwise, level by level, until
+// one run is left. A 2-way merge consumes its two inputs at rates that depend on the keys, which the static
+// dataflow of UREs cannot express without reading the runs at data-dependent addresses (See README.md).
+
+// Merge the pairs of sorted runs of run keys into runs of 2 * run keys, taking the first run first among equal keys
+static void merge_level(const KEY_TYPE *keys, const VALUE_TYPE *values, KEY_TYPE *merged_keys,
+                        VALUE_TYPE *merged_values, int64_t n, int64_t run) {
+    for (int64_t begin = 0; begin < n; begin += 2 * run) {
+        int64_t a = begin, a_end = min(begin + run, n), b = a_end, b_end = min(begin + 2 * run, n), out = begin;
+        while (a < a_end && b < b_end) {
+            int64_t from = (keys[b] < keys[a]) ? b++ : a++;
+            merged_keys[out] = keys[from];
+            merged_values[out++] = values[from];
+        }
+        copy(keys + a, keys + a_end, merged_keys + out);
+        copy(values + a, values + a_end, merged_values + out);
+        out += a_end - a;
+        copy(keys + b, keys + b_end, merged_keys + out);
+        copy(values + b, values + b_end, merged_values + out);
+    }
+}
+
+int sort_pairs(KEY_TYPE *keys, VALUE_TYPE *values, int64_t n) {
+    assert(n >= 0);
+    if (n <= 1) {
+        return 0;
+    }
+    if ((n + TILE - 1) / TILE > numeric_limits<int>::max()) {
+        return halide_error_code_buffer_extents_too_large;
+    }
+    // Pad the last tile with the max key. The values of the real keys equal to the max key are set aside,
+    // as they could be mixed up with those of the padding.
+    const KEY_TYPE pad = numeric_limits<KEY_TYPE>::has_infinity ? numeric_limits<KEY_TYPE>::infinity()
+                                                                 : numeric_limits<KEY_TYPE>::max();
+    const int tiles = (int)((n + TILE - 1) / TILE);
+    const int64_t N = (int64_t)tiles * TILE;
+    Halide::Runtime::Buffer<KEY_TYPE> k(TILE, tiles), sk(TILE, tiles);
+    Halide::Runtime::Buffer<VALUE_TYPE> v(TILE, tiles), sv(TILE, tiles);
+    vector<VALUE_TYPE> padded_values;
+    for (int64_t x = 0; x < N; x++) {
+        k.data()[x] = (x < n) ? keys[x] : pad;
+        v.data()[x] = (x < n) ? values[x] : VALUE_TYPE();
+        if (x < n && keys[x] == pad) {
+            padded_values.push_back(values[x]);
+        }
+    }
+
+    int result = sort_tiles(k, v, sk, sv);
+    if (result != 0) {
+        return result;
+    }
+    sk.copy_to_host();
+    sv.copy_to_host();
+    release_device(k);
+    release_device(v);
+    release_device(sk);
+    release_device(sv);
+
+    // Merge the sorted tiles, from sk and sv into k and v, and back
+    for (int64_t run = TILE; run < N; run *= 2) {
+        merge_level(sk.data(), sv.data(), k.data(), v.data(), N, run);
+        swap(k, sk);
+        swap(v, sv);
+    }
+
+    copy(sk.data(), sk.data() + n, keys);
+    copy(sv.data(), sv.data() + n, values);
+    copy(padded_values.begin(), padded_values.end(), values + n - padded_values.size());
+    return 0;
+}
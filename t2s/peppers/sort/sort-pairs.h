@@ -0,0 +1,12 @@
+#ifndef sort_pairs_h
+#define sort_pairs_h
+
+#include <stdint.h>
+#include "const-parameters.h"
+
+// Sort n keys in ascending order, and move their values with them. The order of the values of equal keys
+// is unspecified. The device sorts tiles of TILE keys, and the host merges them. Returns 0,
+// halide_error_code_buffer_extents_too_large if there are more than INT_MAX tiles, or the error of the device.
+int sort_pairs(KEY_TYPE *keys, VALUE_TYPE *values, int64_t n);
+
+#endif
@@ -0,0 +1,84 @@
+#include "sort-pairs.h"
+#include "sort-interface.h"
+#include "const-parameters.h"
+#include "HalideBuffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <iostream>
+#include <assert.h>
+
+using namespace std;
+
+// Sort n random pairs, where the value of a key is derived from the key and its position, and check that the
+// keys are sorted and every value is still with its key.
+void test(int64_t n, int distinct_keys)
+{
+    vector<KEY_TYPE> keys(n);
+    vector<VALUE_TYPE> values(n);
+    for (int64_t x = 0; x < n; x++) {
+        keys[x] = (KEY_TYPE)(random() % distinct_keys) - (KEY_TYPE)(distinct_keys / 2);
+        if (x % 97 == 0) {
+            keys[x] = numeric_limits<KEY_TYPE>::has_infinity ? numeric_limits<KEY_TYPE>::infinity()
+                                                              : numeric_limits<KEY_TYPE>::max();
+        }
+        values[x] = (VALUE_TYPE)x;
+    }
+    vector<KEY_TYPE> original = keys;
+
+    int result = sort_pairs(keys.data(), values.data(), n);
+    assert(result == 0);
+
+    vector<bool> seen(n, false);
+    for (int64_t x = 0; x < n; x++) {
+        assert(x == 0 || keys[x - 1] <= keys[x]);
+        int64_t from = (int64_t)values[x];
+        assert(from >= 0 && from < n && !seen[from] && original[from] == keys[x]);
+        seen[from] = true;
+    }
+}
+
+// Sort the tiles of random pairs with one invocation of the design, and check every tile. With fewer tiles than
+// the layers of the network, the loaders run more iterations before the first tile than on any tile.
+void test_tiles(int tiles)
+{
+    Halide::Runtime::Buffer<KEY_TYPE> k(TILE, tiles), sk(TILE, tiles);
+    Halide::Runtime::Buffer<VALUE_TYPE> v(TILE, tiles), sv(TILE, tiles);
+    for (int t = 0; t < tiles; t++) {
+        for (int i = 0; i < TILE; i++) {
+            k(i, t) = (KEY_TYPE)(random() % 1000);
+            v(i, t) = (VALUE_TYPE)i;
+        }
+    }
+    int result = sort_tiles(k, v, sk, sv);
+    assert(result == 0);
+    sk.copy_to_host();
+    sv.copy_to_host();
+    for (int t = 0; t < tiles; t++) {
+        vector<bool> seen(TILE, false);
+        for (int i = 0; i < TILE; i++) {
+            assert(i == 0 || sk(i - 1, t) <= sk(i, t));
+            int from = (int)sv(i, t);
+            assert(from >= 0 && from < TILE && !seen[from] && k(from, t) == sk(i, t));
+            seen[from] = true;
+        }
+    }
+}
+
+int main()
+{
+    for (int tiles : {1, 2, 5}) {
+        test_tiles(tiles);
+    }
+    for (int64_t n : {1, 2, TILE - 1, TILE, TILE + 1, TILE * 5 + 3, TILE * 64}) {
+        test(n, 1000);
+    }
+    // Many equal keys
+    test(TILE * 17 + 5, 3);
+
+    printf("Success\n");
+    return 0;
+}
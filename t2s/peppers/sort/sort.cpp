@@ -0,0 +1,71 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Sorting of tiles of TILE keys and their values by a bitonic network pipelined over the tiles (See
+// t2s/peppers/primitives/bitonic.h). The network has TILE lanes, and takes a new tile every cycle.
+//
+// The input is K(i, t) and V(i, t), the key and the value at position i of tile t. The output is the
+// keys and the values of every tile in ascending order of the keys, in the same layout. The sorted tiles
+// are merged on the host (See sort-pairs.cpp).
+//
+// Compile and generate the bitstream and the interface (sort-interface.h/cpp):
+//    g++ sort.cpp -g -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin -lHalide -lz -lpthread -ldl -std=c++11 -DTILE=64
+//    env BITSTREAM=sort.aocx AOC_OPTION="$EMULATOR_AOC_OPTION -board=$FPGA_BOARD -emulator-channel-depth-model=strict" ./a.out
+#include "Halide.h"
+#include "../primitives/bitonic.h"
+
+// Constant parameters of the design
+#include "const-parameters.h"
+
+using namespace Halide;
+
+int main(void) {
+    ImageParam K(type_of<KEY_TYPE>(), 2), V(type_of<VALUE_TYPE>(), 2);
+    #define TILES K.dim(1).extent()
+
+    Var i, t;
+    SortUREs s = bitonic_sort_ures(i, t, TILE, TILES,
+                                   [&](Expr i, Expr t) { return K(i, t); },
+                                   [&](Expr i, Expr t) { return V(i, t); });
+    const int S = s.latency;
+    s.head.space_time_transform(i);
+
+    // The loaders stream the next tiles into the first layer. Iteration t reads tile t + S.
+    Func kloader(Place::Device), vloader(Place::Device);
+    s.head.isolate_producer_chain(K, kloader);
+    s.head.isolate_producer_chain(V, vloader);
+    kloader.set_bounds(t, -S, TILES);
+    vloader.set_bounds(t, -S, TILES);
+    kloader.min_depth(256);
+    vloader.min_depth(256);
+
+    // The last layer sends tile t out at iteration t
+    Func kunloader(Place::Device), vunloader(Place::Device);
+    s.keys.isolate_consumer_chain(kunloader);
+    s.values.isolate_consumer_chain(vunloader);
+    kunloader.set_bounds(t, 0, TILES, i, 0, TILE);
+    vunloader.set_bounds(t, 0, TILES, i, 0, TILE);
+    kunloader.min_depth(256);
+    vunloader.min_depth(256);
+
+    Target target = get_host_target();
+    target.set_feature(Target::IntelFPGA);
+    Pipeline({kunloader, vunloader}).compile_to_host("sort-interface", { K, V }, "sort_tiles", target);
+    printf("Success\n");
+    return 0;
+}
@@ -18,6 +18,9 @@
 *******************************************************************************/
 #include "AOT-OpenCL-Runtime.h"
 #include "SharedUtilsInC.h"
+#include "DeviceProfile.h"
+#include <map>
+#include <mutex>
 
 #define WEAK __attribute__((weak))
 #define ACL_ALIGNMENT 64
@@ -25,14 +28,28 @@
 extern int MAX_DEVICES;
 extern int NUM_QUEUES_TO_CREATE;
 extern int NUM_KERNELS_TO_CREATE;
-extern cl_int status;
+extern thread_local cl_int status;
 extern cl_context context;
-extern cl_command_queue cmdQueue[]; // extra queue for reading buffer D
+extern cl_command_queue cmdQueue[]; // For every device, a queue per kernel and an extra queue for reading buffer D
 extern cl_device_id devices[];
-extern int current_kernel;
-extern cl_kernel kernel[];
+extern thread_local int current_device;
+extern thread_local int current_kernel;
+extern cl_kernel kernel[];          // For every device, a copy of every kernel
 extern const char *kernel_name[];
 
+// Number of devices sharing the context. The same bitstream is programmed into all of them.
+static int num_devices = 0;
+static std::mutex init_mutex;
+
+// The i-th queue and kernel of the device the calling thread runs on
+static cl_command_queue &queue_of(int i) {
+    return cmdQueue[current_device * (NUM_QUEUES_TO_CREATE + 1) + i];
+}
+
+static cl_kernel &kernel_of(int i) {
+    return kernel[current_device * NUM_KERNELS_TO_CREATE + i];
+}
+
 using namespace aocl_utils;
 
 void cleanup() {
@@ -49,6 +66,48 @@ void acl_aligned_free (void *ptr) {
     free (ptr);
 }
 
+// The counters of a kernel compiled with Target::ProfileDevice, which the kernel writes when it finishes
+struct ProfiledKernel {
+    std::string pipeline, kernel;
+    std::vector<DeviceProfileCounter> counters;
+    device_handle handle;
+    halide_buffer_t buffer;
+};
+
+// (device, kernel index) -> counters. The same kernel on every device has its own counters.
+static std::map<std::pair<int, int>, ProfiledKernel> profiled_kernels;
+static std::mutex profile_mutex;
+
+DeviceProfile &t2s_device_profile() {
+    static DeviceProfile profile;
+    return profile;
+}
+
+// When the program exits, print the profile, and write it and its trace into the bitstream directory
+static void report_device_profile() {
+    std::lock_guard<std::mutex> guard(profile_mutex);
+    DeviceProfile &profile = t2s_device_profile();
+    if (profile.empty()) {
+        return;
+    }
+    std::string report = profile.report();
+    printf("%s", report.c_str());
+    char *bitstream_dir = bitstream_directory();
+    char *report_file = concat_directory_and_file(bitstream_dir, "device_profile.txt");
+    char *trace_file = concat_directory_and_file(bitstream_dir, "device_trace.json");
+    FILE *fp = fopen(report_file, "w");
+    if (fp != NULL) {
+        fprintf(fp, "%s", report.c_str());
+        fclose(fp);
+    }
+    if (!profile.write_chrome_trace(trace_file)) {
+        DPRINTF("Failed to open %s for writing.\n", trace_file);
+    }
+    free(bitstream_dir);
+    free(report_file);
+    free(trace_file);
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -88,10 +147,12 @@ WEAK int halide_device_malloc(void *user_context, struct halide_buffer_t *buf,
         }
     }
     uint64_t total_bytes = (highest_index + 1  - lowest_index) * buf->type.bytes();
-    if (total_bytes > (static_cast<uint64_t>(1) << 32) - 1) {
+    if (total_bytes > device_buffer_size_limit()) {
         std::cout << "CL: halide_opencl_device_malloc failed: "
-                  << total_bytes << " bytes are requested to allocate on the device. The size exceeds 2^32 - 1.\n";
-        assert(false);
+                  << total_bytes << " bytes are requested to allocate on the device. The size exceeds "
+                  << device_buffer_size_limit() << " bytes. Consider streaming the operands "
+                  << "through the device in chunks (See StreamingExecution.h).\n";
+        return halide_error_code_device_malloc_failed;
     }
 
     if (buf->device) {
@@ -116,161 +177,229 @@ WEAK int halide_device_malloc(void *user_context, struct halide_buffer_t *buf,
     return 0;
 }
 
-WEAK int32_t halide_device_and_host_malloc(void *user_context, struct halide_buffer_t *buf,
-                                       const halide_device_interface_t *device_interface) {
-    size_t size = buf->size_in_bytes();
-    assert(size != 0);
-    buf->host = (uint8_t *)halide_malloc(user_context, size);
-    if (buf->host == NULL) {
-        return CL_OUT_OF_HOST_MEMORY;
+/** Free the device memory of a buffer, and keep its host memory. */
+WEAK int halide_device_free(void *user_context, struct halide_buffer_t *buf) {
+    if (buf->device == 0) {
+        return 0;
     }
+    cl_mem dev_ptr = ((device_handle *)buf->device)->mem;
+    assert(((device_handle *)buf->device)->offset == 0);
+    cl_int result = clReleaseMemObject(dev_ptr);
+    free((device_handle *)buf->device);
+    buf->device = 0;
+    buf->set_device_dirty(false);
+    return result;
+}
 
-    if (context == NULL) {
-        cl_uint numPlatforms = 0;
-        cl_platform_id platform;
+/** Create the context, queues and kernels for all the devices of the platform, if not yet. */
+WEAK int halide_opencl_init_devices(void *user_context) {
+    std::lock_guard<std::mutex> guard(init_mutex);
+    if (num_devices > 0) {
+        return 0;
+    }
 
-        const char *name = getenv("INTEL_FPGA_OCL_PLATFORM_NAME");
-        platform = findPlatform(name);
-        if(platform == NULL) {
-            DPRINTF("ERROR: Unable to find Intel(R) FPGA OpenCL platform\n");
-            return -1;
-        }
+    cl_uint numPlatforms = 0;
+    cl_platform_id platform;
 
-        cl_uint numDevices = 0;
-        cl_device_id *devices = NULL;
-        // Device info
-        char buffer[4096];
-        unsigned int buf_uint;
-        int device_found = 0;
-
-        printf("Initializing IDs\n");
-        status = clGetDeviceIDs(platform,
-                        CL_DEVICE_TYPE_ALL,
-                        0,
-                        NULL,
-                        &numDevices);
-
-        if(status == CL_SUCCESS){
-            clGetPlatformInfo(platform,
-                            CL_PLATFORM_VENDOR,
-                            4096,
-                            buffer,
-                            NULL);
+    // While the bitstream is compiled in the background, run the emulator bitstream, if any, instead.
+    use_emulator_while_bitstream_pending();
+    const char *name = getenv("INTEL_FPGA_OCL_PLATFORM_NAME");
+    platform = findPlatform(name);
+    if(platform == NULL) {
+        DPRINTF("ERROR: Unable to find Intel(R) FPGA OpenCL platform\n");
+        return -1;
+    }
 
-            if(strstr(buffer, "Intel(R)") != NULL){
-                    device_found = 1;
-            }
-            printf("%s\n", buffer);
-
-            if(device_found){
-                // Allocate enough space for each device
-                devices = (cl_device_id*)
-                acl_aligned_malloc (numDevices * sizeof(cl_device_id));
-
-                // Fill in devices with clGetDeviceIDs()
-                status = clGetDeviceIDs(platform,
-                                CL_DEVICE_TYPE_ALL,
-                                numDevices,
-                                devices,
-                                NULL);
-            }
+    cl_uint numDevices = 0;
+    cl_device_id *devices = NULL;
+    // Device info
+    char buffer[4096];
+    unsigned int buf_uint;
+    int device_found = 0;
+
+    printf("Initializing IDs\n");
+    status = clGetDeviceIDs(platform,
+                    CL_DEVICE_TYPE_ALL,
+                    0,
+                    NULL,
+                    &numDevices);
+
+    if(status == CL_SUCCESS){
+        clGetPlatformInfo(platform,
+                        CL_PLATFORM_VENDOR,
+                        4096,
+                        buffer,
+                        NULL);
+
+        if(strstr(buffer, "Intel(R)") != NULL){
+                device_found = 1;
         }
-
-        if (!device_found) {
-            DPRINTF("failed to find a OpenCL device\n");
-            exit(-1);
+        printf("%s\n", buffer);
+
+        if(device_found){
+            // Allocate enough space for each device
+            devices = (cl_device_id*)
+            acl_aligned_malloc (numDevices * sizeof(cl_device_id));
+
+            // Fill in devices with clGetDeviceIDs()
+            status = clGetDeviceIDs(platform,
+                            CL_DEVICE_TYPE_ALL,
+                            numDevices,
+                            devices,
+                            NULL);
         }
+    }
 
-        DPRINTF("Total number of devices: %d\n", numDevices);
+    if (!device_found) {
+        DPRINTF("failed to find a OpenCL device\n");
+        exit(-1);
+    }
 
-        context = clCreateContext(
-            NULL,
-            1,
-            devices,
-            NULL,
-            NULL,
-            &status);
-        CHECK(status);
+    DPRINTF("Total number of devices: %d\n", numDevices);
+    if (numDevices > (cl_uint)MAX_DEVICES) {
+        DPRINTF("Using the first %d devices\n", MAX_DEVICES);
+        numDevices = MAX_DEVICES;
+    }
+    for (cl_uint d = 0; d < numDevices; d++) {
+        ::devices[d] = devices[d];
+    }
 
-        // Create a command queue using clCreateCommandQueue(),
-        // and associate it with the device you want to execute on
+    context = clCreateContext(
+        NULL,
+        numDevices,
+        devices,
+        NULL,
+        NULL,
+        &status);
+    CHECK(status);
+
+    // Create a command queue using clCreateCommandQueue(),
+    // and associate it with the device you want to execute on
+    for (cl_uint d = 0; d < numDevices; d++) {
         for (int i = 0; i < NUM_QUEUES_TO_CREATE; i++) {
             //fDPRINTF(stdout,"cmdQueue i = %d\n", i);
-            cmdQueue[i] = clCreateCommandQueue(
+            cmdQueue[d * (NUM_QUEUES_TO_CREATE + 1) + i] = clCreateCommandQueue(
                 context,
-                devices[0],
+                devices[d],
                 CL_QUEUE_PROFILING_ENABLE,
                 &status);
             CHECK(status);
         }
 
         //fDPRINTF(stdout,"cmdQueue i = %d, a queue for reading the C buffer\n", i);
-        cmdQueue[NUM_QUEUES_TO_CREATE] = clCreateCommandQueue(
+        cmdQueue[d * (NUM_QUEUES_TO_CREATE + 1) + NUM_QUEUES_TO_CREATE] = clCreateCommandQueue(
             context,
-            devices[0],
+            devices[d],
             CL_QUEUE_PROFILING_ENABLE,
             &status);
         CHECK(status);
+    }
 
-        DPRINTF("\n===== Host-CPU setting up OpenCL program and kernels ======\n\n");
+    DPRINTF("\n===== Host-CPU setting up OpenCL program and kernels ======\n\n");
 
-        cl_program program;
+    cl_program program;
 
-        size_t binary_length;
-        const unsigned char *binary;
+    size_t binary_length;
+    const unsigned char *binary;
 
-        fflush(stdout);
-        // create the program using binary already compiled offline using aoc (i.e. the .aocx file)
-        char *aocx_file = getenv("BITSTREAM");
-        FILE *fp = fopen(aocx_file, "rb");
+    fflush(stdout);
+    // create the program using binary already compiled offline using aoc (i.e. the .aocx file)
+    char *aocx_file = getenv("BITSTREAM");
+    FILE *fp = fopen(aocx_file, "rb");
 
-        if (fp == NULL) {
-            DPRINTF("Failed to open the AOCX file (fopen).\n");
-            return -1;
-        }
+    if (fp == NULL) {
+        DPRINTF("Failed to open the AOCX file (fopen).\n");
+        return -1;
+    }
 
-        fseek(fp, 0, SEEK_END);
-        binary_length = ftell(fp);
-        binary = (unsigned char *)malloc(sizeof(unsigned char) * binary_length);
-        assert(binary && "Malloc failed");
-        rewind(fp);
+    fseek(fp, 0, SEEK_END);
+    binary_length = ftell(fp);
+    binary = (unsigned char *)malloc(sizeof(unsigned char) * binary_length);
+    assert(binary && "Malloc failed");
+    rewind(fp);
 
-        if (fread((void *)binary, binary_length, 1, fp) == 0) {
-            DPRINTF("Failed to read from the AOCX file (fread).\n");
-            return -1;
-        }
-        fclose(fp);
+    if (fread((void *)binary, binary_length, 1, fp) == 0) {
+        DPRINTF("Failed to read from the AOCX file (fread).\n");
+        return -1;
+    }
+    fclose(fp);
 
-        DPRINTF("Create program with binary\n");
-        // Create a program using clCreateProgramWithBinary()
-        program = clCreateProgramWithBinary(
-            context,
-            1,
-            devices,
-            &binary_length,
-            (const unsigned char **)&binary,
-            &status,
-            NULL);
-        CHECK(status);
+    DPRINTF("Create program with binary\n");
+    // Create a program using clCreateProgramWithBinary(), with the same binary for every device
+    size_t binary_lengths[numDevices];
+    const unsigned char *binaries[numDevices];
+    for (cl_uint d = 0; d < numDevices; d++) {
+        binary_lengths[d] = binary_length;
+        binaries[d] = binary;
+    }
+    program = clCreateProgramWithBinary(
+        context,
+        numDevices,
+        devices,
+        binary_lengths,
+        binaries,
+        &status,
+        NULL);
+    CHECK(status);
 
-        //----------------------------------------------
-        // Create the kernel
-        //----------------------------------------------
+    //----------------------------------------------
+    // Create the kernel
+    //----------------------------------------------
 
-        status = clBuildProgram(program, 0, NULL, NULL, NULL, NULL);
-        if (status != CL_SUCCESS) {
-            char log[128 * 1024] = {0};
-            clGetProgramBuildInfo(program, devices[0], CL_PROGRAM_BUILD_LOG, 128 * 1024, log, NULL);
-            DPRINTF("%s\n", log);
-            CHECK(status);
-        }
+    status = clBuildProgram(program, 0, NULL, NULL, NULL, NULL);
+    if (status != CL_SUCCESS) {
+        char log[128 * 1024] = {0};
+        clGetProgramBuildInfo(program, devices[0], CL_PROGRAM_BUILD_LOG, 128 * 1024, log, NULL);
+        DPRINTF("%s\n", log);
+        CHECK(status);
+    }
 
+    // Every device has its own kernel objects, so that the kernel arguments of different devices can
+    // be set concurrently.
+    for (cl_uint d = 0; d < numDevices; d++) {
         for (int j = 0; j < NUM_KERNELS_TO_CREATE; j++) {
             DPRINTF("Creating kernel[%d]: %s\n", j, kernel_name[j]);
-            kernel[j] = clCreateKernel(program, (const char *)kernel_name[j], &status);
+            kernel[d * NUM_KERNELS_TO_CREATE + j] = clCreateKernel(program, (const char *)kernel_name[j], &status);
             CHECK(status);
         }
-        DPRINTF("All kernels created\n");
+    }
+    DPRINTF("All kernels created\n");
+    num_devices = numDevices;
+    return 0;
+}
+
+/** Number of devices that designs can run on. */
+WEAK int halide_opencl_get_device_count(void *user_context) {
+    int result = halide_opencl_init_devices(user_context);
+    return result == 0 ? num_devices : 0;
+}
+
+/** Run the subsequent invocations of designs from the calling thread on the given device. */
+WEAK int halide_opencl_set_device(void *user_context, int device) {
+    int result = halide_opencl_init_devices(user_context);
+    if (result != 0) {
+        return result;
+    }
+    if (device < 0 || device >= num_devices) {
+        std::cout << "Device " << device << " does not exist. There are " << num_devices << " devices.\n";
+        return halide_error_code_generic_error;
+    }
+    current_device = device;
+    return 0;
+}
+
+WEAK int32_t halide_device_and_host_malloc(void *user_context, struct halide_buffer_t *buf,
+                                       const halide_device_interface_t *device_interface) {
+    size_t size = buf->size_in_bytes();
+    assert(size != 0);
+    buf->host = (uint8_t *)halide_malloc(user_context, size);
+    if (buf->host == NULL) {
+        return CL_OUT_OF_HOST_MEMORY;
+    }
+
+    int result = halide_opencl_init_devices(user_context);
+    if (result != 0) {
+        return result;
     }
 
     return halide_device_malloc(user_context, buf, device_interface);
@@ -309,6 +438,104 @@ double compute_kernel_execution_time(cl_event &event, double &start_d, double &e
     return (double)(end-start);
 }
 
+// The state of Halide's profiler, if the design has been compiled with Target::Profile as well
+#pragma weak halide_profiler_get_state
+#pragma weak halide_mutex_lock
+#pragma weak halide_mutex_unlock
+
+// Add the time of the kernels of a pipeline to the report of Halide's profiler, as a pipeline named
+// "<pipeline> (device)" with a func per kernel
+static void merge_into_halide_profiler(const std::string &pipeline, const std::vector<const ProfiledKernel *> &kernels,
+                                       const std::vector<double> &times, double pipeline_time) {
+    if (halide_profiler_get_state == NULL || halide_mutex_lock == NULL || halide_mutex_unlock == NULL) {
+        return;
+    }
+    struct halide_profiler_state *s = halide_profiler_get_state();
+    std::string name = pipeline + " (device)";
+    halide_mutex_lock(&s->lock);
+    struct halide_profiler_pipeline_stats *p = s->pipelines;
+    while (p != NULL && name != p->name) {
+        p = (struct halide_profiler_pipeline_stats *)p->next;
+    }
+    if (p == NULL) {
+        // Halide's profiler frees the stats when reset, so they are allocated with malloc
+        p = (struct halide_profiler_pipeline_stats *)calloc(1, sizeof(struct halide_profiler_pipeline_stats));
+        p->name = strdup(name.c_str());
+        // The first func is the overhead, which the profiler reports only if it is not empty
+        p->num_funcs = (int)kernels.size() + 1;
+        p->funcs = (struct halide_profiler_func_stats *)calloc(p->num_funcs, sizeof(struct halide_profiler_func_stats));
+        p->funcs[0].name = "overhead";
+        for (size_t i = 0; i < kernels.size(); i++) {
+            p->funcs[i + 1].name = strdup(kernels[i]->kernel.c_str());
+        }
+        p->first_func_id = s->first_free_id;
+        s->first_free_id += p->num_funcs;
+        p->next = s->pipelines;
+        s->pipelines = p;
+    }
+    for (size_t i = 0; i < kernels.size() && i + 1 < (size_t)p->num_funcs; i++) {
+        p->funcs[i + 1].time += (uint64_t)times[i];
+    }
+    p->time += (uint64_t)pipeline_time;
+    p->runs++;
+    halide_mutex_unlock(&s->lock);
+}
+
+// Read the counters of the profiled kernels of the current device after an invocation of the design, and record
+// them with the start and end of the kernels
+static void record_device_profile(const double *start, const double *end) {
+    std::lock_guard<std::mutex> guard(profile_mutex);
+    std::map<std::string, std::vector<const ProfiledKernel *>> kernels_of_pipeline;
+    std::map<std::string, std::vector<double>> times_of_pipeline;
+    std::map<std::string, std::pair<double, double>> span_of_pipeline;
+    for (auto &entry : profiled_kernels) {
+        if (entry.first.first != current_device) {
+            continue;
+        }
+        int i = entry.first.second;
+        const ProfiledKernel &k = entry.second;
+        std::vector<uint64_t> values(k.counters.size());
+        status = clEnqueueReadBuffer(queue_of(i), k.handle.mem, CL_TRUE, 0, values.size() * sizeof(uint64_t),
+                                     values.data(), 0, NULL, NULL);
+        CHECK(status);
+        t2s_device_profile().record(k.pipeline, k.kernel, current_device, k.counters, values, start[i], end[i]);
+
+        kernels_of_pipeline[k.pipeline].push_back(&k);
+        times_of_pipeline[k.pipeline].push_back(end[i] - start[i]);
+        auto span = span_of_pipeline.find(k.pipeline);
+        if (span == span_of_pipeline.end()) {
+            span_of_pipeline[k.pipeline] = std::make_pair(start[i], end[i]);
+        } else {
+            span->second.first = std::min(span->second.first, start[i]);
+            span->second.second = std::max(span->second.second, end[i]);
+        }
+    }
+    for (auto &p : kernels_of_pipeline) {
+        auto &span = span_of_pipeline[p.first];
+        merge_into_halide_profiler(p.first, p.second, times_of_pipeline[p.first], span.second - span.first);
+    }
+}
+
+WEAK halide_buffer_t *halide_t2s_device_profile(const char *pipeline, const char *kernel, const char *counters) {
+    std::lock_guard<std::mutex> guard(profile_mutex);
+    if (profiled_kernels.empty()) {
+        atexit(report_device_profile);
+    }
+    ProfiledKernel &k = profiled_kernels[std::make_pair(current_device, current_kernel)];
+    if (k.counters.empty()) {
+        k.pipeline = pipeline;
+        k.kernel = kernel;
+        k.counters = parse_device_profile_counters(counters);
+        k.handle.offset = 0;
+        k.handle.mem = clCreateBuffer(context, CL_MEM_READ_WRITE, k.counters.size() * sizeof(uint64_t), NULL, &status);
+        CHECK(status);
+        memset(&k.buffer, 0, sizeof(k.buffer));
+        k.buffer.device = (uint64_t)&k.handle;
+        k.buffer.device_interface = halide_opencl_device_interface();
+    }
+    return &k.buffer;
+}
+
 WEAK int32_t halide_opencl_wait_for_kernels_finish(void *user_context) {
     // Define the number of threads that will be created
     // as well as the number of work groups
@@ -330,8 +557,8 @@ WEAK int32_t halide_opencl_wait_for_kernels_finish(void *user_context) {
         // Alternatively, can use clEnqueueTaskKernel
         DPRINTF("clEnqueueNDRangeKernel[%d]: %s!\n", i, kernel_name[i]);
         status = clEnqueueNDRangeKernel(
-            cmdQueue[i],
-            kernel[i],
+            queue_of(i),
+            kernel_of(i),
             1,
             NULL,
             globalWorkSize,
@@ -344,16 +571,18 @@ WEAK int32_t halide_opencl_wait_for_kernels_finish(void *user_context) {
     DPRINTF("\n");
     DPRINTF(" *** FPGA execution started!\n");
     for (int i = 0; i < NUM_KERNELS_TO_CREATE; i++) {
-        status = clFlush(cmdQueue[i]);
+        status = clFlush(queue_of(i));
         CHECK(status);
     }
 
     for (int i = 0; i < NUM_QUEUES_TO_CREATE; i++) {
         DPRINTF("cmd queue: %d\n", i);
         fflush(stdout);
-        status = clFinish(cmdQueue[i]);
+        status = clFinish(queue_of(i));
         CHECK(status);
     }
+    // Ready for the next invocation of the design
+    current_kernel = 0;
     DPRINTF(" *** FPGA execution finished!\n");
     DPRINTF("\n");
 
@@ -377,8 +606,15 @@ WEAK int32_t halide_opencl_wait_for_kernels_finish(void *user_context) {
 
     double k_overall_exec_time = k_latest_end_time - k_earliest_start_time;
 
+    if (!profiled_kernels.empty()) {
+        record_device_profile(k_start_time, k_end_time);
+    }
+
     char *bitstream_dir = bitstream_directory();
     char *exec_time_file = concat_directory_and_file(bitstream_dir, "exec_time.txt");
+    // Designs running on different devices share the file
+    static std::mutex exec_time_mutex;
+    std::lock_guard<std::mutex> guard(exec_time_mutex);
     FILE *fp = fopen(exec_time_file, "w");
     if (fp == NULL) {
         DPRINTF("Failed to open %s for writing.\n", exec_time_file);
@@ -405,19 +641,19 @@ WEAK int halide_opencl_buffer_copy(void *user_context, struct halide_buffer_t *s
                      (src->host_dirty() && src->host != NULL);
     if (!from_host && to_host) {
         std::cout << "Command queue " << current_kernel << ": copying " << src->size_in_bytes() << " bytes data from device to host. ";
-        status = clEnqueueReadBuffer(cmdQueue[current_kernel], ((device_handle *)src->device)->mem,
+        status = clEnqueueReadBuffer(queue_of(current_kernel), ((device_handle *)src->device)->mem,
                                      CL_TRUE, 0, src->size_in_bytes(), (void *)(dst->host),
                                      0, NULL, NULL);
         std::cout << "Done.\n";
     } else if (from_host && !to_host) {
         std::cout << "Command queue " << current_kernel << ": copying " << src->size_in_bytes() << " bytes data from host to device. ";
-        status = clEnqueueWriteBuffer(cmdQueue[current_kernel], ((device_handle *)dst->device)->mem,
+        status = clEnqueueWriteBuffer(queue_of(current_kernel), ((device_handle *)dst->device)->mem,
                                       CL_TRUE, 0, src->size_in_bytes(), (void *)(src->host),
                                       0, NULL, NULL);
         std::cout << "Done.\n";
     } else if (!from_host && !to_host) {
         std::cout << "Command queue " << current_kernel << ": copying " << src->size_in_bytes() << " bytes data from device to device. ";
-        status = clEnqueueCopyBuffer(cmdQueue[current_kernel], ((device_handle *)src->device)->mem, ((device_handle *)dst->device)->mem,
+        status = clEnqueueCopyBuffer(queue_of(current_kernel), ((device_handle *)src->device)->mem, ((device_handle *)dst->device)->mem,
                                      0, 0,
                                      src->size_in_bytes(), 0, NULL, NULL);
         std::cout << "Done.\n";
@@ -1491,6 +1491,7 @@ typedef enum halide_target_feature_t {
     halide_target_feature_intel_fpga, ///< Enable Intel FPGAs
     halide_target_feature_intel_gpu, ///< Enable Intel Graphics
     halide_target_feature_enable_synthesis, ///< Enable synthesizing binaries. Currently used only for Intel FPGAs.
+    halide_target_feature_profile_device, ///< Count loop iterations and channel stalls in the kernels of Intel FPGAs.
     halide_target_feature_end ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
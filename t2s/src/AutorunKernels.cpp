@@ -44,6 +44,7 @@ class FindNonAutorunnableFuncs: public IRVisitor {
     vector<string> producer_stack;
     bool in_device_func;
     Scope<> ignore;
+    vector<string> host_lets;       // The host variables defined around the current point
 
 public:
     FindNonAutorunnableFuncs(const map<string, Function> &_env) :
@@ -57,6 +58,12 @@ public:
     map<string, set<string>> func2ExternalAllocations;
     map<string, set<string>> func2CallsWithSideEffects;
 
+    // For sending the external variables of a func through channels instead
+    map<string, map<string, Type>> func2ExternalVarTypes;
+    vector<string> device_funcs;                    // In the order of their kernels
+    set<string> host_defined_vars;                  // The variables defined by the host code anywhere
+    map<string, set<string>> func2VisibleHostVars;  // The host variables defined around a func
+
 private:
     void visit(const ProducerConsumer *op) override {
         if (!op->is_producer) {
@@ -77,6 +84,10 @@ private:
         } else {
             bool old = in_device_func;
             in_device_func = true;
+            if (std::find(device_funcs.begin(), device_funcs.end(), func_name) == device_funcs.end()) {
+                device_funcs.push_back(func_name);
+            }
+            func2VisibleHostVars[func_name].insert(host_lets.begin(), host_lets.end());
 
             producer_stack.push_back(func_name);
             op->body.accept(this);
@@ -95,6 +106,7 @@ private:
                 for (string func_name : producer_stack) {
                     non_autorunnable_funcs.emplace(func_name);
                     func2ExternalVars[func_name].emplace(op->name);
+                    func2ExternalVarTypes[func_name][op->name] = op->type;
                 }
             }
         }
@@ -116,7 +128,10 @@ private:
             ScopedBinding<> p(ignore, op->name);
             op->body.accept(this);
         } else {
+            host_defined_vars.insert(op->name);
+            host_lets.push_back(op->name);
             op->body.accept(this);
+            host_lets.pop_back();
         }
     }
 
@@ -141,6 +156,7 @@ private:
             ScopedBinding<> p(ignore, op->name);
             op->body.accept(this);
         } else {
+            host_defined_vars.insert(op->name);
             op->body.accept(this);
         }
     }
@@ -161,15 +177,121 @@ private:
     }
 };
 
+// The name of the channel sending a control variable to a func, and of the register keeping it in the func
+string control_channel(const string &func_name, const string &var) {
+    return func_name + "." + var + ".ctrl.channel";
+}
+
+string control_register(const string &func_name, const string &var) {
+    return func_name + "." + var + ".ctrl.temp";
+}
+
+// Can a kernel receive its control variables at the start of every run? The kernel must be a serial loop,
+// optionally under some lets and realizations that do not use the variables, so that reading the variables
+// at the start of an iteration of the loop is before any use of them.
+class CanReceiveControls: public IRVisitor {
+    using IRVisitor::visit;
+    const map<string, Type> &vars;
+    bool uses_vars = false;
+
+    void visit(const Variable *op) override {
+        uses_vars |= (vars.find(op->name) != vars.end());
+    }
+
+public:
+    CanReceiveControls(const map<string, Type> &vars) : vars(vars) {}
+
+    bool check(const For *kernel) {
+        Stmt s = kernel->body;
+        while (true) {
+            if (const LetStmt *let = s.as<LetStmt>()) {
+                let->value.accept(this);
+                s = let->body;
+            } else if (const Realize *realize = s.as<Realize>()) {
+                for (auto &b : realize->bounds) {
+                    b.min.accept(this);
+                    b.extent.accept(this);
+                }
+                s = realize->body;
+            } else {
+                break;
+            }
+        }
+        const For *loop = s.as<For>();
+        return !uses_vars && loop != nullptr && loop->for_type == ForType::Serial && !ends_with(loop->name, ".infinite");
+    }
+};
+
+// Find the kernel of a func
+class FindKernel: public IRVisitor {
+    using IRVisitor::visit;
+    const string &func_name;
+    bool in_func = false;
+
+public:
+    const For *kernel = nullptr;
+
+    FindKernel(const string &func_name) : func_name(func_name) {}
+
+    void visit(const ProducerConsumer *op) override {
+        if (op->is_producer && extract_first_token(op->name) == func_name) {
+            in_func = true;
+            op->body.accept(this);
+            in_func = false;
+            return;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const For *op) override {
+        if (in_func && kernel == nullptr && ends_with(op->name, ".run_on_device")) {
+            kernel = op;
+            return;
+        }
+        IRVisitor::visit(op);
+    }
+};
+
 class AutorunFuncs: public IRMutator {
     using IRMutator::visit;
     const map<string, Function> &env;
     const map<string, string> &non_autorunnable_funcs_and_why;
+    const map<string, map<string, Type>> &controls;    // Func -> the variables it receives through channels
+    const string &broadcaster;                          // The func sending the variables
+    string current_func;
+
+    // Prepend the broadcaster's kernel with writing every control variable into the channel of every receiver
+    class BroadcastControls: public IRMutator {
+        using IRMutator::visit;
+        const map<string, map<string, Type>> &controls;
+
+    public:
+        BroadcastControls(const map<string, map<string, Type>> &controls) : controls(controls) {}
+
+        Stmt visit(const For *op) override {
+            if (!ends_with(op->name, ".run_on_device")) {
+                return IRMutator::visit(op);
+            }
+            vector<Stmt> writes;
+            for (auto &c : controls) {
+                for (auto &v : c.second) {
+                    Expr value = Variable::make(v.second, v.first);
+                    writes.push_back(Evaluate::make(Call::make(v.second, Call::write_channel,
+                                                               {StringImm::make(control_channel(c.first, v.first)), value},
+                                                               Call::Intrinsic)));
+                }
+            }
+            writes.push_back(op->body);
+            return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, Block::make(writes));
+        }
+    };
 
 public:
     AutorunFuncs(const map<string, Function> &_env,
-            const map<string, string> &_non_autorunnable_funcs_and_why) :
-            env(_env), non_autorunnable_funcs_and_why(_non_autorunnable_funcs_and_why) { }
+            const map<string, string> &_non_autorunnable_funcs_and_why,
+            const map<string, map<string, Type>> &_controls, const string &_broadcaster) :
+            env(_env), non_autorunnable_funcs_and_why(_non_autorunnable_funcs_and_why),
+            controls(_controls), broadcaster(_broadcaster) { }
 
     Stmt visit(const ProducerConsumer *op) override {
         string func_name = extract_first_token(op->name);
@@ -178,10 +300,15 @@ public:
         }
 
         if (op->is_producer) {
-            if (non_autorunnable_funcs_and_why.find(func_name) != non_autorunnable_funcs_and_why.end()) {
+            if (func_name == broadcaster) {
+                BroadcastControls broadcast(controls);
+                return ProducerConsumer::make(op->name, op->is_producer, broadcast.mutate(op->body));
+            } else if (non_autorunnable_funcs_and_why.find(func_name) != non_autorunnable_funcs_and_why.end()) {
                 return op;
             } else {
+                current_func = func_name;
                 Stmt stmt = mutate(op->body);
+                current_func.clear();
                 return ProducerConsumer::make(op->name, op->is_producer, std::move(stmt));
             }
         } else {
@@ -206,6 +333,11 @@ public:
             return op;
         }
 
+        auto c = controls.find(current_func);
+        if (c != controls.end()) {
+            return infinitize_with_controls(op, c->second);
+        }
+
         // Infinitize first serial loop
         Stmt new_stmt = Provide::make("counter.temp",
                             {Call::make(Int(32), "counter.temp", {}, Call::Intrinsic) + 1}, {});
@@ -218,12 +350,104 @@ public:
                         MemoryType::Auto, {}, const_true(), new_stmt);
         return new_stmt;
     }
+
+    // Infinitize the first serial loop of a kernel with control variables. At the start of every run of the
+    // loop, the variables are read from their channels into registers, and the loop counter wraps around at
+    // the end of the run:
+    //   counter.temp = 0
+    //   for (loop.infinite)
+    //     if (counter.temp == 0)
+    //       var.ctrl.temp = read_channel(var.ctrl.channel) for every var
+    //     if (extent > 0)
+    //       body, with loop = min + counter.temp and the vars replaced by their registers
+    //       counter.temp = (counter.temp + 1 == extent) ? 0 : counter.temp + 1
+    // A run with an extent of 0 skips the body, and the counter stays 0, so the variables of the next run are read
+    // in the next iteration.
+    Stmt infinitize_with_controls(const For *op, const map<string, Type> &vars) {
+        map<string, Expr> registers;
+        vector<Stmt> reads;
+        for (auto &v : vars) {
+            string reg = control_register(current_func, v.first);
+            registers[v.first] = Call::make(v.second, reg, {}, Call::Intrinsic);
+            Expr read = Call::make(v.second, Call::read_channel, {StringImm::make(control_channel(current_func, v.first))},
+                                   Call::Intrinsic);
+            reads.push_back(Provide::make(reg, {read}, {}));
+        }
+        Expr counter = Call::make(Int(32), "counter.temp", {}, Call::Intrinsic);
+        Expr min = substitute(registers, op->min);
+        Expr extent = substitute(registers, op->extent);
+        Stmt body = substitute(registers, op->body);
+        body = substitute(op->name, min + counter, body);
+
+        Stmt next = Provide::make("counter.temp", {select(counter + 1 == extent, 0, counter + 1)}, {});
+        Stmt run = IfThenElse::make(extent > 0, Block::make(body, next));
+        Stmt new_stmt = Block::make(IfThenElse::make(counter == 0, Block::make(reads)), run);
+        new_stmt = For::make(op->name + ".infinite", 0, 10, ForType::Serial, op->device_api, new_stmt);
+        new_stmt = Block::make(Provide::make("counter.temp", {0}, {}), new_stmt);
+        new_stmt = Realize::make("counter.temp", {Int(32)}, MemoryType::Auto, {}, const_true(), new_stmt);
+        for (auto &v : vars) {
+            new_stmt = Realize::make(control_register(current_func, v.first), {v.second}, MemoryType::Auto, {},
+                                     const_true(), new_stmt);
+        }
+        return new_stmt;
+    }
 };
 
-void are_kernels_autorunnable(Stmt s, const map<string, Function> &env, map<string, string> &non_autorunnable_funcs_and_why) {
-    FindNonAutorunnableFuncs finder(env);
-    s.accept(&finder);
+// Funcs that are not autorunnable only because they refer to scalar variables defined by the host can receive
+// the variables through channels from a func that stays launched by the host (the broadcaster), and become
+// autorunnable. The first such func on the device is chosen as the broadcaster, if it can see the variables.
+void find_controls(Stmt s, const FindNonAutorunnableFuncs &finder, map<string, string> &non_autorunnable_funcs_and_why,
+                   map<string, map<string, Type>> &controls, string &broadcaster) {
+    vector<string> candidates;
+    for (auto &f : finder.func2ExternalVarTypes) {
+        const string &func_name = f.first;
+        bool only_scalars = finder.hostFuncs.count(func_name) == 0 &&
+                            finder.func2ExternalAllocations.count(func_name) == 0 &&
+                            finder.func2CallsWithSideEffects.count(func_name) == 0;
+        for (auto &v : f.second) {
+            only_scalars &= !v.second.is_handle();
+        }
+        if (only_scalars) {
+            candidates.push_back(func_name);
+        }
+    }
+    for (auto &func_name : finder.device_funcs) {
+        if (non_autorunnable_funcs_and_why.count(func_name) &&
+            std::find(candidates.begin(), candidates.end(), func_name) == candidates.end()) {
+            broadcaster = func_name;
+            break;
+        }
+    }
+    if (broadcaster.empty()) {
+        return;
+    }
+
+    const set<string> &visible = finder.func2VisibleHostVars.at(broadcaster);
+    for (auto &func_name : candidates) {
+        const map<string, Type> &vars = finder.func2ExternalVarTypes.at(func_name);
+        bool can_see = true;
+        for (auto &v : vars) {
+            can_see &= (finder.host_defined_vars.count(v.first) == 0 || visible.count(v.first) > 0);
+        }
+
+        FindKernel producer(func_name);
+        s.accept(&producer);
+        CanReceiveControls receiver(vars);
+        if (can_see && producer.kernel != nullptr && receiver.check(producer.kernel)) {
+            debug(4) << "Func " << func_name << " is autorunnable with variables " << to_string<string>(finder.func2ExternalVars.at(func_name))
+                     << " sent from " << broadcaster << "\n";
+            controls[func_name] = vars;
+            non_autorunnable_funcs_and_why.erase(func_name);
+        }
+    }
+    if (controls.empty()) {
+        broadcaster.clear();
+    }
+}
 
+// Explain why the funcs are not autorunnable
+void why_not_autorunnable(FindNonAutorunnableFuncs &finder, const map<string, Function> &env,
+                          map<string, string> &non_autorunnable_funcs_and_why) {
     for (auto e : env) {
         string func_name = e.first;
         if (finder.non_autorunnable_funcs.find(func_name) != finder.non_autorunnable_funcs.end()) {
@@ -245,17 +469,42 @@ void are_kernels_autorunnable(Stmt s, const map<string, Function> &env, map<stri
     }
 }
 
+void are_kernels_autorunnable(Stmt s, const map<string, Function> &env, map<string, string> &non_autorunnable_funcs_and_why) {
+    FindNonAutorunnableFuncs finder(env);
+    s.accept(&finder);
+    why_not_autorunnable(finder, env, non_autorunnable_funcs_and_why);
+
+    // The funcs that can receive their variables through channels are autorunnable
+    map<string, map<string, Type>> controls;
+    string broadcaster;
+    find_controls(s, finder, non_autorunnable_funcs_and_why, controls, broadcaster);
+}
+
 Stmt autorun_kernels(Stmt stmt, const map<string, Function> &env) {
+    FindNonAutorunnableFuncs finder(env);
+    stmt.accept(&finder);
     map<string, string> non_autorunnable_funcs_and_why;
-    are_kernels_autorunnable(stmt, env, non_autorunnable_funcs_and_why);
+    why_not_autorunnable(finder, env, non_autorunnable_funcs_and_why);
+
+    map<string, map<string, Type>> controls;
+    string broadcaster;
+    find_controls(stmt, finder, non_autorunnable_funcs_and_why, controls, broadcaster);
 
     for (auto n : non_autorunnable_funcs_and_why) {
         debug(4) << n.second << "\n";
     }
 
-    AutorunFuncs autorun(env, non_autorunnable_funcs_and_why);
+    AutorunFuncs autorun(env, non_autorunnable_funcs_and_why, controls, broadcaster);
     Stmt s = autorun.mutate(stmt);
-    
+
+    // Declare the control channels around the whole pipeline. Their depth lets the broadcaster send the
+    // variables of the next run before a receiver has finished the current run.
+    for (auto &c : controls) {
+        for (auto &v : c.second) {
+            s = Realize::make(control_channel(c.first, v.first), {v.second}, MemoryType::Auto, {Range(0, 2)},
+                              const_true(), s);
+        }
+    }
     return s;
 }
 
@@ -32,7 +32,10 @@ namespace Internal {
 // Are the kernels in the environment autorunnable? If not, why?
 extern void are_kernels_autorunnable(Stmt s, const std::map<std::string, Function> &env, std::map<std::string, std::string> &non_autorunnable_funcs_and_why);
 
-// Make kernels autorunnable if possible.
+// Make kernels autorunnable if possible. A kernel that refers to scalar variables defined by the host, e.g. the
+// extents of the input, becomes autorunnable if the variables can be sent to it: the first kernel launched by the
+// host writes every variable into a control channel to the kernel at its start, and the kernel reads them at the
+// start of every run of its outermost loop.
 extern Stmt autorun_kernels(Stmt s, const std::map<std::string, Function> &env);
 
 }
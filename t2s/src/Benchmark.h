@@ -0,0 +1,214 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef T2S_BENCHMARK_H
+#define T2S_BENCHMARK_H
+
+/* Benchmarking of a design invoked from the host. The design is run a few times to warm up (e.g. to
+ * program the device and allocate the device buffers), and then a number of times as samples. The
+ * statistics of the samples, and the throughput and efficiency derived from the number of operations
+ * declared for the design, are printed, and written as JSON for tracking regressions.
+ * Every sample is timed either by the profile of the kernels on the device, or by the wall clock of
+ * the host, which is the only choice for emulators running on the CPU. */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "halide_benchmark.h"
+#include "Roofline.h"
+
+enum class BenchmarkBackend {
+    Device,     // Time a run by the kernels on the device (exec_time.txt written by the runtime)
+    Emulation   // Time a run by the wall clock of the host
+};
+
+// The backend set by env variable BENCHMARK_BACKEND ("device" or "emulation"). If unset, emulation
+// is chosen when the design runs in the emulator of Intel FPGAs.
+inline BenchmarkBackend benchmark_backend() {
+    const char *backend = getenv("BENCHMARK_BACKEND");
+    if (backend != NULL) {
+        return strcmp(backend, "emulation") == 0 ? BenchmarkBackend::Emulation : BenchmarkBackend::Device;
+    }
+    return getenv("CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA") != NULL ? BenchmarkBackend::Emulation : BenchmarkBackend::Device;
+}
+
+inline int benchmark_env_or(const char *name, int value) {
+    const char *s = getenv(name);
+    return s == NULL ? value : atoi(s);
+}
+
+struct BenchmarkStats {
+    double min = 0, median = 0, p95 = 0, mean = 0, stddev = 0;
+};
+
+// The p95 is the nearest-rank percentile, and the stddev is that of the samples (divided by n - 1).
+inline BenchmarkStats benchmark_stats(std::vector<double> samples) {
+    BenchmarkStats stats;
+    size_t n = samples.size();
+    if (n == 0) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    stats.min = samples[0];
+    stats.median = (n % 2 == 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    stats.p95 = samples[(size_t)std::ceil(0.95 * n) - 1];
+    for (double s : samples) {
+        stats.mean += s / n;
+    }
+    for (double s : samples) {
+        stats.stddev += (n > 1) ? (s - stats.mean) * (s - stats.mean) / (n - 1) : 0;
+    }
+    stats.stddev = std::sqrt(stats.stddev);
+    return stats;
+}
+
+struct DesignBenchmark {
+    std::string name;
+    double number_ops;                  // Operations of a run, independent of designs, e.g. 2 * I * J * K for GEMM
+    double number_bytes;                // Bytes of a run to and from the device memory
+    double compute_roof = 0;            // Peak GFLOPS of the device, e.g. 2 * DSPs() * FMax(). 0 if unknown
+    double mem_bandwidth = 0;           // GB/s of the device memory. 0 if unknown
+    std::vector<std::pair<std::string, double>> parameters;    // e.g. the sizes of the problem, recorded in JSON
+    const char *kernel = "kernel_unloader";                     // The kernel timed on the device. NULL for all kernels
+    int warmup = benchmark_env_or("BENCHMARK_WARMUP", 1);
+    int samples = benchmark_env_or("BENCHMARK_SAMPLES", 10);
+    BenchmarkBackend backend = benchmark_backend();
+};
+
+struct BenchmarkReport {
+    DesignBenchmark config;
+    int result = 0;                     // 0, or the first non-zero result of the design
+    std::vector<double> times;          // Nanoseconds of every sample
+    BenchmarkStats time;
+    double gflops = 0;                  // Throughput of the median time
+    double best_gflops = 0;             // Throughput of the min time
+    double efficiency = 0;              // gflops / compute_roof. 0 if unknown
+    double roofline_efficiency = 0;     // gflops / the attainable GFLOPS under the roofline. 0 if unknown
+
+    void print() const;
+    bool write_json(const std::string &file) const;
+};
+
+// Run a design as configured, and time every sample. `run` invokes the design once, and returns its result.
+inline BenchmarkReport benchmark_design(const DesignBenchmark &config, std::function<int()> run) {
+    BenchmarkReport report;
+    report.config = config;
+    for (int i = 0; i < config.warmup && report.result == 0; i++) {
+        report.result = run();
+    }
+    for (int i = 0; i < config.samples && report.result == 0; i++) {
+        auto start = Halide::Tools::benchmark_now();
+        report.result = run();
+        double wall_time = Halide::Tools::benchmark_duration_seconds(start, Halide::Tools::benchmark_now()) * 1e9;
+        report.times.push_back(config.backend == BenchmarkBackend::Device ? ExecTime(config.kernel, false) : wall_time);
+    }
+    if (report.result != 0) {
+        return report;
+    }
+    report.time = benchmark_stats(report.times);
+    if (report.time.median > 0) {
+        report.gflops = config.number_ops / report.time.median;
+        report.best_gflops = config.number_ops / report.time.min;
+    }
+    // Efficiency against the hardware does not make sense in emulation
+    if (config.backend == BenchmarkBackend::Device && config.compute_roof > 0) {
+        report.efficiency = report.gflops / config.compute_roof;
+        if (config.mem_bandwidth > 0 && config.number_bytes > 0) {
+            double attainable = std::min(config.compute_roof, config.mem_bandwidth * config.number_ops / config.number_bytes);
+            report.roofline_efficiency = report.gflops / attainable;
+        }
+    }
+    return report;
+}
+
+inline void BenchmarkReport::print() const {
+    if (result != 0) {
+        printf("Benchmark of %s failed with %d\n", config.name.c_str(), result);
+        return;
+    }
+    printf("Benchmark of %s (%s, %d warm-up runs, %d samples)\n", config.name.c_str(),
+           config.backend == BenchmarkBackend::Device ? "device" : "emulation", config.warmup, (int)times.size());
+    printf("  Time (ns): median %lf, p95 %lf, min %lf, mean %lf, stddev %lf\n",
+           time.median, time.p95, time.min, time.mean, time.stddev);
+    printf("  GFlops: %lf (median), %lf (best)\n", gflops, best_gflops);
+    if (efficiency > 0) {
+        printf("  Efficiency: %.2lf%% of the compute roof, %.2lf%% of the roofline\n",
+               efficiency * 100, roofline_efficiency * 100);
+    }
+}
+
+// Write the report as a JSON object. An unknown efficiency is written as null.
+inline bool BenchmarkReport::write_json(const std::string &file) const {
+    FILE *fp = fopen(file.c_str(), "w");
+    if (fp == NULL) {
+        printf("Cannot open %s!\n", file.c_str());
+        return false;
+    }
+    auto number_or_null = [](double x) {
+        char s[64];
+        snprintf(s, sizeof(s), "%.17g", x);
+        return x > 0 ? std::string(s) : std::string("null");
+    };
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"design\": \"%s\",\n", config.name.c_str());
+    fprintf(fp, "  \"backend\": \"%s\",\n", config.backend == BenchmarkBackend::Device ? "device" : "emulation");
+    fprintf(fp, "  \"result\": %d,\n", result);
+    fprintf(fp, "  \"parameters\": {");
+    for (size_t i = 0; i < config.parameters.size(); i++) {
+        fprintf(fp, "%s\"%s\": %.17g", i == 0 ? "" : ", ", config.parameters[i].first.c_str(), config.parameters[i].second);
+    }
+    fprintf(fp, "},\n");
+    fprintf(fp, "  \"warmup\": %d,\n", config.warmup);
+    fprintf(fp, "  \"samples\": %d,\n", (int)times.size());
+    fprintf(fp, "  \"number_ops\": %.17g,\n", config.number_ops);
+    fprintf(fp, "  \"number_bytes\": %.17g,\n", config.number_bytes);
+    fprintf(fp, "  \"times_ns\": [");
+    for (size_t i = 0; i < times.size(); i++) {
+        fprintf(fp, "%s%.17g", i == 0 ? "" : ", ", times[i]);
+    }
+    fprintf(fp, "],\n");
+    fprintf(fp, "  \"time_ns\": {\"min\": %.17g, \"median\": %.17g, \"p95\": %.17g, \"mean\": %.17g, \"stddev\": %.17g},\n",
+            time.min, time.median, time.p95, time.mean, time.stddev);
+    fprintf(fp, "  \"gflops\": %.17g,\n", gflops);
+    fprintf(fp, "  \"best_gflops\": %.17g,\n", best_gflops);
+    fprintf(fp, "  \"compute_roof_gflops\": %s,\n", number_or_null(config.compute_roof).c_str());
+    fprintf(fp, "  \"mem_bandwidth_gbps\": %s,\n", number_or_null(config.mem_bandwidth).c_str());
+    fprintf(fp, "  \"efficiency\": %s,\n", number_or_null(efficiency).c_str());
+    fprintf(fp, "  \"roofline_efficiency\": %s\n", number_or_null(roofline_efficiency).c_str());
+    fprintf(fp, "}\n");
+    fclose(fp);
+    return true;
+}
+
+// Benchmark a design, print the report, and write it as JSON into the file set by env variable
+// BENCHMARK_JSON, or <name>-benchmark.json by default.
+inline BenchmarkReport benchmark_and_report(const DesignBenchmark &config, std::function<int()> run) {
+    BenchmarkReport report = benchmark_design(config, run);
+    report.print();
+    const char *file = getenv("BENCHMARK_JSON");
+    report.write_json(file != NULL ? std::string(file) : config.name + "-benchmark.json");
+    return report;
+}
+
+#endif
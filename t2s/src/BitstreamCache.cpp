@@ -0,0 +1,266 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "./BitstreamCache.h"
+#include "../../Halide/src/Debug.h"
+#include "../../Halide/src/Error.h"
+#include "../../Halide/src/Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+
+namespace {
+
+// 64-bit FNV-1a, continued from the given hash
+uint64_t fnv1a(const string &s, uint64_t h) {
+    for (unsigned char c : s) {
+        h = (h ^ c) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+string env_or(const char *name, const string &value) {
+    const char *s = getenv(name);
+    return s == NULL ? value : string(s);
+}
+
+bool read_file(const string &file, string &content) {
+    std::ifstream fp(file.c_str(), std::ios::in | std::ios::binary);
+    if (!fp) {
+        return false;
+    }
+    std::stringstream ss;
+    ss << fp.rdbuf();
+    content = ss.str();
+    return true;
+}
+
+void write_file(const string &file, const string &content) {
+    std::ofstream fp(file.c_str(), std::ios::out | std::ios::binary);
+    internal_assert(fp) << "Error: failed to open file " << file << " for output.\n";
+    fp << content;
+}
+
+// Create the directory and its parents, like mkdir -p.
+void make_directories(const string &dir) {
+    for (size_t i = 1; i <= dir.size(); i++) {
+        if (i == dir.size() || dir[i] == '/') {
+            string prefix = dir.substr(0, i);
+            user_assert(mkdir(prefix.c_str(), 0777) == 0 || errno == EEXIST)
+                << "Failed to create directory " << prefix << " for the bitstream cache\n";
+        }
+    }
+}
+
+// Copy the file through a temporary file in the directory of the destination, so that the destination
+// is replaced atomically.
+bool copy_file_atomically(const string &from, const string &to) {
+    string content;
+    if (!read_file(from, content)) {
+        return false;
+    }
+    string tmp = to + "." + std::to_string(getpid());
+    write_file(tmp, content);
+    return rename(tmp.c_str(), to.c_str()) == 0;
+}
+
+string shell_quote(const string &s) {
+    return "'" + replace_all(s, "'", "'\\''") + "'";
+}
+
+// The directory where Quartus outputs acl_quartus_report.txt, i.e. the bitstream file without ".aocx"
+string quartus_report_of(const string &bitstream_file) {
+    return bitstream_file.substr(0, bitstream_file.size() - 5) + "/acl_quartus_report.txt";
+}
+
+// Copy a bitstream and its report from the cache.
+bool install_from_cache(const string &cache, const string &key, const string &bitstream_file) {
+    if (!copy_file_atomically(cache + "/" + key + ".aocx", bitstream_file)) {
+        return false;
+    }
+    string report = cache + "/" + key + ".report.txt";
+    if (file_exists(report)) {
+        string dst = quartus_report_of(bitstream_file);
+        make_directories(dst.substr(0, dst.rfind('/')));
+        copy_file_atomically(report, dst);
+    }
+    write_file(bitstream_file + ".key", key);
+    return true;
+}
+
+// A script that compiles the source file into the bitstream file with aoc, publishes the bitstream into
+// the cache, records its key, and removes the pending marker. The key is recorded only after aoc succeeds,
+// and a partial bitstream left by a failed aoc is removed. If the key is locked by another compilation,
+// the script waits for it instead, and compiles on its own only if that compilation fails.
+string compile_script(const string &cache, const string &key, const string &cl_file,
+                      const string &bitstream_file, const string &aoc_option) {
+    string aoc = "aoc " + aoc_option + " -g \"$cl\" -o \"$bits\"";
+    std::ostringstream s;
+    s << "#!/bin/sh\n"
+      << "# Compile " << cl_file << " into " << bitstream_file << ", and publish it into the bitstream cache.\n"
+      << "cache=" << shell_quote(cache) << "\n"
+      << "key=" << key << "\n"
+      << "cl=" << shell_quote(cl_file) << "\n"
+      << "bits=" << shell_quote(bitstream_file) << "\n"
+      << "report=" << shell_quote(quartus_report_of(bitstream_file)) << "\n"
+      << "publish() { cp \"$1\" \"$cache/$2.$$\" && mv -f \"$cache/$2.$$\" \"$cache/$2\"; }\n"
+      << "status=1\n"
+      << "if mkdir \"$cache/$key.lock\" 2>/dev/null; then\n"
+      << "    if " << aoc << "; then\n"
+      << "        if [ -f \"$report\" ]; then publish \"$report\" \"$key.report.txt\"; fi\n"
+      << "        publish \"$bits\" \"$key.aocx\" && status=0\n"
+      << "    fi\n"
+      << "    rmdir \"$cache/$key.lock\"\n"
+      << "else\n"
+      << "    echo \"Waiting for another compilation of the same bitstream (remove $cache/$key.lock if none)\"\n"
+      << "    while [ -d \"$cache/$key.lock\" ] && [ ! -f \"$cache/$key.aocx\" ]; do sleep 10; done\n"
+      << "    if [ -f \"$cache/$key.aocx\" ]; then\n"
+      << "        cp \"$cache/$key.aocx\" \"$bits.$$\" && mv -f \"$bits.$$\" \"$bits\" && status=0\n"
+      << "        if [ -f \"$cache/$key.report.txt\" ]; then\n"
+      << "            mkdir -p \"$(dirname \"$report\")\" && cp \"$cache/$key.report.txt\" \"$report\"\n"
+      << "        fi\n"
+      << "    elif " << aoc << "; then\n"
+      << "        status=0\n"
+      << "    fi\n"
+      << "fi\n"
+      << "if [ $status -eq 0 ]; then printf '%s' \"$key\" > \"$bits.key\"; else rm -f \"$bits\"; fi\n"
+      << "rm -f \"$bits.pending\"\n"
+      << "exit $status\n";
+    return s.str();
+}
+
+}  // namespace
+
+string bitstream_cache_key(const string &source, const string &aoc_option, const string &board) {
+    // Two 64-bit FNV-1a hashes with different offset bases. The passes are not independent, so the key is
+    // about as strong as one 64-bit hash: enough to tell apart the bitstreams of a cache, but not a 128-bit
+    // hash, nor resistant to crafted collisions. Every field ends with '\0' so that moving characters between
+    // fields changes the key.
+    string content = source + '\0' + aoc_option + '\0' + board + '\0';
+    uint64_t h1 = fnv1a(content, 0xcbf29ce484222325ULL);
+    uint64_t h2 = fnv1a(content, 0x84222325cbf29ce4ULL);
+    char key[33];
+    snprintf(key, sizeof(key), "%016llx%016llx", (unsigned long long)h1, (unsigned long long)h2);
+    return string(key);
+}
+
+string bitstream_cache_key(const string &source) {
+    // The board is usually in AOC_OPTION (-board=...). Otherwise aoc uses the default board of the board
+    // package. The SDK is included as well, since its version changes the bitstream.
+    string board = env_or("FPGA_BOARD", "") + ";" + env_or("AOCL_BOARD_PACKAGE_ROOT", "") + ";" +
+                   env_or("INTELFPGAOCLSDKROOT", "");
+    return bitstream_cache_key(source, env_or("AOC_OPTION", ""), board);
+}
+
+string bitstream_cache_directory() {
+    return env_or("BITSTREAM_CACHE", env_or("HOME", ".") + "/tmp/aocx-cache");
+}
+
+void compile_to_bitstream(const string &source, const string &bitstream_file, bool synthesize) {
+    string key = bitstream_cache_key(source);
+    string key_file = bitstream_file + ".key";
+    string pending_file = bitstream_file + ".pending";
+
+    if (file_exists(pending_file)) {
+        user_warning << "Bitstream " << bitstream_file << " is being compiled in the background. "
+                     << "Remove " << pending_file << " if the compilation has been killed.\n";
+        return;
+    }
+    if (file_exists(bitstream_file)) {
+        string recorded_key;
+        if (!read_file(key_file, recorded_key)) {
+            // Generated ahead of time, e.g. copied from another machine. We cannot tell if it is up to date
+            // with the source code. So if you want to regenerate it, delete it before invoking Halide.
+            user_warning << "Bitstream " << bitstream_file << " exists. No re-compilation.\n";
+            return;
+        }
+        if (recorded_key == key) {
+            debug(1) << "Bitstream " << bitstream_file << " is up to date with the source code.\n";
+            return;
+        }
+        user_warning << "Bitstream " << bitstream_file << " is stale: it was compiled from other source code "
+                     << "or options. Re-compiling.\n";
+        // Remove the stale bitstream with its key. Otherwise, if the re-compilation fails, the next run would
+        // take the bitstream without a key for one generated ahead of time, and silently run it.
+        remove(bitstream_file.c_str());
+        remove(key_file.c_str());
+    }
+
+    // Create the source file
+    string cl_file = replace_all(bitstream_file, ".aocx", ".cl");
+    write_file(cl_file, source + "\n");
+    if (!synthesize) {
+        return;
+    }
+
+    // If environment var WAIT is set, give the programmer a chance to modify the source file, which then
+    // identifies the bitstream instead of the generated source code.
+    if (getenv("WAIT")) {
+        std::cout << "Modify " << cl_file << ". Then press c to continue\n";
+        char c = getchar();
+        while (c != 'c') {
+            c = getchar();
+        }
+        string modified;
+        if (read_file(cl_file, modified)) {
+            key = bitstream_cache_key(modified);
+        }
+    }
+
+    string cache = bitstream_cache_directory();
+    make_directories(cache);
+    if (file_exists(cache + "/" + key + ".aocx") && install_from_cache(cache, key, bitstream_file)) {
+        user_warning << "Bitstream " << bitstream_file << " is copied from the cache (" << cache << "/" << key << ".aocx).\n";
+        return;
+    }
+
+    // Compile the OpenCL file into a bitstream.
+    string script_file = bitstream_file + ".compile.sh";
+    write_file(script_file, compile_script(cache, key, cl_file, bitstream_file, env_or("AOC_OPTION", "")));
+    if (getenv("AOC_ASYNC")) {
+        write_file(pending_file, key);
+        string command = "nohup sh " + shell_quote(script_file) + " > " + shell_quote(bitstream_file + ".log") + " 2>&1 &";
+        debug(4) << "Compiling for bitstream in the background: " << command << "\n";
+        int ret = system(command.c_str());
+        user_assert(ret != -1) << "Failed in compiling " << cl_file;
+        user_warning << "Bitstream " << bitstream_file << " is being compiled in the background. It is ready when "
+                     << pending_file << " is removed. See " << bitstream_file << ".log for the output of aoc.\n";
+        return;
+    }
+    string command = "sh " + shell_quote(script_file);
+    debug(4) << "Compiling for bitstream: " << command << "\n";
+    int ret = system(command.c_str());
+    user_assert(ret != -1) << "Failed in compiling " << cl_file;
+    if (ret != 0) {
+        user_warning << "aoc failed in compiling " << cl_file << " into " << bitstream_file << "\n";
+    }
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,65 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef T2S_BITSTREAM_CACHE_H
+#define T2S_BITSTREAM_CACHE_H
+
+/** \file
+ *
+ * A content-addressed cache of bitstreams compiled by aoc.
+ *
+ * A bitstream is identified by a key, the hash of the OpenCL source, AOC_OPTION, the board and the SDK.
+ * When aoc compiles a bitstream, the key is recorded next to it (a.aocx.key for a.aocx), and the bitstream
+ * and its Quartus report are published into a cache directory shared by all the designs (and users):
+ *   $BITSTREAM_CACHE, or $HOME/tmp/aocx-cache by default
+ *   <key>.aocx, <key>.report.txt
+ * A file is published by copying it into a temporary file in the cache directory and renaming it, so that a
+ * reader never sees a partial bitstream. Concurrent compilations of the same key are serialized by a lock
+ * directory <key>.lock: the later ones wait for the first one and reuse its bitstream.
+ *
+ * If the env var AOC_ASYNC is set, aoc runs in the background, and the compilation returns immediately. Until
+ * the bitstream is ready, a marker a.aocx.pending exists, and the host may run the design in the emulator
+ * instead (see use_emulator_while_bitstream_pending() in SharedUtilsInC.h). The output of aoc is in a.aocx.log.
+ */
+
+#include <string>
+
+namespace Halide {
+namespace Internal {
+
+// The key of a bitstream compiled from the source with the given options of aoc, for the given board.
+std::string bitstream_cache_key(const std::string &source, const std::string &aoc_option, const std::string &board);
+
+// The key of a bitstream compiled from the source under the current env vars (AOC_OPTION, FPGA_BOARD,
+// AOCL_BOARD_PACKAGE_ROOT and INTELFPGAOCLSDKROOT).
+std::string bitstream_cache_key(const std::string &source);
+
+// The directory of the shared cache.
+std::string bitstream_cache_directory();
+
+// Make the bitstream file up to date with the source:
+// -- If it exists with the key of the source, nothing is done.
+// -- If it exists without a key, it is assumed to be generated ahead of time, and is not recompiled.
+// -- Otherwise, the source is written into the .cl file next to it, and if synthesize is true, the bitstream
+//    is copied from the cache, or compiled by aoc and published into the cache.
+void compile_to_bitstream(const std::string &source, const std::string &bitstream_file, bool synthesize);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
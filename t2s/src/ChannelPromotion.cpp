@@ -26,6 +26,7 @@
 
 #include "./DebugPrint.h"
 #include "./LoopRemoval.h"
+#include <set>
 
 namespace Halide {
 namespace Internal {
@@ -73,6 +74,212 @@ auto get_promoted_channel(vector<PromotedChannel> &channels, string name, bool i
     return it;
 }
 
+// The widest channel to create by widening, in bits. Wider channels cost more registers on both ends, and
+// are harder to route.
+#define MAX_WIDENED_CHANNEL_BITS 4096
+
+// The most combinations of loop iterations to enumerate when predicating a promoted read
+#define MAX_PREDICATED_POINTS 64
+
+/* Widen a scalar channel between a producer and a consumer kernel that access it once in every iteration of
+ * a serial loop of the same constant extent, e.g.
+ *   producer:                           consumer:
+ *     for (kkk, 0, KKK)                   for (kkk, 0, KKK)
+ *       write_channel("c.channel", x)       y = read_channel("c.channel")
+ * into a channel indexed by the loop:
+ *     for (kkk, 0, KKK)                   for (kkk, 0, KKK)
+ *       write_channel("c.channel", x, kkk)  y = read_channel("c.channel", kkk)
+ * so that the promotion below moves the accesses out of the loops, and the kernels exchange all the KKK
+ * values with one handshake:
+ *     for (kkk, 0, KKK)                   c.array = read_channel("c.channel")
+ *       write_array(c.array, x, kkk)      for (kkk, 0, KKK)
+ *     write_channel("c.channel", c.array)   y = read_array(c.array, kkk)
+ * The consumer starts KKK iterations later. This is safe as long as the producer does not wait for the
+ * consumer in the meantime, directly or through other kernels, i.e. in the graph of kernels connected by
+ * channels, there is no path from the consumer back to the producer, and no path from the producer to the
+ * consumer other than the widened channel. */
+class FindWidenableChannels : public IRVisitor {
+    using IRVisitor::visit;
+
+    struct Access {
+        string kernel;
+        int kernel_order;
+        const For *loop;        // The innermost loop around the access
+        bool conditional;       // True if it is under a condition inside the loop
+        bool scalar;            // True if the channel is accessed without any index
+    };
+
+    string kernel;
+    int kernel_order = -1;
+    const For *loop = nullptr;
+    bool conditional = false;
+    std::map<string, vector<Access>> writes, reads;
+    std::map<string, std::set<string>> kernel_writes;
+    std::map<string, const Realize *> realizes;
+
+    void visit(const Realize *op) override {
+        if (ends_with(op->name, ".channel")) {
+            realizes[op->name] = op;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const For *op) override {
+        if (ends_with(op->name, ".run_on_device")) {
+            string old_kernel = kernel;
+            kernel = extract_first_token(op->name);
+            kernel_order++;
+            op->body.accept(this);
+            kernel = old_kernel;
+            return;
+        }
+        const For *old_loop = loop;
+        bool old_conditional = conditional;
+        loop = op;
+        conditional = false;
+        op->body.accept(this);
+        loop = old_loop;
+        conditional = old_conditional;
+    }
+
+    void visit(const IfThenElse *op) override {
+        op->condition.accept(this);
+        bool old_conditional = conditional;
+        conditional = true;
+        op->then_case.accept(this);
+        if (op->else_case.defined()) {
+            op->else_case.accept(this);
+        }
+        conditional = old_conditional;
+    }
+
+    void visit(const Select *op) override {
+        op->condition.accept(this);
+        bool old_conditional = conditional;
+        conditional = true;
+        op->true_value.accept(this);
+        op->false_value.accept(this);
+        conditional = old_conditional;
+    }
+
+    void visit(const Call *op) override {
+        if (!kernel.empty() && (op->is_intrinsic(Call::write_channel) || op->is_intrinsic(Call::read_channel))) {
+            bool is_write_chn = op->is_intrinsic(Call::write_channel);
+            string name = get_channel_name(op->args[0]);
+            Access a = { kernel, kernel_order, loop, conditional, op->args.size() == (is_write_chn ? 2u : 1u) };
+            (is_write_chn ? writes : reads)[name].push_back(a);
+            if (is_write_chn) {
+                kernel_writes[kernel].insert(name);
+            }
+        }
+        IRVisitor::visit(op);
+    }
+
+    // True if the kernel from feeds the kernel to through a chain of channels, not counting the excluded channel
+    bool feeds(const string &from, const string &to, const string &excluded) {
+        std::set<string> visited = { from };
+        vector<string> worklist = { from };
+        while (!worklist.empty()) {
+            string k = worklist.back();
+            worklist.pop_back();
+            for (auto &c : kernel_writes[k]) {
+                if (c == excluded) {
+                    continue;
+                }
+                for (auto &r : reads[c]) {
+                    if (r.kernel == to) {
+                        return true;
+                    }
+                    if (visited.insert(r.kernel).second) {
+                        worklist.push_back(r.kernel);
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    bool is_widenable_loop(const For *l) {
+        const IntImm *extent = l ? l->extent.as<IntImm>() : nullptr;
+        return l != nullptr && l->for_type == ForType::Serial && is_zero(l->min) && extent != nullptr &&
+               extent->value > 1 && !ends_with(l->name, ".infinite");
+    }
+
+public:
+    // Channel -> its new extent, and the loops in which the producer and consumer access it
+    struct Widening {
+        int extent;
+        string write_loop, read_loop;
+    };
+    std::map<string, Widening> widenings;
+
+    void find() {
+        for (auto &w : writes) {
+            const string &name = w.first;
+            auto r = reads.find(name);
+            auto realize = realizes.find(name);
+            if (w.second.size() != 1 || r == reads.end() || r->second.size() != 1 || realize == realizes.end()) {
+                continue;
+            }
+            const Access &producer = w.second[0], &consumer = r->second[0];
+            const Realize *chn = realize->second;
+            if (!producer.scalar || !consumer.scalar || producer.conditional || consumer.conditional ||
+                producer.kernel == consumer.kernel || producer.kernel_order > consumer.kernel_order ||
+                !is_widenable_loop(producer.loop) || !is_widenable_loop(consumer.loop) ||
+                !equal(producer.loop->extent, consumer.loop->extent) || chn->bounds.size() != 1 || chn->types.size() != 1) {
+                continue;
+            }
+            int extent = producer.loop->extent.as<IntImm>()->value;
+            if (extent * chn->types[0].bits() * chn->types[0].lanes() > MAX_WIDENED_CHANNEL_BITS) {
+                continue;
+            }
+            // The producer must not wait for the consumer
+            if (feeds(consumer.kernel, producer.kernel, "") || feeds(producer.kernel, consumer.kernel, name)) {
+                debug(4) << "Not widening channel " << name << ": kernel " << producer.kernel
+                         << " may wait for kernel " << consumer.kernel << "\n";
+                continue;
+            }
+            debug(4) << "Widen channel " << name << " by " << extent << " between the loops "
+                     << producer.loop->name << " and " << consumer.loop->name << "\n";
+            widenings[name] = { extent, producer.loop->name, consumer.loop->name };
+        }
+    }
+};
+
+class WidenChannels : public IRMutator {
+    using IRMutator::visit;
+    const std::map<string, FindWidenableChannels::Widening> &widenings;
+
+    Stmt visit(const Realize *op) override {
+        Stmt body = mutate(op->body);
+        auto w = widenings.find(op->name);
+        if (w == widenings.end()) {
+            return Realize::make(op->name, op->types, op->memory_type, op->bounds, op->condition, body);
+        }
+        Region bounds = { Range(0, w->second.extent), op->bounds[0] };
+        return Realize::make(op->name, op->types, op->memory_type, bounds, op->condition, body);
+    }
+
+    Expr visit(const Call *op) override {
+        if (op->is_intrinsic(Call::write_channel) || op->is_intrinsic(Call::read_channel)) {
+            auto w = widenings.find(get_channel_name(op->args[0]));
+            if (w != widenings.end()) {
+                vector<Expr> args;
+                for (auto &a : op->args) {
+                    args.push_back(mutate(a));
+                }
+                const string &loop = op->is_intrinsic(Call::write_channel) ? w->second.write_loop : w->second.read_loop;
+                args.push_back(Variable::make(Int(32), loop));
+                return Call::make(op->type, op->name, args, op->call_type);
+            }
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    WidenChannels(const std::map<string, FindWidenableChannels::Widening> &widenings) : widenings(widenings) {}
+};
+
 class VarsFinder : public IRVisitor
 {
     string l = "__outermost";
@@ -157,13 +364,15 @@ public:
 
 class ChannelVisitor : public IRVisitor {
   public:
-    ChannelVisitor(VarsFinder &vf)
-        : loop_vf(vf) {}
+    ChannelVisitor(VarsFinder &vf, bool predicate_reads)
+        : loop_vf(vf), predicate_reads(predicate_reads) {}
 
     VarsFinder &loop_vf;
+    bool predicate_reads;
     vector<PromotedChannel> channels;
     vector<string> unrolled_loops;
     vector<string> loop_vars;
+    std::map<string, Range> loop_ranges;
 
     // Path condition to a channel write/read
     Expr condition = const_true();
@@ -176,6 +385,7 @@ class ChannelVisitor : public IRVisitor {
             unrolled_loops.push_back(op->name);
         }
         loop_vars.push_back(op->name);
+        loop_ranges[op->name] = Range(op->min, op->extent);
 
         op->body.accept(this);
 
@@ -225,7 +435,8 @@ class ChannelVisitor : public IRVisitor {
         return false;
     }
 
-    bool check_cond(Expr condition, vector<Expr> args, string &promotion_loop, Expr &guarding_cond) {
+    bool check_cond(Expr condition, vector<Expr> args, string &promotion_loop, Expr &guarding_cond,
+                    vector<Expr> &unsafe_conds) {
         vector<Expr> conjunction = break_logic_into_conjunction(condition);
         std::map<string, Expr> removable_conds;
         bool safe_promotion = true;
@@ -241,6 +452,7 @@ class ChannelVisitor : public IRVisitor {
                 if (cond_vf.find_var(args)) {
                     // For non-equality conjunction, if it contains channel arguments, the promotion is unsafe
                     safe_promotion = false;
+                    unsafe_conds.push_back(c);
                 } else {
                     // Otherwise it is added as a part of guarding condition
                     guarding_cond = simplify(guarding_cond && c);
@@ -278,6 +490,7 @@ class ChannelVisitor : public IRVisitor {
             } else {
                 // Other cases are considered as unsafe
                 safe_promotion = false;
+                unsafe_conds.push_back(c);
             }
             debug(4) << "\t" << (safe_promotion ? "removable " : "unremovable ")
                      << "conjunction: " << c << "\n";
@@ -310,6 +523,68 @@ class ChannelVisitor : public IRVisitor {
         return safe_promotion;
     }
 
+    /* A read under a condition that depends on the loops it is promoted out of, e.g.
+     *   unrolled for (iii, 0, III)
+     *     if (iii <= t)
+     *       read_channel(name, iii)
+     * is promoted with the predicate that any of the iterations reads the channel:
+     *   if (0 <= t || 1 <= t || ... || III - 1 <= t)
+     *     write_array(name.array, read_channel(name))
+     *   unrolled for (iii, 0, III)
+     *     if (iii <= t)
+     *       read_array(name.array, iii)
+     * The predicate enumerates the iterations of the loops, which must have constant bounds. */
+    bool predicate(const vector<Expr> &unsafe_conds, const string &promotion_loop, Expr &guarding_cond) {
+        if (ends_with(promotion_loop, "__innermost")) {
+            return false;
+        }
+        Expr cond = const_true();
+        for (auto &c : unsafe_conds) {
+            cond = cond && c;
+        }
+        VarsFinder cond_vf;
+        cond.accept(&cond_vf);
+        vector<std::map<string, Expr>> points = { {} };
+        for (auto it = loop_vars.rbegin(); it != loop_vars.rend(); ++it) {
+            if (cond_vf.find_var({ Variable::make(Int(32), *it) })) {
+                const Range &r = loop_ranges.at(*it);
+                const IntImm *min = r.min.as<IntImm>(), *extent = r.extent.as<IntImm>();
+                if (!min || !extent || points.size() * extent->value > MAX_PREDICATED_POINTS) {
+                    return false;
+                }
+                vector<std::map<string, Expr>> more;
+                for (auto &p : points) {
+                    for (int i = 0; i < extent->value; i++) {
+                        more.push_back(p);
+                        more.back()[*it] = (int)(min->value + i);
+                    }
+                }
+                points.swap(more);
+            }
+            if (*it == promotion_loop) {
+                break;
+            }
+        }
+        Expr any = const_false();
+        for (auto &p : points) {
+            any = any || substitute(p, cond);
+        }
+        any = simplify(any);
+        // The predicate may refer to the loops outside the promotion loop only
+        VarsFinder pred_vf;
+        any.accept(&pred_vf);
+        for (auto it = loop_vars.rbegin(); it != loop_vars.rend(); ++it) {
+            if (pred_vf.find_var({ Variable::make(Int(32), *it) })) {
+                return false;
+            }
+            if (*it == promotion_loop) {
+                break;
+            }
+        }
+        guarding_cond = simplify(guarding_cond && any);
+        return true;
+    }
+
     void visit(const Call* op) override {
         if (op->is_intrinsic(Call::write_channel) || op->is_intrinsic(Call::read_channel)) {
             bool is_write_chn = op->is_intrinsic(Call::write_channel) ? true : false;
@@ -322,7 +597,13 @@ class ChannelVisitor : public IRVisitor {
                      << " channel " << chn_name
                      << " with condition: " << condition << "\n";
             Expr guarding_cond = UIntImm::make(Bool(1), 1);
-            bool safe_promotion = check_cond(condition, args, promotion_loop, guarding_cond);
+            vector<Expr> unsafe_conds;
+            bool safe_promotion = check_cond(condition, args, promotion_loop, guarding_cond, unsafe_conds);
+            if (!safe_promotion && !is_write_chn && predicate_reads &&
+                predicate(unsafe_conds, promotion_loop, guarding_cond)) {
+                debug(4) << "Predicate read channel " << chn_name << " with " << guarding_cond << "\n";
+                safe_promotion = true;
+            }
             // Note the write operation can be promoted even if not safe,
             // and the safe promotion can be disabled in some cases
             if (!ends_with(promotion_loop, "__innermost")) {
@@ -347,9 +628,12 @@ class ChannelVisitor : public IRVisitor {
             } else {
                 // For write channels, if channel arguments occurs in the condition, we cannot ensure the entire array
                 // is write at once (example is CNN-Kung-Song). So we disable promotion for safe.
+                // With predicated reads, the array is written when any iteration writes (see the flag below), and
+                // the consumer, which reads under the same condition, is predicated accordingly. If the consumer
+                // cannot be predicated, the promotion is revoked.
                 VarsFinder vf;
                 condition.accept(&vf);
-                if (vf.find_var(args)) {
+                if (vf.find_var(args) && !predicate_reads) {
                     need_promotion = false;
                 }
             }
@@ -545,11 +829,19 @@ class ChannelPromotor : public IRMutator {
     }
 };
 
-Stmt channel_promotion(Stmt s) {
+Stmt channel_promotion(Stmt s, const Target &t) {
     VarsFinder vf;
-    ChannelVisitor cv(vf);
+    ChannelVisitor cv(vf, t.has_feature(Target::PredicateChannels));
     ChannelPromotor cp(cv);
     s = remove_lets(s, true, false, false, false, {});
+    if (t.has_feature(Target::WidenChannels)) {
+        FindWidenableChannels fw;
+        s.accept(&fw);
+        fw.find();
+        if (!fw.widenings.empty()) {
+            s = WidenChannels(fw.widenings).mutate(s);
+        }
+    }
     s.accept(&vf);
     s.accept(&cv);
     s = cp.mutate(s);
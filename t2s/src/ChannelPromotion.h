@@ -29,15 +29,22 @@
  *   // original: float a = read_channel("A", i)
  *   float a = arrA[i]
  * }
+ * With Target::WidenChannels, a scalar channel accessed once per iteration of a serial loop of the same constant
+ * extent in its producer and consumer kernels is first widened into a channel array indexed by the loop, so that
+ * the values of all the iterations are sent with one handshake. With Target::PredicateChannels, a read under a
+ * condition on the loops it is promoted out of is guarded by the predicate that any iteration of the loops reads
+ * the channel, and the write of its producer is promoted as well. This requires the producer to write under the
+ * same condition as the consumer reads, as isolate_producer_chain() generates.
  */
 
 #include "../../Halide/src/IR.h"
+#include "../../Halide/src/Target.h"
 
 namespace Halide {
 namespace Internal {
 
 /* Promote channels */
-extern Stmt channel_promotion(Stmt s);
+extern Stmt channel_promotion(Stmt s, const Target &t);
 
 }
 }
@@ -0,0 +1,341 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef T2S_DEVICE_PROFILE_H
+#define T2S_DEVICE_PROFILE_H
+
+/* The profile of the kernels of designs compiled with Target::ProfileDevice. Every kernel measures its
+ * cycles by the device clock, and counts the iterations of its loop levels (See DeviceProfiling.h). The
+ * runtime records the counters with the time of the kernel after every invocation. The counters of an
+ * autorun kernel come with those of the kernel relaying them, and are recorded with the time of that
+ * kernel. From the counters:
+ *   - the cycles of a loop level are the iterations of the innermost loops in it, as a loop pipelined
+ *     with II=1 advances an iteration per cycle. These are the busy cycles of a kernel;
+ *   - the stalls of a kernel are its other cycles, in which its PEs wait for a channel, or do not advance
+ *     for another reason, e.g. an II above 1;
+ *   - the PE utilisation of a kernel is the fraction of its cycles that are busy.
+ * Without the clock (CLEARCODE), the cycles of a kernel are its busy cycles.
+ * In a chain of kernels connected by channels, the kernels waiting for a slower one stall, so the least
+ * stalled kernel is the bottleneck.
+ * In the emulator, the iterations are exact, while the clock and the times are those of the emulation.
+ *
+ * The profile is reported in the format of the report of Halide's profiler, and written as a trace in the
+ * Chrome trace event format, which can be opened in chrome://tracing or ui.perfetto.dev. */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct DeviceProfileCounter {
+    enum Kind { Cycles, Loop } kind;
+    std::string name;           // The loop, or "cycles"
+    int parent = -1;            // For a loop, the counter of the enclosing loop, or -1
+    std::string kernel;         // The autorun kernel the counter is relayed from, or empty
+};
+
+// Parse the counters of a kernel described by the compiler: "cycles" or "loop <parent> <loop>", separated
+// by ';'. The counters after "kernel <name>" are relayed from autorun kernel <name>, and the parents of its
+// loops are counted from the first of its counters.
+inline std::vector<DeviceProfileCounter> parse_device_profile_counters(const std::string &description) {
+    std::vector<DeviceProfileCounter> counters;
+    std::istringstream in(description);
+    std::string item, kernel;
+    while (std::getline(in, item, ';')) {
+        std::istringstream words(item);
+        std::string kind;
+        DeviceProfileCounter c;
+        words >> kind;
+        if (kind == "kernel") {
+            words >> kernel;
+            continue;
+        }
+        if (kind == "loop") {
+            c.kind = DeviceProfileCounter::Loop;
+            words >> c.parent >> c.name;
+        } else {
+            c.kind = DeviceProfileCounter::Cycles;
+            c.name = kind;
+        }
+        c.kernel = kernel;
+        counters.push_back(c);
+    }
+    return counters;
+}
+
+struct DeviceKernelRun {
+    double start_ns, end_ns;
+    std::vector<uint64_t> values;
+};
+
+struct DeviceKernelProfile {
+    std::string pipeline, kernel;
+    int device = 0;
+    std::vector<DeviceProfileCounter> counters;
+    std::vector<DeviceKernelRun> runs;
+    std::vector<uint64_t> values;           // Summed over the runs
+    double time_ns = 0;                     // Summed over the runs
+
+    // The cycles of a loop level: its iterations if it is innermost, or the cycles of the loops in it
+    uint64_t loop_cycles(const std::vector<uint64_t> &v, int loop) const {
+        uint64_t n = 0;
+        bool innermost = true;
+        for (size_t c = 0; c < counters.size(); c++) {
+            if (counters[c].kind == DeviceProfileCounter::Loop && counters[c].parent == loop) {
+                n += loop_cycles(v, (int)c);
+                innermost = false;
+            }
+        }
+        return innermost ? v[loop] : n;
+    }
+    uint64_t loop_cycles(int loop) const { return loop_cycles(values, loop); }
+
+    // The cycles in which the PEs advance
+    uint64_t busy_cycles(const std::vector<uint64_t> &v) const {
+        uint64_t n = 0;
+        for (size_t c = 0; c < counters.size(); c++) {
+            if (counters[c].kind == DeviceProfileCounter::Loop && counters[c].parent == -1) {
+                n += loop_cycles(v, (int)c);
+            }
+        }
+        return n;
+    }
+    uint64_t busy_cycles() const { return busy_cycles(values); }
+
+    // The cycles measured by the clock, or the busy cycles without the clock
+    uint64_t cycles(const std::vector<uint64_t> &v) const {
+        for (size_t c = 0; c < counters.size(); c++) {
+            if (counters[c].kind == DeviceProfileCounter::Cycles) {
+                return std::max(v[c], busy_cycles(v));
+            }
+        }
+        return busy_cycles(v);
+    }
+    uint64_t cycles() const { return cycles(values); }
+
+    uint64_t stalls(const std::vector<uint64_t> &v) const { return cycles(v) - busy_cycles(v); }
+    uint64_t stalls() const { return stalls(values); }
+
+    double utilisation() const {
+        return cycles() == 0 ? 0 : (double)busy_cycles() / cycles();
+    }
+};
+
+class DeviceProfile {
+public:
+    // Record a run of a kernel, and of the autorun kernels whose counters it relays
+    void record(const std::string &pipeline, const std::string &kernel, int device,
+                const std::vector<DeviceProfileCounter> &counters, const std::vector<uint64_t> &values,
+                double start_ns, double end_ns) {
+        size_t first = 0;
+        while (first < counters.size() && first < values.size()) {
+            size_t last = first;
+            while (last < counters.size() && last < values.size() && counters[last].kernel == counters[first].kernel) {
+                last++;
+            }
+            std::vector<DeviceProfileCounter> own(counters.begin() + first, counters.begin() + last);
+            for (auto &c : own) {
+                c.kernel.clear();
+            }
+            std::vector<uint64_t> own_values(values.begin() + first, values.begin() + last);
+            record_kernel(pipeline, counters[first].kernel.empty() ? kernel : counters[first].kernel, device,
+                          own, own_values, start_ns, end_ns);
+            first = last;
+        }
+    }
+
+    const std::vector<DeviceKernelProfile> &kernels() const { return all; }
+    bool empty() const { return all.empty(); }
+
+    // The kernels of a pipeline, on all the devices
+    std::vector<const DeviceKernelProfile *> kernels_of(const std::string &pipeline) const {
+        std::vector<const DeviceKernelProfile *> ks;
+        for (auto &k : all) {
+            if (k.pipeline == pipeline) {
+                ks.push_back(&k);
+            }
+        }
+        return ks;
+    }
+
+    std::vector<std::string> pipelines() const {
+        std::vector<std::string> names;
+        for (auto &k : all) {
+            if (std::find(names.begin(), names.end(), k.pipeline) == names.end()) {
+                names.push_back(k.pipeline);
+            }
+        }
+        return names;
+    }
+
+    // The least stalled kernel of a pipeline that has loops, or NULL
+    const DeviceKernelProfile *bottleneck(const std::string &pipeline) const {
+        const DeviceKernelProfile *b = NULL;
+        for (auto k : kernels_of(pipeline)) {
+            if (k->busy_cycles() > 0 && (b == NULL || k->utilisation() > b->utilisation() ||
+                                         (k->utilisation() == b->utilisation() && k->cycles() > b->cycles()))) {
+                b = k;
+            }
+        }
+        return b;
+    }
+
+    // The time of a pipeline, from the earliest start to the latest end of its kernels in every run
+    double time_ns(const std::string &pipeline, int *runs = NULL) const {
+        auto ks = kernels_of(pipeline);
+        size_t n = 0;
+        for (auto k : ks) {
+            n = std::max(n, k->runs.size());
+        }
+        double t = 0;
+        for (size_t r = 0; r < n; r++) {
+            double start = 0, end = 0;
+            bool first = true;
+            for (auto k : ks) {
+                if (r < k->runs.size()) {
+                    start = first ? k->runs[r].start_ns : std::min(start, k->runs[r].start_ns);
+                    end = first ? k->runs[r].end_ns : std::max(end, k->runs[r].end_ns);
+                    first = false;
+                }
+            }
+            t += end - start;
+        }
+        if (runs != NULL) {
+            *runs = (int)n;
+        }
+        return t;
+    }
+
+    // In the format of Halide's profiler: a pipeline, then a line per kernel, followed by its counters
+    std::string report() const {
+        std::ostringstream out;
+        for (auto &pipeline : pipelines()) {
+            int runs = 0;
+            double t = time_ns(pipeline, &runs) / 1e6;
+            out << pipeline << " (device)\n"
+                << " total time: " << t << " ms  samples: 0  runs: " << runs
+                << "  time/run: " << (runs ? t / runs : 0) << " ms\n";
+            for (auto k : kernels_of(pipeline)) {
+                char line[512];
+                double kt = k->time_ns / (std::max(runs, 1) * 1e6);
+                int percent = t > 0 ? (int)(100 * k->time_ns / 1e6 / t) : 0;
+                snprintf(line, sizeof(line), "  %-23s %-9s (%d%%)  cycles: %llu  stalls: %llu  PE utilisation: %.1f%%\n",
+                         (k->kernel + (k->device ? "@" + std::to_string(k->device) : "") + ":").c_str(),
+                         (std::to_string(kt).substr(0, 5) + "ms").c_str(), percent,
+                         (unsigned long long)k->cycles(), (unsigned long long)k->stalls(), 100 * k->utilisation());
+                out << line;
+                for (size_t c = 0; c < k->counters.size(); c++) {
+                    auto &counter = k->counters[c];
+                    if (counter.kind == DeviceProfileCounter::Loop) {
+                        int depth = 0;
+                        for (int p = counter.parent; p >= 0; p = k->counters[p].parent) {
+                            depth++;
+                        }
+                        out << "    " << std::string(2 * depth, ' ') << counter.name << ": iterations: " << k->values[c]
+                            << "  cycles: " << k->loop_cycles((int)c) << "\n";
+                    }
+                }
+            }
+            if (const DeviceKernelProfile *b = bottleneck(pipeline)) {
+                out << " bottleneck: " << b->kernel << " (the least stalled kernel)\n";
+            }
+        }
+        return out.str();
+    }
+
+    // Every run of a kernel is a complete event on the track of the kernel, with the counters of the run
+    std::string chrome_trace() const {
+        std::ostringstream out;
+        out << "{\"traceEvents\": [";
+        double origin = -1;
+        for (auto &k : all) {
+            for (auto &r : k.runs) {
+                origin = (origin < 0) ? r.start_ns : std::min(origin, r.start_ns);
+            }
+        }
+        bool first = true;
+        for (size_t i = 0; i < all.size(); i++) {
+            auto &k = all[i];
+            out << (first ? "\n" : ",\n") << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << k.device
+                << ", \"tid\": " << i << ", \"args\": {\"name\": \"" << k.pipeline << "/" << k.kernel << "\"}}";
+            first = false;
+            for (auto &r : k.runs) {
+                uint64_t busy = k.busy_cycles(r.values), stalls = k.stalls(r.values);
+                out << ",\n  {\"name\": \"" << k.kernel << "\", \"cat\": \"" << k.pipeline << "\", \"ph\": \"X\", \"pid\": "
+                    << k.device << ", \"tid\": " << i << ", \"ts\": " << (r.start_ns - origin) / 1e3
+                    << ", \"dur\": " << (r.end_ns - r.start_ns) / 1e3 << ", \"args\": {\"cycles\": " << busy + stalls
+                    << ", \"stalls\": " << stalls << ", \"PE utilisation\": "
+                    << (busy + stalls == 0 ? 0 : (double)busy / (busy + stalls));
+                for (size_t c = 0; c < k.counters.size(); c++) {
+                    if (k.counters[c].kind == DeviceProfileCounter::Loop) {
+                        out << ", \"" << k.counters[c].name << "\": " << r.values[c];
+                    }
+                }
+                out << "}}";
+            }
+        }
+        out << "\n]}\n";
+        return out.str();
+    }
+
+    bool write_chrome_trace(const std::string &file) const {
+        FILE *fp = fopen(file.c_str(), "w");
+        if (fp == NULL) {
+            return false;
+        }
+        std::string trace = chrome_trace();
+        fwrite(trace.data(), 1, trace.size(), fp);
+        return fclose(fp) == 0;
+    }
+
+private:
+    std::vector<DeviceKernelProfile> all;
+
+    void record_kernel(const std::string &pipeline, const std::string &kernel, int device,
+                       const std::vector<DeviceProfileCounter> &counters, const std::vector<uint64_t> &values,
+                       double start_ns, double end_ns) {
+        DeviceKernelProfile *k = NULL;
+        for (auto &p : all) {
+            if (p.pipeline == pipeline && p.kernel == kernel && p.device == device) {
+                k = &p;
+            }
+        }
+        if (k == NULL) {
+            all.push_back(DeviceKernelProfile());
+            k = &all.back();
+            k->pipeline = pipeline;
+            k->kernel = kernel;
+            k->device = device;
+            k->counters = counters;
+            k->values.resize(counters.size(), 0);
+        }
+        for (size_t c = 0; c < values.size() && c < k->values.size(); c++) {
+            k->values[c] += values[c];
+        }
+        k->time_ns += end_ns - start_ns;
+        k->runs.push_back({start_ns, end_ns, values});
+    }
+};
+
+// The profile recorded by the runtime so far (defined in AOT-OpenCL-Runtime.cpp)
+DeviceProfile &t2s_device_profile();
+
+#endif
@@ -0,0 +1,357 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "ExprUsesVar.h"
+#include "IR.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Simplify.h"
+#include "Substitute.h"
+#include "Util.h"
+#include "./DebugPrint.h"
+#include "./DeviceProfiling.h"
+#include "./Utilities.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+const char *device_clock_call = "halide_t2s_device_clock";
+
+namespace {
+
+Expr temp(const string &name) {
+    return Call::make(UInt(64), name, {}, Call::Intrinsic);
+}
+
+// Count the iterations of the serial loops of a kernel, as the products of the extents of the loops and the
+// loops around them. The products hold when the kernel finishes if the extents do not change in the kernel.
+// The loops in a condition, and those inside unrolled or vectorized loops, which every PE would count, are
+// skipped, and so are the loops in them.
+class CountLoopIterations : public IRVisitor {
+    using IRVisitor::visit;
+
+    Scope<> loop_vars;          // The loops around the current statement
+    map<string, Expr> lets;     // The lets around it, with the lets in their values substituted
+    int parent;
+    Expr parent_iterations;
+    bool skipped = false;
+
+    void skip(const Stmt &s) {
+        bool old_skipped = skipped;
+        skipped = true;
+        s.accept(this);
+        skipped = old_skipped;
+    }
+
+public:
+    vector<string> loops;       // "loop <parent> <name>" for every loop counter, in order
+    vector<Expr> iterations;    // The iterations of every loop counter
+    int first;                  // The index of the first loop counter
+
+    CountLoopIterations(int first, int parent = -1, Expr parent_iterations = make_const(UInt(64), 1))
+        : parent(parent), parent_iterations(parent_iterations), first(first) {}
+
+    void visit(const LetStmt *op) override {
+        lets[op->name] = substitute(lets, op->value);
+        op->body.accept(this);
+        lets.erase(op->name);
+    }
+
+    void visit(const IfThenElse *op) override {
+        skip(op->then_case);
+        if (op->else_case.defined()) {
+            skip(op->else_case);
+        }
+    }
+
+    void visit(const For *op) override {
+        Expr extent = substitute(lets, op->extent);
+        loop_vars.push(op->name);
+        if (ends_with(op->name, "remove")) {
+            op->body.accept(this);
+        } else if (op->for_type != ForType::Serial || ends_with(op->name, ".infinite") || skipped ||
+                   expr_uses_vars(extent, loop_vars)) {
+            skip(op->body);
+        } else {
+            int index = first + (int)loops.size();
+            loops.push_back("loop " + std::to_string(parent) + " " + op->name);
+            iterations.push_back(simplify(parent_iterations * cast(UInt(64), max(extent, 0))));
+            int old_parent = parent;
+            Expr old_parent_iterations = parent_iterations;
+            parent = index;
+            parent_iterations = iterations.back();
+            op->body.accept(this);
+            parent = old_parent;
+            parent_iterations = old_parent_iterations;
+        }
+        loop_vars.pop(op->name);
+    }
+};
+
+string kernel_name_of(const string &loop_name) {
+    string name = "kernel_" + extract_first_token(loop_name);
+    for (auto &c : name) {
+        if (!isalnum(c)) {
+            c = '_';
+        }
+    }
+    return name;
+}
+
+// The kernels launched by the host, in order
+class FindHostKernels : public IRVisitor {
+    using IRVisitor::visit;
+
+public:
+    vector<string> kernels;
+
+    void visit(const For *op) override {
+        if (ends_with(op->name, ".run_on_device") && !ends_with(op->name, ".autorun.run_on_device")) {
+            kernels.push_back(op->name);
+        }
+        IRVisitor::visit(op);
+    }
+};
+
+// The counters of an autorun kernel, sent over a channel at the end of every run
+struct AutorunCounters {
+    string kernel;
+    string channel;
+    vector<string> names;
+};
+
+// Measure every run of an autorun kernel that receives its loop bounds over control channels. Its infinite loop
+// is made by AutorunFuncs::infinitize_with_controls():
+//   for (loop.infinite)
+//     if (counter.temp == 0)
+//       read the bounds
+//     if (extent > 0)
+//       body
+//       counter.temp = (counter.temp + 1 == extent) ? 0 : counter.temp + 1
+// The loop samples the clock in every iteration, and the kernel sends its counters at the end of a run:
+//   clock.temp = 0
+//   for (loop.infinite)
+//     clock.temp = sample of the clock, or clock.temp
+//     if (counter.temp == 0)
+//       read the bounds
+//       start.temp = clock.temp
+//     if (extent > 0)
+//       body
+//       if (counter.temp + 1 == extent)
+//         write the counters
+//       counter.temp = (counter.temp + 1 == extent) ? 0 : counter.temp + 1
+//     else
+//       write the counters
+class InstrumentRuns : public IRMutator {
+    using IRMutator::visit;
+
+    const string &func;
+    bool with_clock;
+
+public:
+    AutorunCounters counters;
+    bool found = false;
+
+    InstrumentRuns(const string &func, bool with_clock) : func(func), with_clock(with_clock) {}
+
+    Stmt visit(const For *op) override {
+        if (found || !ends_with(op->name, ".infinite")) {
+            return IRMutator::visit(op);
+        }
+        const Block *block = op->body.as<Block>();
+        const IfThenElse *receive = block ? block->first.as<IfThenElse>() : nullptr;
+        const IfThenElse *run = block ? block->rest.as<IfThenElse>() : nullptr;
+        const Block *run_body = run ? run->then_case.as<Block>() : nullptr;
+        const Provide *next = run_body ? run_body->rest.as<Provide>() : nullptr;
+        const GT *positive = run ? run->condition.as<GT>() : nullptr;
+        if (!receive || !run || run->else_case.defined() || !next || next->name != "counter.temp" || !positive) {
+            return op;
+        }
+        found = true;
+        Expr extent = positive->a;
+        Expr counter = Call::make(Int(32), "counter.temp", {}, Call::Intrinsic);
+        string clock = func + ".profile.clock.temp", start = func + ".profile.start.temp";
+
+        // The cycles, the iterations of the loop of the run, and those of the loops in it
+        vector<Expr> values;
+        if (with_clock) {
+            counters.names.push_back("cycles");
+            values.push_back(temp(clock) - temp(start));
+        }
+        string loop = op->name.substr(0, op->name.length() - string(".infinite").length());
+        int index = (int)counters.names.size();
+        counters.names.push_back("loop -1 " + loop);
+        values.push_back(cast(UInt(64), max(extent, 0)));
+        CountLoopIterations loops(index + 1, index, values.back());
+        run_body->first.accept(&loops);
+        counters.names.insert(counters.names.end(), loops.loops.begin(), loops.loops.end());
+        values.insert(values.end(), loops.iterations.begin(), loops.iterations.end());
+
+        vector<Stmt> writes;
+        for (auto &v : values) {
+            writes.push_back(Evaluate::make(Call::make(UInt(64), Call::write_channel, {StringImm::make(counters.channel), v},
+                                                       Call::Intrinsic)));
+        }
+        Stmt finish = Block::make(writes);
+        Stmt received = receive->then_case;
+        if (with_clock) {
+            received = Block::make(received, Provide::make(start, {temp(clock)}, {}));
+        }
+        Stmt body = Block::make(Block::make(run_body->first, IfThenElse::make(counter + 1 == extent, finish)), next);
+        body = Block::make(IfThenElse::make(receive->condition, received), IfThenElse::make(run->condition, body, finish));
+        if (with_clock) {
+            Expr sample = Call::make(UInt(64), device_clock_call, {temp(clock)}, Call::Extern);
+            body = Block::make(Provide::make(clock, {sample}, {}), body);
+        }
+        Stmt s = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        if (with_clock) {
+            s = Block::make(Provide::make(clock, {make_zero(UInt(64))}, {}), s);
+            s = Realize::make(clock, {UInt(64)}, MemoryType::Auto, {}, const_true(), s);
+            s = Realize::make(start, {UInt(64)}, MemoryType::Auto, {}, const_true(), s);
+        }
+        return s;
+    }
+};
+
+class InjectDeviceProfiling : public IRMutator {
+    using IRMutator::visit;
+
+    const string &pipeline_name;
+    bool with_clock;
+    bool autorun_phase = true;
+    string relay;               // The last kernel launched by the host, which relays the counters of the autorun kernels
+
+    Stmt instrument_autorun_kernel(const For *op) {
+        string func = extract_first_token(op->name);
+        InstrumentRuns runs(func, with_clock);
+        runs.counters.kernel = kernel_name_of(op->name);
+        runs.counters.channel = func + ".profile.channel";
+        Stmt body = runs.mutate(op->body);
+        if (!runs.found) {
+            debug(2) << "Not profiling " << kernel_name_of(op->name) << ", which does not receive its loop bounds\n";
+            return op;
+        }
+        autorun_counters.push_back(runs.counters);
+        return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+    }
+
+    Stmt instrument_host_kernel(const For *op) {
+        string func = extract_first_token(op->name);
+        string buffer = func + ".profile";
+        string start = func + ".profile.start.temp";
+
+        // The cycles, the iterations of the loops, and the counters relayed from the autorun kernels
+        vector<string> names;
+        vector<Expr> values;
+        if (with_clock) {
+            names.push_back("cycles");
+            values.push_back(Call::make(UInt(64), device_clock_call, {}, Call::Extern) - temp(start));
+        }
+        CountLoopIterations loops((int)values.size());
+        op->body.accept(&loops);
+        names.insert(names.end(), loops.loops.begin(), loops.loops.end());
+        values.insert(values.end(), loops.iterations.begin(), loops.iterations.end());
+        if (op->name == relay) {
+            for (auto &k : autorun_counters) {
+                names.push_back("kernel " + k.kernel);
+                names.insert(names.end(), k.names.begin(), k.names.end());
+                for (size_t i = 0; i < k.names.size(); i++) {
+                    values.push_back(Call::make(UInt(64), Call::read_channel, {StringImm::make(k.channel)}, Call::Intrinsic));
+                }
+            }
+        }
+        if (values.empty()) {
+            return op;
+        }
+
+        // Read the clock before the kernel body, and write the counters out after it
+        vector<Stmt> write_out;
+        for (size_t i = 0; i < values.size(); i++) {
+            write_out.push_back(Store::make(buffer, values[i], (int)i, Parameter(), const_true(), ModulusRemainder()));
+        }
+        Stmt body = Block::make(op->body, Block::make(write_out));
+        if (with_clock) {
+            body = Block::make(Provide::make(start, {Call::make(UInt(64), device_clock_call, {}, Call::Extern)}, {}), body);
+            body = Realize::make(start, {UInt(64)}, MemoryType::Auto, {}, const_true(), body);
+        }
+        Stmt kernel = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+
+        string description;
+        for (auto &n : names) {
+            description += (description.empty() ? "" : ";") + n;
+        }
+        debug(2) << "Profiling " << kernel_name_of(op->name) << " with counters " << description << "\n";
+        Expr profile = Call::make(type_of<struct halide_buffer_t *>(), "halide_t2s_device_profile",
+                                  {StringImm::make(pipeline_name), StringImm::make(kernel_name_of(op->name)),
+                                   StringImm::make(description)}, Call::Extern);
+        return LetStmt::make(buffer + ".buffer", profile, kernel);
+    }
+
+public:
+    vector<AutorunCounters> autorun_counters;
+
+    InjectDeviceProfiling(const string &pipeline_name, bool with_clock) : pipeline_name(pipeline_name), with_clock(with_clock) {}
+
+    Stmt inject(Stmt s) {
+        FindHostKernels host_kernels;
+        s.accept(&host_kernels);
+        if (!host_kernels.kernels.empty()) {
+            // The autorun kernels first, so that their counters are known to the relay
+            relay = host_kernels.kernels.back();
+            autorun_phase = true;
+            s = mutate(s);
+        }
+        autorun_phase = false;
+        s = mutate(s);
+
+        // Declare the channels of the counters of the autorun kernels around the whole pipeline. Their depth lets
+        // a kernel send all its counters without waiting for the relay.
+        for (auto &k : autorun_counters) {
+            s = Realize::make(k.channel, {UInt(64)}, MemoryType::Auto, {Range(0, (int)k.names.size())}, const_true(), s);
+        }
+        return s;
+    }
+
+    Stmt visit(const For *op) override {
+        if (!ends_with(op->name, ".run_on_device")) {
+            return IRMutator::visit(op);
+        }
+        bool autorun = ends_with(op->name, ".autorun.run_on_device");
+        if (autorun && autorun_phase) {
+            return instrument_autorun_kernel(op);
+        } else if (!autorun && !autorun_phase) {
+            return instrument_host_kernel(op);
+        }
+        return op;
+    }
+};
+
+} // namespace
+
+Stmt inject_device_profiling(Stmt s, const string &pipeline_name, bool with_clock) {
+    InjectDeviceProfiling injector(pipeline_name, with_clock);
+    return injector.inject(s);
+}
+
+}
+}
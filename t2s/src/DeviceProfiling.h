@@ -0,0 +1,68 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef T2S_DEVICE_PROFILING_H
+#define T2S_DEVICE_PROFILING_H
+
+/** \file
+ * Defines the instrumentation of device kernels with profiling counters (Target::ProfileDevice).
+ *
+ * No counter is updated in the loops of a kernel, so that the instrumentation does not change the II of
+ * its loops. A kernel measures:
+ *   - its cycles, by reading a free-running device clock when it starts and when it finishes. The clock is
+ *     an autorun kernel that offers its count to every profiled kernel in every cycle, over a channel of
+ *     depth 0 (See CodeGen_OpenCL_Dev), so that a read gets the current count;
+ *   - the iterations of every serial loop level, as the product of the extents of the loop and the loops
+ *     around it. A loop whose extent changes in the kernel, or that is in a condition, is not counted.
+ * For a loop pipelined with II=1, the iterations of an innermost loop are the cycles its PEs advance, and
+ * the other cycles of the kernel are stalls.
+ *
+ * A kernel launched by the host writes its counters into a buffer provided by the runtime when it finishes.
+ * The runtime gets the buffer by calling
+ *     halide_buffer_t *halide_t2s_device_profile(const char *pipeline, const char *kernel, const char *counters)
+ * before launching the kernel, where counters describes the counters in order, separated by ';':
+ *     cycles, loop <index of the parent loop counter, or -1> <loop>, or kernel <name>
+ * An autorun kernel measures every run of its loops instead, i.e. every run between two receptions of its
+ * loop bounds over control channels (See AutorunKernels.cpp), and sends its counters over a channel
+ * to the last kernel of the pipeline launched by the host, which appends them to its own counters after
+ * "kernel <name>". An autorun kernel that does not receive its loop bounds has no runs, and is not profiled.
+ * See t2s/src/DeviceProfile.h for the report built from the counters.
+ *
+ * The counters cost registers, and a clock read retries a non-blocking read at the start and the end of a
+ * kernel, or samples the clock in every iteration of an autorun kernel. So the feature is for diagnostic
+ * builds, not for the design to deploy. The runtime call is implemented only in the AOT runtime
+ * (t2s/src/AOT-OpenCL-Runtime.cpp). The kernels generated with CLEARCODE count loop iterations but not
+ * cycles.
+ */
+
+#include "../../Halide/src/IR.h"
+#include <string>
+
+namespace Halide {
+namespace Internal {
+
+// The name of the call reading the device clock. Without arguments, the read waits for the clock. With the
+// previous count as its argument, the read returns it if the clock cannot be read in the cycle.
+extern const char *device_clock_call;
+
+extern Stmt inject_device_profiling(Stmt s, const std::string &pipeline_name, bool with_clock);
+
+}
+}
+
+#endif
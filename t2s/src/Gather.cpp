@@ -39,6 +39,10 @@
 namespace Halide{
 using namespace Internal;
 Func &Func::gather(Func f, VarOrRVar loop, GatherStrategy strategy) {
+    return gather(f, loop, strategy, 2, GatherOp::None);
+}
+
+Func &Func::gather(Func f, VarOrRVar loop, GatherStrategy strategy, int fan_in, GatherOp op) {
     user_assert(this->defined() && !this->has_update_definition())
         << GATHER_ERROR_MESSAGE(f.name(), name(), loop.name())
         << "can only support gathering defined Func without updated definition.\n";
@@ -48,9 +52,15 @@ Func &Func::gather(Func f, VarOrRVar loop, GatherStrategy strategy) {
     user_assert(func.definition().schedule().gather_params().empty())
         << GATHER_ERROR_MESSAGE(f.name(), name(), loop.name())
         << "can only support gathering once for each Func.\n";
+    user_assert(fan_in >= 2)
+        << GATHER_ERROR_MESSAGE(f.name(), name(), loop.name())
+        << "the fan-in of a gathering tree must be at least 2.\n";
+    user_assert(strategy == GatherStrategy::Tree || op == GatherOp::None)
+        << GATHER_ERROR_MESSAGE(f.name(), name(), loop.name())
+        << "only a gathering tree (GatherStrategy::Tree) can reduce or pack data.\n";
     // just record args, gather in lower
     vector<GatherItem>& gather_params = func.definition().schedule().gather_params();
-    gather_params.push_back(GatherItem(f.name(), loop.name(), strategy));
+    gather_params.push_back(GatherItem(f.name(), loop.name(), strategy, fan_in, op));
     return *this;
 };
 struct VarOrRVar;
@@ -246,14 +256,85 @@ public:
     const vector<string> unroll_names;
     const vector<pair<int, int>> unroll_min_extents;
     GatherStrategy strategy;
+    string loop_name;
+    int fan_in;
+    GatherOp op;
     GatherArgInfo(string _func_name, Expr node, Stmt _write_channel_node, const For* loop, string _vec_loop_name,vector<string> &_unroll_names,
-                  vector<pair<int, int>>& _unroll_min_extents, GatherStrategy _strategy)
+                  vector<pair<int, int>>& _unroll_min_extents, GatherStrategy _strategy, string _loop_name = "", int _fan_in = 2,
+                  GatherOp _op = GatherOp::None)
         :func_name(_func_name), call_node(node), write_channel_node(_write_channel_node),gather_loop(loop), vec_loop_name(_vec_loop_name),
-         unroll_names(_unroll_names), unroll_min_extents(_unroll_min_extents), strategy(_strategy){}
+         unroll_names(_unroll_names), unroll_min_extents(_unroll_min_extents), strategy(_strategy), loop_name(_loop_name),
+         fan_in(_fan_in), op(_op){}
 };
 
 using GatherArgs=map<string,GatherArgInfo>;
 
+// Select leaves[index - lo] out of leaves [lo, lo + n) through a tree: every node selects one of
+// its (up to) fan_in children, each covering a contiguous range of the leaves.
+Expr select_tree(const vector<Expr> &leaves, int lo, int n, Expr index, int fan_in) {
+    if (n == 1) {
+        return leaves[lo];
+    }
+    int size = (n + fan_in - 1) / fan_in;
+    int last = lo + ((n - 1) / size) * size;
+    Expr node = select_tree(leaves, last, lo + n - last, index, fan_in);
+    for (int child = last - size; child >= lo; child -= size) {
+        node = Select::make(LT::make(index, child + size), select_tree(leaves, child, size, index, fan_in), node);
+    }
+    return node;
+}
+
+// Combine leaves [lo, lo + n) with op through a tree, every node of which combines (up to) fan_in children.
+Expr reduce_tree(const vector<Expr> &leaves, int lo, int n, GatherOp op, int fan_in) {
+    if (n == 1) {
+        return leaves[lo];
+    }
+    int size = (n + fan_in - 1) / fan_in;
+    Expr node;
+    for (int child = lo; child < lo + n; child += size) {
+        Expr e = reduce_tree(leaves, child, std::min(size, lo + n - child), op, fan_in);
+        if (!node.defined()) {
+            node = e;
+        } else if (op == GatherOp::Add) {
+            node = Add::make(node, e);
+        } else if (op == GatherOp::Max) {
+            node = Max::make(node, e);
+        } else {
+            internal_assert(op == GatherOp::Min);
+            node = Min::make(node, e);
+        }
+    }
+    return node;
+}
+
+// Replace a statement with another one.
+class ReplaceGatherWrite : public IRMutator {
+    using IRMutator::visit;
+    const Stmt &write;
+    const Stmt &replacement;
+
+    Stmt visit(const Evaluate *op) override {
+        if (equal(Stmt(op), write)) {
+            replaced = true;
+            return replacement;
+        }
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Store *op) override {
+        if (equal(Stmt(op), write)) {
+            replaced = true;
+            return replacement;
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    bool replaced;
+    ReplaceGatherWrite(const Stmt &_write, const Stmt &_replacement)
+        : write(_write), replacement(_replacement), replaced(false) {}
+};
+
 class DataGathering : public IRMutator{
     using IRMutator::visit;
     // key is caller_name
@@ -263,6 +344,78 @@ class DataGathering : public IRMutator{
     string producer_name;
     int loop_level;
     Stmt write_node;
+
+    // Gather through a tree (GatherStrategy::Tree). Given the gather loop ii of extent II,
+    // for (ii.gather, 0, steps)
+    //   unrolled for (ii, min, II)
+    //     if (ii.gather == 0)
+    //       A[ii] = origin_read_shreg(ii, ...) from main kernel
+    //     if (ii == min + II - 1)
+    //       write the tree of A[0..II-1] to output
+    // where the tree selects A[ii.gather] (GatherOp::None, II steps), combines all of A
+    // (GatherOp::Add/Max/Min, 1 step), or packs every fan_in of A into a vector (GatherOp::Pack, II/fan_in steps).
+    Stmt gather_through_tree(const For *op, const GatherArgInfo &info) {
+        Type type = info.call_node.type();
+        user_assert(op->min.as<IntImm>() && op->extent.as<IntImm>())
+            << GATHER_ERROR_MESSAGE(info.func_name, producer_name, info.loop_name)
+            << "the min and extent of loop " + info.loop_name + " are expected to be constants.\n";
+        int min = op->min.as<IntImm>()->value;
+        int extent = op->extent.as<IntImm>()->value;
+        Expr gather_var = Variable::make(Int(32), op->name + ".gather");
+
+        string shreg_name = producer_name + "_gather_" + info.func_name + ".shreg";
+        vector<Expr> shreg_args(1, Expr(shreg_name));
+        for (auto t : info.unroll_names) {
+            shreg_args.push_back(Variable::make(Int(32), t));
+        }
+        vector<Expr> hand_over_args(shreg_args);
+        hand_over_args.push_back(info.call_node);
+        Stmt hand_over = Evaluate::make(Call::make(type, Call::write_shift_reg, hand_over_args, Call::Intrinsic));
+
+        Expr read_shreg = Call::make(type, Call::read_shift_reg, shreg_args, Call::Intrinsic);
+        vector<Expr> leaves;
+        for (int i = 0; i < extent; i++) {
+            leaves.push_back(substitute(op->name, min + i, read_shreg));
+        }
+
+        int steps;
+        Stmt output;
+        if (info.op == GatherOp::None) {
+            steps = extent;
+            output = substitute(info.call_node, select_tree(leaves, 0, extent, gather_var, info.fan_in), info.write_channel_node);
+            output = substitute(op->name, min + gather_var, output);
+        } else if (info.op == GatherOp::Pack) {
+            steps = extent / info.fan_in;
+            vector<Expr> lanes;
+            for (int l = 0; l < info.fan_in; l++) {
+                vector<Expr> lane_leaves;
+                for (int i = 0; i < steps; i++) {
+                    lane_leaves.push_back(leaves[i * info.fan_in + l]);
+                }
+                lanes.push_back(select_tree(lane_leaves, 0, steps, gather_var, info.fan_in));
+            }
+            Expr packed = Shuffle::make_concat(lanes);
+            const Call *write = info.write_channel_node.as<Evaluate>()->value.as<Call>();
+            vector<Expr> write_args(write->args);
+            write_args[1] = packed;
+            output = Evaluate::make(Call::make(packed.type(), Call::write_channel, write_args, Call::Intrinsic));
+            output = substitute(op->name, min, output);
+        } else {
+            steps = 1;
+            output = substitute(info.call_node, reduce_tree(leaves, 0, extent, info.op, info.fan_in), info.write_channel_node);
+            output = substitute(op->name, min, output);
+        }
+
+        Stmt take = steps > 1 ? IfThenElse::make(EQ::make(gather_var, 0), hand_over) : hand_over;
+        Stmt give = IfThenElse::make(EQ::make(Variable::make(Int(32), op->name), min + extent - 1), output);
+        ReplaceGatherWrite replacer(info.write_channel_node, Block::make(take, give));
+        Stmt body = replacer.mutate(op->body);
+        internal_assert(replacer.replaced);
+        debug(4) << "Gathering : insert gather loop " + op->name + ".gather with " << steps << " steps.\n";
+        body = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        return For::make(op->name + ".gather", 0, steps, ForType::Serial, op->device_api, body);
+    }
+
     Stmt visit(const For *op) override{
         debug(4) << "Gathering : enter For " << op->name << ".\n";
         loop_level++;
@@ -270,6 +423,9 @@ class DataGathering : public IRMutator{
         auto iter = gather_arg_info.find(producer_name);
         if(iter == gather_arg_info.end() || iter->second.vec_loop_name != "")
             return Stmt(op);
+        if (iter->second.strategy == GatherStrategy::Tree && iter->second.gather_loop == op) {
+            return gather_through_tree(op, iter->second);
+        }
         Stmt updated_body = mutate(op->body);
 
         if(loop_now == loop_level){
@@ -695,6 +851,166 @@ public:
     :loop_info(_loop_info), channel_names(_channel_names), producer_name(""){}
 };
 
+// Suppose func c gathers func p through a tree that reduces or packs the data (GatherOp other than None).
+// Then the consumer of c receives less data than the iterations of the gather loop l: one value per
+// tile (reduction), or one vector every fan_in iterations of loop l (packing). The consumer reads c's
+// channel into a register at the first of these iterations, and takes its value out of the register
+// in every iteration:
+//   if ((l - l.min) % fan_in == 0)                     // or l == l.min for a reduction
+//     c.gather.temp(...) = read_channel(c.channel, ...)
+//   ... c.gather.temp(...)[(l - l.min) % fan_in] ...   // or c.gather.temp(...) for a reduction
+class UnpackGatheredData : public IRMutator {
+    using IRMutator::visit;
+    // key is caller_name
+    const map<string, GatherArgInfo> &gather_arg_info;
+    // The bounds of the channels of the callers, except the depth
+    map<string, Region> channel_bounds;
+    string producer_name;
+    vector<const For *> loops;
+    // The registers used in the current kernel
+    map<string, pair<Type, Region>> registers;
+    // Reading the registers, to be inserted before the current statement
+    vector<Stmt> fetches;
+
+    const GatherArgInfo *find_tree(const string &channel_name) {
+        if (!ends_with(channel_name, ".channel")) {
+            return nullptr;
+        }
+        auto iter = gather_arg_info.find(channel_name.substr(0, channel_name.size() - string(".channel").size()));
+        if (iter == gather_arg_info.end() || iter->second.strategy != GatherStrategy::Tree ||
+            iter->second.op == GatherOp::None) {
+            return nullptr;
+        }
+        return &iter->second;
+    }
+
+    Stmt with_fetches(Stmt s) {
+        if (!fetches.empty()) {
+            s = Block::make(Block::make(fetches), s);
+            fetches.clear();
+        }
+        return s;
+    }
+
+    Expr visit(const Call *op) override {
+        if (!op->is_intrinsic(Call::read_channel)) {
+            return IRMutator::visit(op);
+        }
+        string channel_name = op->args[0].as<StringImm>()->value;
+        const GatherArgInfo *info = find_tree(channel_name);
+        if (info == nullptr) {
+            return IRMutator::visit(op);
+        }
+        string caller_name = channel_name.substr(0, channel_name.size() - string(".channel").size());
+        const For *loop = nullptr;
+        for (auto l = loops.rbegin(); l != loops.rend(); l++) {
+            if (ends_with((*l)->name, "." + info->loop_name)) {
+                loop = *l;
+                break;
+            }
+        }
+        user_assert(loop != nullptr)
+            << GATHER_ERROR_MESSAGE(info->func_name, caller_name, info->loop_name)
+            << "cannot find loop " + info->loop_name + " in " + producer_name + ", which receives the data of the tree.\n";
+
+        vector<Expr> args, indices;
+        for (auto &a : op->args) {
+            args.push_back(mutate(a));
+        }
+        indices.insert(indices.end(), args.begin() + 1, args.end());
+        bool pack = info->op == GatherOp::Pack;
+        Type type = pack ? op->type.with_lanes(info->fan_in) : op->type;
+        string reg_name = caller_name + ".gather.temp";
+        internal_assert(channel_bounds.count(caller_name));
+        registers[reg_name] = {type, channel_bounds[caller_name]};
+
+        Expr step = Variable::make(Int(32), loop->name) - loop->min;
+        Expr lane = pack ? step % info->fan_in : Expr();
+        Stmt fetch = Provide::make(reg_name, {Call::make(type, Call::read_channel, args, Call::Intrinsic)}, indices);
+        fetches.push_back(IfThenElse::make(EQ::make(pack ? lane : step, 0), fetch));
+
+        Expr reg = Call::make(type, reg_name, indices, Call::Intrinsic);
+        if (!pack) {
+            return reg;
+        }
+        Expr value = Shuffle::make_extract_element(reg, info->fan_in - 1);
+        for (int l = info->fan_in - 2; l >= 0; l--) {
+            value = Select::make(EQ::make(lane, l), Shuffle::make_extract_element(reg, l), value);
+        }
+        return value;
+    }
+
+    Stmt visit(const Evaluate *op) override {
+        return with_fetches(IRMutator::visit(op));
+    }
+
+    Stmt visit(const Store *op) override {
+        return with_fetches(IRMutator::visit(op));
+    }
+
+    Stmt visit(const Provide *op) override {
+        return with_fetches(IRMutator::visit(op));
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        Expr value = mutate(op->value);
+        vector<Stmt> value_fetches;
+        value_fetches.swap(fetches);
+        Stmt body = mutate(op->body);
+        fetches.swap(value_fetches);
+        return with_fetches(LetStmt::make(op->name, value, body));
+    }
+
+    Stmt visit(const For *op) override {
+        if (producer_name == "") {
+            return IRMutator::visit(op);
+        }
+        bool kernel = ends_with(op->name, ".run_on_device");
+        if (kernel) {
+            registers.clear();
+        }
+        loops.push_back(op);
+        Stmt body = mutate(op->body);
+        loops.pop_back();
+        if (kernel) {
+            for (auto &r : registers) {
+                body = Realize::make(r.first, {r.second.first}, MemoryType::Auto, r.second.second, const_true(), body);
+            }
+            registers.clear();
+        }
+        return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+    }
+
+    Stmt visit(const Realize *op) override {
+        const GatherArgInfo *info = find_tree(op->name);
+        if (info == nullptr) {
+            return IRMutator::visit(op);
+        }
+        string caller_name = op->name.substr(0, op->name.size() - string(".channel").size());
+        channel_bounds[caller_name] = Region(op->bounds.begin(), op->bounds.end() - 1);
+        vector<Type> types(op->types);
+        if (info->op == GatherOp::Pack) {
+            types[0] = types[0].with_lanes(info->fan_in);
+        }
+        return Realize::make(op->name, types, op->memory_type, op->bounds, op->condition, mutate(op->body));
+    }
+
+    Stmt visit(const ProducerConsumer *op) override {
+        if (op->is_producer) {
+            string old_producer_name = producer_name;
+            producer_name = op->name;
+            Stmt body = mutate(op->body);
+            producer_name = old_producer_name;
+            return ProducerConsumer::make(op->name, op->is_producer, body);
+        }
+        return ProducerConsumer::make(op->name, op->is_producer, mutate(op->body));
+    }
+
+public:
+    UnpackGatheredData(const map<string, GatherArgInfo> &_gather_arg_info)
+        : gather_arg_info(_gather_arg_info), producer_name("") {}
+};
+
 void find_gather_loops(
     const GatherArgs& gather_arg_groups,
     const map<string, vector<string>>& reverse_call_graph,
@@ -775,7 +1091,8 @@ Stmt gather_data(Stmt s, const std::map<std::string, Function> &env){
         if (!gather_params.empty()){
             auto t = gather_params[0];
             debug(3) << " test for GatherItem " << t.func_name << " "
-                     << t.loop_name << " " << ((t.strategy == GatherStrategy::Up || t.strategy == GatherStrategy::FPGAReg) ? "Up" : "Down") << "\n";
+                     << t.loop_name << " " << (t.strategy == GatherStrategy::Tree ? "Tree" :
+                                               (t.strategy == GatherStrategy::Up || t.strategy == GatherStrategy::FPGAReg) ? "Up" : "Down") << "\n";
             TestGathering ts(caller_name, t.loop_name, t.func_name, t.strategy, env);
             s.accept(&ts);
             user_assert(ts.found_loop != nullptr || ts.vec_loop_name != "")
@@ -785,6 +1102,10 @@ Stmt gather_data(Stmt s, const std::map<std::string, Function> &env){
             user_assert(ts.found_call.defined())
                 << GATHER_ERROR_MESSAGE(t.func_name, caller_name, t.loop_name)
                 << t.func_name + " is not found in " + caller_name + ".\n";
+            user_assert(ts.found_loop == nullptr ||
+                        (ts.found_loop->min.as<IntImm>() && ts.found_loop->extent.as<IntImm>()))
+                << GATHER_ERROR_MESSAGE(t.func_name, caller_name, t.loop_name)
+                << "the min and extent of loop " + t.loop_name + " are expected to be constants.\n";
 
             // record arguments
             assert(gather_arg_info.find(caller_name) == gather_arg_info.end());
@@ -796,7 +1117,25 @@ Stmt gather_data(Stmt s, const std::map<std::string, Function> &env){
                                                                             ts.vec_loop_name,
                                                                             ts.unroll_names,
                                                                             ts.unroll_min_extents,
-                                                                            t.strategy)));
+                                                                            t.strategy,
+                                                                            t.loop_name,
+                                                                            t.fan_in,
+                                                                            t.op)));
+            if (t.strategy == GatherStrategy::Tree && ts.found_loop != nullptr) {
+                int extent = ts.found_loop->extent.as<IntImm>()->value;
+                user_assert(t.op != GatherOp::Pack || extent % t.fan_in == 0)
+                    << GATHER_ERROR_MESSAGE(t.func_name, caller_name, t.loop_name)
+                    << "cannot pack the data of " << extent << " iterations into vectors of " << t.fan_in << ".\n";
+                if (t.op != GatherOp::None) {
+                    const Evaluate *write = ts.write_channel_stmt.as<Evaluate>();
+                    const Call *write_call = write ? write->value.as<Call>() : nullptr;
+                    user_assert(write_call && write_call->is_intrinsic(Call::write_channel) &&
+                                equal(write_call->args[1], ts.found_call))
+                        << GATHER_ERROR_MESSAGE(t.func_name, caller_name, t.loop_name)
+                        << "a gathering tree can reduce or pack data only if " + caller_name
+                        << " sends the data of " + t.func_name + " unchanged to a device consumer.\n";
+                }
+            }
         }
     }
 
@@ -823,6 +1162,8 @@ Stmt gather_data(Stmt s, const std::map<std::string, Function> &env){
         s.accept(&cs);
         ModifyGatherLoop ms(cs.loop_info);
         s = ms.mutate(s);
+        UnpackGatheredData us(gather_arg_info);
+        s = us.mutate(s);
     }
 
 
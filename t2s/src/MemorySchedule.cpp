@@ -18,12 +18,14 @@
 *******************************************************************************/
 #include <list>
 #include "../../Halide/src/CSE.h"
+#include "../../Halide/src/ExprUsesVar.h"
 #include "../../Halide/src/IR.h"
 #include "../../Halide/src/IREquality.h"
 #include "../../Halide/src/IRMutator.h"
 #include "../../Halide/src/IROperator.h"
 #include "../../Halide/src/Simplify.h"
 #include "../../Halide/src/Substitute.h"
+#include "../../Halide/src/Target.h"
 #include "./MemorySchedule.h"
 #include "./Utilities.h"
 
@@ -140,6 +142,9 @@ inline string addr_name(const string &buf, const string &type,
 inline string buf_name(string name = "") {
     return name + "_buf";
 }
+inline string bank_name(string name) {
+    return "var." + name + "_buf.bank";
+}
 
 int space_loop_extents() {
     int sz = 1;
@@ -1192,7 +1197,9 @@ private:
         return Stmt();
     }
 
-    Stmt make_load_insts(string name) {
+    // Load the tile into the buffer starting at buf_offs. The tile is addressed with the
+    // enclosing loop variables, which can be replaced to load the tile of another iteration.
+    Stmt make_load_insts(string name, Expr buf_offs = 0, const map<string, Expr> &iter = {}) {
         // Eliminate _im suffix
         auto pos = name.find("_im");
         internal_assert(pos != name.npos);
@@ -1215,7 +1222,7 @@ private:
             call_args.push_back(simplify(var_addr_1 + in.off_1));
 
             int size = in.ext_0 * in.ext_1;
-            Expr store_idx = Ramp::make(acc_size, 1, size);
+            Expr store_idx = Ramp::make(simplify(buf_offs + acc_size), 1, size);
             acc_size += size;
             call_args.push_back(buf_var);
             call_args.push_back(store_idx);
@@ -1230,11 +1237,54 @@ private:
         auto addrs = gpu_bufs[name].iter_loop.addr.as<Shuffle>()->vectors;
         for (size_t i = 0; i < addrs.size(); i++) {
             string let_addr_name = addr_name(name, "load", "", i);
-            block = LetStmt::make(let_addr_name, addrs[i], block);
+            block = LetStmt::make(let_addr_name, substitute(iter, addrs[i]), block);
         }
         return block;
     }
 
+    int buf_elems(string name) {
+        int size = 1;
+        for (auto &r : gpu_bufs[name].allocation) {
+            size *= int_val(r.extent);
+        }
+        return size;
+    }
+
+    // Ping-pong the buffer between two banks across the iterations of the loop.
+    // Transform the IR like this:
+    // X_buf[ramp(0, 1, size)] = the tile at k = min                // in prologue
+    // for (k, min, extent) {
+    //   let X_buf.bank = (k - min) % 2
+    //   if (k < min + extent - 1)
+    //     X_buf[ramp((1 - X_buf.bank) * size, 1, size)] = the tile at k + 1
+    //   ... = X_buf[access_idx + X_buf.bank * size]
+    //   gpu_thread_barrier()                                       // for SLM only
+    // }
+    // The loads of the next tile are issued before the current tile is consumed, so that
+    // the memory latency is hidden behind the computation.
+    Stmt make_double_buffer(string name, const For *op, Stmt body, Stmt &prologue) {
+        const auto &info = gpu_bufs[name];
+        int size = buf_elems(name);
+        Expr loop_var = Variable::make(Int(32), op->name);
+        Expr bank_var = make_var(bank_name(name));
+
+        Stmt prefetch = make_load_insts(name, (1 - bank_var) * size, {{ op->name, loop_var + 1 }});
+        prefetch = IfThenElse::make(loop_var < op->min + op->extent - 1, prefetch);
+        body = Block::make(prefetch, body);
+        Stmt first = make_load_insts(name, 0, {{ op->name, op->min }});
+        if (info.fp.store_in == MemoryType::GPUShared) {
+            // SLM is shared by the threads in a group: the tile must be completely written
+            // before it is read, and completely read before it is overwritten.
+            Stmt barrier = Evaluate::make(Call::make(Int(32), Call::gpu_thread_barrier,
+                                                     vector<Expr>(), Call::Intrinsic));
+            body = Block::make(body, barrier);
+            first = Block::make(first, barrier);
+        }
+        body = LetStmt::make(bank_name(name), (loop_var - op->min) % 2, body);
+        prologue = prologue.defined() ? Block::make(prologue, first) : first;
+        return body;
+    }
+
     Stmt build_enclosing_loops(string name, bool is_init, const For *op) {
         const auto &info = gpu_bufs[name];
         const auto &loop = is_init ?info.init_loop :info.iter_loop;
@@ -1286,7 +1336,20 @@ private:
     }
 
     Stmt visit(const For *op) override {
+        if (op->for_type == ForType::GPUThread || op->for_type == ForType::GPUBlock) {
+            // The iterations of a GPU loop run in parallel, each using only its own tile. So a buffer stored
+            // at a GPU loop has no next tile to prefetch, and is not double buffered: its tile is loaded at
+            // the beginning of the body, inside the allocation of the buffer in the kernel.
+            for (auto &b : gpu_bufs) {
+                if (extract_token(op->name, 3) == b.second.fp.store_at && b.second.fp.num_buffers == 2) {
+                    user_warning << "The input " << b.first << " is fetched at GPU loop " << b.second.fp.store_at
+                                 << ", whose iterations run in parallel. It is fetched into 1 buffer, instead of 2.\n";
+                    b.second.fp.num_buffers = 1;
+                }
+            }
+        }
         Stmt body = mutate(op->body);
+        Stmt prologue;
         // True at the beginning of a kernel (the first GPU loop)
         in_kernel = (in_kernel==false && op->for_type==ForType::GPUThread) ? true : false;
 
@@ -1312,8 +1375,12 @@ private:
                 // }
                 // Insert loops enclosing the load instructions
                 // Stmt iter_for = build_enclosing_loops(name, false, op);
-                Stmt iter_for = make_load_insts(name);
-                body = Block::make(iter_for, body);
+                if (info.fp.num_buffers == 2) {
+                    body = make_double_buffer(name, op, body, prologue);
+                } else {
+                    Stmt iter_for = make_load_insts(name);
+                    body = Block::make(iter_for, body);
+                }
                 // if (sz > 0) {
                 //     Stmt init_for = build_fetch_loops(name, true, op->device_api);
                 //     out_body = out_body.defined() ?Block::make(out_body, init_for) :init_for;
@@ -1336,11 +1403,17 @@ private:
                 for (size_t i = 0; i < info.allocation.size(); i++) {
                     buf_size.push_back(info.allocation[i].extent);
                 }
+                if (info.fp.num_buffers == 2) {
+                    buf_size.push_back(2);
+                }
                 body = Allocate::make(buf_name(name), image_param[name].type(),
                                     info.fp.store_in, buf_size, const_true(), body);
             }
         }
         body = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        if (prologue.defined()) {
+            body = Block::make(prologue, body);
+        }
         // if (out_body.defined()) {
         //     body = Block::make(out_body, body);
         // }
@@ -1353,6 +1426,9 @@ private:
         for (auto pair : gpu_bufs) {
             if (name == pair.first) {
                 Expr access_idx = gpu_bufs[name].access_idx;
+                if (pair.second.fp.num_buffers == 2) {
+                    access_idx += make_var(bank_name(name)) * buf_elems(name);
+                }
                 return Load::make(op->type, buf_name(name), access_idx,
                                   op->image, op->param, op->predicate, op->alignment);
             }
@@ -1568,6 +1644,136 @@ public:
     }
 };
 
+// Vectorize the innermost loop in a kernel if its body is element-wise along the loop, so
+// that the systolic array is emitted as a register-blocked micro-kernel. For GEMM:
+//   for (iii, 0, III)                                  // unrolled
+//     for (jjj, 0, JJJ)                                // unrolled
+//       X[iii*JJJ + jjj] = X[iii*JJJ + jjj] + A_buf[f(iii)] * B_buf[g + jjj]
+// becomes
+//   for (iii, 0, III)                                  // unrolled
+//     X[ramp(iii*JJJ, 1, JJJ)] = X[ramp(iii*JJJ, 1, JJJ)] + A_buf[f(iii)] * B_buf[ramp(g, 1, JJJ)]
+// which is a row of multiply-adds in CM, with A_buf[f(iii)] as a scalar region and B_buf
+// reused across the rows, instead of III*JJJ scalar multiply-adds.
+class GPUMicroKernelVectorizer : public IRMutator
+{
+    // The loop can be vectorized if every store writes distinct elements along the loop,
+    // every load of a stored buffer reads the element being stored (no loop-carried dependence),
+    // and every index is an affine function of the loop variable with a constant stride.
+    class CheckElementwise : public IRVisitor
+    {
+        const string &var;
+        map<string, Expr> stores;
+        vector<pair<string, Expr>> loads;
+
+        // The stride of the index along the loop, or -1 if it is not a non-negative constant
+        int64_t stride_of(Expr index) {
+            Expr next = substitute(var, Variable::make(Int(32), var) + 1, index);
+            Expr stride = simplify(next - index);
+            const IntImm *imm = stride.as<IntImm>();
+            return (imm && imm->value >= 0) ? imm->value : -1;
+        }
+
+        bool is_register(const string &name) {
+            return ends_with(name, buf_name()) || func_info.count(name) > 0;
+        }
+
+    public:
+        using IRVisitor::visit;
+        bool ok = true;
+
+        CheckElementwise(const string &_v)
+            : var(_v) {}
+
+        void visit(const For *op) override { ok = false; }
+        void visit(const Allocate *op) override { ok = false; }
+        void visit(const Realize *op) override { ok = false; }
+
+        void visit(const Call *op) override {
+            if (op->is_intrinsic(Call::read_channel) || op->is_intrinsic(Call::write_channel)
+                || op->is_intrinsic(Call::cm_load_2d) || op->is_intrinsic(Call::cm_store_2d)) {
+                ok = false;
+                return;
+            }
+            // Calls are printed as scalar functions in CM
+            for (auto &arg : op->args) {
+                if (expr_uses_var(arg, var))
+                    ok = false;
+            }
+            IRVisitor::visit(op);
+        }
+
+        void visit(const Let *op) override {
+            ok = ok && !expr_uses_var(op->value, var);
+            IRVisitor::visit(op);
+        }
+
+        void visit(const LetStmt *op) override {
+            ok = ok && !expr_uses_var(op->value, var);
+            IRVisitor::visit(op);
+        }
+
+        void visit(const IfThenElse *op) override {
+            // Vectorized stores are not predicated in CM
+            ok = ok && !expr_uses_var(op->condition, var);
+            IRVisitor::visit(op);
+        }
+
+        void visit(const Load *op) override {
+            ok = ok && is_register(op->name) && is_one(op->predicate)
+                    && stride_of(op->index) >= 0;
+            loads.push_back({ op->name, op->index });
+            IRVisitor::visit(op);
+        }
+
+        void visit(const Store *op) override {
+            ok = ok && is_register(op->name) && is_one(op->predicate)
+                    && stride_of(op->index) > 0 && stores.count(op->name) == 0;
+            stores[op->name] = op->index;
+            IRVisitor::visit(op);
+        }
+
+        bool is_elementwise() {
+            if (!ok || stores.empty())
+                return false;
+            for (auto &ld : loads) {
+                auto it = stores.find(ld.first);
+                if (it != stores.end() && !equal(simplify(ld.second), simplify(it->second)))
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    bool in_kernel = false;
+    bool has_inner_loop = false;
+
+public:
+    using IRMutator::visit;
+
+    Stmt visit(const For *op) override {
+        bool old_in_kernel = in_kernel;
+        if (op->for_type == ForType::GPUThread)
+            in_kernel = true;
+        has_inner_loop = false;
+        Stmt body = mutate(op->body);
+        bool is_innermost = !has_inner_loop;
+        has_inner_loop = true;
+        in_kernel = old_in_kernel;
+
+        const IntImm *extent = op->extent.as<IntImm>();
+        if (in_kernel && is_innermost && extent && extent->value > 1 && extent->value <= 32
+            && (op->for_type == ForType::Serial || op->for_type == ForType::PragmaUnrolled)) {
+            CheckElementwise checker(op->name);
+            body.accept(&checker);
+            if (checker.is_elementwise()) {
+                debug(1) << "Vectorize " << op->name << " into a micro-kernel\n";
+                return For::make(op->name, op->min, op->extent, ForType::Vectorized, op->device_api, body);
+            }
+        }
+        return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+    }
+};
+
 void update_loop_vars(Stmt s) {
     LoopInfoCollector lc;
     s.accept(&lc);
@@ -1596,7 +1802,7 @@ Stmt do_prepare_memory_schedule(Stmt s, const map<string, Function> &env, const
     return s;
 }
 
-Stmt do_memory_schedule(Stmt s, const map<string, Function> &env) {
+Stmt do_memory_schedule(Stmt s, const map<string, Function> &env, const Target &t) {
     // The loop information is collected before performing space-time transform
     if (!loop_vars.empty()) {
         GPUBufferInserter gb_inserter(env);
@@ -1611,6 +1817,10 @@ Stmt do_memory_schedule(Stmt s, const map<string, Function> &env) {
         s = auto_unroll.mutate(s);
         s = gpu_ipm.mutate(s);
         s = rda.mutate(s);
+        if (!t.has_feature(Target::DisableGPUMicroKernel)) {
+            GPUMicroKernelVectorizer gpu_mkv;
+            s = gpu_mkv.mutate(s);
+        }
     }
     return s;
 }
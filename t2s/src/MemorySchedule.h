@@ -29,7 +29,9 @@ struct Adaptor {
 };
 
 Stmt do_prepare_memory_schedule(Stmt s, const std::map<std::string, Function> &env, const Adaptor &stt);
-Stmt do_memory_schedule(Stmt s, const std::map<std::string, Function> &env);
+// Insert the buffers and stores of the GPU kernels. Unless Target::DisableGPUMicroKernel, the systolic array of
+// a kernel is also vectorized into a register-blocked micro-kernel where its body allows.
+Stmt do_memory_schedule(Stmt s, const std::map<std::string, Function> &env, const Target &t);
 
 } // namespace Internal
 } // namespace Halide
@@ -22,6 +22,14 @@ Func &Func::relay(Func f, VarOrRVar loop) {
     return *this;
 }
 
+Func &Func::relay(Func f, VarOrRVar loop, int segment) {
+    user_assert(segment > 0) << "Func " << this->name() << " relays data with segments of "
+        << segment << " PEs. A segment is expected to have at least 1 PE.\n";
+    relay(f, loop);
+    func.definition().schedule().relay_params().back().segment = segment;
+    return *this;
+}
+
 namespace Internal {
 
 string undecorated_arg(Expr arg) {
@@ -115,9 +123,23 @@ class DataRelaying : public IRMutator {
         Expr PE_arg;
         Expr PE_extent;
         Expr lin_extent;
+        Expr seg_extent;    // PEs in a segment of a pipe
+        int segments;       // Segments of a pipe, each with its own head writing its own channel
         Expr depth;
     } pipe_alloc;
 
+    // Args to a pipe: [bank][segment][slot], or [bank][slot] if the pipe is not segmented
+    vector<Expr> pipe_args(Expr bank, Expr seg, Expr slot) {
+        vector<Expr> args;
+        args.push_back(pipe_alloc.name + ".shreg");
+        args.push_back(bank);
+        if (pipe_alloc.segments > 1) {
+            args.push_back(seg);
+        }
+        args.push_back(slot);
+        return args;
+    }
+
     void get_pipe_alloc() {
         pipe_alloc.name = param.from_func + ".pipe";
         // Bank loop
@@ -147,11 +169,24 @@ class DataRelaying : public IRMutator {
         pipe_alloc.PE_arg    = simplify(pipe_alloc.PE_arg);
         pipe_alloc.PE_extent = simplify(pipe_alloc.PE_extent);
         pipe_alloc.lin_extent = simplify(pipe_alloc.lin_extent);
-        pipe_alloc.depth = simplify(pipe_alloc.lin_extent * (pipe_alloc.PE_extent-1) + 1);
+        // Segments
+        pipe_alloc.seg_extent = pipe_alloc.PE_extent;
+        pipe_alloc.segments = 1;
+        if (param.segment > 0) {
+            auto PE_extent = pipe_alloc.PE_extent.as<IntImm>();
+            user_assert(PE_extent && PE_extent->value % param.segment == 0)
+                << "Func " << param.to_func << " relays data with segments of " << param.segment
+                << " PEs, which is expected to divide the number of PEs along a pipe ("
+                << pipe_alloc.PE_extent << ").\n";
+            pipe_alloc.seg_extent = param.segment;
+            pipe_alloc.segments = PE_extent->value / param.segment;
+        }
+        pipe_alloc.depth = simplify(pipe_alloc.lin_extent * (pipe_alloc.seg_extent-1) + 1);
         debug(4) << "Pipe_alloc: "      << pipe_alloc.name
                  << "\n\t Bank extent: " << pipe_alloc.bank_extent
                  << "\n\t PE arg: "     << pipe_alloc.PE_arg
                  << "\n\t PE extent: "  << pipe_alloc.PE_extent
+                 << "\n\t segments: "   << pipe_alloc.segments
                  << "\n\t lin extent: " << pipe_alloc.lin_extent
                  << "\n\t lin cond:"    << pipe_alloc.lin_cond
                  << "\n\t depth: "      << pipe_alloc.depth << "\n";
@@ -197,31 +232,43 @@ class DataRelaying : public IRMutator {
     //   } // Z.pipe.p
     // } // Z.pipe.b
     //
+    // With segmented pipes, every segment shifts separately, i.e. there is a loop Z.pipe.s over the segments
+    // between Z.pipe.b and Z.pipe.p, and Z.pipe.p ranges over the PEs of a segment.
     Stmt make_pipe_shift() {
         string lin_name  = unique_name(pipe_alloc.name + ".l");
         string PE_name   = unique_name(pipe_alloc.name + ".p");
+        string seg_name  = unique_name(pipe_alloc.name + ".s");
         string bank_name = unique_name(pipe_alloc.name + ".b");
         Expr var_lin  = Variable::make(Int(32), lin_name);
         Expr var_PE   = Variable::make(Int(32), PE_name);
+        Expr var_seg  = Variable::make(Int(32), seg_name);
         Expr var_bank = Variable::make(Int(32), bank_name);
         // Shift operation
         Expr arg_shift = simplify(var_PE * pipe_alloc.lin_extent + var_lin);
         Expr read_shift = Call::make(pipe_alloc.t, Call::IntrinsicOp::read_shift_reg,
-                                    { pipe_alloc.name+".shreg", var_bank, arg_shift+1 }, Call::CallType::PureIntrinsic);
+                                    pipe_args(var_bank, var_seg, arg_shift+1), Call::CallType::PureIntrinsic);
+        vector<Expr> write_shift_args = pipe_args(var_bank, var_seg, arg_shift);
+        write_shift_args.push_back(read_shift);
         Expr write_shift = Call::make(pipe_alloc.t, Call::IntrinsicOp::write_shift_reg,
-                                    { pipe_alloc.name+".shreg", var_bank, arg_shift, read_shift }, Call::CallType::PureIntrinsic);
+                                    write_shift_args, Call::CallType::PureIntrinsic);
         // Linear loop
         Stmt for_lin = For::make(lin_name, 0, pipe_alloc.lin_extent-1, ForType::Unrolled, DeviceAPI::None, Evaluate::make(write_shift));
         // Shift operation at PE edges
         Expr arg_edge = simplify(var_PE * pipe_alloc.lin_extent + (pipe_alloc.lin_extent-1));
         Expr read_edge = Call::make(pipe_alloc.t, Call::IntrinsicOp::read_shift_reg,
-                                    { pipe_alloc.name+".shreg", var_bank, arg_edge+1 }, Call::CallType::PureIntrinsic);
+                                    pipe_args(var_bank, var_seg, arg_edge+1), Call::CallType::PureIntrinsic);
         Expr read_edge_regs = Call::make(pipe_alloc.t, Call::IntrinsicOp::fpga_reg, { read_edge }, Call::CallType::PureIntrinsic);
+        vector<Expr> write_edge_args = pipe_args(var_bank, var_seg, arg_edge);
+        write_edge_args.push_back(read_edge_regs);
         Expr write_edge = Call::make(pipe_alloc.t, Call::IntrinsicOp::write_shift_reg,
-                                    { pipe_alloc.name+".shreg", var_bank, arg_edge, read_edge_regs }, Call::CallType::PureIntrinsic);
+                                    write_edge_args, Call::CallType::PureIntrinsic);
         // PE loop
         Stmt PE_body = Block::make(for_lin, Evaluate::make(write_edge));
-        Stmt for_PE = For::make(PE_name, 0, pipe_alloc.PE_extent-1, ForType::Unrolled, DeviceAPI::None, PE_body);
+        Stmt for_PE = For::make(PE_name, 0, pipe_alloc.seg_extent-1, ForType::Unrolled, DeviceAPI::None, PE_body);
+        // Segment loop
+        if (pipe_alloc.segments > 1) {
+            for_PE = For::make(seg_name, 0, pipe_alloc.segments, ForType::Unrolled, DeviceAPI::None, for_PE);
+        }
         // Bank loop
         Stmt for_bank = For::make(bank_name, 0, pipe_alloc.bank_extent, ForType::Unrolled, DeviceAPI::None, for_PE);
         return for_bank;
@@ -236,7 +283,24 @@ class DataRelaying : public IRMutator {
     // if (pipe.iter - pipe.base < lin_extents * PE_extents) {
     //   write_channel("Out.channel", Out.channel.temp)
     // }
+    //
+    // With segmented pipes, the head of every segment writes its own channel:
+    // unrolled for (Z.pipe.s, 0, pipe_alloc.segments) {
+    //   ... Out.channel.temp[Z.pipe.b] = read_shift_reg(Z.pipe, Z.pipe.b, Z.pipe.s, 0) ...
+    //   if (pipe.iter - pipe.base < lin_extents * PEs in a segment) {
+    //     write_channel("Out.channel", Out.channel.temp, Z.pipe.s)
+    //   }
+    // }
     Stmt make_write() {
+        if (pipe_alloc.segments == 1) {
+            return make_write(Expr());
+        }
+        string seg_name = unique_name(pipe_alloc.name + ".s");
+        Stmt write = make_write(Variable::make(Int(32), seg_name));
+        return For::make(seg_name, 0, pipe_alloc.segments, ForType::Unrolled, DeviceAPI::None, write);
+    }
+
+    Stmt make_write(Expr seg) {
         string chn_temp_name = param.to_func + ".channel.temp";
         auto num_bank = pipe_alloc.bank_extent.as<IntImm>();
         internal_assert(num_bank);
@@ -247,12 +311,15 @@ class DataRelaying : public IRMutator {
         vector<Expr> write_args;
         write_args.push_back(param.to_func + ".channel");
         write_args.push_back(read_temp);
+        if (pipe_alloc.segments > 1) {
+            write_args.push_back(seg);
+        }
         Expr write_chn = Call::make(vec_t, Call::IntrinsicOp::write_channel, write_args, Call::CallType::PureIntrinsic);
 
         // Flag is true
         Expr read_iter = Call::make(Int(32), pipe_alloc.name+".iter.temp", {}, Call::Intrinsic);
         Expr read_base = Call::make(Int(32), pipe_alloc.name+".base.temp", {}, Call::Intrinsic);
-        Expr bound = pipe_alloc.lin_extent * pipe_alloc.PE_extent;
+        Expr bound = pipe_alloc.lin_extent * pipe_alloc.seg_extent;
         Expr if_cond = simplify(read_iter - read_base < bound);
         Stmt if_stmt = IfThenElse::make(if_cond, Evaluate::make(write_chn));
 
@@ -268,7 +335,7 @@ class DataRelaying : public IRMutator {
         // Fill the temp variable
         Expr var_bank = Variable::make(Int(32), bank_name);
         Expr read_pipe = Call::make(pipe_alloc.t, Call::IntrinsicOp::read_shift_reg,
-                                    { pipe_alloc.name+".shreg", var_bank, 0 }, Call::CallType::PureIntrinsic);
+                                    pipe_args(var_bank, seg, 0), Call::CallType::PureIntrinsic);
         Stmt write_temp = Provide::make(chn_temp_name, { read_pipe }, { var_bank });
         Stmt loop_body = Block::make(write_temp, dummy_for_bank);
         Stmt for_bank = For::make(bank_name, 0, pipe_alloc.bank_extent, ForType::Unrolled, DeviceAPI::None, loop_body);
@@ -345,12 +412,39 @@ public:
                         args.push_back(e);
                     }
                 }
+                if (pipe_alloc.segments > 1) {
+                    // Read the channel of the segment the current PE belongs to
+                    args.push_back(consumer_segment(op));
+                }
                 return Call::make(op->type, Call::IntrinsicOp::read_channel, args, Call::CallType::PureIntrinsic);
             }
         }
         return IRMutator::visit(op);
     }
 
+    // The segment of a pipe that the PE the consumer reads belongs to. The PE is linearized from the
+    // args of the consumer's read in the same way as pipe_alloc.PE_arg.
+    Expr consumer_segment(const Call *read) {
+        Expr PE_arg = 0, PE_extent = 1;
+        int bank = get_dim(param.bank_loop, alloc);
+        for (size_t i = 0; i < alloc.PE_dims.size(); i++) {
+            if (alloc.PE_dims[i] == bank) {
+                continue;
+            }
+            string PE_loop = undecorated_arg(alloc.args[alloc.PE_dims[i]]);
+            auto it = std::find_if(read->args.begin() + 1, read->args.end(), [&](const Expr &e) {
+                auto v = e.as<Variable>();
+                return v && extract_last_token(v->name) == PE_loop;
+            });
+            user_assert(it != read->args.end())
+                << "Func " << param.to_func << " relays data with segmented pipes, but its read of "
+                << param.from_func << " is not indexed by loop " << PE_loop << ".\n";
+            PE_arg += (*it) * PE_extent;
+            PE_extent *= alloc.PE_extents[i];
+        }
+        return simplify(PE_arg / pipe_alloc.seg_extent);
+    }
+
     Stmt visit(const IfThenElse *op) override {
         auto eval = op->then_case.as<Evaluate>();
         if (eval) {
@@ -361,10 +455,16 @@ public:
                 if (inside_pipe && p->value == param.to_func + ".channel") {
                     pipe_alloc.emit_cond = op->condition;
                     // Replace the write_channel with write_shift_reg to the pipe
+                    Expr bank = alloc.args[get_dim(param.bank_loop, alloc)];
                     vector<Expr> args;
-                    args.push_back(pipe_alloc.name+".shreg");
-                    args.push_back(alloc.args[get_dim(param.bank_loop, alloc)]);
-                    args.push_back(pipe_alloc.lin_extent * pipe_alloc.PE_arg);
+                    if (pipe_alloc.segments > 1) {
+                        // A PE writes the pipe of its segment at its position inside the segment
+                        Expr seg = simplify(pipe_alloc.PE_arg / pipe_alloc.seg_extent);
+                        Expr slot = simplify(pipe_alloc.lin_extent * (pipe_alloc.PE_arg % pipe_alloc.seg_extent));
+                        args = pipe_args(bank, seg, slot);
+                    } else {
+                        args = pipe_args(bank, Expr(), pipe_alloc.lin_extent * pipe_alloc.PE_arg);
+                    }
                     args.push_back(call->args[1]);    // Value
                     Expr write_pipe = Call::make(call->type, Call::IntrinsicOp::write_shift_reg, args, Call::CallType::PureIntrinsic);
                     Stmt write_pipe_stmt = Evaluate::make(write_pipe);
@@ -424,7 +524,15 @@ public:
         if (op->name == param.to_func + ".channel") {
             Region channel_bounds;
             channel_bounds.push_back(Range(0, pipe_alloc.bank_extent));
-            channel_bounds.push_back(op->bounds.back());
+            if (pipe_alloc.segments > 1) {
+                // A channel per segment. The consumer reads the segments in turn, so a channel should
+                // be able to hold all the data of its segment while the consumer reads the previous ones.
+                channel_bounds.push_back(Range(0, pipe_alloc.segments));
+                Expr depth = simplify(max(op->bounds.back().extent, pipe_alloc.lin_extent * pipe_alloc.seg_extent));
+                channel_bounds.push_back(Range(op->bounds.back().min, depth));
+            } else {
+                channel_bounds.push_back(op->bounds.back());
+            }
             return Realize::make(op->name, op->types, op->memory_type, channel_bounds, op->condition, body);
         }
         // We need to reserve sufficient space to accomodate output values
@@ -433,6 +541,9 @@ public:
         if (op->name == param.from_func + ".shreg") {
             Region pipe_bounds;
             pipe_bounds.push_back(Range(0, pipe_alloc.bank_extent));
+            if (pipe_alloc.segments > 1) {
+                pipe_bounds.push_back(Range(0, pipe_alloc.segments));
+            }
             pipe_bounds.push_back(Range(0, pipe_alloc.depth));
             body = Realize::make(pipe_alloc.name+".shreg", op->types, op->memory_type, pipe_bounds, const_true(), body);
         }
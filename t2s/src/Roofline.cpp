@@ -110,7 +110,7 @@ double FMax() {
 }
 
 // Execution time in terms of nanoseconds
-double ExecTime(const char* kernel_name) {
+double ExecTime(const char* kernel_name, bool verbose) {
     char *bitstream_dir = bitstream_directory();
     char *exec_time_file = concat_directory_and_file(bitstream_dir, "exec_time.txt");
 
@@ -118,7 +118,9 @@ double ExecTime(const char* kernel_name) {
     double _ret = 0;
   
     if ((fp = fopen(exec_time_file, "r")) == NULL) {
-        printf("Cannot open %s!\n", exec_time_file);
+        if (verbose) {
+            printf("Cannot open %s!\n", exec_time_file);
+        }
     } else {
         fscanf(fp, "%lf", &_ret);
         if (kernel_name) {
@@ -126,14 +128,16 @@ double ExecTime(const char* kernel_name) {
             double tmp_t;
             while (fscanf(fp, "%s %lf\n", tmp_s, &tmp_t) != EOF) {
                 if (strcmp(tmp_s, kernel_name) == 0) {
-                    printf("kernel %s exec time: %lf\n", tmp_s, tmp_t);
+                    if (verbose) {
+                        printf("kernel %s exec time: %lf\n", tmp_s, tmp_t);
+                    }
                     _ret = tmp_t;
                     break;
                 }
             }
         }
+        fclose(fp);
     }
-    fclose(fp);
     free(bitstream_dir);
     free(exec_time_file);
     return _ret;
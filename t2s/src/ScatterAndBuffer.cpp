@@ -16,6 +16,7 @@
 *
 * SPDX-License-Identifier: BSD-2-Clause-Patent
 *******************************************************************************/
+#include <algorithm>
 #include <set>
 #include <string>
 #include <queue>
@@ -42,12 +43,25 @@ Func &Func::buffer(Func f, VarOrRVar loop, BufferStrategy buffer_strategy, Buffe
     invalidate_cache();
     user_assert(this->defined()) <<"Func " << this->name() << " is undefined";
     user_assert(f.defined()) <<"Func " << f.name() << " is undefined";
-    user_assert(buffer_strategy == BufferStrategy::Double) << "Only BufferStrategy::Double is supported so far.";
+    user_assert(buffer_strategy == BufferStrategy::Double || buffer_strategy == BufferStrategy::Triple)
+        << "Only BufferStrategy::Double and BufferStrategy::Triple are supported so far.";
 
     std::vector<Internal::BufferItem> &buffer_params = func.definition().schedule().buffer_params();
     user_assert(buffer_params.empty())
         << "Inserting more than 1 buffer to Func " << func.name() << " is unexpected. We support only one buffer in a function so far\n";
     buffer_params.push_back(Internal::BufferItem(f.name(), loop.name(), buffer_strategy,read_strategy));
+    buffer_params.back().num_buffers = (buffer_strategy == BufferStrategy::Triple) ? 3 : 2;
+    return *this;
+}
+
+Func &Func::buffer(Func f, VarOrRVar loop, int num_buffers, BufferPrefetch prefetch, BufferLayout layout) {
+    user_assert(num_buffers >= 2) << "Func " << this->name() << " buffers data with " << num_buffers
+        << " buffers. At least 2 buffers are expected.";
+    buffer(f, loop, BufferStrategy::Double, BufferReadStrategy::Block);
+    Internal::BufferItem &item = func.definition().schedule().buffer_params().back();
+    item.num_buffers = num_buffers;
+    item.prefetch = prefetch;
+    item.layout = layout;
     return *this;
 }
 
@@ -81,6 +95,9 @@ public:
     Expr read_node = nullptr;      // The expression that reads the data from the producer
     Expr read_condition = nullptr; // Path conditioin to read_node. It is the same condition the producer writes into its output channel.
     BufferStrategy buffer_strategy = BufferStrategy::Double;
+    int num_buffers = 2;           // Number of buffers to rotate through
+    BufferPrefetch buffer_prefetch = BufferPrefetch::Tile;
+    BufferLayout buffer_layout = BufferLayout::Default;
     ScatterStrategy scatter_strategy = ScatterStrategy::Up; 
 
     // Full names, mins, extents and types of the loops around the read node.
@@ -898,6 +915,9 @@ private:
     const Expr &original_read_node; // The expression in the consumer that reads the data from the producer
     const Expr &original_read_condition; // Path condition to the original_read_node. It is the same condition the producer writes to its output channel.
     const BufferStrategy buffer_strategy;
+    const int num_buffers;          // Number of buffers a tile rotates through
+    const BufferPrefetch buffer_prefetch;
+    const BufferLayout buffer_layout;
     const ScatterStrategy scatter_strategy;
     const vector<tuple<string, Expr, Expr, ForType>> &loops; // Full names, mins, extents and types of the loops around the read node.
 
@@ -913,6 +933,11 @@ private:
     uint32_t CYCLES_PER_PERIOD;
     uint32_t INIT;           // The cycle in a period when buffer writing should start.
     Expr PERIODS;            // Total periods
+    int32_t NUM_BUFFERS;     // Number of buffers a tile rotates through. The tile written in period p is in buffer p % NUM_BUFFERS.
+    uint32_t LAG;            // Cycles from the start of a period to the start of reading the tile written in the period
+    bool PARTIAL;            // Start reading a tile before it is completely written?
+    bool BANKED;             // Every PE has its own bank in the last dimension of a buffer?
+    bool DOUBLE_BUFFER;      // Plain double buffering (NUM_BUFFERS = 2, LAG = CYCLES_PER_PERIOD) as in the design doc?
     Expr cycle;              // Current cycle
     Expr in_v;               // Incoming value read from the input channel in the current cycle
     Expr value;              // Incoming value stored in shift registers for scattering
@@ -945,6 +970,12 @@ private:
     Expr _owner;
     Expr _idx;
     Expr _time_to_read;
+    // Variables for reading a buffer, when a tile is read LAG cycles after the start of the period it is written.
+    // Not needed for plain double buffering, where the tile written in the previous period is read.
+    Expr _rcycle;
+    Expr _rperiod;
+    Expr _roffset;
+    Expr _ridx;
 
     // The incoming data type might be a compiler-generated struct, which contains
     // multiple fields, and each field might differ in their degrees of reuse. Therefore,
@@ -960,6 +991,8 @@ private:
                                  // the NonScatter_NonReuse_Write_Loops out of the WRITE_LOOPS
         vector<Expr> read_args;  // DB[!_idx][READ_FROM(_offset)][nonscatter_unroll_loops][buf], where READ_FROM(_offset) is the address determined by
                                  // the NonScatter_NonReuse_Write_Loops out of the READ_LOOPS
+                                 // In general, [_ridx][READ_FROM(_roffset)][nonscatter_unroll_loops][buf].
+        vector<int> address_loops; // NonScatter_NonReuse_Write_Loops. Elements: indices to loops
     } buffer_info;
     vector<buffer_info> buffers_info; // Buffer info for all fields
 
@@ -974,12 +1007,16 @@ public:
         const Expr &original_read_node,
         const Expr &original_read_condition,
         const BufferStrategy buffer_strategy,
+        const int num_buffers,
+        const BufferPrefetch buffer_prefetch,
+        const BufferLayout buffer_layout,
         const ScatterStrategy scatter_strategy,
         const vector<tuple<string, Expr, Expr, ForType>> &loops) :
             envs(envs), all_loops(all_loops), func_name(func_name), producer(producer),
             buffer_loop(buffer_loop), scatter_loop(scatter_loop),
             original_read_node(original_read_node), original_read_condition(original_read_condition),
-            buffer_strategy(buffer_strategy), scatter_strategy(scatter_strategy), loops(loops) {
+            buffer_strategy(buffer_strategy), num_buffers(num_buffers), buffer_prefetch(buffer_prefetch),
+            buffer_layout(buffer_layout), scatter_strategy(scatter_strategy), loops(loops) {
                 initialize_common_constants_vars();
     }
 
@@ -1129,6 +1166,25 @@ private:
         CYCLES_PER_PERIOD = std::max(READS, WRITES);
         INIT = (READS >= WRITES) ? (READS - WRITES) : 0;
 
+        NUM_BUFFERS = num_buffers;
+        PARTIAL = (buffer_prefetch == BufferPrefetch::Partial);
+        BANKED = (buffer_layout == BufferLayout::Banked);
+        if (scatter_loop_removed_in_producer) {
+            // Every PE owns the incoming data in turn across periods, and the address to write is not
+            // decided by the write loops alone. Keep the default schedule and layout.
+            if (PARTIAL || BANKED) {
+                user_warning << "Buffering in func " << func_name << ": loop " << scatter_loop << " is removed in func "
+                             << producer << ". Partial prefetch and banked layout are ignored.\n";
+            }
+            PARTIAL = false;
+            BANKED = false;
+        }
+        DOUBLE_BUFFER = (NUM_BUFFERS == 2 && !PARTIAL);
+        if (PARTIAL) {
+            // Write a tile from the beginning of a period so that reading it can start as early as possible
+            INIT = 0;
+        }
+
         for(size_t i = 0; i < loops.size(); i++){
             auto &l = loops[i];
             ForType for_type = std::get<3>(l);
@@ -1172,9 +1228,9 @@ private:
         Expr new_isolated_opnd = isolated_operand_with_loop_vars_after_stt(isolated_opnd);
         debug(4) << "calculate_buffer_dims_args with isolated operand " << to_string(new_isolated_opnd) << "\n";
 
-        buf.dims.push_back(Range(0, 2));
+        buf.dims.push_back(Range(0, NUM_BUFFERS));
         buf.write_args.push_back(_idx);
-        buf.read_args.push_back(!_idx);
+        buf.read_args.push_back(DOUBLE_BUFFER ? !_idx : _ridx);
 
         vector<int> NonScatter_NonReuse_Write_Loops;
         for(size_t i = 0; i < WRITE_LOOPS.size(); i++){
@@ -1196,6 +1252,7 @@ private:
 
             debug(4) << "Found a NonScatter_NonReuse_Write_Loop: " << loop_name << "\n";
             NonScatter_NonReuse_Write_Loops.push_back(i);
+            buf.address_loops.push_back(WRITE_LOOPS[i]);
 
             Expr loop_extent = std::get<2>(l);
             internal_assert(loop_extent.as<IntImm>());
@@ -1205,6 +1262,9 @@ private:
             buf.read_args.push_back(Variable::make(Int(32),loop_name));
         }
 
+        // With the banked layout, the PEs of the nonscatter unroll loops are linearized into the last dimension
+        Expr PE;
+        uint32_t PEs = 1;
         for (size_t i = 0; i < nonscatter_unroll_loops.size(); i++) {
             const string &loop_name = nonscatter_unroll_loop_vars[i].as<Variable>()->name;
             Expr value;
@@ -1215,6 +1275,12 @@ private:
             Expr loop_extent = nonscatter_unroll_loop_dims[i].extent;
             internal_assert(loop_extent.as<IntImm>());
             int loop_extent_val = loop_extent.as<IntImm>()->value;
+            if (BANKED) {
+                Expr index = nonscatter_unroll_loop_vars[i] - nonscatter_unroll_loop_dims[i].min;
+                PE = PE.defined() ? (PE * loop_extent_val + index) : index;
+                PEs *= loop_extent_val;
+                continue;
+            }
             buf.dims.push_back(Range(0, loop_extent_val));
             buf.write_args.push_back(nonscatter_unroll_loop_vars[i]);
             buf.read_args.push_back(nonscatter_unroll_loop_vars[i]);
@@ -1222,9 +1288,15 @@ private:
 
         if (!scatter_loop_removed_in_producer) {
             BANKS = (int32_t)closest_power_of_two((uint32_t)BUFFERS);
+            Expr bank = buf_loop_var;
+            if (PE.defined()) {
+                // [PE][buf] flattened into 1 dimension, so that every PE reads and writes its own bank
+                bank = PE * BANKS + buf_loop_var;
+                BANKS = (int32_t)closest_power_of_two(PEs) * BANKS;
+            }
             buf.dims.push_back(Range(0, Expr(BANKS)));
-            buf.write_args.push_back(buf_loop_var);
-            buf.read_args.push_back(buf_loop_var);
+            buf.write_args.push_back(bank);
+            buf.read_args.push_back(bank);
         } else {
             auto dim = buf.dims.back();
             internal_assert(dim.extent.as<IntImm>());
@@ -1282,10 +1354,81 @@ private:
         _offset = Variable::make(UInt(32), "_offset");
         _time_to_write_buffer = Variable::make(Bool(1), "_time_to_write_buffer");
         _owner = Variable::make(UInt(32), "_owner");
-        _idx = Variable::make(Bool(1), "_idx");
+        _idx = DOUBLE_BUFFER ? Variable::make(Bool(1), "_idx") : Variable::make(Int(32), "_idx");
         _time_to_read = Variable::make(Bool(1), "_time_to_read");
+        _rcycle = Variable::make(UInt(32), "_rcycle");
+        _rperiod = Variable::make(UInt(32), "_rperiod");
+        _roffset = Variable::make(UInt(32), "_roffset");
+        _ridx = Variable::make(Int(32), "_ridx");
 
         calculate_buffer_dims_args();
+
+        if (DOUBLE_BUFFER) {
+            LAG = CYCLES_PER_PERIOD;
+        } else if (PARTIAL) {
+            LAG = least_read_lag() + (NUM_BUFFERS - 2) * CYCLES_PER_PERIOD;
+        } else {
+            LAG = (NUM_BUFFERS - 1) * CYCLES_PER_PERIOD;
+        }
+        debug(4) << "Buffer NUM_BUFFERS: " << NUM_BUFFERS << ", INIT: " << INIT << ", LAG: " << LAG << "\n";
+    }
+
+    // The least cycles from the start of writing a tile to the start of reading it, so that every read
+    // is at least 1 cycle after the last write to the same address in the tile. A tile is written from
+    // offset 0 of a period in the order of the WRITE_LOOPS, and the scatter loop, which is not removed
+    // in the producer, is the innermost of them. Reading decodes the offset in the order of the READ_LOOPS.
+    uint32_t least_read_lag() {
+        internal_assert(INIT == 0 && !scatter_loop_removed_in_producer);
+        map<int, uint32_t> write_strides; // Loop index -> stride of the loop in the write order
+        uint32_t stride = 1;
+        for (int i = WRITE_LOOPS.size() - 1; i >= 0; i--) {
+            int loop_index = WRITE_LOOPS[i];
+            auto &l = loops[loop_index];
+            if (loop_index != original_scatter_loop && std::get<3>(l) == ForType::Unrolled) {
+                continue;
+            }
+            write_strides[loop_index] = stride;
+            stride *= std::get<2>(l).as<IntImm>()->value;
+        }
+
+        uint32_t lag = 1;
+        map<int, uint32_t> read_digits;   // Loop index -> value of the loop, without its min, at a read
+        for (uint32_t r = 0; r < READS; r++) {
+            uint32_t reads = r;
+            for (int i = READ_LOOPS.size() - 1; i >= 0; i--) {
+                uint32_t extent = std::get<2>(loops[READ_LOOPS[i]]).as<IntImm>()->value;
+                read_digits[READ_LOOPS[i]] = reads % extent;
+                reads = reads / extent;
+            }
+            for (auto &b : buffers_info) {
+                // The same address is written in every iteration of the other write loops. The last time
+                // is when they are all at their last iterations.
+                uint32_t last_write = 0;
+                for (auto &w : write_strides) {
+                    uint32_t digit;
+                    if (std::find(b.address_loops.begin(), b.address_loops.end(), w.first) != b.address_loops.end()) {
+                        internal_assert(read_digits.find(w.first) != read_digits.end());
+                        digit = read_digits[w.first];
+                    } else {
+                        digit = std::get<2>(loops[w.first]).as<IntImm>()->value - 1;
+                    }
+                    last_write += digit * w.second;
+                }
+                if (last_write + 1 > r + lag) {
+                    lag = last_write + 1 - r;
+                }
+            }
+        }
+        return lag;
+    }
+
+    // Offsets in a period when the incoming data are written into a buffer
+    Expr is_write_offset(const Expr &off) {
+        Expr cond = (off >= Expr(INIT));
+        if (INIT + WRITES < CYCLES_PER_PERIOD) {
+            cond = cond && (off < Expr(INIT + WRITES));
+        }
+        return cond;
     }
 
 public:
@@ -1389,7 +1532,9 @@ public:
         add_nonscatter_unroll_loops(op->device_api, new_body);
 
         // TODO: change here into while(1)
-        new_body = For::make(func_name + ".s0.outermost_loop", 0, Expr(PERIODS + 1) * Expr(CYCLES_PER_PERIOD), ForType::Serial, op->device_api, new_body);
+        Expr total_cycles = DOUBLE_BUFFER ? Expr(PERIODS + 1) * Expr(CYCLES_PER_PERIOD) :
+                            PERIODS * (int)CYCLES_PER_PERIOD + (int)LAG;
+        new_body = For::make(func_name + ".s0.outermost_loop", 0, total_cycles, ForType::Serial, op->device_api, new_body);
 
         initialize(op->device_api, new_body);
     }
@@ -1441,7 +1586,7 @@ public:
     /* Make IR as:
      *   int period = cycle[nonscatter_unroll_loop_vars] / CYCLES_PER_PERIOD; // current period
          int offset = cycle[nonscatter_unroll_loop_vars] % CYCLES_PER_PERIOD; // relative position of the current cycle in the current period
-         bool time_to_write_buffer = (offset >= INIT);
+         bool time_to_write_buffer = (offset >= INIT); // && (offset < INIT + WRITES) if INIT + WRITES < CYCLES_PER_PERIOD
          if ((period < PERIODS) && time_to_write_buffer) {
              in_v[nonscatter_unroll_loop_vars] = read_channel_intel(IN_CHANNEL);
          }
@@ -1474,7 +1619,7 @@ public:
         Expr condition = (period < PERIODS) && time_to_write_buffer;
         read_input = IfThenElse::make(condition, read_input);
 
-        read_input = LetStmt::make(var_name(time_to_write_buffer), (offset >= Expr(INIT)), read_input);
+        read_input = LetStmt::make(var_name(time_to_write_buffer), is_write_offset(offset), read_input);
 
         Expr offset_val = Call::make(UInt(32), var_name(cycle), nonscatter_unroll_loop_vars, Call::PureIntrinsic) % Expr(CYCLES_PER_PERIOD);
         read_input = LetStmt::make(var_name(offset), offset_val, read_input);
@@ -1555,9 +1700,9 @@ public:
         int  _cycle = time_stamp[unroll_loop_vars];
         int  _period = _cycle / CYCLES_PER_PERIODS;
         int  _offset = _cycle % CYCLES_PER_PERIODS;
-        bool _time_to_write_buffer = (_offset >= INIT);
+        bool _time_to_write_buffer = (_offset >= INIT); // && (_offset < INIT + WRITES) if INIT + WRITES < CYCLES_PER_PERIOD
         int  _owner = _cycle % BUFFERS;
-        bool _idx = _period & 1;
+        bool _idx = _period & 1; // In general, int _idx = _period % NUM_BUFFERS;
         if (buf == _owner) // Note: needed only when the scatter loop is not removed in the producer
           if (_time_to_write_buffer)
             TYPE _tmp =  = value[unroll_loop_vars];
@@ -1634,9 +1779,10 @@ public:
         }
         write_buffer = IfThenElse::make(_time_to_write_buffer, write_buffer);
         new_body = Block::make(write_buffer, new_body);
-        new_body = LetStmt::make(var_name(_idx), Cast::make(Bool(), _period & 0x1), new_body);
+        Expr _idx_value = DOUBLE_BUFFER ? Cast::make(Bool(), _period & 0x1) : Cast::make(Int(32), _period % Expr((uint32_t)NUM_BUFFERS));
+        new_body = LetStmt::make(var_name(_idx), _idx_value, new_body);
         new_body = LetStmt::make(var_name(_owner), _owner_value, new_body);
-        new_body = LetStmt::make(var_name(_time_to_write_buffer), _offset >= Expr(INIT), new_body);
+        new_body = LetStmt::make(var_name(_time_to_write_buffer), is_write_offset(_offset), new_body);
         new_body = LetStmt::make(var_name(_offset), _cycle % Expr(CYCLES_PER_PERIOD), new_body);
         new_body = LetStmt::make(var_name(_period), _cycle / Expr(CYCLES_PER_PERIOD), new_body);
         vector<Expr> read_time_stamp_args(unroll_loop_vars);
@@ -1652,6 +1798,16 @@ public:
                     _tmp = { DB_f0[!_idx][READ_FROM(_offset)][buf], DB_f1[!_idx][READ_FROM(_offset)][buf], ...}
                     or simply _tmp = DB[!_idx][READ_FROM(_offset)][buf] if there is only 1 type of buffer.
              }
+     * That is for plain double buffering. In general, a tile is read LAG cycles after the start of the period
+     * it is written:
+     *       int  _rcycle = _cycle - LAG;
+     *       int  _rperiod = _rcycle / CYCLES_PER_PERIOD;
+     *       int  _roffset = _rcycle % CYCLES_PER_PERIOD;
+     *       int  _ridx = _rperiod % NUM_BUFFERS;
+     *       bool _time_to_read = _cycle >= LAG && _rperiod < PERIODS && _roffset < READS;
+     *       if (_time_to_read) {
+     *          write_channel_intel(OUT_CHANNEL[buf], DB[_ridx][READ_FROM(_roffset)][buf]);
+     *       }
      */
     void read_from_buffer(Stmt &new_body) {
         Expr buf_value;
@@ -1672,7 +1828,7 @@ public:
         new_body = substitute(original_read_node, buf_value, new_body);
 
         // Recover the variables of the sequential loops
-        Expr reads = _offset; // Total reads in the current period
+        Expr reads = DOUBLE_BUFFER ? _offset : _roffset; // Total reads in the current period
         for(int i = READ_LOOPS.size() - 1; i >= 0; --i){
             auto &l = loops[READ_LOOPS[i]];
             string loop_name = std::get<0>(l);
@@ -1691,6 +1847,18 @@ public:
 
         new_body = IfThenElse::make(_time_to_read, new_body);
 
+        if (!DOUBLE_BUFFER) {
+            Expr val = (_cycle >= Expr(LAG)) && (_rperiod < PERIODS);
+            if (READS < CYCLES_PER_PERIOD) {
+                val = val && (_roffset < Expr(READS));
+            }
+            new_body = LetStmt::make("_time_to_read", val, new_body);
+            new_body = LetStmt::make(var_name(_ridx), Cast::make(Int(32), _rperiod % Expr((uint32_t)NUM_BUFFERS)), new_body);
+            new_body = LetStmt::make(var_name(_roffset), _rcycle % Expr(CYCLES_PER_PERIOD), new_body);
+            new_body = LetStmt::make(var_name(_rperiod), _rcycle / Expr(CYCLES_PER_PERIOD), new_body);
+            new_body = LetStmt::make(var_name(_rcycle), _cycle - Expr(LAG), new_body);
+            return;
+        }
         Expr periods_unfinished = (_period <= PERIODS);
         Expr val = (READS >= WRITES) ? ((_period > 0) && periods_unfinished) :
                    ((_period > 0) && periods_unfinished && (_offset < Expr(READS)));
@@ -1730,6 +1898,11 @@ public:
                     debug(4)<<"Func "<< op->name <<": buffers data from "
                             << iter->second.producer <<" at loop "
                             << iter->second.buffer_loop << "\n";
+                    user_assert(iter->second.num_buffers == 2 && iter->second.buffer_prefetch == BufferPrefetch::Tile &&
+                                iter->second.buffer_layout == BufferLayout::Default)
+                        << "Func " << op->name << " buffers data from " << iter->second.producer
+                        << " without scattering them. Only double buffering with the default prefetch and layout"
+                        << " is supported in this case so far.";
                     BufferInserter bufferInserter(envs, scatterbuffer_args,op->name);
                     new_body = bufferInserter.mutate(op->body);
                     break;
@@ -1746,6 +1919,9 @@ public:
                                                       iter->second.read_node,
                                                       iter->second.read_condition,
                                                       iter->second.buffer_strategy,
+                                                      iter->second.num_buffers,
+                                                      iter->second.buffer_prefetch,
+                                                      iter->second.buffer_layout,
                                                       iter->second.scatter_strategy,
                                                       iter->second.loops);
                     new_body =  scatterAndBuffer.mutate(op->body);
@@ -2100,6 +2276,9 @@ void get_ScatterBufferArgs(const map<string, Function> &envs, ScatterBufferArgs&
             tmp.producer = buffer_params[0].func_name;
             tmp.buffer_loop = buffer_params[0].loop_name;
             tmp.buffer_strategy = buffer_params[0].strategy;
+            tmp.num_buffers = buffer_params[0].num_buffers;
+            tmp.buffer_prefetch = buffer_params[0].prefetch;
+            tmp.buffer_layout = buffer_params[0].layout;
         }
 
         if(!scatter_params.empty()){
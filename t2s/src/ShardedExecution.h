@@ -0,0 +1,179 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef T2S_SHARDED_EXECUTION_H
+#define T2S_SHARDED_EXECUTION_H
+
+/* Sharded execution of a design across the devices attached to the host. All the devices are
+ * programmed with the same bitstream. The host splits the outermost loops of the design into
+ * shards, and invokes the design on every shard from a thread bound to a device, so that the
+ * devices run concurrently. Outputs of shards splitting a reduction are summed up on the host.
+ * Every shard is further streamed (See StreamingExecution.h) if it does not fit into its device. */
+
+#include <future>
+#include "StreamingExecution.h"
+
+extern "C" int halide_opencl_get_device_count(void *user_context);
+extern "C" int halide_opencl_set_device(void *user_context, int device);
+
+// Run the shards concurrently, shard d on device d. Return 0, or the first non-zero result.
+inline int run_on_devices(const std::vector<std::function<int()>> &shards) {
+    std::vector<std::future<int>> results;
+    for (size_t d = 0; d < shards.size(); d++) {
+        std::function<int()> shard = shards[d];
+        results.push_back(std::async(std::launch::async, [=]() {
+            int result = halide_opencl_set_device(NULL, (int)d);
+            return result != 0 ? result : shard();
+        }));
+    }
+    int result = 0;
+    for (auto &r : results) {
+        int shard_result = r.get();
+        if (result == 0) {
+            result = shard_result;
+        }
+    }
+    return result;
+}
+
+// The beginning of the s-th of n nearly equal parts of [0, extent)
+inline int shard_begin(int extent, int n, int s) {
+    return (int)((int64_t)extent * s / n);
+}
+
+// Shard a design over its outermost loop of `extent` iterations across `num_devices` devices. The
+// operands are described as in stream_outermost_loop. Every device gets a contiguous range of the
+// iterations, which is streamed through the device within the budget.
+template<typename T>
+int shard_outermost_loop(std::function<int(std::vector<Halide::Runtime::Buffer<T>> &)> design,
+                         std::vector<StreamedOperand<T>> operands, int extent,
+                         int num_devices = halide_opencl_get_device_count(NULL),
+                         uint64_t budget = device_buffer_size_limit()) {
+    int n = std::min(num_devices, extent);
+    if (n <= 0) {
+        return halide_error_code_generic_error;
+    }
+    std::vector<std::function<int()>> shards;
+    for (int s = 0; s < n; s++) {
+        int begin = shard_begin(extent, n, s);
+        int iters = shard_begin(extent, n, s + 1) - begin;
+        std::vector<StreamedOperand<T>> cropped = operands;
+        for (auto &op : cropped) {
+            if (op.dim >= 0) {
+                op.buf = op.buf.cropped(op.dim, op.buf.dim(op.dim).min() + begin * op.unit, iters * op.unit);
+            }
+        }
+        shards.push_back([=]() {
+            return stream_outermost_loop<T>(design, cropped, iters, budget);
+        });
+    }
+    return run_on_devices(shards);
+}
+
+// Number of shards of GEMM along i, j and k. Sharding along k splits the reduction, and the
+// host sums up the partial products of the shards.
+struct GemmSharding {
+    int i = 1, j = 1, k = 1;
+
+    GemmSharding() {}
+    GemmSharding(int _i, int _j, int _k) : i(_i), j(_j), k(_k) {}
+    int num_shards() const { return i * j * k; }
+};
+
+// Shard i and j of a GEMM with I * J output tiles across num_devices devices, minimizing the
+// panels of A and B every device reads, i.e. I / i + J / j. If there are fewer tiles than devices,
+// the remaining devices shard k.
+inline GemmSharding choose_gemm_sharding(int num_devices, int I, int J, int K) {
+    GemmSharding best(1, 1, 1);
+    double best_cost = -1;
+    for (int i = 1; i <= std::min(num_devices, I); i++) {
+        int j = std::min(num_devices / i, J);
+        double cost = (double)I / i + (double)J / j;
+        if (i * j > best.i * best.j || (i * j == best.i * best.j && (best_cost < 0 || cost < best_cost))) {
+            best = GemmSharding(i, j, 1);
+            best_cost = cost;
+        }
+    }
+    best.k = std::max(1, std::min(num_devices / (best.i * best.j), K));
+    return best;
+}
+
+// Shard C = A * B across devices, with A, B, C, k_tile and gemm as in stream_gemm.
+template<typename T>
+int shard_gemm(std::function<int(Halide::Runtime::Buffer<T> &, Halide::Runtime::Buffer<T> &, Halide::Runtime::Buffer<T> &)> gemm,
+               Halide::Runtime::Buffer<T> A, Halide::Runtime::Buffer<T> B, Halide::Runtime::Buffer<T> C,
+               int k_tile, GemmSharding sharding, uint64_t budget = device_buffer_size_limit()) {
+    const int j_tile = C.dim(0).extent() * C.dim(2).extent();
+    const int i_tile = C.dim(1).extent() * C.dim(3).extent();
+    const int J = C.dim(4).extent(), I = C.dim(5).extent();
+    const int K = A.dim(0).extent() / k_tile;
+    if (sharding.i > I || sharding.j > J || sharding.k > K || sharding.num_shards() <= 0 ||
+        sharding.num_shards() > halide_opencl_get_device_count(NULL)) {
+        return halide_error_code_generic_error;
+    }
+
+    // Partial products of the shards along k, summed up after all the shards finish
+    std::vector<Halide::Runtime::Buffer<T>> partials;
+    std::vector<std::function<int()>> shards;
+    for (int si = 0; si < sharding.i; si++)
+    for (int sj = 0; sj < sharding.j; sj++)
+    for (int sk = 0; sk < sharding.k; sk++) {
+        int i = shard_begin(I, sharding.i, si), ni = shard_begin(I, sharding.i, si + 1) - i;
+        int j = shard_begin(J, sharding.j, sj), nj = shard_begin(J, sharding.j, sj + 1) - j;
+        int k = shard_begin(K, sharding.k, sk), nk = shard_begin(K, sharding.k, sk + 1) - k;
+        Halide::Runtime::Buffer<T> a = A.cropped(0, A.dim(0).min() + k * k_tile, nk * k_tile)
+                                        .cropped(1, A.dim(1).min() + i * i_tile, ni * i_tile);
+        Halide::Runtime::Buffer<T> b = B.cropped(0, B.dim(0).min() + j * j_tile, nj * j_tile)
+                                        .cropped(1, B.dim(1).min() + k * k_tile, nk * k_tile);
+        Halide::Runtime::Buffer<T> c = C.cropped(4, C.dim(4).min() + j, nj).cropped(5, C.dim(5).min() + i, ni);
+        if (sk > 0) {
+            Halide::Runtime::Buffer<T> partial(c.dim(0).extent(), c.dim(1).extent(), c.dim(2).extent(),
+                                               c.dim(3).extent(), nj, ni);
+            partial.set_min({c.dim(0).min(), c.dim(1).min(), c.dim(2).min(), c.dim(3).min(),
+                             c.dim(4).min(), c.dim(5).min()});
+            partials.push_back(partial);
+            c = partial;
+        }
+        shards.push_back([=]() {
+            Halide::Runtime::Buffer<T> a_ = a, b_ = b, c_ = c;
+            return stream_gemm<T>(gemm, a_, b_, c_, k_tile, budget);
+        });
+    }
+    int result = run_on_devices(shards);
+    if (result != 0) {
+        return result;
+    }
+    for (auto &partial : partials) {
+        Halide::Runtime::Buffer<T> c = C.cropped(4, partial.dim(4).min(), partial.dim(4).extent())
+                                        .cropped(5, partial.dim(5).min(), partial.dim(5).extent());
+        c.for_each_value([](T &sum, T p) { sum += p; }, partial);
+    }
+    return 0;
+}
+
+// Shard C = A * B across all the devices.
+template<typename T>
+int shard_gemm(std::function<int(Halide::Runtime::Buffer<T> &, Halide::Runtime::Buffer<T> &, Halide::Runtime::Buffer<T> &)> gemm,
+               Halide::Runtime::Buffer<T> A, Halide::Runtime::Buffer<T> B, Halide::Runtime::Buffer<T> C,
+               int k_tile, uint64_t budget = device_buffer_size_limit()) {
+    GemmSharding sharding = choose_gemm_sharding(halide_opencl_get_device_count(NULL), C.dim(5).extent(),
+                                                 C.dim(4).extent(), A.dim(0).extent() / k_tile);
+    return shard_gemm<T>(gemm, A, B, C, k_tile, sharding, budget);
+}
+
+#endif
@@ -137,4 +137,51 @@ extern "C" char *concat_simple(const char *dir, const char *file) {
     STRING_COPY_WITH_NULL(name, dir);
     strncat(name, file, strlen(file));
     return name;
-}
\ No newline at end of file
+}
+
+extern "C" uint64_t device_buffer_size_limit() {
+    char *env = getenv("DEVICE_BUFFER_SIZE_LIMIT");
+    if (env != NULL) {
+        uint64_t limit = strtoull(env, NULL, 10);
+        if (limit > 0) {
+            return limit;
+        }
+        printf("Error! Invalid DEVICE_BUFFER_SIZE_LIMIT: '%s'. Use 2^32 - 1 bytes instead\n", env);
+    }
+    return (static_cast<uint64_t>(1) << 32) - 1;
+}
+
+extern "C" int bitstream_is_pending() {
+    // The bitstream may not exist yet. So do not resolve its path.
+    char *env = getenv("BITSTREAM");
+    char *home = getenv("HOME");
+    char *bitstream = (env != NULL) ? concat_simple(env, "") : concat_directory_and_file(home, "tmp/a.aocx");
+    char *pending = concat_simple(bitstream, ".pending");
+    FILE *fp = fopen(pending, "r");
+    free(bitstream);
+    free(pending);
+    if (fp == NULL) {
+        return 0;
+    }
+    fclose(fp);
+    return 1;
+}
+
+extern "C" int use_emulator_while_bitstream_pending() {
+    if (!bitstream_is_pending()) {
+        return 0;
+    }
+    char *emulator_bitstream = getenv("EMULATOR_BITSTREAM");
+    if (emulator_bitstream == NULL) {
+        printf("The bitstream is being compiled in the background. Define EMULATOR_BITSTREAM to run in the emulator meanwhile.\n");
+        return 0;
+    }
+    printf("The bitstream is being compiled in the background. Running %s in the emulator instead.\n", emulator_bitstream);
+    setenv("BITSTREAM", emulator_bitstream, 1);
+    setenv("CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA", "1", 0);
+    char *platform = getenv("EMULATOR_PLATFORM");
+    if (platform != NULL) {
+        setenv("INTEL_FPGA_OCL_PLATFORM_NAME", platform, 1);
+    }
+    return 1;
+}
@@ -21,6 +21,8 @@
 
 /* This file contains common utilities shared by AOT runtime and roofline drawing. */
 
+#include <stdint.h>
+
 // Return the bitstream file name with full path.
 // Caller: free the space after usage.
 extern "C" char *bistream_file_name_with_absolute_path();
@@ -51,4 +53,18 @@ extern "C" char *quartus_output_directory_oneapi();
 // Assists in avoiding double free runtime errors
 extern "C" char *concat_simple(const char *dir, const char *file);
 
+// Return the max bytes of a buffer allocated on the device. By default, it is 2^32 - 1, and
+// can be overridden by the environment variable DEVICE_BUFFER_SIZE_LIMIT.
+extern "C" uint64_t device_buffer_size_limit();
+
+// Return 1 if the bitstream is being compiled in the background (env var AOC_ASYNC), i.e. its .pending
+// marker exists, or 0 otherwise.
+extern "C" int bitstream_is_pending();
+
+// If the bitstream is being compiled in the background, run the design in the emulator until it is ready:
+// switch the env var BITSTREAM to EMULATOR_BITSTREAM, a bitstream compiled for the emulator, and set
+// CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA and INTEL_FPGA_OCL_PLATFORM_NAME (from EMULATOR_PLATFORM) for the
+// runtime. The AOT runtime calls it before loading the bitstream. Return 1 if switched, or 0 otherwise.
+extern "C" int use_emulator_while_bitstream_pending();
+
 #endif
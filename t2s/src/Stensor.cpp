@@ -20,6 +20,7 @@
 #include "./Utilities.h"
 #include "./PreprocessBeforeLower.h"
 #include "./Stensor.h"
+#include "../../Halide/src/FindCalls.h"
 
 namespace Halide {
 
@@ -59,6 +60,11 @@ Stensor &Stensor::out(const vector<Var> &v) {
     return *this;
 }
 
+Stensor &Stensor::double_buffer() {
+    num_buffers = 2;
+    return *this;
+}
+
 Stensor &Stensor::operator()(const vector<Expr> &d) {
     if (d.empty()) {
         // By default, this stensor will use the original layout.
@@ -568,9 +574,10 @@ class RealizeOnGPU
                 for (auto &p : c.imp) {
                     int gpu_var_index = fv.free_vars.size() - num_gpu_vars -1;
                     Var loop = fv.var_index(s.v_scope) < gpu_var_index ? s.v_scope : fv.free_vars[gpu_var_index];
-                    p.gpu_fetch(loop, MemoryType::Register, s.v_outs);
+                    p.gpu_fetch(loop, MemoryType::Register, s.v_outs, {}, s.num_buffers);
                     debug(1) << p.name() << ".gpu_fetch("
-                             << loop.name() << ", {" << names_to_string(s.v_outs) << "});\n";
+                             << loop.name() << ", {" << names_to_string(s.v_outs) << "}, {}, "
+                             << s.num_buffers << ");\n";
                 }
             }
         }
@@ -652,6 +659,30 @@ Func Stensor::stensor_realize_wrapper(Starget t) {
     return f;
 }
 
+Func Stensor::realize_wrapper(const Target &t) {
+    user_assert(t.has_feature(Target::IntelFPGA) || t.has_feature(Target::IntelGPU))
+        << "Stensor " << name << " can be realized only for a target with intel_fpga or intel_gpu\n";
+    bool gpu = t.has_feature(Target::IntelGPU);
+    Func f = stensor_realize_wrapper(gpu ? Starget::IntelGPU : Starget::IntelFPGA);
+    if (!gpu) {
+        // The source code of the host is generated, where unrolled and vectorized loops are not supported.
+        // Serialize them as Pipeline::compile_to_host() does.
+        map<string, Function> env = find_transitive_calls(f.function());
+        for (auto &e : env) {
+            if (e.second.place() == Place::Host) {
+                vector<Dim> &dims = e.second.definition().schedule().dims();
+                for (auto &d : dims) {
+                    if (d.for_type == ForType::Unrolled || d.for_type == ForType::Vectorized) {
+                        d.for_type = ForType::Serial;
+                    }
+                }
+            }
+        }
+    }
+    schains.clear();
+    return f;
+}
+
 void Stensor::realize(Buffer<> dst, Starget t) {
     Func f = stensor_realize_wrapper(t);
     if (t == Starget::IntelFPGA) {
@@ -693,6 +724,21 @@ void Stensor::compile_to_host(string file_name, const vector<Argument> &args,
     }
 }
 
+void Stensor::compile_to_host(string file_name, const vector<Argument> &args,
+                              const std::string fn_name, const Target &t) {
+    user_assert(t.has_feature(Target::IntelFPGA) || t.has_feature(Target::IntelGPU))
+        << "Stensor " << name << " can be compiled only for a target with intel_fpga or intel_gpu\n";
+    if (t.has_feature(Target::IntelGPU)) {
+        Func f = stensor_realize_wrapper(Starget::IntelGPU);
+        user_warning << "Currently the GPU runtime is under developement, "
+                        "so we just emit out the source code in " << fn_name << "_genx.cpp\n";
+        f.compile_to_cm(fn_name, std::move(args), t);
+    } else {
+        Func f = stensor_realize_wrapper(Starget::IntelFPGA);
+        f.compile_to_host(file_name, args, fn_name, t);
+    }
+}
+
 
 void Stensor::compile_to_oneapi(const vector<Argument> &args,
                               const std::string fn_name, Starget t) {
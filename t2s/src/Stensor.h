@@ -47,6 +47,7 @@ struct Stensor
     vector<Expr> dims;
     int schain_idx = -1;
     int fifo_depth = 0;
+    int num_buffers = 1;
 
     Stensor(std::string _n, SMemType _p)
         : name(_n), position(_p) {}
@@ -54,15 +55,24 @@ struct Stensor
         : Stensor(_n, HOST) {}
 
     Func stensor_realize_wrapper(Starget t);
+    // The Func on the host that realizes the stensor on the device of the target (IntelFPGA or IntelGPU), as
+    // compile_to_host() does, for a Generator to return as its output. The stensor chains of the design are
+    // consumed, so that the same process can build another design (e.g. another variant) afterwards.
+    Func realize_wrapper(const Target &t);
     void realize(Buffer<> dst, Starget t);
     void compile_jit(Starget t);
     void compile_to_host(string file_name, const vector<Argument> &args,
                          const std::string fn_name, Starget t);
+    // The same, for a target with intel_fpga or intel_gpu, and any other features, e.g. disable_gpu_micro_kernel
+    void compile_to_host(string file_name, const vector<Argument> &args,
+                         const std::string fn_name, const Target &t);
     void compile_to_oneapi(const vector<Argument> &args,
                          const std::string fn_name, Starget t);
     Stensor &scope(Var v);
     Stensor &banks(const std::vector<Var> &banks);
     Stensor &out(const std::vector<Var> &bankwidth_and_banks);
+    // Ping-pong the buffer on GPUs: the next tile is prefetched while the current one is used
+    Stensor &double_buffer();
     Stensor &operator()(const std::vector<Expr> &dims);
 
     template<typename... Args>
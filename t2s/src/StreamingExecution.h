@@ -0,0 +1,338 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef T2S_STREAMING_EXECUTION_H
+#define T2S_STREAMING_EXECUTION_H
+
+/* Streaming execution of a design whose operands do not fit into the device memory.
+ * The host tiles the outermost loops of the design into chunks, and invokes the design
+ * (i.e. the same bitstream) once per chunk on staging buffers small enough for the device.
+ * The host work overlaps with the device: while the device computes chunk c, the host
+ * gathers the inputs of chunk c+1 and scatters the outputs of chunk c-1. At most 3 chunks
+ * are staged at a time. */
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+#include "HalideBuffer.h"
+#include "SharedUtilsInC.h"
+
+extern "C" int halide_device_free(void *user_context, struct halide_buffer_t *buf);
+
+struct StreamingChunk {
+    std::function<void()> gather;   // Copy the inputs of the chunk into its staging buffers
+    std::function<int()> compute;   // Invoke the design on the staging buffers
+    std::function<void()> scatter;  // Copy the outputs of the chunk out of its staging buffers, and release them
+};
+
+// Run the chunks in order. Return 0, or the first non-zero result of the design.
+inline int stream_chunks(std::vector<StreamingChunk> &chunks) {
+    std::future<void> gathering, scattering;
+    if (!chunks.empty()) {
+        chunks[0].gather();
+    }
+    for (size_t c = 0; c < chunks.size(); c++) {
+        if (c + 1 < chunks.size()) {
+            gathering = std::async(std::launch::async, chunks[c + 1].gather);
+        }
+        int result = chunks[c].compute();
+        if (scattering.valid()) {
+            scattering.wait();
+        }
+        if (gathering.valid()) {
+            gathering.wait();
+        }
+        if (result != 0) {
+            return result;
+        }
+        scattering = std::async(std::launch::async, chunks[c].scatter);
+    }
+    if (scattering.valid()) {
+        scattering.wait();
+    }
+    return 0;
+}
+
+// Copy the region of the source at the given mins into a new buffer whose mins are 0.
+template<typename T>
+Halide::Runtime::Buffer<T> stage_region(const Halide::Runtime::Buffer<T> &src, const std::vector<int> &mins,
+                                        const std::vector<int> &extents) {
+    Halide::Runtime::Buffer<T> staged(extents);
+    staged.set_min(mins);
+    staged.copy_from(src);
+    staged.set_min(std::vector<int>(mins.size(), 0));
+    return staged;
+}
+
+// Release the device memory the design allocated for a staging buffer.
+template<typename T>
+void release_device(Halide::Runtime::Buffer<T> &buf) {
+    halide_device_free(NULL, buf.raw_buffer());
+}
+
+// An operand of a design streamed over its outermost loop. Every iteration of the loop covers
+// `unit` elements of the operand along dimension `dim`. An operand with dim < 0 (e.g. the weights
+// of a convolution) is not chunked, and is passed whole to every chunk.
+template<typename T>
+struct StreamedOperand {
+    Halide::Runtime::Buffer<T> buf;
+    int dim;
+    int unit;
+    bool is_output;
+};
+
+// Stream a design over its outermost loop of `extent` iterations, with as many iterations per chunk
+// as the device buffers allow (at most `budget` bytes per buffer). The design is invoked with the
+// staging buffers of the operands, in the order of the operands.
+// For example, a convolution over a batch of N images, as in t2s/tests/performance/conv/conv-run-fpga.cpp:
+//    stream_outermost_loop<float>([](std::vector<Halide::Runtime::Buffer<float>> &b) { return conv(b[0], b[1], b[2]); },
+//                                 {{i, 0, GROUP_CI * GROUPS, false}, {k, -1, 0, false}, {o, 9, GROUPS, true}}, N);
+template<typename T>
+int stream_outermost_loop(std::function<int(std::vector<Halide::Runtime::Buffer<T>> &)> design,
+                          std::vector<StreamedOperand<T>> operands, int extent,
+                          uint64_t budget = device_buffer_size_limit()) {
+    int per_chunk = extent;
+    for (auto &op : operands) {
+        uint64_t bytes = op.buf.number_of_elements() * sizeof(T);
+        if (op.dim < 0) {
+            if (bytes > budget) {
+                return halide_error_code_device_malloc_failed;
+            }
+            continue;
+        }
+        uint64_t bytes_per_iter = bytes / op.buf.dim(op.dim).extent() * op.unit;
+        per_chunk = std::min<int64_t>(per_chunk, budget / bytes_per_iter);
+    }
+    if (per_chunk == 0) {
+        return halide_error_code_device_malloc_failed;
+    }
+
+    std::vector<StreamingChunk> chunks;
+    for (int begin = 0; begin < extent; begin += per_chunk) {
+        int iters = std::min(per_chunk, extent - begin);
+        auto staged = std::make_shared<std::vector<Halide::Runtime::Buffer<T>>>(operands.size());
+        StreamingChunk chunk;
+        chunk.gather = [=]() {
+            for (size_t i = 0; i < operands.size(); i++) {
+                const auto &op = operands[i];
+                if (op.dim < 0) {
+                    (*staged)[i] = op.buf;
+                    continue;
+                }
+                std::vector<int> mins, extents;
+                for (int d = 0; d < op.buf.dimensions(); d++) {
+                    bool chunked = (d == op.dim);
+                    mins.push_back(chunked ? op.buf.dim(d).min() + begin * op.unit : op.buf.dim(d).min());
+                    extents.push_back(chunked ? iters * op.unit : op.buf.dim(d).extent());
+                }
+                (*staged)[i] = op.is_output ? Halide::Runtime::Buffer<T>(extents)
+                                            : stage_region(op.buf, mins, extents);
+            }
+        };
+        chunk.compute = [=]() {
+            int result = design(*staged);
+            for (size_t i = 0; i < operands.size(); i++) {
+                release_device((*staged)[i]);
+            }
+            return result;
+        };
+        chunk.scatter = [=]() {
+            for (size_t i = 0; i < operands.size(); i++) {
+                const auto &op = operands[i];
+                if (op.is_output && op.dim >= 0) {
+                    std::vector<int> mins;
+                    for (int d = 0; d < op.buf.dimensions(); d++) {
+                        mins.push_back(d == op.dim ? op.buf.dim(d).min() + begin * op.unit : op.buf.dim(d).min());
+                    }
+                    (*staged)[i].set_min(mins);
+                    Halide::Runtime::Buffer<T> dst = op.buf;
+                    dst.copy_from((*staged)[i]);
+                }
+            }
+            staged->clear();
+        };
+        chunks.push_back(chunk);
+    }
+    return stream_chunks(chunks);
+}
+
+// Stream a batch of unknown size (e.g. matrices arriving from sensors) through a design, a chunk at a
+// time. make() creates the staging buffers of a chunk. read(chunk) fills the inputs of the chunk, and
+// returns the number of items it read, or 0 at the end of the stream. compute(chunk, n) invokes the
+// design on the first n items, and write(chunk, n) consumes their outputs. While the device computes
+// a chunk, the next chunk is read and the previous one is written.
+template<typename Staging>
+int stream_batches(std::function<std::shared_ptr<Staging>()> make,
+                   std::function<int(Staging &)> read,
+                   std::function<int(Staging &, int)> compute,
+                   std::function<void(Staging &, int)> write) {
+    std::shared_ptr<Staging> current = make();
+    int count = read(*current);
+    std::future<void> writing;
+    while (count > 0) {
+        std::shared_ptr<Staging> next = make();
+        std::future<int> reading = std::async(std::launch::async, [=]() { return read(*next); });
+        int result = compute(*current, count);
+        if (writing.valid()) {
+            writing.wait();
+        }
+        int next_count = reading.get();
+        if (result != 0) {
+            return result;
+        }
+        writing = std::async(std::launch::async, [=]() { write(*current, count); });
+        current = next;
+        count = next_count;
+    }
+    if (writing.valid()) {
+        writing.wait();
+    }
+    return 0;
+}
+
+// Stream C = A * B through a GEMM design as in t2s/tests/performance/gemm, where A is (TOTAL_K, TOTAL_I),
+// B is (TOTAL_J, TOTAL_K), C is (JJJ, III, JJ, II, J, I), and gemm(a, b, c) is the generated interface.
+// The operands are chunked along i, j and k in units of the tiles of the design. k is chunked only if a
+// row panel of A or a column panel of B does not fit, in which case the partial products are summed up
+// on the host.
+template<typename T>
+int stream_gemm(std::function<int(Halide::Runtime::Buffer<T> &, Halide::Runtime::Buffer<T> &, Halide::Runtime::Buffer<T> &)> gemm,
+                Halide::Runtime::Buffer<T> A, Halide::Runtime::Buffer<T> B, Halide::Runtime::Buffer<T> C,
+                int k_tile, uint64_t budget = device_buffer_size_limit()) {
+    const int64_t j_tile = C.dim(0).extent() * C.dim(2).extent();
+    const int64_t i_tile = C.dim(1).extent() * C.dim(3).extent();
+    const int J = C.dim(4).extent(), I = C.dim(5).extent();
+    const int K = A.dim(0).extent() / k_tile;
+    const int64_t bytes = sizeof(T);
+
+    // Tiles per chunk along k, i and j
+    int64_t ck = std::min<int64_t>(K, budget / (bytes * k_tile * std::max(i_tile, j_tile)));
+    int64_t ci = std::min<int64_t>(I, ck == 0 ? 0 : budget / (bytes * ck * k_tile * i_tile));
+    int64_t cj = std::min<int64_t>(J, ck == 0 ? 0 : budget / (bytes * ck * k_tile * j_tile));
+    while (ci > 0 && cj > 0 && (uint64_t)(ci * cj * i_tile * j_tile * bytes) > budget) {
+        if (ci >= cj) {
+            ci--;
+        } else {
+            cj--;
+        }
+    }
+    if (ck == 0 || ci == 0 || cj == 0) {
+        return halide_error_code_device_malloc_failed;
+    }
+
+    std::vector<StreamingChunk> chunks;
+    for (int i = 0; i < I; i += ci)
+    for (int j = 0; j < J; j += cj)
+    for (int k = 0; k < K; k += ck) {
+        int ni = std::min<int>(ci, I - i), nj = std::min<int>(cj, J - j), nk = std::min<int>(ck, K - k);
+        struct Staged {
+            Halide::Runtime::Buffer<T> a, b, c;
+        };
+        auto staged = std::make_shared<Staged>();
+        StreamingChunk chunk;
+        chunk.gather = [=]() {
+            staged->a = stage_region(A, {A.dim(0).min() + k * k_tile, A.dim(1).min() + int(i * i_tile)},
+                                     {nk * k_tile, int(ni * i_tile)});
+            staged->b = stage_region(B, {B.dim(0).min() + int(j * j_tile), B.dim(1).min() + k * k_tile},
+                                     {int(nj * j_tile), nk * k_tile});
+            staged->c = Halide::Runtime::Buffer<T>(C.dim(0).extent(), C.dim(1).extent(), C.dim(2).extent(),
+                                                   C.dim(3).extent(), nj, ni);
+        };
+        chunk.compute = [=]() {
+            int result = gemm(staged->a, staged->b, staged->c);
+            release_device(staged->a);
+            release_device(staged->b);
+            release_device(staged->c);
+            return result;
+        };
+        chunk.scatter = [=]() {
+            Halide::Runtime::Buffer<T> dst = C.cropped(4, C.dim(4).min() + j, nj).cropped(5, C.dim(5).min() + i, ni);
+            staged->c.set_min({dst.dim(0).min(), dst.dim(1).min(), dst.dim(2).min(), dst.dim(3).min(),
+                               dst.dim(4).min(), dst.dim(5).min()});
+            if (k == 0) {
+                dst.copy_from(staged->c);
+            } else {
+                dst.for_each_value([](T &sum, T partial) { sum += partial; }, staged->c);
+            }
+            *staged = Staged();
+        };
+        chunks.push_back(chunk);
+    }
+    return stream_chunks(chunks);
+}
+
+// Stream C' = alpha * op(A) * op(A)^T + beta * C through a SYRK design as in t2s/tests/performance/syrk, where C is
+// (N, N), the output out is in the layout of the design, and syrk(opa, alpha, beta, a, c, out) is the generated
+// interface. A is (K, N) if opa is 0 (op(A) = A), or (N, K) if opa is 1 (op(A) = A^T), and K is reduced in either
+// case. The reduction loops of the design cover k_extent of K, and a longer A is chunked along K: the first chunk is
+// invoked with beta, the others with beta = 0, and their outputs are summed up on the host. Every chunk is staged
+// in the (K, N) layout the design reads, and the design is invoked with opa = 0.
+template<typename T>
+int stream_syrk(std::function<int(int, T, T, Halide::Runtime::Buffer<T> &, Halide::Runtime::Buffer<T> &,
+                                  Halide::Runtime::Buffer<T> &)> syrk,
+                int opa, T alpha, T beta, Halide::Runtime::Buffer<T> A, Halide::Runtime::Buffer<T> C,
+                Halide::Runtime::Buffer<T> out, int k_extent) {
+    // A view of A with K as dimension 0
+    const Halide::Runtime::Buffer<T> AK = (opa == 0) ? A : A.transposed(0, 1);
+    if (AK.dim(0).extent() % k_extent != 0) {
+        return halide_error_code_bad_dimensions;
+    }
+    std::vector<StreamingChunk> chunks;
+    for (int k = 0; k < AK.dim(0).extent(); k += k_extent) {
+        struct Staged {
+            Halide::Runtime::Buffer<T> a, out;
+        };
+        auto staged = std::make_shared<Staged>();
+        StreamingChunk chunk;
+        chunk.gather = [=]() {
+            staged->a = stage_region(AK, {AK.dim(0).min() + k, AK.dim(1).min()}, {k_extent, AK.dim(1).extent()});
+            std::vector<int> extents;
+            for (int d = 0; d < out.dimensions(); d++) {
+                extents.push_back(out.dim(d).extent());
+            }
+            staged->out = Halide::Runtime::Buffer<T>(extents);
+        };
+        chunk.compute = [=]() {
+            Halide::Runtime::Buffer<T> c = C;
+            int result = syrk(0, alpha, k == 0 ? beta : T(0), staged->a, c, staged->out);
+            release_device(staged->a);
+            release_device(staged->out);
+            return result;
+        };
+        chunk.scatter = [=]() {
+            Halide::Runtime::Buffer<T> dst = out;
+            std::vector<int> mins;
+            for (int d = 0; d < out.dimensions(); d++) {
+                mins.push_back(out.dim(d).min());
+            }
+            staged->out.set_min(mins);
+            if (k == 0) {
+                dst.copy_from(staged->out);
+            } else {
+                dst.for_each_value([](T &sum, T partial) { sum += partial; }, staged->out);
+            }
+            *staged = Staged();
+        };
+        chunks.push_back(chunk);
+    }
+    return stream_chunks(chunks);
+}
+
+#endif
@@ -0,0 +1,442 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "IR.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Module.h"
+#include "Simplify.h"
+#include "Substitute.h"
+#include "./DebugPrint.h"
+#include "./SystolicSearch.h"
+#include "./Utilities.h"
+#include <algorithm>
+#include <set>
+
+namespace Halide {
+
+using namespace Internal;
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+SystolicSearchSpace &SystolicSearchSpace::knob(const string &name, const vector<int> &values) {
+    user_assert(!values.empty()) << "Knob " << name << " of a systolic search space has no values\n";
+    for (auto &k : knobs) {
+        user_assert(k.first != name) << "Knob " << name << " is defined twice in a systolic search space\n";
+    }
+    knobs.push_back({name, values});
+    return *this;
+}
+
+SystolicSearchSpace &SystolicSearchSpace::tile_knob(const string &name, int extent, int min_factor, int max_factor) {
+    user_assert(extent > 0) << "Tile knob " << name << " expects a positive extent\n";
+    if (max_factor <= 0) {
+        max_factor = extent;
+    }
+    vector<int> factors;
+    for (int f = std::max(1, min_factor); f <= std::min(extent, max_factor); f++) {
+        if (extent % f == 0) {
+            factors.push_back(f);
+        }
+    }
+    return knob(name, factors);
+}
+
+SystolicSearchSpace &SystolicSearchSpace::choice_knob(const string &name, int num_choices) {
+    vector<int> values;
+    for (int i = 0; i < num_choices; i++) {
+        values.push_back(i);
+    }
+    return knob(name, values);
+}
+
+SystolicSearchSpace &SystolicSearchSpace::constraint(std::function<bool(const SystolicConfig &)> predicate) {
+    constraints.push_back(predicate);
+    return *this;
+}
+
+size_t SystolicSearchSpace::size() const {
+    size_t n = knobs.empty() ? 0 : 1;
+    for (auto &k : knobs) {
+        n *= k.second.size();
+    }
+    return n;
+}
+
+vector<SystolicConfig> SystolicSearchSpace::configs() const {
+    vector<SystolicConfig> result;
+    if (knobs.empty()) {
+        return result;
+    }
+    // Odometer over the knobs, with the last knob changing the fastest.
+    vector<size_t> index(knobs.size(), 0);
+    while (true) {
+        SystolicConfig config;
+        for (size_t i = 0; i < knobs.size(); i++) {
+            config[knobs[i].first] = knobs[i].second[index[i]];
+        }
+        bool satisfied = true;
+        for (auto &c : constraints) {
+            if (!c(config)) {
+                satisfied = false;
+                break;
+            }
+        }
+        if (satisfied) {
+            result.push_back(config);
+        }
+        int i = (int)knobs.size() - 1;
+        while (i >= 0 && ++index[i] == knobs[i].second.size()) {
+            index[i] = 0;
+            i--;
+        }
+        if (i < 0) {
+            break;
+        }
+    }
+    return result;
+}
+
+namespace Internal {
+namespace {
+
+class FeaturizeSystolicDesign : public IRVisitor {
+    using IRVisitor::visit;
+    const map<string, int64_t> &estimates;
+    map<string, Expr> known_values;     // Lets whose values are constant given the estimates
+
+    // Per kernel
+    bool in_kernel = false;
+    int64_t iterations = 1;             // Product of the extents of the enclosing sequential loops
+    int64_t unroll = 1;                 // Product of the extents of the enclosing unrolled/vectorized loops
+    int64_t kernel_cycles = 0;          // Cycles of the sequential loops visited so far in the current loop body
+    int64_t kernel_PEs = 0;
+    double kernel_ops = 0;
+    bool kernel_stores_to_dram = false;
+    set<string> kernel_buffers;         // Buffers allocated inside the kernel, i.e. on chip
+    set<string> channels;
+
+    int64_t evaluate(const Expr &e) {
+        Expr v = simplify(substitute(known_values, e));
+        if (const int64_t *c = as_const_int(v)) {
+            return *c;
+        }
+        features.has_symbolic_extents = true;
+        return 1;
+    }
+
+    double dynamic_count(int lanes) const {
+        return (double)iterations * (double)unroll * (double)lanes;
+    }
+
+    void count_arithmetic(const Type &t) {
+        if (in_kernel) {
+            kernel_ops += dynamic_count(t.lanes());
+        }
+    }
+
+    void count_dsp(const Type &t) {
+        if (in_kernel && t.is_float()) {
+            features.dsps += unroll * t.lanes();
+        }
+    }
+
+    template<typename T>
+    void visit_let(const T *op) {
+        op->value.accept(this);
+        Expr v = simplify(substitute(known_values, op->value));
+        bool known = is_const(v);
+        if (known) {
+            known_values[op->name] = v;
+        }
+        op->body.accept(this);
+        if (known) {
+            known_values.erase(op->name);
+        }
+    }
+
+    void visit(const Let *op) override {
+        visit_let(op);
+    }
+
+    void visit(const LetStmt *op) override {
+        visit_let(op);
+    }
+
+    void visit(const For *op) override {
+        if (!in_kernel && ends_with(op->name, ".run_on_device")) {
+            in_kernel = true;
+            iterations = 1;
+            unroll = 1;
+            kernel_cycles = 0;
+            kernel_PEs = 1;
+            kernel_ops = 0;
+            kernel_stores_to_dram = false;
+            kernel_buffers.clear();
+            op->body.accept(this);
+            if (kernel_cycles == 0) {
+                kernel_cycles = 1;
+            }
+            features.num_kernels++;
+            features.cycles = std::max(features.cycles, kernel_cycles);
+            features.num_PEs = std::max(features.num_PEs, kernel_PEs);
+            features.ops += kernel_ops;
+            if (kernel_ops == 0 && kernel_stores_to_dram) {
+                features.drain_cycles = std::max(features.drain_cycles, kernel_cycles);
+            }
+            in_kernel = false;
+            return;
+        }
+        if (!in_kernel) {
+            IRVisitor::visit(op);
+            return;
+        }
+        int64_t extent = std::max((int64_t)0, evaluate(op->extent));
+        // Unrolled loops in device kernels are kept in the IR, and unrolled by the device compiler.
+        bool spatial = (op->for_type == ForType::Unrolled || op->for_type == ForType::PragmaUnrolled ||
+                        op->for_type == ForType::DelayUnroll || op->for_type == ForType::Vectorized);
+        int64_t old_iterations = iterations, old_unroll = unroll, old_cycles = kernel_cycles;
+        if (spatial) {
+            unroll *= extent;
+            kernel_PEs = std::max(kernel_PEs, unroll);
+        } else {
+            iterations *= extent;
+        }
+        op->min.accept(this);
+        kernel_cycles = 0;
+        op->body.accept(this);
+        // Sequential loops one after another in a kernel run one after another, so their cycles add up.
+        // Copies of an unrolled loop run at the same time, i.e. take the cycles of one copy.
+        int64_t body_cycles = kernel_cycles;
+        if (!spatial) {
+            body_cycles = extent * std::max(body_cycles, (int64_t)1);
+        }
+        kernel_cycles = old_cycles + body_cycles;
+        iterations = old_iterations;
+        unroll = old_unroll;
+    }
+
+    void visit(const Allocate *op) override {
+        if (in_kernel) {
+            int64_t size = op->type.bytes();
+            for (auto &e : op->extents) {
+                size *= evaluate(e);
+            }
+            features.onchip_bytes += (double)size;
+            kernel_buffers.insert(op->name);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Realize *op) override {
+        if (in_kernel) {
+            int64_t size = 0;
+            for (auto &t : op->types) {
+                size += t.bytes();
+            }
+            for (auto &r : op->bounds) {
+                size *= evaluate(r.extent);
+            }
+            features.onchip_bytes += (double)size;
+            kernel_buffers.insert(op->name);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Load *op) override {
+        if (in_kernel && kernel_buffers.find(op->name) == kernel_buffers.end()) {
+            features.dram_bytes += dynamic_count(op->type.lanes()) * op->type.bytes();
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) override {
+        if (in_kernel && kernel_buffers.find(op->name) == kernel_buffers.end()) {
+            Type t = op->value.type();
+            features.dram_bytes += dynamic_count(t.lanes()) * t.bytes();
+            kernel_stores_to_dram = true;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Call *op) override {
+        if (in_kernel) {
+            if (op->is_intrinsic(Call::read_channel) || op->is_intrinsic(Call::read_channel_nb) ||
+                op->is_intrinsic(Call::write_channel) || op->is_intrinsic(Call::write_channel_nb)) {
+                const StringImm *name = op->args[0].as<StringImm>();
+                if (name) {
+                    channels.insert(name->value);
+                }
+                features.channel_accesses += dynamic_count(1);
+            }
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Add *op) override {
+        count_arithmetic(op->type);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Sub *op) override {
+        count_arithmetic(op->type);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Mul *op) override {
+        count_arithmetic(op->type);
+        count_dsp(op->type);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Div *op) override {
+        count_arithmetic(op->type);
+        IRVisitor::visit(op);
+    }
+
+public:
+    SystolicFeatures features;
+
+    FeaturizeSystolicDesign(const map<string, int64_t> &_estimates) : estimates(_estimates) {
+        for (auto &e : estimates) {
+            // The variables of the IR are 32-bit, so an estimate out of their range is clamped to it
+            int64_t v = std::min<int64_t>(std::max<int64_t>(e.second, INT32_MIN), INT32_MAX);
+            if (v != e.second) {
+                user_warning << "The estimate " << e.second << " of " << e.first << " is out of the range of a 32-bit "
+                             << "integer, and is clamped to " << v << " in featurizing the design.\n";
+            }
+            known_values[e.first] = make_const(Int(32), v);
+        }
+    }
+
+    void finish() {
+        features.num_channels = (int)channels.size();
+    }
+};
+
+}  // namespace
+}  // namespace Internal
+
+SystolicFeatures featurize_systolic_design(const Stmt &s, const map<string, int64_t> &estimates) {
+    FeaturizeSystolicDesign featurizer(estimates);
+    s.accept(&featurizer);
+    featurizer.finish();
+    return featurizer.features;
+}
+
+SystolicCandidate estimate_systolic_design(const SystolicFeatures &features, const SystolicDeviceModel &device) {
+    SystolicCandidate c;
+    c.features = features;
+    c.feasible = true;
+    if (features.num_kernels == 0) {
+        c.feasible = false;
+        c.why_infeasible = "no device kernel";
+    } else if (features.dsps > device.dsps) {
+        c.feasible = false;
+        c.why_infeasible = "needs " + std::to_string(features.dsps) + " DSPs, but the device has " + std::to_string(device.dsps);
+    } else if (features.onchip_bytes > device.onchip_bytes) {
+        c.feasible = false;
+        c.why_infeasible = "needs " + std::to_string((int64_t)features.onchip_bytes) + " bytes on chip, but the device has " +
+                           std::to_string((int64_t)device.onchip_bytes);
+    }
+    double utilization = std::min(1.0, (double)features.dsps / device.dsps);
+    c.fmax = device.fmax * (1 - device.fmax_degradation * utilization);
+    // cycles / MHz = us
+    double compute_time = (double)features.cycles / c.fmax * 1e3;
+    // bytes / (GB/s) = ns
+    double memory_time = features.dram_bytes / device.mem_bandwidth;
+    c.time = std::max(compute_time, memory_time);
+    c.gflops = (c.time > 0) ? features.ops / c.time : 0;
+    return c;
+}
+
+std::vector<SystolicCandidate> search_systolic_schedules(const SystolicSearchSpace &space,
+                                                         std::function<SystolicDesign(const SystolicConfig &)> build,
+                                                         const SystolicDeviceModel &device,
+                                                         const Target &target,
+                                                         const map<string, int64_t> &estimates,
+                                                         int max_evaluations) {
+    vector<SystolicConfig> configs = space.configs();
+    if (max_evaluations > 0 && configs.size() > (size_t)max_evaluations) {
+        // Evenly sample the configs so that the result is reproducible across runs.
+        vector<SystolicConfig> sampled;
+        double stride = (double)configs.size() / max_evaluations;
+        for (int i = 0; i < max_evaluations; i++) {
+            sampled.push_back(configs[(size_t)(i * stride)]);
+        }
+        configs = sampled;
+    }
+
+    vector<SystolicCandidate> candidates;
+    for (auto &config : configs) {
+        SystolicDesign design = build(config);
+        Module m = design.output.compile_to_module(design.args, "systolic_search", target);
+        SystolicFeatures features;
+        for (auto &f : m.functions()) {
+            SystolicFeatures f_features = featurize_systolic_design(f.body, estimates);
+            features.num_kernels += f_features.num_kernels;
+            features.num_channels += f_features.num_channels;
+            features.num_PEs = std::max(features.num_PEs, f_features.num_PEs);
+            features.dsps += f_features.dsps;
+            features.cycles = std::max(features.cycles, f_features.cycles);
+            features.drain_cycles = std::max(features.drain_cycles, f_features.drain_cycles);
+            features.ops += f_features.ops;
+            features.dram_bytes += f_features.dram_bytes;
+            features.channel_accesses += f_features.channel_accesses;
+            features.onchip_bytes += f_features.onchip_bytes;
+            features.has_symbolic_extents |= f_features.has_symbolic_extents;
+        }
+        SystolicCandidate c = estimate_systolic_design(features, device);
+        c.config = config;
+        debug(1) << "Systolic search: " << c << "\n";
+        candidates.push_back(c);
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const SystolicCandidate &a, const SystolicCandidate &b) {
+                         if (a.feasible != b.feasible) {
+                             return a.feasible;
+                         }
+                         return a.time < b.time;
+                     });
+    return candidates;
+}
+
+std::ostream &operator<<(std::ostream &stream, const SystolicCandidate &c) {
+    stream << "{";
+    bool first = true;
+    for (auto &k : c.config) {
+        stream << (first ? "" : ", ") << k.first << "=" << k.second;
+        first = false;
+    }
+    stream << "} PEs=" << c.features.num_PEs
+           << " DSPs=" << c.features.dsps
+           << " cycles=" << c.features.cycles
+           << " DRAM bytes=" << c.features.dram_bytes
+           << " fmax=" << c.fmax
+           << " time(ns)=" << c.time
+           << " GFLOPS=" << c.gflops;
+    if (!c.feasible) {
+        stream << " infeasible: " << c.why_infeasible;
+    }
+    return stream;
+}
+
+}
@@ -0,0 +1,143 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef T2S_SYSTOLIC_SEARCH_H
+#define T2S_SYSTOLIC_SEARCH_H
+
+/** \file
+ * Defines a search over T2S schedules (tile sizes, space loops, stensor scopes, etc.)
+ * scored with a systolic-array cost model featurized from the lowered IR.
+ */
+
+#include <functional>
+#include <iostream>
+#include "../../Halide/src/Func.h"
+#include "../../Halide/src/Target.h"
+
+namespace Halide {
+
+/** Resources of a spatial device that bound the throughput of a systolic array. */
+struct SystolicDeviceModel {
+    std::string name;
+    int dsps;                   // Number of DSPs (one fused multiply-add per DSP per cycle)
+    double fmax;                // Clock frequency (MHz) of a small design on the device
+    double mem_bandwidth;       // DRAM bandwidth (GB/s)
+    double onchip_bytes;        // Capacity of on-chip memories (bytes)
+    // How much the clock frequency drops when the DSPs are fully used. The frequency
+    // is modeled as fmax * (1 - fmax_degradation * DSP utilization).
+    double fmax_degradation = 0.25;
+
+    SystolicDeviceModel(const std::string &_name, int _dsps, double _fmax, double _mem_bandwidth, double _onchip_bytes)
+        : name(_name), dsps(_dsps), fmax(_fmax), mem_bandwidth(_mem_bandwidth), onchip_bytes(_onchip_bytes) {}
+
+    // Intel Arria 10 GX 1150 and Stratix 10 GX 2800 as found in DevCloud
+    static SystolicDeviceModel a10() { return SystolicDeviceModel("a10", 1518, 300, 33, 6.6e6); }
+    static SystolicDeviceModel s10() { return SystolicDeviceModel("s10", 5760, 400, 75, 28.6e6); }
+};
+
+/** Features of a design extracted from its lowered IR. Dynamic counts assume every
+ * loop runs to its extent; symbolic extents are replaced with the estimates given to
+ * the featurizer, or 1 if there is no estimate. */
+struct SystolicFeatures {
+    int num_kernels = 0;        // Device kernels
+    int num_channels = 0;       // Distinct channels between kernels and between PEs
+    int64_t num_PEs = 0;        // Max #iterations of unrolled/vectorized loops in a kernel
+    int64_t dsps = 0;           // DSPs needed: floating-point multiplies in unrolled/vectorized loops
+    int64_t cycles = 0;         // Max cycles of a kernel assuming II=1: #iterations of sequential loops, added up for sibling loops
+    int64_t drain_cycles = 0;   // #iterations of sequential loops in kernels that only move data out
+    double ops = 0;             // Dynamic arithmetic operations
+    double dram_bytes = 0;      // Dynamic bytes loaded from or stored to device DRAM
+    double channel_accesses = 0;// Dynamic channel reads and writes
+    double onchip_bytes = 0;    // Bytes of buffers allocated inside device kernels
+    bool has_symbolic_extents = false; // Some loop extent was not a constant and had no estimate
+};
+
+/** A point in the search space: the value of every knob. */
+typedef std::map<std::string, int> SystolicConfig;
+
+/** The output Func of a design built for a config, and the arguments to compile it with. */
+struct SystolicDesign {
+    Func output;
+    std::vector<Argument> args;
+};
+
+/** A design evaluated by the cost model. */
+struct SystolicCandidate {
+    SystolicConfig config;
+    SystolicFeatures features;
+    bool feasible = false;      // The design fits into the device
+    double fmax = 0;            // Estimated clock frequency (MHz)
+    double time = 0;            // Estimated execution time (ns)
+    double gflops = 0;          // Estimated throughput
+    std::string why_infeasible;
+};
+
+/** Knobs of a T2S schedule and constraints between them. A knob takes one of a list
+ * of integer values. Categorical choices (e.g. which loops are space loops, or the
+ * loop to use as the scope of a stensor) are knobs whose values index into a list of
+ * choices the design builder knows about. */
+class SystolicSearchSpace {
+    std::vector<std::pair<std::string, std::vector<int>>> knobs;
+    std::vector<std::function<bool(const SystolicConfig &)>> constraints;
+
+public:
+    /** A knob taking any of the given values */
+    SystolicSearchSpace &knob(const std::string &name, const std::vector<int> &values);
+
+    /** A tile size: any divisor of the extent in [min_factor, max_factor] */
+    SystolicSearchSpace &tile_knob(const std::string &name, int extent, int min_factor = 1, int max_factor = 0);
+
+    /** A choice among num_choices alternatives, with values 0..num_choices-1 */
+    SystolicSearchSpace &choice_knob(const std::string &name, int num_choices);
+
+    /** Only configs satisfying the predicate are evaluated */
+    SystolicSearchSpace &constraint(std::function<bool(const SystolicConfig &)> predicate);
+
+    /** All configs satisfying the constraints, in lexicographic order of the knobs */
+    std::vector<SystolicConfig> configs() const;
+
+    /** Number of configs ignoring the constraints */
+    size_t size() const;
+};
+
+/** Extract features from the lowered IR of a design. The estimates give values to symbolic
+ * variables (e.g. "A.extent.0") appearing in loop bounds. */
+SystolicFeatures featurize_systolic_design(const Internal::Stmt &s,
+                                           const std::map<std::string, int64_t> &estimates = {});
+
+/** Score features with the systolic-array cost model of the device. The model assumes
+ * all kernels run concurrently with one iteration per cycle, so that the execution time
+ * is bound by the longest kernel, or by the DRAM traffic, whichever is larger. */
+SystolicCandidate estimate_systolic_design(const SystolicFeatures &features, const SystolicDeviceModel &device);
+
+/** Build, lower and score the design of every config in the space, and return the
+ * candidates sorted from the best to the worst, feasible ones first. If max_evaluations
+ * is positive and the space has more configs than that, a deterministic sample of the
+ * configs is evaluated instead. */
+std::vector<SystolicCandidate> search_systolic_schedules(const SystolicSearchSpace &space,
+                                                         std::function<SystolicDesign(const SystolicConfig &)> build,
+                                                         const SystolicDeviceModel &device,
+                                                         const Target &target,
+                                                         const std::map<std::string, int64_t> &estimates = {},
+                                                         int max_evaluations = 0);
+
+std::ostream &operator<<(std::ostream &stream, const SystolicCandidate &candidate);
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef T2S_TASK_GRAPH_H
+#define T2S_TASK_GRAPH_H
+
+/* A DAG of host tasks, e.g. the invocations of designs on the tiles of a blocked factorization
+ * (See t2s/peppers/lapack/cholesky). A pool of threads runs the tasks whose predecessors have all
+ * finished, the task of the highest priority first, so that the tasks on the critical path are not
+ * delayed by the others, while the others fill the idle threads. */
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class TaskGraph {
+public:
+    typedef int Task;
+
+    // Add a task that runs after the given tasks. A task returns 0, or an error that stops the graph.
+    Task add(std::function<int()> work, int priority, const std::vector<Task> &predecessors) {
+        Task t = (Task)tasks.size();
+        tasks.push_back({work, priority, 0, {}});
+        for (Task p : predecessors) {
+            if (p >= 0) {
+                tasks[p].successors.push_back(t);
+                tasks[t].waiting++;
+            }
+        }
+        return t;
+    }
+
+    // Run all the tasks with num_threads threads. Return 0, or the first error of a task, in which case
+    // the tasks not started yet are skipped.
+    int run(int num_threads = std::thread::hardware_concurrency()) {
+        std::mutex m;
+        std::condition_variable cv;
+        std::priority_queue<std::pair<int, Task>> ready;
+        size_t finished = 0;
+        int result = 0;
+        for (Task t = 0; t < (Task)tasks.size(); t++) {
+            if (tasks[t].waiting == 0) {
+                ready.push({tasks[t].priority, -t});
+            }
+        }
+        auto worker = [&]() {
+            std::unique_lock<std::mutex> lock(m);
+            while (true) {
+                cv.wait(lock, [&]() { return !ready.empty() || finished == tasks.size() || result != 0; });
+                if (ready.empty() || result != 0) {
+                    return;
+                }
+                Task t = -ready.top().second;
+                ready.pop();
+                lock.unlock();
+                int r = tasks[t].work();
+                lock.lock();
+                finished++;
+                if (r != 0 && result == 0) {
+                    result = r;
+                }
+                for (Task s : tasks[t].successors) {
+                    if (--tasks[s].waiting == 0) {
+                        ready.push({tasks[s].priority, -s});
+                    }
+                }
+                cv.notify_all();
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < std::max(1, num_threads); i++) {
+            threads.push_back(std::thread(worker));
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        tasks.clear();
+        return result;
+    }
+
+private:
+    struct Node {
+        std::function<int()> work;
+        int priority;
+        int waiting;                    // The number of predecessors not finished yet
+        std::vector<Task> successors;
+    };
+    std::vector<Node> tasks;
+};
+
+#endif
@@ -30,6 +30,10 @@
 namespace Halide {
 namespace Internal {
 
+// The maximum number of devices the generated host code of a design can run on. The generated code defines
+// MAX_DEVICES, which AOT-OpenCL-Runtime.cpp reads, and sizes its arrays of queues, devices and kernels with it.
+const int max_devices = 4;
+
 // If the environment contains the given function name, set func and return true.
 bool function_is_in_environment(const std::string &func_name, const std::map<std::string, Function> &env, Function &func);
 
@@ -0,0 +1,201 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef T2S_VARIANT_LIBRARY_H
+#define T2S_VARIANT_LIBRARY_H
+
+/* A library of variants of a design, i.e. the same specification specialized with different params
+ * (tile sizes, data type, etc.) at compile time. The host dispatches every invocation to the variant
+ * that fits the problem best.
+ *
+ * A generator compiles the variants into a directory, where it lists them in a manifest, <design>.variants,
+ * one per line:
+ *     <variant> <param>=<value> <param>=<value> ...
+ * The generated C interfaces of the variants define the same globals (the OpenCL context, the kernels, etc.),
+ * so every variant v is linked with the AOT runtime into a shared library of its own, lib<v>.so, exporting
+ * the function v, and the bitstream of the variant is v.aocx. See t2s/tests/performance/Makefile.variants.
+ * The libraries are loaded on demand, each with its own symbols. Switching between variants reprograms
+ * the device with the bitstream of the variant. */
+
+#include <dlfcn.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct DesignVariant {
+    std::string name;
+    std::map<std::string, std::string> params;
+
+    // The integer value of a param, or the default value if the variant does not set it
+    int param(const std::string &p, int default_value = 0) const {
+        auto v = params.find(p);
+        return v == params.end() ? default_value : atoi(v->second.c_str());
+    }
+};
+
+// Read the variants listed in a file, where '#' starts a comment. Return false if the file cannot be read or
+// is malformed.
+inline bool read_design_variants(const std::string &file, std::vector<DesignVariant> &variants) {
+    std::ifstream in(file);
+    if (!in) {
+        fprintf(stderr, "Cannot read variants file %s\n", file.c_str());
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        DesignVariant v;
+        if (!(words >> v.name)) {
+            continue;
+        }
+        std::string word;
+        while (words >> word) {
+            size_t eq = word.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                fprintf(stderr, "Expect param=value for variant %s in %s, but got %s\n",
+                        v.name.c_str(), file.c_str(), word.c_str());
+                return false;
+            }
+            v.params[word.substr(0, eq)] = word.substr(eq + 1);
+        }
+        variants.push_back(v);
+    }
+    return true;
+}
+
+inline bool write_design_variants(const std::string &file, const std::vector<DesignVariant> &variants) {
+    std::ofstream out(file);
+    for (auto &v : variants) {
+        out << v.name;
+        for (auto &p : v.params) {
+            out << " " << p.first << "=" << p.second;
+        }
+        out << "\n";
+    }
+    return (bool)out;
+}
+
+// The work of a loop nest of the given extents, each padded up to a multiple of its tile
+inline double padded_work(const std::vector<std::pair<int64_t, int64_t>> &extents_and_tiles) {
+    double work = 1;
+    for (auto &e : extents_and_tiles) {
+        work *= (double)((e.first + e.second - 1) / e.second * e.second);
+    }
+    return work;
+}
+
+class VariantLibrary {
+public:
+    // Load the manifest of a design from the directory of its variants
+    VariantLibrary(const std::string &dir, const std::string &design)
+        : dir(dir) {
+        loaded = read_design_variants(dir + "/" + design + ".variants", all);
+    }
+
+    ~VariantLibrary() {
+        for (auto &l : libraries) {
+            dlclose(l.second);
+        }
+    }
+
+    bool ok() const { return loaded && !all.empty(); }
+    const std::vector<DesignVariant> &variants() const { return all; }
+
+    // The variant of the least cost, or NULL if every variant costs infinity (i.e. cannot run the problem).
+    // Among variants of equal cost, the first in the manifest is chosen.
+    const DesignVariant *select(const std::function<double(const DesignVariant &)> &cost) const {
+        const DesignVariant *best = NULL;
+        double best_cost = std::numeric_limits<double>::infinity();
+        for (auto &v : all) {
+            double c = cost(v);
+            if (c < best_cost) {
+                best = &v;
+                best_cost = c;
+            }
+        }
+        return best;
+    }
+
+    // Invoke a variant, e.g. run(*v, A.raw_buffer(), B.raw_buffer(), C.raw_buffer()) for gemm.
+    // Return the result of the variant, or -1 if it cannot be loaded. Not thread-safe.
+    template<typename... Args>
+    int run(const DesignVariant &v, Args... args) {
+        typedef int (*Function)(Args...);
+        Function f = (Function)function_of(v.name);
+        if (f == NULL) {
+            return -1;
+        }
+        // The runtime of the variant programs the device with the bitstream named by BITSTREAM when the
+        // variant is invoked for the first time.
+        setenv("BITSTREAM", (dir + "/" + v.name + ".aocx").c_str(), 1);
+        if (programmed_variant != v.name) {
+            programmed_variant = v.name;
+            num_reconfigurations++;
+        }
+        return f(args...);
+    }
+
+    // The variant invoked last, i.e. whose bitstream the device is programmed with, or NULL
+    const DesignVariant *programmed() const {
+        for (auto &v : all) {
+            if (v.name == programmed_variant) {
+                return &v;
+            }
+        }
+        return NULL;
+    }
+
+    // How many times the device has been programmed with the bitstream of a variant
+    int reconfigurations() const { return num_reconfigurations; }
+
+private:
+    void *function_of(const std::string &name) {
+        auto l = libraries.find(name);
+        if (l == libraries.end()) {
+            std::string file = dir + "/lib" + name + ".so";
+            void *library = dlopen(file.c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (library == NULL) {
+                fprintf(stderr, "Cannot load variant %s: %s\n", name.c_str(), dlerror());
+                return NULL;
+            }
+            l = libraries.insert({name, library}).first;
+        }
+        void *f = dlsym(l->second, name.c_str());
+        if (f == NULL) {
+            fprintf(stderr, "Variant %s does not export function %s\n", name.c_str(), name.c_str());
+        }
+        return f;
+    }
+
+    std::string dir;
+    std::vector<DesignVariant> all;
+    bool loaded;
+    std::map<std::string, void *> libraries;
+    std::string programmed_variant;
+    int num_reconfigurations = 0;
+};
+
+#endif
@@ -169,6 +169,10 @@ int main() {
     Target target = get_host_target();     // Get the CPU host
     target.set_feature(Target::IntelFPGA); // To execute on an Intel FPGA device attached to the host.
     target.set_feature(Target::EnableSynthesis);
+#ifdef PROFILE_DEVICE
+    // Measure the cycles and count the loop iterations of the kernels
+    target.set_feature(Target::ProfileDevice);
+#endif
     Func mm = matrix_multiply();           // Get the compute.
 
     std::vector<Argument> args = {a, b};
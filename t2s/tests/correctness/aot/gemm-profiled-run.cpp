@@ -0,0 +1,132 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "host.h"
+// The profile of the kernels recorded by the runtime
+#include "DeviceProfile.h"
+
+// The only header file needed for including T2S.
+#include "HalideBuffer.h"
+
+#include <math.h>
+#include <string.h>
+// For printing output
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+// For validation of results.
+#include <assert.h>
+
+// using namespace Halide;
+using namespace std;
+
+#define OUTERMOST_I 2
+#define OUTERMOST_J 2
+#define OUTERMOST_K 2
+#define II   4
+#define JJ   4
+#define KK   256
+#define III  2
+#define JJJ  4
+#define KKK  4
+
+int main() {
+    const int TOTAL_I = III * II * OUTERMOST_I;
+    const int TOTAL_J = JJJ * JJ * OUTERMOST_J;
+    const int TOTAL_K = KKK * KK * OUTERMOST_K;
+    Halide::Runtime::Buffer<float> ina(TOTAL_K, TOTAL_I), inb(TOTAL_J, TOTAL_K);
+    for (size_t i = 0; i < TOTAL_I; i++) {
+        for (size_t k = 0; k < TOTAL_K; k++) {
+            ina(k, i) = k + i;
+        }
+    }
+    for (size_t k = 0; k < TOTAL_K; k++) {
+        for (size_t j = 0; j < TOTAL_J; j++) {
+            inb(j, k) = j - k;
+        }
+    }
+
+    Halide::Runtime::Buffer<float> result(JJJ, III, JJ, II, OUTERMOST_J, OUTERMOST_I);
+    // Run twice: the counters of every run are recorded
+    GEMM(ina, inb, result);
+    GEMM(ina, inb, result);
+
+    // Step 3: Validate the results
+    for (size_t i = 0; i < OUTERMOST_I; i++) {
+        for (size_t j = 0; j < OUTERMOST_J; j++) {
+            for (size_t ii = 0; ii < II; ii++) {
+                for (size_t jj = 0; jj < JJ; jj++) {
+                    for (size_t iii = 0; iii < III; iii++) {
+                        for (size_t jjj = 0; jjj < JJJ; jjj++) {
+                            size_t i1 = iii + III * ii + III * II * i;
+                            size_t j1 = jjj + JJJ * jj + JJJ * JJ * j;
+                            float golden = 0.0f;
+                            for (size_t k1 = 0; k1 < TOTAL_K; k1++) {
+                                golden += ina(k1, i1) * inb(j1, k1);
+                            }
+                            // cout << "(" << j1 << ", " << i1 << ") = " << golden << " " << result(jjj, iii, jj, ii, j, i) << endl;
+                            assert(fabs(golden - result(jjj, iii, jj, ii, j, i)) < 0.005*fabs(golden));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Step 4: Validate the profile. The systolic array and the feeders and drainers receive the loop bounds over
+    // control channels, and stay autorun. They send the counters of every run to the unloader, which relays them.
+    // No loop of a kernel is instrumented: only the device clock is read with non-blocking calls.
+    std::ifstream cl("b.cl");
+    std::stringstream source;
+    source << cl.rdbuf();
+    string code = source.str();
+    assert(code.find("__attribute__((autorun))\n__kernel void kernel_A(") != string::npos);
+    assert(code.find("__kernel void kernel_t2s_device_clock()") != string::npos);
+    for (size_t at = code.find("read_channel_nb_intel("); at != string::npos; at = code.find("read_channel_nb_intel(", at + 1)) {
+        assert(code.compare(at + strlen("read_channel_nb_intel("), strlen("_t2s_device_clock"), "_t2s_device_clock") == 0);
+    }
+    const DeviceProfile &profile = t2s_device_profile();
+    const DeviceKernelProfile *loader = NULL, *unloader = NULL, *systolic_array = NULL;
+    for (auto &k : profile.kernels()) {
+        assert(k.runs.size() == 2);
+        assert(k.cycles() == k.busy_cycles() + k.stalls());
+        assert(!k.counters.empty() && k.counters[0].kind == DeviceProfileCounter::Cycles);
+        if (k.kernel == "kernel_aLoader") {
+            loader = &k;
+        } else if (k.kernel == "kernel_unloader") {
+            unloader = &k;
+        } else if (k.kernel == "kernel_A") {
+            systolic_array = &k;
+        }
+    }
+    assert(loader != NULL && unloader != NULL && systolic_array != NULL);
+    assert(loader->busy_cycles() > 0 && unloader->busy_cycles() > 0 && systolic_array->busy_cycles() > 0);
+    assert(unloader->utilisation() > 0 && unloader->utilisation() <= 1);
+    assert(profile.bottleneck("GEMM") != NULL);
+    // The runtime prints the report when the program exits
+    string report = profile.report();
+    assert(report.find("GEMM (device)") != string::npos && report.find("kernel_unloader") != string::npos);
+    assert(profile.chrome_trace().find("\"ph\": \"X\"") != string::npos);
+    cout << "Success!\n";
+    return 0;
+}
+
+
+
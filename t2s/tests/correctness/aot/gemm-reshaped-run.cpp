@@ -0,0 +1,105 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "host.h"
+
+// The only header file needed for including T2S.
+#include "HalideBuffer.h"
+
+#include <math.h>
+// For printing output
+#include <stdio.h>
+#include <iostream>
+
+// For validation of results.
+#include <assert.h>
+
+// using namespace Halide;
+using namespace std;
+
+#define II   4
+#define JJ   4
+#define KK   256
+#define III  2
+#define JJJ  4
+#define KKK  4
+
+// The kernels launched by the host (defined in host.cpp)
+extern const char *kernel_name[];
+extern int NUM_KERNELS_TO_CREATE;
+
+void test(int OUTERMOST_I, int OUTERMOST_J, int OUTERMOST_K) {
+    const int TOTAL_I = III * II * OUTERMOST_I;
+    const int TOTAL_J = JJJ * JJ * OUTERMOST_J;
+    const int TOTAL_K = KKK * KK * OUTERMOST_K;
+    // With OUTERMOST_I = 0, matrix a has fewer rows than a tile, and the autorun kernels get an extent of 0. The
+    // buffers keep some rows so as not to be empty on the device.
+    const int ROWS = (OUTERMOST_I == 0) ? III * II / 2 : TOTAL_I;
+    Halide::Runtime::Buffer<float> ina(TOTAL_K, ROWS), inb(TOTAL_J, TOTAL_K);
+    for (size_t i = 0; i < ROWS; i++) {
+        for (size_t k = 0; k < TOTAL_K; k++) {
+            ina(k, i) = k + i;
+        }
+    }
+    for (size_t k = 0; k < TOTAL_K; k++) {
+        for (size_t j = 0; j < TOTAL_J; j++) {
+            inb(j, k) = j - k;
+        }
+    }
+
+    Halide::Runtime::Buffer<float> result(JJJ, III, JJ, II, OUTERMOST_J, (OUTERMOST_I == 0) ? 1 : OUTERMOST_I);
+    GEMM(ina, inb, result);
+
+    for (size_t i = 0; i < OUTERMOST_I; i++) {
+        for (size_t j = 0; j < OUTERMOST_J; j++) {
+            for (size_t ii = 0; ii < II; ii++) {
+                for (size_t jj = 0; jj < JJ; jj++) {
+                    for (size_t iii = 0; iii < III; iii++) {
+                        for (size_t jjj = 0; jjj < JJJ; jjj++) {
+                            size_t i1 = iii + III * ii + III * II * i;
+                            size_t j1 = jjj + JJJ * jj + JJJ * JJ * j;
+                            float golden = 0.0f;
+                            for (size_t k1 = 0; k1 < TOTAL_K; k1++) {
+                                golden += ina(k1, i1) * inb(j1, k1);
+                            }
+                            assert(fabs(golden - result(jjj, iii, jj, ii, j, i)) < 0.005*fabs(golden));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    // The systolic array depends on the extents of the matrices only, which it receives through control
+    // channels, and thus runs without being launched by the host
+    for (int i = 0; i < NUM_KERNELS_TO_CREATE; i++) {
+        assert(string(kernel_name[i]) != "kernel_A");
+    }
+
+    // The autorun kernels get the extents of every run. A run with an extent of 0 does no iteration, and
+    // the next run is still correct.
+    test(2, 2, 2);
+    test(1, 3, 2);
+    test(0, 2, 2);
+    test(3, 1, 1);
+    test(2, 2, 2);
+    cout << "Success!\n";
+    return 0;
+}
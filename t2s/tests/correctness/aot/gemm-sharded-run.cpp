@@ -0,0 +1,105 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "host.h"
+
+// The only header file needed for including T2S.
+#include "HalideBuffer.h"
+
+// Shard the design across devices
+#include "ShardedExecution.h"
+
+#include <math.h>
+// For printing output
+#include <stdio.h>
+#include <iostream>
+
+// For validation of results.
+#include <assert.h>
+
+// using namespace Halide;
+using namespace std;
+
+#define OUTERMOST_I 2
+#define OUTERMOST_J 2
+#define OUTERMOST_K 2
+#define II   4
+#define JJ   4
+#define KK   256
+#define III  2
+#define JJJ  4
+#define KKK  4
+
+void check(const Halide::Runtime::Buffer<float> &ina, const Halide::Runtime::Buffer<float> &inb,
+           const Halide::Runtime::Buffer<float> &result) {
+    const int TOTAL_K = KKK * KK * OUTERMOST_K;
+    for (size_t i = 0; i < OUTERMOST_I; i++) {
+        for (size_t j = 0; j < OUTERMOST_J; j++) {
+            for (size_t ii = 0; ii < II; ii++) {
+                for (size_t jj = 0; jj < JJ; jj++) {
+                    for (size_t iii = 0; iii < III; iii++) {
+                        for (size_t jjj = 0; jjj < JJJ; jjj++) {
+                            size_t i1 = iii + III * ii + III * II * i;
+                            size_t j1 = jjj + JJJ * jj + JJJ * JJ * j;
+                            float golden = 0.0f;
+                            for (size_t k1 = 0; k1 < TOTAL_K; k1++) {
+                                golden += ina(k1, i1) * inb(j1, k1);
+                            }
+                            assert(fabs(golden - result(jjj, iii, jj, ii, j, i)) < 0.005*fabs(golden));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    const int TOTAL_I = III * II * OUTERMOST_I;
+    const int TOTAL_J = JJJ * JJ * OUTERMOST_J;
+    const int TOTAL_K = KKK * KK * OUTERMOST_K;
+    Halide::Runtime::Buffer<float> ina(TOTAL_K, TOTAL_I), inb(TOTAL_J, TOTAL_K);
+    for (size_t i = 0; i < TOTAL_I; i++) {
+        for (size_t k = 0; k < TOTAL_K; k++) {
+            ina(k, i) = k + i;
+        }
+    }
+    for (size_t k = 0; k < TOTAL_K; k++) {
+        for (size_t j = 0; j < TOTAL_J; j++) {
+            inb(j, k) = j - k;
+        }
+    }
+
+    // The test runs with 2 emulated devices
+    assert(halide_opencl_get_device_count(NULL) == 2);
+    auto gemm = [](Halide::Runtime::Buffer<float> &a, Halide::Runtime::Buffer<float> &b,
+                   Halide::Runtime::Buffer<float> &c) { return GEMM(a, b, c); };
+
+    // Shard i across the devices
+    Halide::Runtime::Buffer<float> result(JJJ, III, JJ, II, OUTERMOST_J, OUTERMOST_I);
+    assert(shard_gemm<float>(gemm, ina, inb, result, KKK * KK, GemmSharding(2, 1, 1)) == 0);
+    check(ina, inb, result);
+
+    // Shard k across the devices, and sum up the partial products on the host
+    result.fill(0);
+    assert(shard_gemm<float>(gemm, ina, inb, result, KKK * KK, GemmSharding(1, 1, 2)) == 0);
+    check(ina, inb, result);
+
+    cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "host.h"
+
+// The only header file needed for including T2S.
+#include "HalideBuffer.h"
+
+// Stream the operands through the design in chunks
+#include "StreamingExecution.h"
+
+#include <math.h>
+// For printing output
+#include <stdio.h>
+#include <iostream>
+
+// For validation of results.
+#include <assert.h>
+
+// using namespace Halide;
+using namespace std;
+
+#define OUTERMOST_I 6
+#define OUTERMOST_J 2
+#define OUTERMOST_K 2
+#define II   4
+#define JJ   4
+#define KK   256
+#define III  2
+#define JJJ  4
+#define KKK  4
+
+void check(const Halide::Runtime::Buffer<float> &ina, const Halide::Runtime::Buffer<float> &inb,
+           const Halide::Runtime::Buffer<float> &result) {
+    const int TOTAL_K = KKK * KK * OUTERMOST_K;
+    for (size_t i = 0; i < OUTERMOST_I; i++) {
+        for (size_t j = 0; j < OUTERMOST_J; j++) {
+            for (size_t ii = 0; ii < II; ii++) {
+                for (size_t jj = 0; jj < JJ; jj++) {
+                    for (size_t iii = 0; iii < III; iii++) {
+                        for (size_t jjj = 0; jjj < JJJ; jjj++) {
+                            size_t i1 = iii + III * ii + III * II * i;
+                            size_t j1 = jjj + JJJ * jj + JJJ * JJ * j;
+                            float golden = 0.0f;
+                            for (size_t k1 = 0; k1 < TOTAL_K; k1++) {
+                                golden += ina(k1, i1) * inb(j1, k1);
+                            }
+                            assert(fabs(golden - result(jjj, iii, jj, ii, j, i)) < 0.005*fabs(golden));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    const int TOTAL_I = III * II * OUTERMOST_I;
+    const int TOTAL_J = JJJ * JJ * OUTERMOST_J;
+    const int TOTAL_K = KKK * KK * OUTERMOST_K;
+    Halide::Runtime::Buffer<float> ina(TOTAL_K, TOTAL_I), inb(TOTAL_J, TOTAL_K);
+    for (size_t i = 0; i < TOTAL_I; i++) {
+        for (size_t k = 0; k < TOTAL_K; k++) {
+            ina(k, i) = k + i;
+        }
+    }
+    for (size_t k = 0; k < TOTAL_K; k++) {
+        for (size_t j = 0; j < TOTAL_J; j++) {
+            inb(j, k) = j - k;
+        }
+    }
+    auto gemm = [](Halide::Runtime::Buffer<float> &a, Halide::Runtime::Buffer<float> &b,
+                   Halide::Runtime::Buffer<float> &c) { return GEMM(a, b, c); };
+
+    // A budget of 1 k-tile of a column panel of B per device buffer: i and j are chunked into 3 and 2
+    // chunks, and k into 2 chunks, whose partial products are summed up on the host.
+    const uint64_t gemm_budget = sizeof(float) * (KKK * KK) * (JJJ * JJ);
+    Halide::Runtime::Buffer<float> result(JJJ, III, JJ, II, OUTERMOST_J, OUTERMOST_I);
+    assert(stream_gemm<float>(gemm, ina, inb, result, KKK * KK, gemm_budget) == 0);
+    check(ina, inb, result);
+
+    // Stream the outermost loop i with a budget of B: B is passed whole to every chunk, and a chunk has
+    // 4 row panels of A and of the result, i.e. the 6 iterations are chunked into 4 + 2.
+    result.fill(0);
+    assert(stream_outermost_loop<float>([&](std::vector<Halide::Runtime::Buffer<float>> &b) { return gemm(b[0], b[1], b[2]); },
+                                        {{ina, 1, III * II, false}, {inb, -1, 0, false}, {result, 5, 1, true}},
+                                        OUTERMOST_I, sizeof(float) * TOTAL_K * TOTAL_J) == 0);
+    check(ina, inb, result);
+
+    // Stream the row panels of A as a batch of unknown size, as if they arrived one by one
+    struct Panel {
+        Halide::Runtime::Buffer<float> a, c;
+        int i;
+    };
+    int next_panel = 0;
+    int panels_read = 0, panels_written = 0;
+    result.fill(0);
+    int status = stream_batches<Panel>(
+        [&]() {
+            auto p = std::make_shared<Panel>();
+            p->a = Halide::Runtime::Buffer<float>(TOTAL_K, III * II);
+            p->c = Halide::Runtime::Buffer<float>(JJJ, III, JJ, II, OUTERMOST_J, 1);
+            return p;
+        },
+        [&](Panel &p) {
+            if (next_panel == OUTERMOST_I) {
+                return 0;
+            }
+            p.i = next_panel++;
+            p.a.set_min({0, p.i * III * II});
+            p.a.copy_from(ina);
+            p.a.set_min({0, 0});
+            panels_read++;
+            return 1;
+        },
+        [&](Panel &p, int n) {
+            assert(n == 1);
+            int r = gemm(p.a, inb, p.c);
+            release_device(p.a);
+            release_device(p.c);
+            return r;
+        },
+        [&](Panel &p, int n) {
+            p.c.set_min({0, 0, 0, 0, 0, p.i});
+            result.copy_from(p.c);
+            panels_written++;
+        });
+    assert(status == 0);
+    assert(panels_read == OUTERMOST_I && panels_written == OUTERMOST_I);
+    check(ina, inb, result);
+
+    // Stream C' = alpha * A^T * A + beta * C, with A in the (N, K) layout of opa = 1, through a SYRK design
+    // emulated with the gemm design: out = A^T * A on the device, and alpha and beta on the host. K is chunked
+    // into 2 chunks, which stream_syrk stages in the (K, N) layout of the design.
+    const int N = JJJ * JJ;
+    Halide::Runtime::Buffer<float> at(N, TOTAL_K), cc(N, N), out(JJJ, III, JJ, II, 1, N / (III * II));
+    for (size_t k = 0; k < TOTAL_K; k++) {
+        for (size_t n = 0; n < N; n++) {
+            at(n, k) = (float)((n + k) % 7) - 3;
+        }
+    }
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = 0; j < N; j++) {
+            cc(j, i) = j - i;
+        }
+    }
+    const float alpha = 2.0f, beta = 3.0f;
+    auto syrk = [](int opa, float alpha, float beta, Halide::Runtime::Buffer<float> &a,
+                   Halide::Runtime::Buffer<float> &c, Halide::Runtime::Buffer<float> &o) {
+        assert(opa == 0 && a.dim(0).extent() == KKK * KK);
+        Halide::Runtime::Buffer<float> b(a.dim(1).extent(), a.dim(0).extent());
+        b.for_each_element([&](int n, int k) { b(n, k) = a(k, n); });
+        int r = GEMM(a, b, o);
+        release_device(b);
+        o.for_each_element([&](int jjj, int iii, int jj, int ii, int j, int i) {
+            o(jjj, iii, jj, ii, j, i) = alpha * o(jjj, iii, jj, ii, j, i)
+                + beta * c(jjj + JJJ * jj + JJJ * JJ * j, iii + III * ii + III * II * i);
+        });
+        return r;
+    };
+    assert(stream_syrk<float>(syrk, 1, alpha, beta, at, cc, out, KKK * KK) == 0);
+    out.for_each_element([&](int jjj, int iii, int jj, int ii, int j, int i) {
+        int i1 = iii + III * ii + III * II * i, j1 = jjj + JJJ * jj + JJJ * JJ * j;
+        float golden = beta * cc(j1, i1);
+        for (int k = 0; k < TOTAL_K; k++) {
+            golden += alpha * at(i1, k) * at(j1, k);
+        }
+        assert(fabs(golden - out(jjj, iii, jj, ii, j, i)) <= 0.005 * fabs(golden) + 0.001);
+    });
+
+    cout << "Success!\n";
+    return 0;
+}
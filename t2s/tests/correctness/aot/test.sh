@@ -9,6 +9,10 @@ NOCOLOR='\033[0m'
 regression=(
         gemm
         lu
+        gemm-sharded
+        gemm-profiled
+        gemm-reshaped
+        gemm-streamed
         )
 
 succ=0
@@ -17,8 +21,22 @@ fail=0
 function emulate_func {
     eval file="$1"
     printf "$file emulate"
-    compile1="   g++ $file-generate.cpp -g -I ../util -I ../../../../Halide/include -L ../../../../Halide/bin $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 "
-    rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt a.out
+    # A sharded test runs the design of its prefix (e.g. gemm-sharded runs gemm) on 2 emulated devices
+    design=${file%%-*}
+    devices=1
+    if [[ $file == *-sharded ]]; then
+        devices=2
+    fi
+    # A profiled test runs the design of its prefix compiled with Target::ProfileDevice. The runtime prints the
+    # profile after the test passes.
+    profile=
+    last_lines=1
+    if [[ $file == *-profiled ]]; then
+        profile=-DPROFILE_DEVICE
+        last_lines=100000
+    fi
+    compile1="   g++ $design-generate.cpp $profile -g -I ../util -I ../../../../Halide/include -L ../../../../Halide/bin $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 "
+    rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt device_profile.txt device_trace.json a.out
     $compile1 >& a
     if [ -f "a.out" ]; then
         # There is an error "Unterminated quoted string" using $run due to AOC_OPTION. To avoid it, explicitly run for every case.
@@ -28,11 +46,11 @@ function emulate_func {
         compile2="   g++ $file-run.cpp host.cpp ../../../src/AOT-OpenCL-Runtime.cpp ../../../src/SharedUtilsInC.cpp -g -DLINUX -DALTERA_CL -fPIC -I../../../src/ -I ../../../../Halide/include -I$INTELFPGAOCLSDKROOT/examples_aoc/common/inc $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/opencl.cpp $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/options.cpp -I$INTELFPGAOCLSDKROOT/host/include -L$INTELFPGAOCLSDKROOT/linux64/lib -L$AOCL_BOARD_PACKAGE_ROOT/linux64/lib -L$INTELFPGAOCLSDKROOT/host/linux64/lib -lOpenCL -L ../../../../Halide/bin -lelf $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 "
         $compile2 >& a
         if [ -f "a.out" ]; then
-            run2="env CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=1 INTEL_FPGA_OCL_PLATFORM_NAME="\""$EMULATOR_PLATFORM"\"" BITSTREAM=b.aocx ./a.out"
-            timeout 5m env CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=1 INTEL_FPGA_OCL_PLATFORM_NAME="$EMULATOR_PLATFORM" BITSTREAM=b.aocx ./a.out >& a
-            if  tail -n 1 a | grep -q -E "^Success!"; then
+            run2="env CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=$devices INTEL_FPGA_OCL_PLATFORM_NAME="\""$EMULATOR_PLATFORM"\"" BITSTREAM=b.aocx ./a.out"
+            timeout 5m env CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=$devices INTEL_FPGA_OCL_PLATFORM_NAME="$EMULATOR_PLATFORM" BITSTREAM=b.aocx ./a.out >& a
+            if  tail -n $last_lines a | grep -q -E "^Success!"; then
                 echo >> success.txt
-                echo "rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt a.out" >> success.txt
+                echo "rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt device_profile.txt device_trace.json a.out" >> success.txt
                 echo $compile1 >> success.txt
                 echo $run1 >> success.txt
                 echo $compile2 >> success.txt
@@ -42,7 +60,7 @@ function emulate_func {
                 echo " Success!"
             else
                 echo >> failure.txt
-                echo "rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt a.out" >> failure.txt
+                echo "rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt device_profile.txt device_trace.json a.out" >> failure.txt
                 echo $compile1 >> failure.txt
                 echo $run1 >> failure.txt
                 echo $compile2 >> failure.txt
@@ -53,7 +71,7 @@ function emulate_func {
             fi
         else
             echo >> failure.txt
-            echo "rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt a.out" >> failure.txt
+            echo "rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt device_profile.txt device_trace.json a.out" >> failure.txt
             echo $compile1 >> failure.txt
             echo $run1 >> failure.txt
             echo $compile2 >> failure.txt
@@ -63,13 +81,13 @@ function emulate_func {
         fi
     else
         echo >> failure.txt
-        echo "rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt a.out" >> failure.txt
+        echo "rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt device_profile.txt device_trace.json a.out" >> failure.txt
         echo $compile1 >> failure.txt
         cat a >> failure.txt
         let fail=fail+1
         echo " Failure!"
     fi 
-    rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt a.out
+    rm -rf b b.aoc* b.cl a host.cpp host.h exec_time.txt device_profile.txt device_trace.json a.out
 }
         
 rm -f success.txt failure.txt
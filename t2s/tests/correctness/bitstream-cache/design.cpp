@@ -0,0 +1,53 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// A small design whose bitstream is compiled through the bitstream cache (t2s/src/BitstreamCache.h). The
+// kernel changes with SCALE, which makes its bitstream stale.
+#include "Halide.h"
+
+using namespace Halide;
+
+#ifndef SCALE
+#define SCALE 2
+#endif
+
+#define PES 4
+#define N   64
+
+int main() {
+    ImageParam a(Float(32), 1, "a");
+    Var p, t;
+    Func A("A", Float(32), {p, t}, Place::Device), O("O", Place::Device);
+    A(p, t) = select(p == 0, a(t), A(p - 1, t)) * SCALE;
+    O(t) = select(p == PES - 1, A(p, t));
+    A.merge_ures(O)
+     .set_bounds(p, 0, PES, t, 0, N)
+     .space_time_transform(p);
+
+    Func serializer("serializer", Place::Host), loader("loader", Place::Device),
+         unloader("unloader", Place::Device), deserializer("deserializer", Place::Host);
+    A.isolate_producer_chain(a, serializer, loader);
+    loader.set_bounds(p, 0, 1);
+    O.isolate_consumer_chain(unloader, deserializer);
+
+    Target target = get_host_target();
+    target.set_feature(Target::IntelFPGA);
+    target.set_feature(Target::EnableSynthesis);
+    deserializer.compile_to_host("host", {a}, "design", target);
+    return 0;
+}
@@ -0,0 +1,30 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// The choice of the bitstream that the AOT runtime makes before loading it (halide_opencl_init_devices in
+// t2s/src/AOT-OpenCL-Runtime.cpp). Prints whether the emulator is used, and the bitstream to load.
+#include "SharedUtilsInC.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int main() {
+    int emulated = use_emulator_while_bitstream_pending();
+    const char *bitstream = getenv("BITSTREAM");
+    printf("%d %s\n", emulated, bitstream ? bitstream : "");
+    return 0;
+}
@@ -0,0 +1,159 @@
+#!/bin/bash
+# ./test.sh
+# Test the bitstream cache (t2s/src/BitstreamCache.h) with a stub of aoc, which only copies the source into
+# the bitstream. Every case runs the compiler of a small design, and checks how many times aoc is called.
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NOCOLOR='\033[0m'
+
+# In this array, every element contains:
+# Test case
+regression=(
+        miss
+        up_to_date
+        stale
+        aoc_failure
+        hit
+        option
+        ahead_of_time
+        async
+        pending_emulator
+        concurrent
+)
+
+succ=0
+fail=0
+
+export PATH=$PWD:$PATH
+export BITSTREAM_CACHE=$PWD/cache
+export AOC_CALLS=$PWD/calls
+export AOC_OPTION="-board=$FPGA_BOARD"
+export BITSTREAM=b.aocx
+unset AOC_ASYNC AOC_DELAY AOC_FAIL WAIT
+
+function clean_func {
+    rm -rf a a.out1 a.out2 a.out3 b b.aocx* b.cl c c.aocx* c.cl cache calls host.cpp host.h
+}
+
+function calls {
+    if [ -f $AOC_CALLS ]; then cat $AOC_CALLS | wc -l; else echo 0; fi
+}
+
+function miss {
+    ./a.out1 && [ $(calls) -eq 1 ] && cmp -s b.aocx b.cl && [ -f b/acl_quartus_report.txt ] && [ $(ls cache/*.aocx | wc -l) -eq 1 ]
+}
+
+function up_to_date {
+    ./a.out1 && ./a.out1 && [ $(calls) -eq 1 ]
+}
+
+function stale {
+    ./a.out1 && ./a.out2 && [ $(calls) -eq 2 ] && cmp -s b.aocx b.cl
+}
+
+function aoc_failure {
+    # When re-compiling a stale bitstream fails, neither the stale bitstream nor a partial one is left
+    # behind to be taken for one generated ahead of time. The next run compiles again.
+    ./a.out1 || return 1
+    AOC_FAIL=1 ./a.out2
+    [ ! -f b.aocx ] && [ ! -f b.aocx.key ] && [ $(calls) -eq 2 ] || return 1
+    ./a.out2 && [ $(calls) -eq 3 ] && cmp -s b.aocx b.cl && [ -f b.aocx.key ]
+}
+
+function hit {
+    # Another bitstream file compiled from the same source is copied from the cache, with its report
+    ./a.out1 && BITSTREAM=c.aocx ./a.out1 && [ $(calls) -eq 1 ] && cmp -s b.aocx c.aocx && [ -f c/acl_quartus_report.txt ] \
+        && [ "$(cat b.aocx.key)" == "$(cat c.aocx.key)" ]
+}
+
+function option {
+    ./a.out1 && AOC_OPTION="$AOC_OPTION -fp-relaxed" ./a.out1 && [ $(calls) -eq 2 ]
+}
+
+function ahead_of_time {
+    # A bitstream without a key is not recompiled
+    echo "generated ahead of time" > b.aocx && ./a.out1 && [ $(calls) -eq 0 ] && grep -q "ahead of time" b.aocx
+}
+
+function async {
+    AOC_ASYNC=1 AOC_DELAY=3 ./a.out1 && [ -f b.aocx.pending ] && [ ! -f b.aocx ] || return 1
+    # The compiler does not wait, nor compile again while the bitstream is pending
+    AOC_ASYNC=1 ./a.out1 || return 1
+    for i in $(seq 1 20); do
+        if [ ! -f b.aocx.pending ]; then break; fi
+        sleep 1
+    done
+    [ ! -f b.aocx.pending ] && [ $(calls) -eq 1 ] && cmp -s b.aocx b.cl && ./a.out1 && [ $(calls) -eq 1 ]
+}
+
+function pending_emulator {
+    # While the bitstream is pending, the runtime loads the emulator bitstream instead, and the bitstream
+    # once it is ready
+    AOC_ASYNC=1 AOC_DELAY=3 ./a.out1 && [ -f b.aocx.pending ] || return 1
+    [ "$(EMULATOR_BITSTREAM=e.aocx ./a.out3 | tail -1)" == "1 e.aocx" ] || return 1
+    for i in $(seq 1 20); do
+        if [ ! -f b.aocx.pending ]; then break; fi
+        sleep 1
+    done
+    [ "$(EMULATOR_BITSTREAM=e.aocx ./a.out3 | tail -1)" == "0 b.aocx" ]
+}
+
+function concurrent {
+    # The same bitstream compiled at the same time into 2 files is compiled only once
+    AOC_DELAY=3 ./a.out1 >& c.aocx.out &
+    sleep 1
+    BITSTREAM=c.aocx ./a.out1 && wait && [ $(calls) -eq 1 ] && cmp -s b.aocx c.aocx && [ ! -d cache/*.lock ]
+}
+
+function test_func {
+    eval case="$1"
+    printf "$case "
+    rm -rf b b.aocx* b.cl c c.aocx* c.cl cache calls
+    $case >& a
+    if [ $? -eq 0 ]; then
+        echo >> success.txt
+        echo $case >> success.txt
+        cat a >> success.txt
+        let succ=succ+1
+        echo " Success!"
+    else
+        echo >> failure.txt
+        echo $case >> failure.txt
+        cat a >> failure.txt
+        let fail=fail+1
+        echo " Failure!"
+    fi
+}
+
+rm -f success.txt failure.txt
+clean_func
+
+compile="g++ design.cpp -g -I ../util -I ../../../../Halide/include -L ../../../../Halide/bin $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 "
+$compile -DSCALE=2 -o a.out1 >& a && $compile -DSCALE=3 -o a.out2 >& a \
+    && g++ pending.cpp ../../../src/SharedUtilsInC.cpp -I ../../../src -std=c++11 -o a.out3 >& a
+if [ -f "a.out1" ] && [ -f "a.out2" ] && [ -f "a.out3" ]; then
+    array_to_read=("${regression[@]}")
+    echo "Testing the bitstream cache for regression."
+
+    index=0
+    while [ "$index" -lt "${#array_to_read[*]}" ]; do
+        case=${array_to_read[$index]}
+        let index=index+1
+        test_func "\${case}"
+    done
+else
+    echo >> failure.txt
+    echo $compile >> failure.txt
+    cat a >> failure.txt
+    let fail=fail+1
+fi
+clean_func
+
+let total=succ+fail
+echo -e Total $total, pass ${GREEN}$succ${NOCOLOR}, fail ${RED}$fail${NOCOLOR}. See $PWD/success.txt and failure.txt for details.
+
+# Return values for the parent script
+echo $total > ../total.temp
+echo $succ > ../succ.temp
+echo $fail > ../fail.temp
@@ -31,6 +31,13 @@
 #define OJ J/JJ/JJJ
 #define OK K/KK/KKK
 
+#ifndef PREFETCH
+#define PREFETCH BufferPrefetch::Tile
+#endif
+#ifndef LAYOUT
+#define LAYOUT BufferLayout::Default
+#endif
+
 int main(void) {
     // Input parameters: a and b are 2D matrices.
     ImageParam a(type_of<float>(), 2);
@@ -87,8 +94,13 @@ int main(void) {
     serializerB.remove(iii);
     loaderA.remove(jjj);
     loaderB.remove(iii);
+#ifdef NUM_BUFFERS
+    feederA.buffer(loaderA, iii, NUM_BUFFERS, PREFETCH, LAYOUT);
+    feederB.buffer(loaderB, kk, NUM_BUFFERS, PREFETCH, LAYOUT);
+#else
     feederA.buffer(loaderA, iii, BufferStrategy::Double);
     feederB.buffer(loaderB, kk, BufferStrategy::Double);
+#endif
 
     Func drainer(PLACE1), collector(PLACE1), unloader(PLACE1);
     c.isolate_consumer_chain(drainer);
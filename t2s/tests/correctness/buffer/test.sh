@@ -24,6 +24,12 @@ array=( "buffer-with-scatter.cpp" yes 1 2 no
             Host Device
       )
 
+# Options to test N-way buffering, partial-tile prefetch and banked layout with buffer-with-scatter.cpp
+nway=( "-DNUM_BUFFERS=3"
+       "-DNUM_BUFFERS=2 -DPREFETCH=BufferPrefetch::Partial"
+       "-DNUM_BUFFERS=3 -DPREFETCH=BufferPrefetch::Partial -DLAYOUT=BufferLayout::Banked"
+     )
+
 succ=0
 fail=0
 
@@ -103,6 +109,12 @@ while [ "$index" -lt "${#array[*]}" ]; do
             printf "For Buffer::Single\n"
             test_func "\${file}" "\${option}" "-DSTRATEGY=BufferStrategy::Single" "\${expect_executable}"
        fi
+       if [ "$file" = "buffer-with-scatter.cpp" ]; then
+           for nway_option in "${nway[@]}"; do
+               printf "Case: $file $option $nway_option"
+               test_func "\${file}" "\${option}" "\${nway_option}" "\${expect_executable}"
+           done
+       fi
    done
 
 done
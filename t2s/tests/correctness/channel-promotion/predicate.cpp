@@ -0,0 +1,54 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Promote a conditional channel read under a predicate (Target::PredicateChannels).
+#include "util.h"
+
+#define I 4
+#define T 8
+
+int main(void) {
+    // Define the compute. In the unrolled loop i, a(i, t) is read only when i + t < T, which depends on i.
+    ImageParam a(Int(32), 2, "a");
+    Func A(Place::Device), B(Place::Host);
+    Var i, t;
+    A(i, t) = select(i + t < T, a(i, t), 0) * 2;
+    B(i, t) = select(i + t < T, a(i, t), 0) * 2;
+
+    // Compile.
+    Target target = get_host_target();
+    target.set_feature(Target::IntelFPGA);
+    target.set_feature(Target::PredicateChannels);
+
+    // Generate input and run.
+    Buffer<int> in = new_data_2d<int, I, T>(SEQUENTIAL);
+    a.set(in);
+    Buffer<int> golden = B.realize(I, T, target);
+
+    // Isolate. Re-compile and run. The feeder writes a(i, t) under the same condition, and the channel
+    // is promoted out of loop i in both kernels: the array is sent and received when any i + t < T.
+    Func Feeder(Place::Device);
+    A.set_bounds(i, 0, I, t, 0, T)
+     .unroll(i)
+     .isolate_producer_chain(a, Feeder);
+    Buffer<int> out = A.realize(I, T, target);
+
+    // Check correctness.
+    check_equal_2D<int>(golden, out);
+    cout << "Success!\n";
+}
@@ -0,0 +1,88 @@
+#!/bin/bash
+# ./test.sh
+# Test widening channels (Target::WidenChannels) and predicating channel reads (Target::PredicateChannels) in
+# channel promotion (t2s/src/ChannelPromotion.h). Every case checks the results in the emulator, and checks in
+# the debug output of the compiler that the channels are, or are not, widened or predicated.
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NOCOLOR='\033[0m'
+
+# In this array, every element contains:
+#  Test name
+#  gcc options
+#  A pattern that must be in the debug output
+#  A pattern that must not be in the debug output
+array=(
+        "widen.cpp"     ""          "Widen channel"           "Not widening channel"
+        "widen.cpp"     "-DREFUSE"  "Not widening channel"    "Widen channel"
+        "predicate.cpp" ""          "Predicate read channel"  "Widen channel"
+      )
+
+succ=0
+fail=0
+
+function emulate_func {
+    eval file="$1"
+    eval gcc_options="$2"
+    eval expected="$3"
+    eval unexpected="$4"
+    compile="g++ $file $gcc_options -g -I ../util  -I ../../../../Halide/include -L ../../../../Halide/bin $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 "
+    clean="rm -rf a a.out $HOME/tmp/a.aocx $HOME/tmp/a.aocr $HOME/tmp/a.aoco $HOME/tmp/a.cl $HOME/tmp/a exec_time.txt"
+    $clean
+    $compile >& a
+    if [ -f "a.out" ]; then
+        # There is an error "Unterminated quoted string" using $run due to AOC_OPTION. To avoid it, explicitly run for every case.
+        rm -f a
+        run="env HL_DEBUG_CODEGEN=4 BITSTREAM="\""${HOME}/tmp/a.aocx"\"" CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=1 INTEL_FPGA_OCL_PLATFORM_NAME="\""$EMULATOR_PLATFORM"\"" AOC_OPTION="\""$EMULATOR_AOC_OPTION -board=$FPGA_BOARD -emulator-channel-depth-model=strict "\"" ./a.out"
+        timeout 5m env HL_DEBUG_CODEGEN=4 BITSTREAM="${HOME}/tmp/a.aocx" CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=1 INTEL_FPGA_OCL_PLATFORM_NAME="$EMULATOR_PLATFORM" AOC_OPTION="$EMULATOR_AOC_OPTION -board=${FPGA_BOARD} -emulator-channel-depth-model=strict " ./a.out >& a
+        if tail -n 1 a | grep -q -E "^Success!" && grep -q "$expected" a && ! grep -q "$unexpected" a; then
+            echo >> success.txt
+            echo $clean >> success.txt
+            echo $compile >> success.txt
+            echo $run >> success.txt
+            grep -E "Widen|Not widening|Predicate" a >> success.txt
+            tail -n 1 a >> success.txt
+            let succ=succ+1
+            echo " Success!"
+        else
+            echo >> failure.txt
+            echo $clean >> failure.txt
+            echo $compile >> failure.txt
+            echo $run >> failure.txt
+            echo "Expected \"$expected\" but not \"$unexpected\" in the debug output" >> failure.txt
+            cat a >> failure.txt
+            let fail=fail+1
+            echo " Failure!"
+        fi
+    else
+        echo >> failure.txt
+        echo $clean >> failure.txt
+        echo $compile >> failure.txt
+        cat a >> failure.txt
+        let fail=fail+1
+        echo " Failure!"
+    fi
+    $clean
+}
+
+echo "Testing channel promotion."
+rm -f success.txt failure.txt
+index=0
+while [ "$index" -lt "${#array[*]}" ]; do
+   file=${array[$index]}
+   gcc_options=${array[$((index+1))]}
+   expected=${array[$((index+2))]}
+   unexpected=${array[$((index+3))]}
+   let index=index+4
+   printf "Case: $file $gcc_options"
+   emulate_func "\${file}" "\${gcc_options}" "\${expected}" "\${unexpected}"
+done
+
+let total=succ+fail
+echo -e Total $total, pass ${GREEN}$succ${NOCOLOR}, fail ${RED}$fail${NOCOLOR}. See $PWD/success.txt and failure.txt for details.
+
+# Return values for the parent script
+echo $total > ../total.temp
+echo $succ > ../succ.temp
+echo $fail > ../fail.temp
@@ -0,0 +1,65 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Widen the channels between two feeders and a kernel (Target::WidenChannels), or with -DREFUSE, refuse to.
+#include "util.h"
+
+#define I 4
+#define T 8
+
+int main(void) {
+    // Define the compute.
+    ImageParam a(Int(32), 2, "a");
+    ImageParam b(Int(32), 2, "b");
+    Func A(Place::Device), B(Place::Host);
+    Var i, t;
+    A(i, t) = a(i, t) * b(i, t);
+    B(i, t) = a(i, t) * b(i, t);
+
+    // Compile.
+    Target target = get_host_target();
+    target.set_feature(Target::IntelFPGA);
+    target.set_feature(Target::WidenChannels);
+
+    // Generate input and run.
+    Buffer<int> ina = new_data_2d<int, I, T>(SEQUENTIAL);
+    Buffer<int> inb = new_data_2d<int, I, T>(RANDOM);
+    a.set(ina);
+    b.set(inb);
+    Buffer<int> golden = B.realize(I, T, target);
+
+    // Isolate. Re-compile and run.
+    A.set_bounds(i, 0, I, t, 0, T);
+#ifdef REFUSE
+    // One feeder sends a and b in two channels, both accessed in every iteration of loop i. If either
+    // channel was widened, A would wait for a whole loop of values of it, while the feeder could block
+    // on the other one. So neither is widened.
+    Func Feeder(Place::Device);
+    A.isolate_producer_chain({a, b}, Feeder);
+#else
+    // Every feeder sends its values in one channel, which is widened by I.
+    Func FeederA(Place::Device), FeederB(Place::Device);
+    A.isolate_producer_chain(a, FeederA)
+     .isolate_producer_chain(b, FeederB);
+#endif
+    Buffer<int> out = A.realize(I, T, target);
+
+    // Check correctness.
+    check_equal_2D<int>(golden, out);
+    cout << "Success!\n";
+}
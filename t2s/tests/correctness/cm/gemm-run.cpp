@@ -0,0 +1,104 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Run the CM kernel of gemm.cpp and check the results. With -DCMRT_EMU, the kernel is
+// compiled by the host compiler and executed by the CM emulation runtime on the CPU.
+#include "sizes.h"
+
+// Outer loop bounds
+#define K           2
+#define J           2
+#define I           2
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "cm_rt.h"
+#include "common/cm_rt_helpers.h"
+#include "common/isa_helpers.h"
+
+#define TOTAL_I     III*II*I
+#define TOTAL_J     JJJ*JJ*J
+#define TOTAL_K     KKK*KK*K
+
+#ifdef CMRT_EMU
+extern "C" void kernel_X(int _A_extent_0, SurfaceIndex _A, SurfaceIndex _B, SurfaceIndex _unloader);
+#endif
+
+int main() {
+    CmDevice *device = nullptr;
+    unsigned int version = 0;
+    cm_result_check(::CreateCmDevice(device, version));
+
+    CmProgram *program = nullptr;
+    std::string isa_code = cm::util::isa::loadFile("gemm_genx.isa");
+    cm_result_check(device->LoadProgram(const_cast<char*>(isa_code.data()), isa_code.size(), program));
+    CmKernel *kernel = nullptr;
+    cm_result_check(device->CreateKernel(program, CM_KERNEL_FUNCTION(kernel_X), kernel));
+    CmQueue *cmd_queue = nullptr;
+    cm_result_check(device->CreateQueue(cmd_queue));
+
+    float *a = (float*)malloc(sizeof(float) * TOTAL_I * TOTAL_K);
+    float *b = (float*)malloc(sizeof(float) * TOTAL_K * TOTAL_J);
+    float *c = (float*)malloc(sizeof(float) * TOTAL_I * TOTAL_J);
+    for (int i = 0; i < TOTAL_I * TOTAL_K; i++) a[i] = random() % 8;
+    for (int i = 0; i < TOTAL_K * TOTAL_J; i++) b[i] = random() % 8;
+
+    CmSurface2D *surf_a = nullptr, *surf_b = nullptr, *surf_c = nullptr;
+    SurfaceIndex *surf_a_idx = nullptr, *surf_b_idx = nullptr, *surf_c_idx = nullptr;
+    cm_result_check(device->CreateSurface2D(TOTAL_K, TOTAL_I, CM_SURFACE_FORMAT_R32F, surf_a));
+    cm_result_check(surf_a->WriteSurface((unsigned char*)a, NULL));
+    cm_result_check(surf_a->GetIndex(surf_a_idx));
+    cm_result_check(device->CreateSurface2D(TOTAL_J, TOTAL_K, CM_SURFACE_FORMAT_R32F, surf_b));
+    cm_result_check(surf_b->WriteSurface((unsigned char*)b, NULL));
+    cm_result_check(surf_b->GetIndex(surf_b_idx));
+    cm_result_check(device->CreateSurface2D(TOTAL_J, TOTAL_I, CM_SURFACE_FORMAT_R32F, surf_c));
+    cm_result_check(surf_c->GetIndex(surf_c_idx));
+
+    int _A_extent_0 = TOTAL_K;
+    cm_result_check(kernel->SetKernelArg(0, sizeof(int), &_A_extent_0));
+    cm_result_check(kernel->SetKernelArg(1, sizeof(SurfaceIndex), surf_a_idx));
+    cm_result_check(kernel->SetKernelArg(2, sizeof(SurfaceIndex), surf_b_idx));
+    cm_result_check(kernel->SetKernelArg(3, sizeof(SurfaceIndex), surf_c_idx));
+
+    CmTask *task = nullptr;
+    cm_result_check(device->CreateTask(task));
+    cm_result_check(task->AddKernel(kernel));
+    CmThreadGroupSpace *thread_group_space = nullptr;
+    cm_result_check(device->CreateThreadGroupSpace(JJ, II, J, I, thread_group_space));
+    CmEvent *sync_event = nullptr;
+    cm_result_check(cmd_queue->EnqueueWithGroup(task, sync_event, thread_group_space));
+    cm_result_check(sync_event->WaitForTaskFinished());
+    cm_result_check(surf_c->ReadSurface((unsigned char *)c, sync_event));
+
+    for (int i = 0; i < TOTAL_I; i++) {
+        for (int j = 0; j < TOTAL_J; j++) {
+            float golden = 0.0f;
+            for (int k = 0; k < TOTAL_K; k++) {
+                golden += a[k + i * TOTAL_K] * b[j + k * TOTAL_J];
+            }
+            assert(fabs(golden - c[j + i * TOTAL_J]) <= 0.005 * fabs(golden));
+        }
+    }
+    cm_result_check(device->DestroyTask(task));
+    cm_result_check(::DestroyCmDevice(device));
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// A small GEMM for Intel GPUs. The systolic array is expected to be emitted as a
+// register-blocked micro-kernel, i.e. rows of vector multiply-adds in CM, or as scalar
+// multiply-adds with -DSCALAR_ARRAY (Target::DisableGPUMicroKernel).
+#include "Halide.h"
+#include "util.h"
+#include "sizes.h"
+
+using namespace Halide;
+
+int main()
+{
+    #define P               kkk,      jjj,  iii,  jj, ii, kk,     k,  j,i
+    #define P_kkk_minus_1   kkk-1,    jjj,  iii,  jj, ii, kk,     k,  j,i
+    #define P_kk_minus_1    kkk+KKK-1,jjj,  iii,  jj, ii, kk-1,   k,  j,i
+    #define P_k_minus_1     kkk+KKK-1,jjj,  iii,  jj, ii, kk+KK-1,k-1,j,i
+    #define P_jjj_minus_1   kkk,      jjj-1,iii,  jj, ii, kk,     k,  j,i
+    #define P_iii_minus_1   kkk,      jjj,  iii-1,jj, ii, kk,     k,  j,i
+    #define P_Out                     jjj,  iii,  jj, ii,             j,i
+
+    #define total_i         (iii + III * ii + III * II * i)
+    #define total_j         (jjj + JJJ * jj + JJJ * JJ * j)
+    #define total_k         (kkk + KKK * kk + KKK * KK * k)
+
+    #define I (A.dim(1).extent() / (III * II))
+    #define J (B.dim(0).extent() / (JJJ * JJ))
+#ifdef GPU_LOOP_SCOPE
+    // The tiles fetched at GPU loop jj span all the iterations of k, which has the constant extent of gemm-run.cpp
+    #define K 2
+#else
+    #define K (A.dim(0).extent() / (KKK * KK))
+#endif
+
+    ImageParam A("A", Float(32), 2), B("B", Float(32), 2);
+
+    Var kkk("kkk"), jjj("jjj"), iii("iii"), jj("jj"), ii("ii"), kk("kk"), k("k"), j("j"), i("i");
+    URE X("X", Float(32), {P}), Y("Y", Float(32), {P}), Z("Z", Float(32), {P}), Out("Out");
+    X(P) = select(jjj == 0, A(total_k, total_i), X(P_jjj_minus_1));
+    Y(P) = select(iii == 0, B(total_j, total_k), Y(P_iii_minus_1));
+    Z(P) = select(kkk == 0 && kk == 0 && k == 0, 0,
+                select(kkk == 0, select(kk == 0, Z(P_k_minus_1), Z(P_kk_minus_1)), Z(P_kkk_minus_1)))
+                + X(P) * Y(P);
+    Out(P_Out) = select(kkk == KKK-1 && kk == KK-1 && k == K-1, Z(P));
+
+    X.merge_ures(Y, Z, Out);
+    X.set_bounds(jjj, 0, JJJ, iii, 0, III, kkk, 0, KKK)
+     .set_bounds(jj,  0, JJ,  ii,  0, II,  kk,  0, KK)
+     .set_bounds(j,   0, J,   i,   0, I,   k,   0, K);
+    X.space_time_transform(jjj, iii);
+    X.gpu_blocks(j, i).gpu_threads(jj, ii);
+
+    Stensor DA("aLoader", DRAM), SA("aFeeder", SRAM), DB("bLoader", DRAM), SB("bFeeder", SRAM);
+    Stensor RC("collector", REG), DC("unloader", DRAM), C("deserializer");
+#if defined(DOUBLE_BUFFER) && defined(GPU_LOOP_SCOPE)
+    // The scope is beyond the GPU loops, so that the tiles are fetched at the GPU loop jj, whose iterations
+    // run in parallel, and nothing is prefetched
+    A >> DA.out(kkk) >> SA.scope(jj).out(kkk, iii).double_buffer();
+    B >> DB.out(kkk) >> SB.scope(jj).out(kkk, jjj).double_buffer();
+#elif defined(DOUBLE_BUFFER)
+    // Prefetch the tiles of the next iteration of k while the current tiles are used
+    A >> DA.out(kkk) >> SA.scope(k).out(kkk, iii).double_buffer();
+    B >> DB.out(kkk) >> SB.scope(k).out(kkk, jjj).double_buffer();
+#else
+    A >> DA.out(kkk) >> SA.scope(k).out(kkk, iii);
+    B >> DB.out(kkk) >> SB.scope(k).out(kkk, jjj);
+#endif
+    Out >> RC.scope(iii).out(jjj) >> DC >> C(total_j, total_i);
+
+    // Emit gemm_genx.cpp
+#ifdef SCALAR_ARRAY
+    Target acc = get_host_target();
+    acc.set_feature(Target::IntelGPU);
+    acc.set_feature(Target::DisableGPUMicroKernel);
+    C.compile_to_host("gemm-interface", { A, B }, "gemm", acc);
+#else
+    C.compile_to_host("gemm-interface", { A, B }, "gemm", IntelGPU);
+#endif
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,100 @@
+#!/bin/bash
+# ./test.sh
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NOCOLOR='\033[0m'
+
+# In this array, every element contains:
+#  Test file
+#  gcc options
+#  A pattern that must be in the debug output of the compiler
+regression=(
+        gemm    ""                                 "}, {}, 1);"
+        gemm    "-DDOUBLE_BUFFER"                  "}, {}, 2);"
+        gemm    "-DDOUBLE_BUFFER -DGPU_LOOP_SCOPE" "It is fetched into 1 buffer, instead of 2."
+        gemm    "-DSCALAR_ARRAY"                   "}, {}, 1);"
+)
+
+succ=0
+fail=0
+
+function emulate_func {
+    eval file="$1"
+    eval gcc_options="$2"
+    eval expected="$3"
+    printf "$file $gcc_options "
+    compile="g++ $file.cpp $gcc_options -g -I ../util -I ../../../../Halide/include -L ../../../../Halide/bin $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 "
+    clean="rm -rf a a.out ${file}_genx.cpp ${file}_genx.isa ${file}-run.out"
+    $clean
+    $compile >& a
+    if [ -f "a.out" ]; then
+        # Generate the CM kernel, which is expected to be a register-blocked micro-kernel, i.e.
+        # vector multiply-adds of a row of 8 elements of the systolic array at a time, unless the micro-kernel
+        # is disabled. The feeders are expected to fetch their tiles into 1 buffer, or 2 buffers with double
+        # buffering.
+        run="env HL_DEBUG_CODEGEN=1 ./a.out"
+        timeout 10m env HL_DEBUG_CODEGEN=1 ./a.out >& a
+        micro_kernel=0
+        if grep -q -E "\*.*select<8, 1>|select<8, 1>.*\*" ${file}_genx.cpp; then micro_kernel=1; fi
+        expected_micro_kernel=1
+        if [[ "$gcc_options" == *"-DSCALAR_ARRAY"* ]]; then expected_micro_kernel=0; fi
+        if tail -n 1 a | grep -q -E "^Success!" && [ $micro_kernel -eq $expected_micro_kernel ] && grep -q -F "$expected" a; then
+            if [ "$CM_ROOT" != "" ]; then
+                # Run the kernel with the CM emulation runtime on the CPU
+                emulate="g++ -DCMRT_EMU -D__LINUX__ -DLINUX -std=gnu++11 -msse4.1 -I$CM_ROOT/compiler/include -I$CM_ROOT/runtime/include -I$CM_ROOT/examples ${file}_genx.cpp ${file}-run.cpp -L$CM_ROOT/runtime/lib/x64 -ligfxcmrt_emu -lcm -ldl -o ${file}-run.out"
+                touch ${file}_genx.isa
+                $emulate >> a 2>&1
+                run="$run; $emulate; ./${file}-run.out"
+                timeout 10m ./${file}-run.out >> a 2>&1
+            fi
+        fi
+        if  tail -n 1 a | grep -q -E "^Success!"; then
+            echo >> success.txt
+            echo $clean >> success.txt
+            echo $compile >> success.txt
+            echo $run >> success.txt
+            cat a >> success.txt
+            let succ=succ+1
+            echo " Success!"
+        else
+            echo >> failure.txt
+            echo $clean >> failure.txt
+            echo $compile >> failure.txt
+            echo $run >> failure.txt
+            cat a >> failure.txt
+            let fail=fail+1
+            echo "Failure!"
+        fi
+    else
+        echo >> failure.txt
+        echo $clean >> failure.txt
+        echo $compile >> failure.txt
+        cat a >> failure.txt
+        let fail=fail+1
+        echo " Failure!"
+    fi
+    $clean
+}
+
+rm -f success.txt failure.txt
+
+array_to_read=("${regression[@]}")
+echo "Testing CM code generation for regression."
+
+index=0
+while [ "$index" -lt "${#array_to_read[*]}" ]; do
+    file=${array_to_read[$index]}
+    gcc_options=${array_to_read[$((index+1))]}
+    expected=${array_to_read[$((index+2))]}
+    let index=index+3
+    emulate_func "\${file}" "\${gcc_options}" "\${expected}"
+done
+
+let total=succ+fail
+echo -e Total $total, pass ${GREEN}$succ${NOCOLOR}, fail ${RED}$fail${NOCOLOR}. See $PWD/success.txt and failure.txt for details.
+
+# Return values for the parent script
+echo $total > ../total.temp
+echo $succ > ../succ.temp
+echo $fail > ../fail.temp
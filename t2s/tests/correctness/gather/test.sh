@@ -19,6 +19,13 @@ array=(   "gather-1-1.cpp" "-DSTRATEGY=GatherStrategy::Up"
         # "gather-1-4.cpp" "-DSTRATEGY=GatherStrategy::Down"
           "gather-1-5.cpp" "-DSTRATEGY=GatherStrategy::Down"
           "gather-1-6.cpp" "-DSTRATEGY=GatherStrategy::Down"
+          "gather-1-1.cpp" "-DSTRATEGY=GatherStrategy::Tree"
+          "gather-1-2.cpp" "-DSTRATEGY=GatherStrategy::Tree"
+          "gather-1-3.cpp" "-DSTRATEGY=GatherStrategy::Tree"
+          "gather-2-1.cpp" "-DFAN_IN=2 -DOP=GatherOp::Add -DREDUCE=sum"
+          "gather-2-1.cpp" "-DFAN_IN=4 -DOP=GatherOp::Max -DREDUCE=maximum"
+          "gather-2-1.cpp" "-DFAN_IN=2 -DOP=GatherOp::Min -DREDUCE=minimum"
+          "gather-2-1.cpp" "-DFAN_IN=4 -DOP=GatherOp::Pack"
 )
 
 succ=0
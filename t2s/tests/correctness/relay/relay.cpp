@@ -0,0 +1,113 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "util.h"
+
+// Relay the results of a systolic GEMM out of the array (Func::relay). The PEs along jjj are the banks,
+// each with its own pipe through the PEs along iii. With SEGMENT defined, every pipe is cut into
+// segments of SEGMENT PEs, and the head of every segment writes its own channel.
+
+#define I 8
+#define J 8
+#define K 8
+#define II 2
+#define JJ 2
+#define KK 2
+#define III 4
+#define JJJ 2
+#define KKK 2
+#define OI I/II/III
+#define OJ J/JJ/JJJ
+#define OK K/KK/KKK
+
+int main(void) {
+    // Input parameters: a and b are 2D matrices.
+    ImageParam a(type_of<int>(), 2);
+    ImageParam b(type_of<int>(), 2);
+
+    Var  oi, oj, ok, ii, jj, kk, iii, jjj, kkk;
+
+    // Macros for convenience.
+    #define P             kkk,           jjj,     iii,     jj, ii, kk,          ok,     oj, oi
+    #define P_kkk_minus_1 kkk - 1,       jjj,     iii,     jj, ii, kk,          ok,     oj, oi
+    #define P_kk_minus_1  kkk + KKK - 1, jjj,     iii,     jj, ii, kk - 1,      ok,     oj, oi
+    #define P_ok_minus_1  kkk + KKK - 1, jjj,     iii,     jj, ii, kk + KK - 1, ok - 1, oj, oi
+    #define P_jjj_minus_1 kkk,           jjj - 1, iii,     jj, ii, kk,          ok,     oj, oi
+    #define P_iii_minus_1 kkk,           jjj,     iii - 1, jj, ii, kk,          ok,     oj, oi
+    #define P_c                          jjj,     iii,     jj, ii,                      oj, oi
+    #define i             (oi * II * III + ii * III + iii)
+    #define j             (oj * JJ * JJJ + jj * JJJ + jjj)
+    #define k             (ok * KK * KKK + kk * KKK + kkk)
+
+    #define compute Int(32), {P}, PLACE1
+
+    Func A(compute), B(compute), C(compute), c(PLACE1);
+    A(P) = select(jjj == 0, a(i, k), A(P_jjj_minus_1));
+    B(P) = select(iii == 0, b(k, j), B(P_iii_minus_1));
+    C(P) = select(kkk == 0 && kk == 0 && ok == 0, 0,
+                select(kkk == 0, select(kk == 0, C(P_ok_minus_1), C(P_kk_minus_1)), C(P_kkk_minus_1)))
+                + A(P) * B(P);
+    c(P_c) = select(kkk == KKK - 1 && kk == KK - 1 && ok == OK - 1, C(P));
+
+    // Merge UREs
+    A.merge_ures(B, C, c)
+     .set_bounds(kkk, 0, KKK, jjj, 0, JJJ, iii, 0, III)
+     .set_bounds(kk,  0, KK,  jj,  0, JJ,  ii,  0, II)
+     .set_bounds(ok,  0, OK,  oj,  0, OJ,  oi,  0, OI);
+    A.space_time_transform(jjj, iii);
+
+    // Relay the results along the PEs of iii, with a pipe for every jjj
+#ifdef SEGMENT
+    c.relay(C, jjj, SEGMENT);
+#else
+    c.relay(C, jjj);
+#endif
+    Func unloader(PLACE1), deserializer(PLACE0);
+    c.isolate_consumer_chain(unloader, deserializer);
+    unloader.vectorize(jjj);
+    deserializer.vectorize(jjj);
+
+    // Generate input and run.
+    Buffer<int> ina = new_data_2d<int, I, K>(RANDOM);
+    Buffer<int> inb = new_data_2d<int, K, J>(RANDOM);
+    a.set(ina);
+    b.set(inb);
+    Target target = get_host_target();
+    target.set_feature(Target::IntelFPGA);
+    Buffer<int> golden = get_result_of_mm<int, I, K, J>(ina, inb);
+    Buffer<int> result = deserializer.realize({JJJ, III, JJ, II, OJ, OI}, target);
+
+    for (size_t ox = 0; ox < OI; ox++) {
+        for (size_t xx = 0; xx < II; xx++) {
+            for (size_t xxx = 0; xxx < III; xxx++) {
+                for (size_t oy = 0; oy < OJ; oy++) {
+                    for (size_t yy = 0; yy < JJ; yy++) {
+                        for (size_t yyy = 0; yyy < JJJ; yyy++) {
+                            size_t x = xxx + xx * III + ox * II * III;
+                            size_t y = yyy + yy * JJJ + oy * JJ * JJJ;
+                            assert(result(yyy, xxx, yy, xx, oy, ox) == golden(x, y));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Benchmark harness
+#include "Benchmark.h"
+
+#include <assert.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+#define I 64
+#define J 64
+#define K 64
+
+// Check the statistics of samples
+void test_stats() {
+    BenchmarkStats stats = benchmark_stats({5, 1, 4, 2, 3});
+    assert(stats.min == 1 && stats.median == 3 && stats.p95 == 5 && stats.mean == 3);
+    assert(fabs(stats.stddev - sqrt(2.5)) < 1e-9);
+    stats = benchmark_stats({4, 1, 3, 2});
+    assert(stats.median == 2.5 && stats.p95 == 4);
+}
+
+// Benchmark a GEMM on the CPU, timed by the wall clock as in emulation
+void test_emulation() {
+    vector<float> a(K * I, 1.0f), b(J * K, 2.0f), c(J * I);
+    int runs = 0;
+    auto gemm = [&]() {
+        for (int i = 0; i < I; i++)
+        for (int j = 0; j < J; j++) {
+            float sum = 0;
+            for (int k = 0; k < K; k++) {
+                sum += a[k + K * i] * b[j + J * k];
+            }
+            c[j + J * i] = sum;
+        }
+        runs++;
+        return 0;
+    };
+
+    DesignBenchmark benchmark;
+    benchmark.name = "gemm";
+    benchmark.number_ops = 2.0 * I * J * K;
+    benchmark.number_bytes = (K * I + J * K + J * I) * 4.0;
+    benchmark.compute_roof = 100;
+    benchmark.warmup = 2;
+    benchmark.samples = 5;
+    benchmark.backend = BenchmarkBackend::Emulation;
+    benchmark.parameters = {{"I", I}, {"J", J}, {"K", K}};
+    BenchmarkReport report = benchmark_design(benchmark, gemm);
+    assert(report.result == 0 && runs == 7 && report.times.size() == 5);
+    assert(c[0] == 2.0f * K);
+    assert(report.time.min > 0 && report.time.min <= report.time.median && report.time.median <= report.time.p95);
+    assert(report.gflops > 0 && report.best_gflops >= report.gflops);
+    // No efficiency in emulation
+    assert(report.efficiency == 0 && report.roofline_efficiency == 0);
+
+    assert(report.write_json("benchmark.json"));
+    ifstream in("benchmark.json");
+    stringstream json;
+    json << in.rdbuf();
+    assert(json.str().find("\"design\": \"gemm\"") != string::npos);
+    assert(json.str().find("\"backend\": \"emulation\"") != string::npos);
+    assert(json.str().find("\"parameters\": {\"I\": 64, \"J\": 64, \"K\": 64}") != string::npos);
+    assert(json.str().find("\"efficiency\": null") != string::npos);
+    remove("benchmark.json");
+
+    // A failing run stops the benchmark
+    runs = 0;
+    report = benchmark_design(benchmark, [&]() { return ++runs == 3 ? -1 : 0; });
+    assert(report.result == -1 && runs == 3 && report.times.size() == 1);
+}
+
+// Time every sample by the profile of the device, which the runtime writes into exec_time.txt
+// in the directory of the bitstream. The bitstream is faked.
+void test_device() {
+    setenv("BITSTREAM", "benchmark.aocx", 1);
+    fclose(fopen("benchmark.aocx", "w"));
+    setenv("BENCHMARK_BACKEND", "device", 1);
+    assert(benchmark_backend() == BenchmarkBackend::Device);
+    setenv("BENCHMARK_BACKEND", "emulation", 1);
+    assert(benchmark_backend() == BenchmarkBackend::Emulation);
+    unsetenv("BENCHMARK_BACKEND");
+
+    int runs = 0;
+    auto design = [&]() {
+        runs++;
+        FILE *fp = fopen("exec_time.txt", "w");
+        fprintf(fp, "%f\n", 2000.0 * runs);
+        fprintf(fp, "kernel_loader %f\n", 500.0);
+        fprintf(fp, "kernel_unloader %f\n", 1000.0 * runs);
+        fclose(fp);
+        return 0;
+    };
+    DesignBenchmark benchmark;
+    benchmark.name = "design";
+    benchmark.number_ops = 4000;
+    benchmark.number_bytes = 4000;
+    benchmark.compute_roof = 2;
+    benchmark.mem_bandwidth = 2;
+    benchmark.warmup = 1;
+    benchmark.samples = 3;
+    benchmark.backend = BenchmarkBackend::Device;
+    BenchmarkReport report = benchmark_design(benchmark, design);
+    // The samples are the 2nd to 4th runs
+    assert(report.result == 0 && report.times == vector<double>({2000, 3000, 4000}));
+    assert(report.time.median == 3000 && report.gflops == 4000.0 / 3000);
+    assert(fabs(report.efficiency - 4000.0 / 3000 / 2) < 1e-9);
+    // Attainable: min(2 GFLOPS, 2 GB/s * 1 op/byte)
+    assert(fabs(report.roofline_efficiency - 4000.0 / 3000 / 2) < 1e-9);
+
+    // All the kernels
+    benchmark.kernel = NULL;
+    runs = 0;
+    report = benchmark_design(benchmark, design);
+    assert(report.times == vector<double>({4000, 6000, 8000}));
+    remove("exec_time.txt");
+    remove("benchmark.aocx");
+}
+
+int main(void) {
+    test_stats();
+    test_emulation();
+    test_device();
+    cout << "Success!\n";
+    return 0;
+}
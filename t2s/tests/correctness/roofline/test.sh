@@ -9,7 +9,7 @@ NOCOLOR='\033[0m'
 # Test file
 regression=(
         gemm
-        
+        benchmark
 )
 
 succ=0
@@ -18,7 +18,7 @@ fail=0
 function emulate_func {
     eval file="$1"
     printf "$file "
-    compile="g++ $file.cpp ../../../src/SharedUtilsInC.cpp ../../../src/Roofline.cpp -g -I ../util -I ../../../src -I ../../../../Halide/include -L ../../../../Halide/bin $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 "
+    compile="g++ $file.cpp ../../../src/SharedUtilsInC.cpp ../../../src/Roofline.cpp -g -I ../util -I ../../../src -I ../../../../Halide/include -I ../../../../Halide/tools -L ../../../../Halide/bin $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 "
     clean="rm -rf a a.out $file $file.aoc* $file.cl exec_time.txt *.png"
     $clean
     $compile >& a
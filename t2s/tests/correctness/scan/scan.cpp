@@ -0,0 +1,105 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// A positive test for the scan template in t2s/peppers/primitives/scan.h. The options are:
+//   MODE:      Inclusive or Exclusive
+//   SEGMENTED: restart the scan at random elements
+//   OP_MAX:    scan with max instead of +
+//   STT:       space-time transform the PEs
+//   GATHER:    gather the results from the PEs (requires STT)
+//   PLACE:     Place::Host or Place::Device
+//   NUM_PES:   the number of PEs (4 by default). With fewer PEs, more elements take the path from the last PE
+//              of a tile to PE 0 of the next tile.
+
+#include "util.h"
+#include "../../../peppers/primitives/scan.h"
+
+#ifdef NUM_PES
+#define PES     NUM_PES
+#else
+#define PES     4
+#endif
+#define TILES   (SIZE / PES)
+
+int main(void) {
+    ImageParam a(Int(32), 1, "a"), f(UInt(8), 1, "f");
+    Var p, t;
+#ifdef OP_MAX
+    auto op = [](Expr x, Expr y) { return max(x, y); };
+    Expr identity = Int(32).min();
+#else
+    auto op = [](Expr x, Expr y) { return x + y; };
+    Expr identity = 0;
+#endif
+#ifdef SEGMENTED
+    Expr segment_start = f(p + PES * t) != 0;
+#else
+    Expr segment_start = Expr(false);
+#endif
+    ScanUREs s = scan_ures(p, t, PES, TILES, a(p + PES * t), op, identity, ScanMode::MODE, segment_start, PLACE);
+#ifdef STT
+    s.head.space_time_transform(p);
+#endif
+    Func result = s.out;
+#ifdef GATHER
+    Func collector(PLACE), unloader(PLACE);
+    s.out.isolate_consumer_chain(collector, unloader);
+    collector.gather(s.out, p);
+    result = unloader;
+#endif
+
+    // Generate input.
+    Buffer<int> in(SIZE);
+    Buffer<uint8_t> flags(SIZE);
+    for (int i = 0; i < SIZE; i++) {
+        in(i) = rand() % 100 - 50;
+        flags(i) = (rand() % 4 == 0);
+    }
+    a.set(in);
+    f.set(flags);
+
+    // Compile and run.
+    Target target = get_host_target();
+    if (PLACE == Place::Device) {
+        target.set_feature(Target::IntelFPGA);
+    }
+    Buffer<int> out = result.realize({PES, TILES}, target);
+
+    // Golden.
+    Buffer<int> golden(PES, TILES);
+    const int identity0 = *as_const_int(identity);
+    int prev = identity0;
+    for (int i = 0; i < SIZE; i++) {
+#ifdef SEGMENTED
+        if (flags(i)) {
+            prev = identity0;
+        }
+#endif
+#ifdef OP_MAX
+        int inclusive = std::max(prev, in(i));
+#else
+        int inclusive = prev + in(i);
+#endif
+        golden(i % PES, i / PES) = (ScanMode::MODE == ScanMode::Inclusive) ? inclusive : prev;
+        prev = inclusive;
+    }
+
+    // Check correctness.
+    check_equal_2D<int>(golden, out);
+    cout << "Success!\n";
+}
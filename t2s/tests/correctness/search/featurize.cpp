@@ -0,0 +1,58 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Featurize hand-written IR of device kernels, and check the cycles of sequential loops one after
+// another in a kernel, of loops nested in them, and of kernels running concurrently.
+
+#include "util.h"
+
+using namespace Halide::Internal;
+
+Stmt loop(const string &name, int extent, Stmt body, ForType for_type = ForType::Serial) {
+    return For::make(name, 0, extent, for_type, DeviceAPI::None, body);
+}
+
+Stmt kernel(const string &name, Stmt body) {
+    return loop(name + ".run_on_device", 1, body, ForType::Parallel);
+}
+
+int main(void) {
+    Stmt compute = Evaluate::make(Variable::make(Float(32), "a") * Variable::make(Float(32), "b"));
+
+    // Two sequential loops one after another: 100 + 50 cycles. The second one has 4 PEs, which run
+    // at the same time.
+    Stmt k1 = kernel("k1", Block::make(loop("k1.x", 100, compute),
+                                       loop("k1.y", 50, loop("k1.u", 4, compute, ForType::Unrolled))));
+    SystolicFeatures f1 = featurize_systolic_design(k1);
+    assert(f1.num_kernels == 1);
+    assert(f1.cycles == 150);
+    assert(f1.num_PEs == 4);
+
+    // Sequential loops one after another inside a sequential loop: 10 * (3 + 2) cycles
+    Stmt k2 = kernel("k2", loop("k2.z", 10, Block::make(loop("k2.w", 3, compute), loop("k2.v", 2, compute))));
+    SystolicFeatures f2 = featurize_systolic_design(k2);
+    assert(f2.cycles == 50);
+
+    // Kernels run concurrently, so the design takes the cycles of the longest kernel
+    SystolicFeatures f = featurize_systolic_design(Block::make(k1, k2));
+    assert(f.num_kernels == 2);
+    assert(f.cycles == 150);
+
+    cout << "Success!\n";
+    return 0;
+}
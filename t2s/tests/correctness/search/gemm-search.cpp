@@ -0,0 +1,106 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Search tile sizes and space loops of a GEMM systolic array, and check that the
+// features extracted from the lowered IR match the schedule of every candidate.
+
+#include "util.h"
+
+#define I 32
+#define J 32
+#define K 32
+#define II 2
+#define JJ 2
+#define KK 2
+
+int main(void) {
+    ImageParam a(Float(32), 2, "a"), b(Float(32), 2, "b");
+
+    SystolicSearchSpace space;
+    space.tile_knob("III", I / II, 2, 8)
+         .tile_knob("JJJ", J / JJ, 2, 8)
+         .knob("KKK", {4})
+         .choice_knob("space_loops", 2); // 0: {jjj, iii}, 1: {iii}
+
+    auto build = [&](const SystolicConfig &config) {
+        int III = config.at("III"), JJJ = config.at("JJJ"), KKK = config.at("KKK");
+        int OI = I / II / III, OJ = J / JJ / JJJ, OK = K / KK / KKK;
+
+        Var kkk, jjj, iii, kk, jj, ii, ok, oj, oi;
+        #define P             kkk, jjj, iii, kk, jj, ii, ok, oj, oi
+        #define P_jjj_minus_1 kkk, jjj - 1, iii, kk, jj, ii, ok, oj, oi
+        #define P_iii_minus_1 kkk, jjj, iii - 1, kk, jj, ii, ok, oj, oi
+        #define P_kkk_minus_1 kkk - 1, jjj, iii, kk, jj, ii, ok, oj, oi
+        #define P_kk_minus_1  kkk + KKK - 1, jjj, iii, kk - 1, jj, ii, ok, oj, oi
+        #define P_ok_minus_1  kkk + KKK - 1, jjj, iii, kk + KK - 1, jj, ii, ok - 1, oj, oi
+        #define P_c           jjj, iii, jj, ii, oj, oi
+        Expr i = oi * II * III + ii * III + iii;
+        Expr j = oj * JJ * JJJ + jj * JJJ + jjj;
+        Expr k = ok * KK * KKK + kk * KKK + kkk;
+
+        Func A(Float(32), {P}, Place::Device), B(Float(32), {P}, Place::Device);
+        Func C(Float(32), {P}, Place::Device), c(Place::Device);
+        A(P) = select(jjj == 0, a(k, i), A(P_jjj_minus_1));
+        B(P) = select(iii == 0, b(j, k), B(P_iii_minus_1));
+        C(P) = select(kkk == 0 && kk == 0 && ok == 0, 0,
+                      select(kkk == 0, select(kk == 0, C(P_ok_minus_1), C(P_kk_minus_1)), C(P_kkk_minus_1)))
+               + A(P) * B(P);
+        c(P_c) = select(kkk == KKK - 1 && kk == KK - 1 && ok == OK - 1, C(P));
+
+        A.merge_ures(B, C, c)
+         .set_bounds(kkk, 0, KKK, jjj, 0, JJJ, iii, 0, III)
+         .set_bounds(kk,  0, KK,  jj,  0, JJ,  ii,  0, II)
+         .set_bounds(ok,  0, OK,  oj,  0, OJ,  oi,  0, OI);
+        if (config.at("space_loops") == 0) {
+            A.space_time_transform(jjj, iii);
+        } else {
+            A.space_time_transform(iii);
+        }
+        Func unloader(Place::Host);
+        c.isolate_consumer_chain(unloader);
+
+        SystolicDesign d;
+        d.output = unloader;
+        d.args = {a, b};
+        return d;
+    };
+
+    // A tiny device where at most 16 PEs fit
+    SystolicDeviceModel device("tiny", 16, 300, 10, 1e6);
+    Target target = get_host_target().with_feature(Target::IntelFPGA);
+    std::vector<SystolicCandidate> candidates = search_systolic_schedules(space, build, device, target);
+    assert(candidates.size() == space.size());
+
+    for (auto &c : candidates) {
+        cout << c << "\n";
+        int64_t PEs = c.config.at("III") * (c.config.at("space_loops") == 0 ? c.config.at("JJJ") : 1);
+        assert(c.features.num_PEs >= PEs);
+        assert(c.features.dsps == PEs);
+        assert(c.features.ops >= 2.0 * I * J * K);
+        assert(c.feasible == (PEs <= device.dsps));
+    }
+
+    // The best design uses all the DSPs of the device.
+    assert(candidates[0].feasible && candidates[0].features.dsps == device.dsps);
+    for (size_t n = 1; n < candidates.size(); n++) {
+        assert(!candidates[n].feasible || candidates[n].time >= candidates[0].time);
+    }
+
+    cout << "Success!\n";
+    return 0;
+}
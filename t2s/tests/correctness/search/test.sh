@@ -0,0 +1,75 @@
+#!/bin/bash
+# ./test.sh
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NOCOLOR='\033[0m'
+
+# In this array, every element contains:
+# Test file
+regression=(
+        gemm-search
+        featurize
+)
+
+succ=0
+fail=0
+
+function emulate_func {
+    eval file="$1"
+    printf "$file "
+    compile="g++ $file.cpp -g -I ../util -I ../../../../Halide/include -L ../../../../Halide/bin $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 "
+    clean="rm -rf a a.out"
+    $clean
+    $compile >& a
+    if [ -f "a.out" ]; then
+        # The search only lowers the designs, and does not need an FPGA or its emulator.
+        run="./a.out"
+        timeout 10m ./a.out >& a
+        if  tail -n 1 a | grep -q -E "^Success!"; then
+            echo >> success.txt
+            echo $clean >> success.txt
+            echo $compile >> success.txt
+            echo $run >> success.txt
+            cat a >> success.txt
+            let succ=succ+1
+            echo " Success!"
+        else
+            echo >> failure.txt
+            echo $clean >> failure.txt
+            echo $compile >> failure.txt
+            echo $run >> failure.txt
+            cat a >> failure.txt
+            let fail=fail+1
+            echo "Failure!"
+        fi
+    else
+        echo >> failure.txt
+        echo $clean >> failure.txt
+        echo $compile >> failure.txt
+        cat a >> failure.txt
+        let fail=fail+1
+        echo " Failure!"
+    fi 
+    $clean
+}
+        
+rm -f success.txt failure.txt
+
+array_to_read=("${regression[@]}")
+echo "Testing systolic schedule search for regression."
+
+index=0
+while [ "$index" -lt "${#array_to_read[*]}" ]; do
+    file=${array_to_read[$index]}
+    let index=index+1
+    emulate_func "\${file}"
+done
+
+let total=succ+fail
+echo -e Total $total, pass ${GREEN}$succ${NOCOLOR}, fail ${RED}$fail${NOCOLOR}. See $PWD/success.txt and failure.txt for details.
+
+# Return values for the parent script
+echo $total > ../total.temp
+echo $succ > ../succ.temp
+echo $fail > ../fail.temp
@@ -0,0 +1,138 @@
+// A positive test for the stencil template in t2s/peppers/primitives/stencil.h: STEPS steps of a Jacobi
+// stencil of radius 1 on a grid tiled along x (and y), compared with the steps on the CPU. The options are:
+//   DIM3:      a 7-point 3-D stencil instead of a 5-point 2-D one
+//   STT:       space-time transform the steps into PEs
+//   PLACE:     Place::Host or Place::Device
+
+#include "util.h"
+#include "../../../peppers/primitives/stencil.h"
+
+#define STEPS   3
+#define BX      4
+#define BY      2
+#define W       (2 * BX)
+#ifdef DIM3
+    #define H   (2 * BY)
+    #define D   4
+    #define TAPS 7
+#else
+    #define H   5
+    #define D   1
+    #define TAPS 5
+#endif
+
+int main(void) {
+    Var s, x, y, z, xb, yb;
+    std::vector<StencilTap> taps;
+    for (int d = -1; d <= 1; d++) {
+        taps.push_back({{d, 0}, 1.0f / TAPS});
+        if (d != 0) {
+            taps.push_back({{0, d}, 1.0f / TAPS});
+        }
+    }
+    auto interior = [](Expr gx, Expr gy, Expr gz) {
+        Expr in = gx >= 1 && gx <= W - 2 && gy >= 1 && gy <= H - 2;
+#ifdef DIM3
+        in = in && gz >= 1 && gz <= D - 2;
+#endif
+        return in;
+    };
+
+#ifdef DIM3
+    ImageParam a(Float(32), 3, "a");
+    for (auto &tap : taps) {
+        tap.offset.push_back(0);
+    }
+    taps.push_back({{0, 0, -1}, 1.0f / TAPS});
+    taps.push_back({{0, 0, 1}, 1.0f / TAPS});
+    StencilUREs st = stencil_ures(s, {x, y, z}, {xb, yb}, STEPS, {BX + 2 * STEPS, BY + 2 * STEPS, D + 2 * STEPS}, taps,
+        [&](std::vector<Expr> X) { return a(xb * BX + X[0], yb * BY + X[1], X[2]); },
+        [&](std::vector<Expr> u) { return interior(xb * BX + u[0] - STEPS, yb * BY + u[1] - STEPS, u[2] - STEPS); },
+        PLACE);
+    st.head.set_bounds(xb, 0, W / BX, yb, 0, H / BY);
+#else
+    ImageParam a(Float(32), 2, "a");
+    StencilUREs st = stencil_ures(s, {x, y}, {xb}, STEPS, {BX + 2 * STEPS, H + 2 * STEPS}, taps,
+        [&](std::vector<Expr> X) { return a(xb * BX + X[0], X[1]); },
+        [&](std::vector<Expr> u) { return interior(xb * BX + u[0] - STEPS, u[1] - STEPS, 0); },
+        PLACE);
+    st.head.set_bounds(xb, 0, W / BX);
+#endif
+#ifdef STT
+    st.head.space_time_transform(s);
+#endif
+
+    // Generate input, padded by STEPS points on every side.
+    std::vector<float> grid(W * H * D);
+    for (auto &v : grid) {
+        v = rand() / (float)RAND_MAX;
+    }
+    auto at = [&](std::vector<float> &g, int x, int y, int z) -> float & { return g[(z * H + y) * W + x]; };
+#ifdef DIM3
+    Buffer<float> in(W + 2 * STEPS, H + 2 * STEPS, D + 2 * STEPS);
+#else
+    Buffer<float> in(W + 2 * STEPS, H + 2 * STEPS);
+#endif
+    in.fill(0);
+    for (int k = 0; k < D; k++)
+    for (int j = 0; j < H; j++)
+    for (int i = 0; i < W; i++) {
+#ifdef DIM3
+        in(i + STEPS, j + STEPS, k + STEPS) = at(grid, i, j, k);
+#else
+        in(i + STEPS, j + STEPS) = at(grid, i, j, k);
+#endif
+    }
+    a.set(in);
+
+    // Compile and run.
+    Target target = get_host_target();
+    if (PLACE == Place::Device) {
+        target.set_feature(Target::IntelFPGA);
+    }
+#ifdef DIM3
+    Buffer<float> out = st.out.realize({BX + 2 * STEPS, BY + 2 * STEPS, D + 2 * STEPS, W / BX, H / BY}, target);
+#else
+    Buffer<float> out = st.out.realize({BX + 2 * STEPS, H + 2 * STEPS, W / BX}, target);
+#endif
+
+    // Golden.
+    std::vector<float> golden(grid), next(grid);
+    for (int t = 0; t < STEPS; t++) {
+        for (int k = 0; k < D; k++)
+        for (int j = 0; j < H; j++)
+        for (int i = 0; i < W; i++) {
+            bool inside = i >= 1 && i <= W - 2 && j >= 1 && j <= H - 2;
+#ifdef DIM3
+            inside = inside && k >= 1 && k <= D - 2;
+#endif
+            if (!inside) {
+                at(next, i, j, k) = at(golden, i, j, k);
+                continue;
+            }
+            float sum = at(golden, i - 1, j, k) + at(golden, i, j - 1, k) + at(golden, i, j, k)
+                        + at(golden, i + 1, j, k) + at(golden, i, j + 1, k);
+#ifdef DIM3
+            sum += at(golden, i, j, k - 1) + at(golden, i, j, k + 1);
+#endif
+            at(next, i, j, k) = sum / TAPS;
+        }
+        golden.swap(next);
+    }
+
+    // Check correctness.
+    for (int k = 0; k < D; k++)
+    for (int j = 0; j < H; j++)
+    for (int i = 0; i < W; i++) {
+#ifdef DIM3
+        float result = out(i % BX + 2 * STEPS, j % BY + 2 * STEPS, k + 2 * STEPS, i / BX, j / BY);
+#else
+        float result = out(i % BX + 2 * STEPS, j + 2 * STEPS, i / BX);
+#endif
+        if (fabs(result - at(golden, i, j, k)) > 1e-4) {
+            cout << "Mismatch at (" << i << ", " << j << ", " << k << "): " << result << " vs " << at(golden, i, j, k) << "\n";
+            return 1;
+        }
+    }
+    cout << "Success!\n";
+}
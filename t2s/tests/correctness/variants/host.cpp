@@ -0,0 +1,94 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// Dispatch gemm to the variant with the least padded work (t2s/src/VariantLibrary.h), and check the results.
+// Usage: ./host.out <library dir> I J K <expected variant> [I J K <expected variant> ...]
+#include "VariantLibrary.h"
+#include "HalideBuffer.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Multiply a matrix of I x K by a matrix of K x J with a variant of gemm. The matrices are padded with zeros
+// to multiples of the tiles of the variant, and the results are unpacked from the layout of the design.
+bool run_gemm(VariantLibrary &gemms, int I, int J, int K, const std::string &expected) {
+    const DesignVariant *v = gemms.select([&](const DesignVariant &v) {
+        return padded_work({{I, v.param("III") * v.param("II")}, {J, v.param("JJJ") * v.param("JJ")},
+                            {K, v.param("KKK") * v.param("KK")}});
+    });
+    if (v == NULL || v->name != expected) {
+        printf("%dx%dx%d: expect variant %s, but got %s\n", I, J, K, expected.c_str(), v ? v->name.c_str() : "none");
+        return false;
+    }
+    const int III = v->param("III"), JJJ = v->param("JJJ"), KKK = v->param("KKK");
+    const int II = v->param("II"), JJ = v->param("JJ"), KK = v->param("KK");
+    const int TI = (I + III * II - 1) / (III * II), TJ = (J + JJJ * JJ - 1) / (JJJ * JJ), TK = (K + KKK * KK - 1) / (KKK * KK);
+
+    Halide::Runtime::Buffer<float> a(TK * KKK * KK, TI * III * II), b(TJ * JJJ * JJ, TK * KKK * KK);
+    a.fill(0.0f);
+    b.fill(0.0f);
+    for (int i = 0; i < I; i++) {
+        for (int k = 0; k < K; k++) {
+            a(k, i) = (float)(rand() % 16);
+        }
+    }
+    for (int k = 0; k < K; k++) {
+        for (int j = 0; j < J; j++) {
+            b(j, k) = (float)(rand() % 16);
+        }
+    }
+    Halide::Runtime::Buffer<float> c(JJJ, III, JJ, II, TJ, TI);
+    if (gemms.run(*v, a.raw_buffer(), b.raw_buffer(), c.raw_buffer()) != 0) {
+        printf("%dx%dx%d: variant %s failed\n", I, J, K, v->name.c_str());
+        return false;
+    }
+    c.copy_to_host();
+    for (int i = 0; i < I; i++) {
+        for (int j = 0; j < J; j++) {
+            float golden = 0.0f;
+            for (int k = 0; k < K; k++) {
+                golden += a(k, i) * b(j, k);
+            }
+            float result = c(j % JJJ, i % III, j / JJJ % JJ, i / III % II, j / (JJJ * JJ), i / (III * II));
+            if (fabs(golden - result) > 0.005 * fabs(golden)) {
+                printf("%dx%dx%d: C(%d, %d) = %f with variant %s, but expect %f\n", I, J, K, i, j, result,
+                       v->name.c_str(), golden);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 6 || (argc - 2) % 4 != 0) {
+        printf("Usage: %s <library dir> I J K <expected variant> [I J K <expected variant> ...]\n", argv[0]);
+        return 1;
+    }
+    VariantLibrary gemms(argv[1], "gemm");
+    if (!gemms.ok()) {
+        return 1;
+    }
+    for (int p = 2; p < argc; p += 4) {
+        if (!run_gemm(gemms, atoi(argv[p]), atoi(argv[p + 1]), atoi(argv[p + 2]), argv[p + 3])) {
+            return 1;
+        }
+    }
+    printf("Success!\n");
+    return 0;
+}
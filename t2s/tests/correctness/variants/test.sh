@@ -0,0 +1,107 @@
+#!/bin/bash
+# ./test.sh
+# Test a library of variants of gemm (t2s/src/VariantLibrary.h) in the emulator: the gemm generator compiles
+# the variants in ../../performance/gemm/tiny.variants in one run, and every case dispatches a few shapes to
+# the variant with the least padded work, and checks the results.
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+NOCOLOR='\033[0m'
+
+# In this array, every element contains:
+# Test case
+regression=(
+        small
+        aligned
+        skinny
+        switch
+)
+
+succ=0
+fail=0
+
+export CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=1
+export INTEL_FPGA_OCL_PLATFORM_NAME="$EMULATOR_PLATFORM"
+
+function clean_func {
+    rm -rf a gemm.generator host.out lib
+}
+
+function small {
+    ./host.out lib 4 4 4 gemm_tiny_2
+}
+
+function aligned {
+    # Equally padded by both variants, and the first one in the manifest is chosen
+    ./host.out lib 32 32 32 gemm_tiny_4
+}
+
+function skinny {
+    ./host.out lib 16 4 16 gemm_tiny_2
+}
+
+function switch {
+    # Switch between the variants, reprogramming the device
+    ./host.out lib 32 32 32 gemm_tiny_4 4 4 4 gemm_tiny_2 16 16 16 gemm_tiny_4
+}
+
+function test_func {
+    eval case="$1"
+    printf "$case "
+    $case >& a
+    if [ $? -eq 0 ]; then
+        echo >> success.txt
+        echo $case >> success.txt
+        cat a >> success.txt
+        let succ=succ+1
+        echo " Success!"
+    else
+        echo >> failure.txt
+        echo $case >> failure.txt
+        cat a >> failure.txt
+        let fail=fail+1
+        echo " Failure!"
+    fi
+}
+
+rm -f success.txt failure.txt
+clean_func
+mkdir lib
+
+generator="g++ ../../performance/gemm/gemm.cpp ../../performance/util/gen-variants.cpp -DT2S_GEN_VARIANTS -g -I ../../performance/util -I ../../../../Halide/include -L ../../../../Halide/bin $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 -o gemm.generator"
+generate="./gemm.generator -g gemm -o lib -v $PWD/../../performance/gemm/tiny.variants target=host-intel_fpga-enable_synthesis"
+host="g++ host.cpp -g -I ../../../src -I ../../../../Halide/include -L ../../../../Halide/bin $EMULATOR_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 -o host.out"
+(
+    $generator && env AOC_OPTION="$EMULATOR_AOC_OPTION -board=$FPGA_BOARD -emulator-channel-depth-model=strict" $generate || exit 1
+    for v in $(awk '{print $1}' lib/gemm.variants); do
+        g++ -shared -Wl,-Bsymbolic lib/$v-interface.cpp $COMMON_OPTIONS_COMPILING_HOST -o lib/lib$v.so || exit 1
+    done
+    $host
+) >& a
+if [ $? -eq 0 ] && [ -f "host.out" ]; then
+    array_to_read=("${regression[@]}")
+    echo "Testing the library of variants for regression."
+
+    index=0
+    while [ "$index" -lt "${#array_to_read[*]}" ]; do
+        case=${array_to_read[$index]}
+        let index=index+1
+        test_func "\${case}"
+    done
+else
+    echo >> failure.txt
+    echo $generator >> failure.txt
+    echo $generate >> failure.txt
+    echo $host >> failure.txt
+    cat a >> failure.txt
+    let fail=fail+1
+fi
+clean_func
+
+let total=succ+fail
+echo -e Total $total, pass ${GREEN}$succ${NOCOLOR}, fail ${RED}$fail${NOCOLOR}. See $PWD/success.txt and failure.txt for details.
+
+# Return values for the parent script
+echo $total > ../total.temp
+echo $succ > ../succ.temp
+echo $fail > ../fail.temp
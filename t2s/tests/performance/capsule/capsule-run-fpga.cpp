@@ -22,6 +22,9 @@
 // Roofline utilities
 #include "Roofline.h"
 
+// Benchmark harness
+#include "Benchmark.h"
+
 // The only header file needed for including T2S.
 #include "HalideBuffer.h"
 
@@ -116,7 +119,17 @@ int main()
     double number_bytes = (long)(MX * MK * TOTAL_CI * TOTAL_IY * TOTAL_IX * TOTAL_N) * 4
                         + (long)(MY * MK * TOTAL_CI * TOTAL_CO * KY * KX) * 4
                         + (long)(TOTAL_CO * YYY_XXX * YY_XX * Y_X * MY * MX * TOTAL_N) * 4;
-    double exec_time = ExecTime("kernel_unloader");
+    // Benchmark the design with warm-up runs and multiple samples, and take the median time
+    DesignBenchmark benchmark;
+    benchmark.name = "capsule";
+    benchmark.number_ops = number_ops;
+    benchmark.number_bytes = number_bytes;
+    benchmark.compute_roof = compute_roof;
+    benchmark.mem_bandwidth = mem_bandwidth;
+    benchmark.parameters = {{"N", TOTAL_N}, {"CI", TOTAL_CI}, {"CO", TOTAL_CO}, {"IY", TOTAL_IY}, {"IX", TOTAL_IX}};
+    BenchmarkReport report = benchmark_and_report(benchmark, [&]() { return capsule(P, W, V); });
+    assert(report.result == 0);
+    double exec_time = report.time.median;
     roofline(mem_bandwidth, compute_roof, number_ops, number_bytes, exec_time);
     if (fopen("roofline.png", "r") == NULL) {
         cout << "Failed to draw roofline!\n";
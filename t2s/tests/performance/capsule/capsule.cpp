@@ -18,91 +18,138 @@
 *******************************************************************************/
 #include "Halide.h"
 #include "util.h"
-#include "const-parameters.h"
+#include "variants.h"
 
 using namespace Halide;
 
-int main(void)
-{
-    // Dependences
-    #define Index               cii,       cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky,      kx,      ci,      mk,   co, n
-    #define Index_cii_minus_1   cii-1,     cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky,      kx,      ci,      mk,   co, n
-    #define Index_ky_minus_1    cii+CII-1, cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky-1,    kx,      ci,      mk,   co, n
-    #define Index_kx_minus_1    cii+CII-1, cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky+KY-1, kx-1,    ci,      mk,   co, n
-    #define Index_ci_minus_1    cii+CII-1, cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky+KY-1, kx+KX-1, ci-1,    mk,   co, n
-    #define Index_mk_minus_1    cii+CII-1, cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky+KY-1, kx+KX-1, ci+CI-1, mk-1, co, n
-    #define Index_co3_minus_1   cii,       cooo-1, yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky,      kx,      ci,      mk,   co, n
-    #define Index_yx3_minus_1   cii,       cooo,   yyy_xxx-1, yy_xx, y_x, my, mx, coo, nn, ky,      kx,      ci,      mk,   co, n
-    #define Index_Out                      cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn,                                  co, n
-    // Linearized addresses
-    #define total_oy        ((yyy_xxx + YYY_XXX*yy_xx + YYY_XXX*YY_XX*y_x) % OY)
-    #define total_ox        ((yyy_xxx + YYY_XXX*yy_xx + YYY_XXX*YY_XX*y_x) / OY)
-    #define total_iy        (total_oy * 2 + ky)
-    #define total_ix        (total_ox * 2 + kx)
-    #define total_ci        (cii  + CII*ci)
-    #define total_n         (nn   + NN*n)
-    #define total_co        (cooo + COOO*coo + COOO*COO*co)
-
-    // Type of the data to process in C and T2S
-    #define CTYPE float
-    #define TTYPE Float(32)
-
-    // Inputs
-    ImageParam P("P", TTYPE, 2), W("W", TTYPE, 2);
-    #define Index_P     total_ci + (TOTAL_CI)*mk + (TOTAL_CI*MK)*mx + (TOTAL_CI*MK*MX)*nn,  total_iy + (TOTAL_IY)*total_ix + (TOTAL_IY*TOTAL_IX)*n
-    #define Index_W     total_co + (TOTAL_CO)*my,                                           cii + (CII)*ky + (CII*KY)*kx + (CII*KY*KX)*ci + (TOTAL_CI*KY*KX)*mk
-    #define Index_V     total_co + (TOTAL_CO)*my + (TOTAL_CO*MY)*mx + (TOTAL_CO*MY*MX)*nn,  total_oy + (OY)*total_ox + (OY*OX)*n
-    #define UN          (P.dim(1).extent() / (TOTAL_IY*TOTAL_IX*NN))
-
-    // UREs
-    Var cii("cii"), my("my"), mx("mx"), nn("nn"), ky("ky"), kx("kx"), ci("ci"), mk("mk"), n("n");
-    Var yyy_xxx("yyy_xxx"), yy_xx("yy_xx"), y_x("y_x"), cooo("cooo"), coo("coo"), co("co");
-    URE A("A", TTYPE, {Index}), B("B", TTYPE, {Index}), C("C", TTYPE, {Index}), Out("Out");
-    A(Index) = select(cooo == 0, P(Index_P), A(Index_co3_minus_1));
-    B(Index) = select(yyy_xxx == 0, W(Index_W), B(Index_yx3_minus_1));
-    C(Index) = select(cii == 0 && ci == 0 && mk == 0 && ky == 0 && kx == 0, 0,
-                select(cii == 0, select(ky == 0, select(kx == 0, select(ci == 0, C(Index_mk_minus_1), C(Index_ci_minus_1)), C(Index_kx_minus_1)), C(Index_ky_minus_1)), C(Index_cii_minus_1)))
-                + A(Index) * B(Index);
-    Out(Index_Out) = select(cii == CII-1 && ci == CI-1 && mk == MK-1 && ky == KY-1 && kx == KX-1, C(Index));
-
-    // Put all the UREs inside the same loop nest of X.
-    A.merge_ures(B, C, Out);
-
-    // Explicitly set the loop bounds
-    A.set_bounds(cooo,    0, COOO,    coo,   0, COO,   co,  0, CO)
-     .set_bounds(my,      0, MY,      mx,    0, MX,    mk,  0, MK)
-     .set_bounds(yyy_xxx, 0, YYY_XXX, yy_xx, 0, YY_XX, y_x, 0, Y_X)
-     .set_bounds(cii,     0, CII,     ci,    0, CI)
-     .set_bounds(ky,      0, KY,      kx,    0, KX)
-     .set_bounds(nn,      0, NN,      n,     0, UN);
-    A.space_time_transform(cooo, yyy_xxx, yy_xx);
+// The design is a generator, whose GeneratorParams specialize it at compile time. The defaults are for A10.
+class CAPSULE : public Generator<CAPSULE> {
+public:
+    // Inner loop bounds, which are static constant parameters of the design
+    GeneratorParam<int> CII_{"CII", 16}, CI_{"CI", 2}, COOO_{"COOO", 8}, COO_{"COO", 4}, CO_{"CO", 1};
+    GeneratorParam<int> YYY_XXX_{"YYY_XXX", 10}, YY_XX_{"YY_XX", 1}, Y_X_{"Y_X", 5}, NN_{"NN", 4};
+    // The sizes of the output image, the filter and the capsule matrices
+    GeneratorParam<int> OX_{"OX", 7}, OY_{"OY", 7}, KY_{"KY", 3}, KX_{"KX", 3};
+    GeneratorParam<int> MY_{"MY", 4}, MX_{"MX", 4}, MK_{"MK", 4};
+    // Type of the data to process in T2S
+    GeneratorParam<Type> TTYPE{"type", Float(32)};
 
-#ifdef GPU
-    // GPU can have many threads running in parallel.
-    A.gpu_blocks(co, nn, n).gpu_threads(my, mx);
-    A.reorder(cii, cooo, y_x, my, mx, coo, ky, kx, yyy_xxx, yy_xx, ci, mk, co, nn, n);
-#endif
+    void configure() {
+        p = add_input<Buffer<>>("P", TTYPE, 2);
+        w = add_input<Buffer<>>("W", TTYPE, 2);
+        // The results are in the order of the loops that drain them:
+        // V(cooo, yyy_xxx, yy_xx, y_x, my, mx, coo, nn, co, n)
+        v = add_output<Buffer<>>("V", TTYPE, 10);
+    }
 
-    // I/O network
-    Stensor DP("PLoader", DRAM), SP("PFeeder", SRAM), DW("WLoader", DRAM), SW("WFeeder", SRAM);
-    Stensor RV("collector", REG), DV("unloader", DRAM), V("deserializer");
-#ifdef GPU
-    SP.scope(yy_xx).out(cii, yyy_xxx);
-#else
-    SP.scope(ci).out(cii, yyy_xxx);
-#endif
-    P >> DP.out(cii) >> FIFO(256) >> SP >> FIFO(256);
-    W >> DW.out(cii) >> FIFO(256)
-      >> SW.scope(ci).out(cii, cooo)    >> FIFO(256);
-    Out >> RV.scope(yyy_xxx).out(cooo)  >> FIFO(256)
-        >> DV >> V(Index_V);
+    void generate() {
+        const int CII = CII_, CI = CI_, COOO = COOO_, COO = COO_, CO = CO_;
+        const int YYY_XXX = YYY_XXX_, YY_XX = YY_XX_, Y_X = Y_X_, NN = NN_;
+        const int OX = OX_, OY = OY_, KY = KY_, KX = KX_, MY = MY_, MX = MX_, MK = MK_;
+        const int TOTAL_IX = OX * 2 + KX - 2, TOTAL_IY = OY * 2 + KY - 2;
+        const int TOTAL_CO = COOO * COO * CO, TOTAL_CI = CII * CI;
+        const bool gpu = get_target().has_feature(Target::IntelGPU);
+
+        // Dependences
+        #define Index               cii,       cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky,      kx,      ci,      mk,   co, n
+        #define Index_cii_minus_1   cii-1,     cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky,      kx,      ci,      mk,   co, n
+        #define Index_ky_minus_1    cii+CII-1, cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky-1,    kx,      ci,      mk,   co, n
+        #define Index_kx_minus_1    cii+CII-1, cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky+KY-1, kx-1,    ci,      mk,   co, n
+        #define Index_ci_minus_1    cii+CII-1, cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky+KY-1, kx+KX-1, ci-1,    mk,   co, n
+        #define Index_mk_minus_1    cii+CII-1, cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky+KY-1, kx+KX-1, ci+CI-1, mk-1, co, n
+        #define Index_co3_minus_1   cii,       cooo-1, yyy_xxx,   yy_xx, y_x, my, mx, coo, nn, ky,      kx,      ci,      mk,   co, n
+        #define Index_yx3_minus_1   cii,       cooo,   yyy_xxx-1, yy_xx, y_x, my, mx, coo, nn, ky,      kx,      ci,      mk,   co, n
+        #define Index_Out                      cooo,   yyy_xxx,   yy_xx, y_x, my, mx, coo, nn,                                  co, n
+        // Linearized addresses
+        #define total_oy        ((yyy_xxx + YYY_XXX*yy_xx + YYY_XXX*YY_XX*y_x) % OY)
+        #define total_ox        ((yyy_xxx + YYY_XXX*yy_xx + YYY_XXX*YY_XX*y_x) / OY)
+        #define total_iy        (total_oy * 2 + ky)
+        #define total_ix        (total_ox * 2 + kx)
+        #define total_ci        (cii  + CII*ci)
+        #define total_n         (nn   + NN*n)
+        #define total_co        (cooo + COOO*coo + COOO*COO*co)
+
+        // Inputs
+        ImageParam P = *p, W = *w;
+        #define Index_P     total_ci + (TOTAL_CI)*mk + (TOTAL_CI*MK)*mx + (TOTAL_CI*MK*MX)*nn,  total_iy + (TOTAL_IY)*total_ix + (TOTAL_IY*TOTAL_IX)*n
+        #define Index_W     total_co + (TOTAL_CO)*my,                                           cii + (CII)*ky + (CII*KY)*kx + (CII*KY*KX)*ci + (TOTAL_CI*KY*KX)*mk
+        #define Index_V     total_co + (TOTAL_CO)*my + (TOTAL_CO*MY)*mx + (TOTAL_CO*MY*MX)*nn,  total_oy + (OY)*total_ox + (OY*OX)*n
+        #define UN          (P.dim(1).extent() / (TOTAL_IY*TOTAL_IX*NN))
+
+        // UREs
+        Var cii("cii"), my("my"), mx("mx"), nn("nn"), ky("ky"), kx("kx"), ci("ci"), mk("mk"), n("n");
+        Var yyy_xxx("yyy_xxx"), yy_xx("yy_xx"), y_x("y_x"), cooo("cooo"), coo("coo"), co("co");
+        URE A("A", TTYPE, {Index}), B("B", TTYPE, {Index}), C("C", TTYPE, {Index}), Out("Out");
+        A(Index) = select(cooo == 0, P(Index_P), A(Index_co3_minus_1));
+        B(Index) = select(yyy_xxx == 0, W(Index_W), B(Index_yx3_minus_1));
+        C(Index) = select(cii == 0 && ci == 0 && mk == 0 && ky == 0 && kx == 0, 0,
+                    select(cii == 0, select(ky == 0, select(kx == 0, select(ci == 0, C(Index_mk_minus_1), C(Index_ci_minus_1)), C(Index_kx_minus_1)), C(Index_ky_minus_1)), C(Index_cii_minus_1)))
+                    + A(Index) * B(Index);
+        Out(Index_Out) = select(cii == CII-1 && ci == CI-1 && mk == MK-1 && ky == KY-1 && kx == KX-1, C(Index));
+
+        // Put all the UREs inside the same loop nest of X.
+        A.merge_ures(B, C, Out);
 
-    // Compile the kernel to an FPGA bitstream, and expose a C interface for the host to invoke
+        // Explicitly set the loop bounds
+        A.set_bounds(cooo,    0, COOO,    coo,   0, COO,   co,  0, CO)
+         .set_bounds(my,      0, MY,      mx,    0, MX,    mk,  0, MK)
+         .set_bounds(yyy_xxx, 0, YYY_XXX, yy_xx, 0, YY_XX, y_x, 0, Y_X)
+         .set_bounds(cii,     0, CII,     ci,    0, CI)
+         .set_bounds(ky,      0, KY,      kx,    0, KX)
+         .set_bounds(nn,      0, NN,      n,     0, UN);
+        A.space_time_transform(cooo, yyy_xxx, yy_xx);
+
+        if (gpu) {
+            // GPU can have many threads running in parallel.
+            A.gpu_blocks(co, nn, n).gpu_threads(my, mx);
+            A.reorder(cii, cooo, y_x, my, mx, coo, ky, kx, yyy_xxx, yy_xx, ci, mk, co, nn, n);
+        }
+
+        // I/O network
+        Stensor DP("PLoader", DRAM), SP("PFeeder", SRAM), DW("WLoader", DRAM), SW("WFeeder", SRAM);
+        Stensor RV("collector", REG), DV("unloader", DRAM), V("deserializer");
+        if (gpu) {
+            SP.scope(yy_xx).out(cii, yyy_xxx);
+        } else {
+            SP.scope(ci).out(cii, yyy_xxx);
+        }
+        P >> DP.out(cii) >> FIFO(256) >> SP >> FIFO(256);
+        W >> DW.out(cii) >> FIFO(256)
+          >> SW.scope(ci).out(cii, cooo)    >> FIFO(256);
+        Out >> RV.scope(yyy_xxx).out(cooo)  >> FIFO(256)
+            >> DV >> V(Index_V);
+
+        // The kernel on the device, invoked by the host through the C interface
+        *v = V.realize_wrapper(get_target());
+    }
+
+private:
+    Input<Buffer<>> *p, *w;
+    Output<Buffer<>> *v;
+};
+
+HALIDE_REGISTER_GENERATOR(CAPSULE, capsule)
+
+#ifndef T2S_GEN_VARIANTS
+#include "const-parameters.h"
+
+int main(void)
+{
+    // The variant of the design as specified by the macros. Compile the kernel to an FPGA bitstream, and
+    // expose a C interface for the host to invoke
+    DesignVariant v{"capsule", {{"CII", std::to_string(CII)}, {"CI", std::to_string(CI)}, {"COOO", std::to_string(COOO)},
+                                {"COO", std::to_string(COO)}, {"CO", std::to_string(CO)},
+                                {"YYY_XXX", std::to_string(YYY_XXX)}, {"YY_XX", std::to_string(YY_XX)},
+                                {"Y_X", std::to_string(Y_X)}, {"NN", std::to_string(NN)},
+                                {"OX", std::to_string(OX)}, {"OY", std::to_string(OY)}, {"KY", std::to_string(KY)},
+                                {"KX", std::to_string(KX)}, {"MY", std::to_string(MY)}, {"MX", std::to_string(MX)},
+                                {"MK", std::to_string(MK)}}};
 #ifdef GPU
-    V.compile_to_host("capsule-interface", { P, W }, "capsule", IntelGPU);
+    compile_design_variant("capsule", v, get_host_target().with_feature(Target::IntelGPU));
 #else
-    V.compile_to_host("capsule-interface", { P, W }, "capsule", IntelFPGA);
+    compile_design_variant("capsule", v, get_host_target().with_feature(Target::IntelFPGA).with_feature(Target::EnableSynthesis));
 #endif
     printf("Success\n");
     return 0;
 }
+#endif
@@ -22,6 +22,20 @@
 #define KY              3
 #define KX              3
 
+// Variants of the convolution, chosen at compile time, e.g. -DSTRIDE=2 -DGROUPS=4
+#ifndef STRIDE
+    #define STRIDE      1
+#endif
+#ifndef DILATION
+    #define DILATION    1
+#endif
+// The input channels are divided into GROUPS groups, each convolved with its own filters into TOTAL_CO
+// output channels. With DEPTHWISE, every channel is convolved separately, and a group is a block of
+// TOTAL_CO channels that the PEs along cooo work on at the same time.
+#ifndef GROUPS
+    #define GROUPS      1
+#endif
+
 // Inner loop bounds, which are static constant parameters of the design
 #ifdef GPU
     #define CII         8
@@ -75,11 +89,26 @@
     #endif
 #endif
 
-#define TOTAL_IX        (XXX * XX * X + KX - 1)
-#define TOTAL_IY        (YYY * YY * Y + KY - 1)
+#ifdef DEPTHWISE
+    // No reduction across input channels
+    #undef CII
+    #undef CI
+    #define CII         1
+    #define CI          1
+#endif
+
 #define TOTAL_OX        (XXX * XX * X)
 #define TOTAL_OY        (YYY * YY * Y)
+#define TOTAL_IX        (STRIDE * (TOTAL_OX - 1) + DILATION * (KX - 1) + 1)
+#define TOTAL_IY        (STRIDE * (TOTAL_OY - 1) + DILATION * (KY - 1) + 1)
 #define TOTAL_CO        (COOO * COO * CO)
 #define TOTAL_CI        (CII * CI)
 
+// Input channels of a group
+#ifdef DEPTHWISE
+    #define GROUP_CI    TOTAL_CO
+#else
+    #define GROUP_CI    TOTAL_CI
+#endif
+
 #endif
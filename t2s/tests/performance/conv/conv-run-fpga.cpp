@@ -25,6 +25,9 @@
 // Roofline utilities
 #include "Roofline.h"
 
+// Benchmark harness
+#include "Benchmark.h"
+
 // For printing output
 #include <stdio.h>
 #include <iostream>
@@ -35,6 +38,11 @@
 // Constant parameters (inner loop bounds) of the design
 #include "const-parameters.h"
 
+#ifdef STREAMING
+// For tensors larger than the device memory
+#include "StreamingExecution.h"
+#endif
+
 // Outer loop bounds for testing
 #ifdef TINY // For verifying correctness only
     #define N       4
@@ -46,31 +54,42 @@ using namespace std;
 
 int main()
 {
-    Halide::Runtime::Buffer<float> i(TOTAL_CI*N, TOTAL_IY*TOTAL_IX), k(TOTAL_CO*KX, TOTAL_CI*KY);
-    for (size_t n = 0; n < N; n++) {
-        for (size_t ci = 0; ci < TOTAL_CI; ci++) {
+    // Every image has GROUPS groups of channels
+    Halide::Runtime::Buffer<float> i(GROUP_CI*GROUPS*N, TOTAL_IY*TOTAL_IX), k(TOTAL_CO*KX, TOTAL_CI*KY*GROUPS);
+    for (size_t n = 0; n < GROUPS*N; n++) {
+        for (size_t ci = 0; ci < GROUP_CI; ci++) {
             for (size_t x = 0; x < TOTAL_IX; x++) {
                 for (size_t y = 0; y < TOTAL_IY; y++) {
-                    i(ci+TOTAL_CI*n, y+TOTAL_IY*x) = random();
+                    i(ci+GROUP_CI*n, y+TOTAL_IY*x) = random();
                 }
             }
         }
     }
-    for (size_t co = 0; co < TOTAL_CO; co++) {
-        for (size_t ci = 0; ci < TOTAL_CI; ci++) {
-            for (size_t kx = 0; kx < KX; kx++) {
-                for (size_t ky = 0; ky < KY; ky++) {
-                    k(co+TOTAL_CO*kx, ci+TOTAL_CI*ky) = random();
+    for (size_t g = 0; g < GROUPS; g++) {
+        for (size_t co = 0; co < TOTAL_CO; co++) {
+            for (size_t ci = 0; ci < TOTAL_CI; ci++) {
+                for (size_t kx = 0; kx < KX; kx++) {
+                    for (size_t ky = 0; ky < KY; ky++) {
+                        k(co+TOTAL_CO*kx, ci+TOTAL_CI*(ky+KY*g)) = random();
+                    }
                 }
             }
         }
     }
-    Halide::Runtime::Buffer<float> o(COOO, YYY, XXX, COO, YY, XX, Y, X, CO, N);
+    Halide::Runtime::Buffer<float> o(COOO, YYY, XXX, COO, YY, XX, Y, X, CO, GROUPS*N);
+#ifdef STREAMING
+    // Invoke the design on chunks of the images, each fitting into the device buffers. An image covers
+    // GROUPS iterations of the outermost loop, so that every chunk starts with the first group.
+    int result = stream_outermost_loop<float>([](std::vector<Halide::Runtime::Buffer<float>> &b) { return conv(b[0], b[1], b[2]); },
+                                              {{i, 0, GROUP_CI * GROUPS, false}, {k, -1, 0, false}, {o, 9, GROUPS, true}}, N);
+    assert(result == 0);
+#else
     conv(i, k, o);
+#endif
 
 #ifdef TINY
-    // Validate the results
-    for (int n = 0; n < N; n++)
+    // Validate the results against a direct convolution on the CPU
+    for (int n = 0; n < GROUPS*N; n++)
     for (int x = 0; x < X; x++)
     for (int y = 0; y < Y; y++)
     for (int xx = 0; xx < XX; xx++)
@@ -81,13 +100,19 @@ int main()
     for (int coo = 0; coo < COO; coo++)
     for (int cooo = 0; cooo < COOO; cooo++) {
         float golden = 0.0f;
+        size_t g = n % GROUPS;
         for (int ci = 0; ci < TOTAL_CI; ci++)
         for (int kx = 0; kx < KX; kx++)
         for (int ky = 0; ky < KY; ky++) {
-            size_t total_iy = (yyy + YYY*yy + YYY*YY*y + ky);
-            size_t total_ix = (xxx + XXX*xx + XXX*XX*x + kx);
+            size_t total_iy = STRIDE*(yyy + YYY*yy + YYY*YY*y) + DILATION*ky;
+            size_t total_ix = STRIDE*(xxx + XXX*xx + XXX*XX*x) + DILATION*kx;
             size_t total_co = (cooo + COOO*coo + COOO*COO*co);
-            golden += i(ci+TOTAL_CI*n, total_iy+TOTAL_IY*total_ix) * k(total_co+TOTAL_CO*kx, ci+TOTAL_CI*ky);
+#ifdef DEPTHWISE
+            size_t total_ci = total_co;
+#else
+            size_t total_ci = ci;
+#endif
+            golden += i(total_ci+GROUP_CI*n, total_iy+TOTAL_IY*total_ix) * k(total_co+TOTAL_CO*kx, ci+TOTAL_CI*(ky+KY*g));
         }
         assert(fabs(golden - o(cooo, yyy, xxx, coo, yy, xx, y, x, co, n)) < 0.005*fabs(golden));
     }
@@ -101,17 +126,27 @@ int main()
 #endif
     double compute_roof = 2 * DSPs() * FMax();
      // Total operations (GFLOP for CONV), independent of designs
-    double number_ops = 2 * (long)(N * TOTAL_CO * TOTAL_OY * TOTAL_OX) * (long)(TOTAL_CI * KX * KY);
-    double number_bytes = (long)(TOTAL_IY * TOTAL_IX * TOTAL_CI * N) * 4 + (long)(KY * KX * TOTAL_CI * TOTAL_CO) * 4
-                        + (long)(TOTAL_OY * TOTAL_OX * TOTAL_CO * N) * 4;
-    double exec_time = ExecTime("kernel_unloader");
+    double number_ops = 2 * (long)(GROUPS * N * TOTAL_CO * TOTAL_OY * TOTAL_OX) * (long)(TOTAL_CI * KX * KY);
+    double number_bytes = (long)(TOTAL_IY * TOTAL_IX * GROUP_CI * GROUPS * N) * 4 + (long)(KY * KX * TOTAL_CI * TOTAL_CO * GROUPS) * 4
+                        + (long)(TOTAL_OY * TOTAL_OX * TOTAL_CO * GROUPS * N) * 4;
+    // Benchmark the design with warm-up runs and multiple samples, and take the median time
+    DesignBenchmark benchmark;
+    benchmark.name = "conv";
+    benchmark.number_ops = number_ops;
+    benchmark.number_bytes = number_bytes;
+    benchmark.compute_roof = compute_roof;
+    benchmark.mem_bandwidth = mem_bandwidth;
+    benchmark.parameters = {{"N", N}, {"CI", TOTAL_CI}, {"CO", TOTAL_CO}, {"OY", TOTAL_OY}, {"OX", TOTAL_OX}, {"STRIDE", STRIDE}, {"DILATION", DILATION}, {"GROUPS", GROUPS}};
+    BenchmarkReport report = benchmark_and_report(benchmark, [&]() { return conv(i, k, o); });
+    assert(report.result == 0);
+    double exec_time = report.time.median;
     roofline(mem_bandwidth, compute_roof, number_ops, number_bytes, exec_time);
     if (fopen("roofline.png", "r") == NULL) {
         cout << "Failed to draw roofline!\n";
         return 1;
     }
-    cout << "Size of tensor I: " << N << ", " << TOTAL_CI << ", " << TOTAL_IX << ", " << TOTAL_IY << "\n";
-    cout << "Size of tensor K: " << TOTAL_CI << ", " << TOTAL_CO << ", " << KX << ", " << KY << "\n";
+    cout << "Size of tensor I: " << N << ", " << GROUP_CI * GROUPS << ", " << TOTAL_IX << ", " << TOTAL_IY << "\n";
+    cout << "Size of tensor K: " << TOTAL_CI << ", " << TOTAL_CO * GROUPS << ", " << KX << ", " << KY << "\n";
 #endif
 
     printf("Success\n");
@@ -29,31 +29,37 @@
 #include <iostream>
 
 #define N           4
-#define SIZE_I_0    TOTAL_CI * N
+// Every image has GROUPS groups of channels
+#define SIZE_I_0    GROUP_CI * GROUPS * N
 #define SIZE_I_1    TOTAL_IY * TOTAL_IX
 #define SIZE_K_0    TOTAL_CO * KX
-#define SIZE_K_1    TOTAL_CI * KY
-#define SIZE_O_0    TOTAL_CO * N
+#define SIZE_K_1    TOTAL_CI * KY * GROUPS
+#define SIZE_O_0    TOTAL_CO * GROUPS * N
 #define SIZE_O_1    TOTAL_OY * TOTAL_OX
 
 using namespace std;
 
 void check_correctness(float *i, float *k, float *o)
 {
-    for (int n = 0; n < N; n++)
+    for (int n = 0; n < GROUPS * N; n++)
     for (int x = 0; x < TOTAL_OX; x++)
     for (int y = 0; y < TOTAL_OY; y++)
     for (int co = 0; co < TOTAL_CO; co++) {
         float golden = 0.0f;
+        size_t g = n % GROUPS;
         for (int ci = 0; ci < TOTAL_CI; ci++)
         for (int kx = 0; kx < KX; kx++)
         for (int ky = 0; ky < KY; ky++) {
-            size_t iy = y + ky;
-            size_t ix = x + kx;
-            size_t i_0 = ci + TOTAL_CI * n;
+            size_t iy = STRIDE * y + DILATION * ky;
+            size_t ix = STRIDE * x + DILATION * kx;
+#ifdef DEPTHWISE
+            size_t i_0 = co + GROUP_CI * n;
+#else
+            size_t i_0 = ci + GROUP_CI * n;
+#endif
             size_t i_1 = iy + TOTAL_IY * ix;
             size_t k_0 = co + TOTAL_CO * kx;
-            size_t k_1 = ci + TOTAL_CI * ky;
+            size_t k_1 = ci + TOTAL_CI * (ky + KY * g);
             golden += i[i_0 + SIZE_I_0 * i_1] * k[k_0 + SIZE_K_0 * k_1];
         }
         size_t o_0 = co + TOTAL_CO * n;
@@ -118,7 +124,7 @@ int main(int argc, char *argv[]) {
         cm_result_check(device->CreateTask(task));
         cm_result_check(task->AddKernel(kernel));
         CmThreadGroupSpace *thread_group_space = nullptr;
-        cm_result_check(device->CreateThreadGroupSpaceEx(YY, XX, 1, X, CO, N, thread_group_space));
+        cm_result_check(device->CreateThreadGroupSpaceEx(YY, XX, 1, X, CO, GROUPS * N, thread_group_space));
 
         UINT64 tmp_kern_time;
         CmEvent *sync_event = nullptr;
@@ -139,15 +145,15 @@ int main(int argc, char *argv[]) {
         cm_result_check(device->DestroyTask(task));
     }
     double tkern = kernel_ns / ITER;
-    double ops = 2.0 * (long)(N * TOTAL_OX * TOTAL_OY * TOTAL_CO) * (long)(TOTAL_CI * KX * KY);
+    double ops = 2.0 * (long)(GROUPS * N * TOTAL_OX * TOTAL_OY * TOTAL_CO) * (long)(TOTAL_CI * KX * KY);
 
     cm_result_check(::DestroyCmDevice(device));
 
     if (ITER == 1) {
         printf("Pass!\n");
     } else {
-        cout << "Size of tensor I: " << N << ", " << TOTAL_CI << ", " << TOTAL_IX << ", " << TOTAL_IY << "\n";
-        cout << "Size of tensor K: " << TOTAL_CI << ", " << TOTAL_CO << ", " << KX << ", " << KY << "\n";
+        cout << "Size of tensor I: " << N << ", " << GROUP_CI * GROUPS << ", " << TOTAL_IX << ", " << TOTAL_IY << "\n";
+        cout << "Size of tensor K: " << TOTAL_CI << ", " << TOTAL_CO * GROUPS << ", " << KX << ", " << KY << "\n";
         printf("Average GFlops: %lf\n", ops / tkern);
         printf("Max GFlops: %lf\n", ops / min_tkern);
     }
@@ -18,88 +18,152 @@
 *******************************************************************************/
 #include "Halide.h"
 #include "util.h"
+#include "variants.h"
 
+using namespace Halide;
+
+// The design is a generator, whose GeneratorParams specialize it at compile time. The defaults are for A10.
+class CONV : public Generator<CONV> {
+public:
+    // Inner loop bounds, which are static constant parameters of the design
+    GeneratorParam<int> CII_{"CII", 16}, CI_{"CI", 16}, COOO_{"COOO", 8}, COO_{"COO", 16}, CO_{"CO", 2};
+    GeneratorParam<int> YYY_{"YYY", 10}, XXX_{"XXX", 16}, YY_{"YY", 2}, XX_{"XX", 2}, Y_{"Y", 3}, X_{"X", 2};
+    GeneratorParam<int> KY_{"KY", 3}, KX_{"KX", 3};
+    // Variants of the convolution. The input channels are divided into GROUPS groups, each convolved with its
+    // own filters into TOTAL_CO output channels. With DEPTHWISE, every channel is convolved separately, and a
+    // group is a block of TOTAL_CO channels that the PEs along cooo work on at the same time.
+    GeneratorParam<int> STRIDE_{"STRIDE", 1}, DILATION_{"DILATION", 1}, GROUPS_{"GROUPS", 1};
+    GeneratorParam<bool> depthwise{"DEPTHWISE", false};
+    // Type of the data to process in T2S
+    GeneratorParam<Type> TTYPE{"type", Float(32)};
+
+    void configure() {
+        i = add_input<Buffer<>>("I", TTYPE, 2);
+        k = add_input<Buffer<>>("K", TTYPE, 2);
+        // The results are in the order of the loops that drain them: O(cooo, yyy, xxx, coo, yy, xx, y, x, co, n)
+        o = add_output<Buffer<>>("O", TTYPE, 10);
+    }
+
+    void generate() {
+        // No reduction across input channels for a depthwise convolution
+        const int CII = depthwise ? 1 : (int)CII_, CI = depthwise ? 1 : (int)CI_;
+        const int COOO = COOO_, COO = COO_, CO = CO_, YYY = YYY_, XXX = XXX_, YY = YY_, XX = XX_, Y = Y_, X = X_;
+        const int KY = KY_, KX = KX_, stride = STRIDE_, dilation = DILATION_, groups = GROUPS_;
+        const int TOTAL_OY = YYY * YY * Y;
+        const int TOTAL_IY = stride * (TOTAL_OY - 1) + dilation * (KY - 1) + 1;
+        const int TOTAL_CO = COOO * COO * CO, TOTAL_CI = CII * CI;
+        // Input channels of a group
+        const int GROUP_CI = depthwise ? TOTAL_CO : TOTAL_CI;
+        const bool gpu = get_target().has_feature(Target::IntelGPU);
+
+        // Dependences
+        #define P               cii,       cooo,   yyy,   xxx, coo, yy, xx,  ky,      kx,      ci,   y, x, co, n
+        #define P_cii_minus_1   cii-1,     cooo,   yyy,   xxx, coo, yy, xx,  ky,      kx,      ci,   y, x, co, n
+        #define P_ky_minus_1    cii+CII-1, cooo,   yyy,   xxx, coo, yy, xx,  ky-1,    kx,      ci,   y, x, co, n
+        #define P_kx_minus_1    cii+CII-1, cooo,   yyy,   xxx, coo, yy, xx,  ky+KY-1, kx-1,    ci,   y, x, co, n
+        #define P_ci_minus_1    cii+CII-1, cooo,   yyy,   xxx, coo, yy, xx,  ky+KY-1, kx+KX-1, ci-1, y, x, co, n
+        #define P_cooo_minus_1  cii,       cooo-1, yyy,   xxx, coo, yy, xx,  ky,      kx,      ci,   y, x, co, n
+        #define P_yyy_minus_1   cii,       cooo,   yyy-1, xxx, coo, yy, xx,  ky,      kx,      ci,   y, x, co, n
+        #define P_Out                      cooo,   yyy,   xxx, coo, yy, xx,                          y, x, co, n
+        // Linearized addresses
+        #define total_oy        (yyy + YYY*yy + YYY*YY*y)
+        #define total_ox        (xxx + XXX*xx + XXX*XX*x)
+        #define total_iy        (stride*total_oy + dilation*ky)
+        #define total_ix        (stride*total_ox + dilation*kx)
+        #define total_ci        (cii + CII*ci)
+        #define total_co        (cooo + COOO*coo + COOO*COO*co)
+
+        // Inputs. Loop n goes over every group of every image, and the group is n % GROUPS.
+        ImageParam I = *i, K = *k;
+        #define P_I     (depthwise ? total_co : total_ci) + (GROUP_CI) * n,  total_iy + (TOTAL_IY) * total_ix
+        #define P_K     total_co + (TOTAL_CO) * kx, total_ci + (TOTAL_CI) * (ky + KY * (n % groups))
+        #define P_O     total_co + (TOTAL_CO) * n,  total_oy + (TOTAL_OY) * total_ox
+        #define UN      (I.dim(0).extent() / GROUP_CI)
+
+        // UREs
+        Var cii("cii"), ci("ci"), cooo("cooo"), coo("coo"), co("co"), ky("ky"), kx("kx"), yyy("yyy"), xxx("xxx"), yy("yy"), xx("xx"), y("y"), x("x"), n("n");
+        URE A("A", TTYPE, {P}), B("B", TTYPE, {P}), C("C", TTYPE, {P}), Out("Out");
+        if (depthwise) {
+            // Every output channel reads its own input channel, so the input is not shared by the PEs along cooo
+            A(P) = I(P_I);
+        } else {
+            A(P) = select(cooo == 0, I(P_I), A(P_cooo_minus_1));
+        }
+        B(P) = select(yyy == 0, K(P_K), B(P_yyy_minus_1));
+        C(P) = select(cii == 0 && ky == 0 && kx == 0 && ci == 0, 0,
+                    select(cii == 0, select(ky == 0, select(kx == 0, C(P_ci_minus_1), C(P_kx_minus_1)), C(P_ky_minus_1)), C(P_cii_minus_1)))
+                    + A(P) * B(P);
+        Out(P_Out) = select(cii == CII-1 && ky == KY-1 && kx == KX-1 && ci == CI-1, C(P));
+
+        // Put all the UREs inside the same loop nest of X.
+        A.merge_ures(B, C, Out);
+
+        // Explicitly set the loop bounds
+        A.set_bounds(cooo,  0, COOO, coo,  0, COO, co, 0, CO)
+         .set_bounds(ky,    0, KY,   kx,   0, KX)
+         .set_bounds(cii,   0, CII,  ci,   0, CI)
+         .set_bounds(yyy,   0, YYY,  xxx,  0, XXX)
+         .set_bounds(yy,    0, YY,   xx,   0, XX)
+         .set_bounds(y,     0, Y,    x,    0, X)
+         .set_bounds(n,     0, UN);
+
+        // Create a systolic array
+        A.space_time_transform(cooo, yyy);
+
+        // GPU can have many threads running in parallel.
+        if (gpu) {
+            A.gpu_blocks(x, co, n).gpu_threads(yy, xx);
+        }
+
+        // I/O network
+        Stensor DI("iLoader", DRAM), SI("iFeeder", SRAM), DK("kLoader", DRAM), SK("kFeeder", SRAM);
+        Stensor RO("collector", REG), DO("unloader", DRAM), O("deserializer");
+        if (depthwise) {
+            I >> DI.out(cooo)                >> FIFO(256)
+              >> SI.scope(kx).out(cooo, yyy) >> FIFO(256);
+        } else {
+            I >> DI.out(cii)                 >> FIFO(256)
+              >> SI.scope(kx).out(cii, yyy)  >> FIFO(256);
+        }
+        K >> DK.out(cii)                 >> FIFO(256)
+          >> SK.scope(kx).out(cii, cooo) >> FIFO(256);
+        Out >> RO.scope(yyy).out(cooo)   >> FIFO(256)
+            >> DO >> O(P_O);
+
+        // The kernel on the device, invoked by the host through the C interface
+        *o = O.realize_wrapper(get_target());
+    }
+
+private:
+    Input<Buffer<>> *i, *k;
+    Output<Buffer<>> *o;
+};
+
+HALIDE_REGISTER_GENERATOR(CONV, conv)
+
+#ifndef T2S_GEN_VARIANTS
 // Constant parameters (inner loop bounds) of the design
 #include "const-parameters.h"
 
-using namespace Halide;
-
 int main(void)
 {
-    // Dependences
-    #define P               cii,       cooo,   yyy,   xxx, coo, yy, xx,  ky,      kx,      ci,   y, x, co, n
-    #define P_cii_minus_1   cii-1,     cooo,   yyy,   xxx, coo, yy, xx,  ky,      kx,      ci,   y, x, co, n
-    #define P_ky_minus_1    cii+CII-1, cooo,   yyy,   xxx, coo, yy, xx,  ky-1,    kx,      ci,   y, x, co, n
-    #define P_kx_minus_1    cii+CII-1, cooo,   yyy,   xxx, coo, yy, xx,  ky+KY-1, kx-1,    ci,   y, x, co, n
-    #define P_ci_minus_1    cii+CII-1, cooo,   yyy,   xxx, coo, yy, xx,  ky+KY-1, kx+KX-1, ci-1, y, x, co, n
-    #define P_cooo_minus_1  cii,       cooo-1, yyy,   xxx, coo, yy, xx,  ky,      kx,      ci,   y, x, co, n
-    #define P_yyy_minus_1   cii,       cooo,   yyy-1, xxx, coo, yy, xx,  ky,      kx,      ci,   y, x, co, n
-    #define P_Out                      cooo,   yyy,   xxx, coo, yy, xx,                          y, x, co, n
-    // Linearized addresso
-    #define total_iy        (yyy + YYY*yy + YYY*YY*y + ky)
-    #define total_ix        (xxx + XXX*xx + XXX*XX*x + kx)
-    #define total_oy        (yyy + YYY*yy + YYY*YY*y)
-    #define total_ox        (xxx + XXX*xx + XXX*XX*x)
-    #define total_ci        (cii + CII*ci)
-    #define total_co        (cooo + COOO*coo + COOO*COO*co)
-
-    // Type of the data to process in C and T2S
-    #define CTYPE float
-    #define TTYPE Float(32)
-
-    // Inputs
-    ImageParam I("I", TTYPE, 2), K("K", TTYPE, 2);
-    #define P_I     total_ci + (TOTAL_CI) * n,  total_iy + (TOTAL_IY) * total_ix
-    #define P_K     total_co + (TOTAL_CO) * kx, total_ci + (TOTAL_CI) * ky
-    #define P_O     total_co + (TOTAL_CO) * n,  total_oy + (TOTAL_OY) * total_ox
-    #define UN      (I.dim(0).extent() / TOTAL_CI)
-
-    // UREs
-    Var cii("cii"), ci("ci"), cooo("cooo"), coo("coo"), co("co"), ky("ky"), kx("kx"), yyy("yyy"), xxx("xxx"), yy("yy"), xx("xx"), y("y"), x("x"), n("n");
-    URE A("A", TTYPE, {P}), B("B", TTYPE, {P}), C("C", TTYPE, {P}), Out("Out");
-    A(P) = select(cooo == 0, I(P_I), A(P_cooo_minus_1));
-    B(P) = select(yyy == 0, K(P_K), B(P_yyy_minus_1));
-    C(P) = select(cii == 0 && ky == 0 && kx == 0 && ci == 0, 0,
-                select(cii == 0, select(ky == 0, select(kx == 0, C(P_ci_minus_1), C(P_kx_minus_1)), C(P_ky_minus_1)), C(P_cii_minus_1)))
-                + A(P) * B(P);
-    Out(P_Out) = select(cii == CII-1 && ky == KY-1 && kx == KX-1 && ci == CI-1, C(P));
-
-    // Put all the UREs inside the same loop nest of X.
-    A.merge_ures(B, C, Out);
-
-    // Explicitly set the loop bounds
-    A.set_bounds(cooo,  0, COOO, coo,  0, COO, co, 0, CO)
-     .set_bounds(ky,    0, KY,   kx,   0, KX)
-     .set_bounds(cii,   0, CII,  ci,   0, CI)
-     .set_bounds(yyy,   0, YYY,  xxx,  0, XXX)
-     .set_bounds(yy,    0, YY,   xx,   0, XX)
-     .set_bounds(y,     0, Y,    x,    0, X)
-     .set_bounds(n,     0, UN);
-
-    // Create a systolic array
-    A.space_time_transform(cooo, yyy);
-
-    // GPU can have many threads running in parallel.
-#ifdef GPU
-    A.gpu_blocks(x, co, n).gpu_threads(yy, xx);
+    // The variant of the design as specified by the macros. Compile the kernel to an FPGA bitstream, and
+    // expose a C interface for the host to invoke
+    DesignVariant v{"conv", {{"CII", std::to_string(CII)}, {"CI", std::to_string(CI)}, {"COOO", std::to_string(COOO)},
+                             {"COO", std::to_string(COO)}, {"CO", std::to_string(CO)}, {"YYY", std::to_string(YYY)},
+                             {"XXX", std::to_string(XXX)}, {"YY", std::to_string(YY)}, {"XX", std::to_string(XX)},
+                             {"Y", std::to_string(Y)}, {"X", std::to_string(X)}, {"KY", std::to_string(KY)},
+                             {"KX", std::to_string(KX)}, {"STRIDE", std::to_string(STRIDE)},
+                             {"DILATION", std::to_string(DILATION)}, {"GROUPS", std::to_string(GROUPS)}}};
+#ifdef DEPTHWISE
+    v.params["DEPTHWISE"] = "true";
 #endif
-
-    // I/O network
-    Stensor DI("iLoader", DRAM), SI("iFeeder", SRAM), DK("kLoader", DRAM), SK("kFeeder", SRAM);
-    Stensor RO("collector", REG), DO("unloader", DRAM), O("deserializer");
-    I >> DI.out(cii)                 >> FIFO(256)
-      >> SI.scope(kx).out(cii, yyy)  >> FIFO(256);
-    K >> DK.out(cii)                 >> FIFO(256)
-      >> SK.scope(kx).out(cii, cooo) >> FIFO(256);
-    Out >> RO.scope(yyy).out(cooo)   >> FIFO(256)
-        >> DO >> O(P_O);
-
-    // Compile the kernel to an FPGA bitstream, and expose a C interface for the host to invoke
 #ifdef GPU
-    O.compile_to_host("conv-interface", { I, K }, "conv", IntelGPU);
+    compile_design_variant("conv", v, get_host_target().with_feature(Target::IntelGPU));
 #else
-    O.compile_to_host("conv-interface", { I, K }, "conv", IntelFPGA);
+    compile_design_variant("conv", v, get_host_target().with_feature(Target::IntelFPGA).with_feature(Target::EnableSynthesis));
 #endif
     printf("Success\n");
     return 0;
 }
+#endif
@@ -38,6 +38,8 @@ elif [ "$target" == "a10" ]; then
     # FPGA: Verify correctness with tiny problem sizes and emulator
     ./devcloud-job.sh gemm $target tiny emulator
     ./devcloud-job.sh conv $target tiny emulator
+    env DESIGN_OPTIONS="-DSTRIDE=2 -DDILATION=2 -DGROUPS=2" ./devcloud-job.sh conv $target tiny emulator
+    env DESIGN_OPTIONS="-DDEPTHWISE" ./devcloud-job.sh conv $target tiny emulator
     ./devcloud-job.sh capsule $target tiny emulator
     
     # FPGA: Test perf with large matrices
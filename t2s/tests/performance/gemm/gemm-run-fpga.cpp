@@ -22,6 +22,11 @@
 // Constant parameters (inner loop bounds) of the design
 #include "const-parameters.h"
 
+#ifdef STREAMING
+// For matrices larger than the device memory
+#include "StreamingExecution.h"
+#endif
+
 // Outer loop bounds for testing
 #ifdef TINY // For verifying correctness only
     #define K           4
@@ -36,6 +41,9 @@
 // Roofline utilities
 #include "Roofline.h"
 
+// Benchmark harness
+#include "Benchmark.h"
+
 // The only header file needed for including T2S.
 #include "HalideBuffer.h"
 
@@ -67,7 +75,15 @@ int main()
     }
 
     Halide::Runtime::Buffer<float> c(JJJ, III, JJ, II, J, I);
+#ifdef STREAMING
+    // Invoke the design on chunks of the matrices, each fitting into the device buffers
+    int result = stream_gemm<float>([](Halide::Runtime::Buffer<float> &a, Halide::Runtime::Buffer<float> &b,
+                                       Halide::Runtime::Buffer<float> &c) { return gemm(a, b, c); },
+                                    a, b, c, KKK * KK);
+    assert(result == 0);
+#else
     gemm(a, b, c);
+#endif
 
 #ifdef TINY
     // Validate the results
@@ -97,7 +113,22 @@ int main()
     double number_bytes = (double)(KKK * III) * (double)(KK * II) * (double)(K * J * I) * 4 +
                           (double)(KKK * JJJ) * (double)(KK * JJ) * (double)(K * J * I) * 4 +
                           (double)(III * II * I) * (double)(JJJ * JJ * J) * 4;
+#ifndef STREAMING
+    // Benchmark the design with warm-up runs and multiple samples, and take the median time
+    DesignBenchmark benchmark;
+    benchmark.name = "gemm";
+    benchmark.number_ops = number_ops;
+    benchmark.number_bytes = number_bytes;
+    benchmark.compute_roof = compute_roof;
+    benchmark.mem_bandwidth = mem_bandwidth;
+    benchmark.parameters = {{"I", TOTAL_I}, {"J", TOTAL_J}, {"K", TOTAL_K}};
+    BenchmarkReport report = benchmark_and_report(benchmark, [&]() { return gemm(a, b, c); });
+    assert(report.result == 0);
+    double exec_time = report.time.median;
+#else
+    // Every chunk is a separate run of the design, and the profile of the device covers only the last one
     double exec_time = ExecTime("kernel_unloader");
+#endif
     roofline(mem_bandwidth, compute_roof, number_ops, number_bytes, exec_time);
     if (fopen("roofline.png", "r") == NULL) {
         cout << "Failed to draw roofline!\n";
@@ -18,82 +18,115 @@
 *******************************************************************************/
 #include "Halide.h"
 #include "util.h"
+#include "variants.h"
 
+using namespace Halide;
+
+// The design is a generator, whose GeneratorParams specialize it at compile time. The defaults are for A10.
+class GEMM : public Generator<GEMM> {
+public:
+    // Inner loop bounds, which are static constant parameters of the design
+    GeneratorParam<int> KKK_{"KKK", 16}, JJJ_{"JJJ", 8}, III_{"III", 10};
+    GeneratorParam<int> KK_{"KK", 32}, JJ_{"JJ", 32}, II_{"II", 32};
+    // Type of the data to process in T2S
+    GeneratorParam<Type> TTYPE{"type", Float(32)};
+
+    void configure() {
+        a = add_input<Buffer<>>("A", TTYPE, 2);
+        b = add_input<Buffer<>>("B", TTYPE, 2);
+        // The results are in the order of the loops that drain them: C(jjj, iii, jj, ii, j, i)
+        c = add_output<Buffer<>>("C", TTYPE, 6);
+    }
+
+    void generate() {
+        const int KKK = KKK_, JJJ = JJJ_, III = III_, KK = KK_, JJ = JJ_, II = II_;
+        const bool gpu = get_target().has_feature(Target::IntelGPU);
+
+        // Dependences
+        #define P               kkk,      jjj,  iii,  jj, ii, kk,     k,  j,i
+        #define P_kkk_minus_1   kkk-1,    jjj,  iii,  jj, ii, kk,     k,  j,i
+        #define P_kk_minus_1    kkk+KKK-1,jjj,  iii,  jj, ii, kk-1,   k,  j,i
+        #define P_k_minus_1     kkk+KKK-1,jjj,  iii,  jj, ii, kk+KK-1,k-1,j,i
+        #define P_jjj_minus_1   kkk,      jjj-1,iii,  jj, ii, kk,     k,  j,i
+        #define P_iii_minus_1   kkk,      jjj,  iii-1,jj, ii, kk,     k,  j,i
+        #define P_Out                     jjj,  iii,  jj, ii,             j,i
+
+        // Linearized addresses
+        #define total_i         (iii + III * ii + III * II * i)
+        #define total_j         (jjj + JJJ * jj + JJJ * JJ * j)
+        #define total_k         (kkk + KKK * kk + KKK * KK * k)
+
+        // Outer loop bounds, which are determined by input sizes
+        #define I (A.dim(1).extent() / (III * II))
+        #define J (B.dim(0).extent() / (JJJ * JJ))
+        #define K (A.dim(0).extent() / (KKK * KK))
+
+        // Inputs
+        ImageParam A = *a, B = *b;
+
+        // UREs
+        Var kkk("kkk"), jjj("jjj"), iii("iii"), jj("jj"), ii("ii"), kk("kk"), k("k"), j("j"), i("i");
+        URE X("X", TTYPE, {P}), Y("Y", TTYPE, {P}), Z("Z", TTYPE, {P}), Out("Out");
+        X(P) = select(jjj == 0, A(total_k, total_i), X(P_jjj_minus_1));
+        Y(P) = select(iii == 0, B(total_j, total_k), Y(P_iii_minus_1));
+        Z(P) = select(kkk == 0 && kk == 0 && k == 0, 0,
+                    select(kkk == 0, select(kk == 0, Z(P_k_minus_1), Z(P_kk_minus_1)), Z(P_kkk_minus_1)))
+                    + X(P) * Y(P);
+        Out(P_Out) = select(kkk == KKK-1 && kk == KK-1 && k == K-1, Z(P));
+
+        // Put all the UREs inside the same loop nest of X.
+        X.merge_ures(Y, Z, Out);
+
+        // Explicitly set the loop bounds
+        X.set_bounds(jjj, 0, JJJ, iii, 0, III, kkk, 0, KKK)
+         .set_bounds(jj,  0, JJ,  ii,  0, II,  kk,  0, KK)
+         .set_bounds(j,   0, J,   i,   0, I,   k,   0, K);
+
+        // Create a systolic array
+        X.space_time_transform(jjj, iii);
+
+        // GPU can have many threads running in parallel.
+        if (gpu) {
+            X.gpu_blocks(j, i).gpu_threads(jj, ii);
+        }
+
+        // I/O network
+        Stensor DA("aLoader", DRAM), SA("aFeeder", SRAM), DB("bLoader", DRAM), SB("bFeeder", SRAM);
+        Stensor RC("collector", REG), DC("unloader", DRAM), C("deserializer");
+        A >> DA.out(kkk)                >> FIFO(256)
+          >> SA.scope(k).out(kkk, iii)  >> FIFO(256);
+        B >> DB.out(kkk)                >> FIFO(256)
+          >> SB.scope(k).out(kkk, jjj)  >> FIFO(256);
+        Out >> RC.scope(iii).out(jjj)   >> FIFO(256)
+            >> DC >> C(total_j, total_i);
+
+        // The kernel on the device, invoked by the host through the C interface
+        *c = C.realize_wrapper(get_target());
+    }
+
+private:
+    Input<Buffer<>> *a, *b;
+    Output<Buffer<>> *c;
+};
+
+HALIDE_REGISTER_GENERATOR(GEMM, gemm)
+
+#ifndef T2S_GEN_VARIANTS
 // Constant parameters (inner loop bounds) of the design
 #include "const-parameters.h"
 
-using namespace Halide;
-
 int main()
 {
-    // Dependences
-    #define P               kkk,      jjj,  iii,  jj, ii, kk,     k,  j,i
-    #define P_kkk_minus_1   kkk-1,    jjj,  iii,  jj, ii, kk,     k,  j,i
-    #define P_kk_minus_1    kkk+KKK-1,jjj,  iii,  jj, ii, kk-1,   k,  j,i
-    #define P_k_minus_1     kkk+KKK-1,jjj,  iii,  jj, ii, kk+KK-1,k-1,j,i
-    #define P_jjj_minus_1   kkk,      jjj-1,iii,  jj, ii, kk,     k,  j,i
-    #define P_iii_minus_1   kkk,      jjj,  iii-1,jj, ii, kk,     k,  j,i
-    #define P_Out                     jjj,  iii,  jj, ii,             j,i
-
-    // Linearized addresses
-    #define total_i         (iii + III * ii + III * II * i)
-    #define total_j         (jjj + JJJ * jj + JJJ * JJ * j)
-    #define total_k         (kkk + KKK * kk + KKK * KK * k)
-
-    // Outer loop bounds, which are determined by input sizes
-    #define I (A.dim(1).extent() / (III * II))
-    #define J (B.dim(0).extent() / (JJJ * JJ))
-    #define K (A.dim(0).extent() / (KKK * KK))
-
-    // Type of the data to process in C and T2S
-    #define CTYPE float
-    #define TTYPE Float(32)
-
-    // Inputs
-    ImageParam A("A", TTYPE, 2), B("B", TTYPE, 2);
-
-    // UREs
-    Var kkk("kkk"), jjj("jjj"), iii("iii"), jj("jj"), ii("ii"), kk("kk"), k("k"), j("j"), i("i");
-    URE X("X", TTYPE, {P}), Y("Y", TTYPE, {P}), Z("Z", TTYPE, {P}), Out("Out");
-    X(P) = select(jjj == 0, A(total_k, total_i), X(P_jjj_minus_1));
-    Y(P) = select(iii == 0, B(total_j, total_k), Y(P_iii_minus_1));
-    Z(P) = select(kkk == 0 && kk == 0 && k == 0, 0,
-                select(kkk == 0, select(kk == 0, Z(P_k_minus_1), Z(P_kk_minus_1)), Z(P_kkk_minus_1)))
-                + X(P) * Y(P);
-    Out(P_Out) = select(kkk == KKK-1 && kk == KK-1 && k == K-1, Z(P));
-
-    // Put all the UREs inside the same loop nest of X.
-    X.merge_ures(Y, Z, Out);
-
-    // Explicitly set the loop bounds
-    X.set_bounds(jjj, 0, JJJ, iii, 0, III, kkk, 0, KKK)
-     .set_bounds(jj,  0, JJ,  ii,  0, II,  kk,  0, KK)
-     .set_bounds(j,   0, J,   i,   0, I,   k,   0, K);
-
-    // Create a systolic array
-    X.space_time_transform(jjj, iii);
-
-    // GPU can have many threads running in parallel.
-#ifdef GPU
-    X.gpu_blocks(j, i).gpu_threads(jj, ii);
-#endif
-
-    // I/O network
-    Stensor DA("aLoader", DRAM), SA("aFeeder", SRAM), DB("bLoader", DRAM), SB("bFeeder", SRAM);
-    Stensor RC("collector", REG), DC("unloader", DRAM), C("deserializer");
-    A >> DA.out(kkk)                >> FIFO(256)
-      >> SA.scope(k).out(kkk, iii)  >> FIFO(256);
-    B >> DB.out(kkk)                >> FIFO(256)
-      >> SB.scope(k).out(kkk, jjj)  >> FIFO(256);
-    Out >> RC.scope(iii).out(jjj)   >> FIFO(256)
-        >> DC >> C(total_j, total_i);
-
-    // Compile the kernel to an FPGA bitstream, and expose a C interface for the host to invoke
+    // The variant of the design as specified by the macros. Compile the kernel to an FPGA bitstream, and
+    // expose a C interface for the host to invoke
+    DesignVariant v{"gemm", {{"KKK", std::to_string(KKK)}, {"JJJ", std::to_string(JJJ)}, {"III", std::to_string(III)},
+                             {"KK", std::to_string(KK)}, {"JJ", std::to_string(JJ)}, {"II", std::to_string(II)}}};
 #ifdef GPU
-    C.compile_to_host("gemm-interface", { A, B }, "gemm", IntelGPU);
+    compile_design_variant("gemm", v, get_host_target().with_feature(Target::IntelGPU));
 #else
-    C.compile_to_host("gemm-interface", { A, B }, "gemm", IntelFPGA);
+    compile_design_variant("gemm", v, get_host_target().with_feature(Target::IntelFPGA).with_feature(Target::EnableSynthesis));
 #endif
     printf("Success\n");
     return 0;
 }
+#endif
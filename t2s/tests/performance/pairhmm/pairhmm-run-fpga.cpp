@@ -19,6 +19,9 @@
 // Roofline Utilities
 #include "Roofline.h"
 
+// Benchmark harness
+#include "Benchmark.h"
+
 // The only header file needed for including T2S.
 #include "HalideBuffer.h"
 
@@ -153,8 +156,18 @@ int main()
         assert(abs(golden - result(hh, rr, h, r)) < 1e-6);
     }
 #else
-    double exec_time = ExecTime();
+    // Cell updates of the dynamic programming
     double number_ops = (double)NUM_READS * READ_LEN * NUM_HAPS * HAP_LEN;
+    // Benchmark the design with warm-up runs and multiple samples, and take the median time
+    DesignBenchmark benchmark;
+    benchmark.name = "pairhmm";
+    benchmark.number_ops = number_ops;
+    benchmark.number_bytes = 0;
+    benchmark.kernel = NULL;
+    benchmark.parameters = {{"NUM_READS", NUM_READS}, {"READ_LEN", READ_LEN}, {"NUM_HAPS", NUM_HAPS}, {"HAP_LEN", HAP_LEN}};
+    BenchmarkReport report = benchmark_and_report(benchmark, [&]() { return pairhmm(H, R, delta, zeta, eta, alpha_match, alpha_gap, beta_match, beta_gap, result); });
+    assert(report.result == 0);
+    double exec_time = report.time.median;
     cout << "Length of read strings: " << NUM_READS << "*" << READ_LEN << "\n";
     cout << "Length of hap strings: " << NUM_HAPS << "*" << HAP_LEN << "\n";
     cout << "GCups: " << number_ops / exec_time << "\n";
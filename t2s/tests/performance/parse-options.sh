@@ -1,7 +1,8 @@
 #!/bin/bash
 
 function show_usage {
-    echo "Options: (devcloud|local) (gemm|conv|capsule|pairhmm|qrd) (a10|s10|gen9|gen12) (tiny|large) (hw|emulator) [bitstream]"
+    echo "Options: (devcloud|local) (gemm|conv|capsule|pairhmm|qrd|winograd|stencil) (a10|s10|gen9|gen12) (tiny|large) (hw|emulator) [bitstream]"
+    echo "Macros in the environment variable DESIGN_OPTIONS, e.g. DESIGN_OPTIONS=\"-DSTRIDE=2\", select a variant of the design"
 }
 
 if [ $0 == $BASH_SOURCE ]; then
@@ -18,7 +19,7 @@ else
     location="$1"
 fi
 
-if [ "$2" != "gemm" -a "$2" != "conv"  -a  "$2" != "capsule" -a "$2" != "pairhmm" -a "$2" != "qrd"]; then
+if [ "$2" != "gemm" -a "$2" != "conv"  -a  "$2" != "capsule" -a "$2" != "pairhmm" -a "$2" != "qrd" -a "$2" != "winograd" -a "$2" != "stencil" ]; then
     show_usage
     return
 else
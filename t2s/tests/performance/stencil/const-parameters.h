@@ -0,0 +1,63 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef STENCIL_CONST_PARAMS_H
+#define STENCIL_CONST_PARAMS_H
+
+// A Jacobi stencil of radius 1: 5 points in 2-D, or 7 points in 3-D with -DDIM3.
+// TSTEPS time steps are fused into a linear array of TSTEPS PEs. The grid is tiled along x (and y in 3-D)
+// into tiles of BX (x BY) points, each read with a halo of TSTEPS points on every side.
+#ifdef DIM3
+    #define TAPS        7
+#else
+    #define TAPS        5
+#endif
+#define HALO            TSTEPS
+
+// Inner loop bounds, which are static constant parameters of the design
+#ifdef TINY // For verifying correctness only
+    #define TSTEPS      2
+    #define BX          4
+    #define BY          4
+#elif S10
+    #ifdef DIM3
+        #define TSTEPS  32
+        #define BX      64
+        #define BY      64
+    #else
+        #define TSTEPS  128
+        #define BX      1024
+        #define BY      1
+    #endif
+#else   // For A10
+    #ifdef DIM3
+        #define TSTEPS  16
+        #define BX      32
+        #define BY      32
+    #else
+        #define TSTEPS  64
+        #define BX      512
+        #define BY      1
+    #endif
+#endif
+
+// Extents of the tile-local loops, including the halos
+#define XX              (BX + 2 * HALO)
+#define YY              (BY + 2 * HALO)
+
+#endif
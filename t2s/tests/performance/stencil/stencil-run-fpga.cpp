@@ -0,0 +1,223 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// The header file generated by stencil.cpp
+#include "stencil-interface.h"
+
+// Constant parameters (inner loop bounds) of the design
+#include "const-parameters.h"
+
+// Roofline utilities
+#include "Roofline.h"
+
+// Benchmark harness
+#include "Benchmark.h"
+
+// The only header file needed for including T2S.
+#include "HalideBuffer.h"
+
+// For printing output
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+// For validation of results.
+#include <assert.h>
+
+// Outer loop bounds for testing
+#ifdef TINY // For verifying correctness only
+    #ifdef DIM3
+        #define W       (2 * BX)
+        #define H       (2 * BY)
+        #define D       5
+    #else
+        #define W       (3 * BX)
+        #define H       7
+        #define D       1
+    #endif
+    #define PASSES      2
+#else
+    #ifdef DIM3
+        #define W       256
+        #define H       256
+        #define D       256
+    #else
+        #define W       8192
+        #define H       8192
+        #define D       1
+    #endif
+    #define PASSES      1
+#endif
+
+#define XB              (W / BX)
+#ifdef DIM3
+    #define YB          (H / BY)
+#endif
+
+using namespace std;
+
+// Point (x, y, z) of a grid
+#define G(g, x, y, z)   g[((size_t)(z) * H + (y)) * W + (x)]
+
+// The design takes the grid padded by HALO points on every side, and returns the results of every tile.
+#ifdef DIM3
+typedef Halide::Runtime::Buffer<float> Padded;
+Padded pad(const vector<float> &g) {
+    Padded in(W + 2 * HALO, H + 2 * HALO, D + 2 * HALO);
+    in.fill(0);
+    for (int z = 0; z < D; z++)
+    for (int y = 0; y < H; y++)
+    for (int x = 0; x < W; x++) {
+        in(x + HALO, y + HALO, z + HALO) = G(g, x, y, z);
+    }
+    return in;
+}
+Halide::Runtime::Buffer<float> result_buffer() {
+    return Halide::Runtime::Buffer<float>(XX, YY, D + 2 * HALO, XB, YB);
+}
+void unpack(const Halide::Runtime::Buffer<float> &out, vector<float> &g) {
+    for (int z = 0; z < D; z++)
+    for (int y = 0; y < H; y++)
+    for (int x = 0; x < W; x++) {
+        G(g, x, y, z) = out(x % BX + 2 * HALO, y % BY + 2 * HALO, z + 2 * HALO, x / BX, y / BY);
+    }
+}
+#else
+typedef Halide::Runtime::Buffer<float> Padded;
+Padded pad(const vector<float> &g) {
+    Padded in(W + 2 * HALO, H + 2 * HALO);
+    in.fill(0);
+    for (int y = 0; y < H; y++)
+    for (int x = 0; x < W; x++) {
+        in(x + HALO, y + HALO) = G(g, x, y, 0);
+    }
+    return in;
+}
+Halide::Runtime::Buffer<float> result_buffer() {
+    return Halide::Runtime::Buffer<float>(XX, H + 2 * HALO, XB);
+}
+void unpack(const Halide::Runtime::Buffer<float> &out, vector<float> &g) {
+    for (int y = 0; y < H; y++)
+    for (int x = 0; x < W; x++) {
+        G(g, x, y, 0) = out(x % BX + 2 * HALO, y + 2 * HALO, x / BX);
+    }
+}
+#endif
+
+// One step of the Jacobi stencil on the CPU
+void jacobi_step(const vector<float> &a, vector<float> &b) {
+    for (int z = 0; z < D; z++)
+    for (int y = 0; y < H; y++)
+    for (int x = 0; x < W; x++) {
+        bool interior = x >= 1 && x <= W - 2 && y >= 1 && y <= H - 2;
+#ifdef DIM3
+        interior = interior && z >= 1 && z <= D - 2;
+#endif
+        if (!interior) {
+            G(b, x, y, z) = G(a, x, y, z);
+            continue;
+        }
+        float sum = G(a, x - 1, y, z) + G(a, x, y - 1, z) + G(a, x, y, z) + G(a, x + 1, y, z) + G(a, x, y + 1, z);
+#ifdef DIM3
+        sum += G(a, x, y, z - 1) + G(a, x, y, z + 1);
+#endif
+        G(b, x, y, z) = sum / TAPS;
+    }
+}
+
+int main()
+{
+    assert(W % BX == 0);
+#ifdef DIM3
+    assert(H % BY == 0);
+#endif
+    vector<float> grid((size_t)W * H * D);
+    for (auto &v : grid) {
+        v = random() / (float)RAND_MAX;
+    }
+
+    // More steps than TSTEPS take several passes of the design over the grid
+    vector<float> result(grid);
+    Halide::Runtime::Buffer<float> out = result_buffer();
+    for (int p = 0; p < PASSES; p++) {
+        Padded in = pad(result);
+        int error = stencil(in, out);
+        assert(error == 0);
+        unpack(out, result);
+    }
+
+#ifdef TINY
+    // Validate the results against the steps on the CPU
+    vector<float> golden(grid), next(grid);
+    for (int t = 0; t < PASSES * TSTEPS; t++) {
+        jacobi_step(golden, next);
+        golden.swap(next);
+    }
+    for (size_t i = 0; i < grid.size(); i++) {
+        assert(fabs(golden[i] - result[i]) <= 0.0001);
+    }
+#else
+    // Report performance. DSPs, FMax and ExecTime are automatically figured out from the static analysis
+    // during FPGA synthesis and and the dynamic profile during the FGPA execution.
+#ifdef S10
+    double mem_bandwidth = 75;
+#else
+    double mem_bandwidth = 33;
+#endif
+    double compute_roof = 2 * DSPs() * FMax();
+    // Every step of an interior point is TAPS multiplications and TAPS - 1 additions
+    double interior = (double)(W - 2) * (H - 2) * (D == 1 ? 1 : D - 2);
+    double number_ops = (2 * TAPS - 1) * interior * TSTEPS;
+    // The tiles read their halos again, and only the results of the tiles are written
+#ifdef DIM3
+    double number_bytes = ((double)XB * YB * XX * YY * (D + 2 * HALO) + (double)W * H * D) * 4;
+#else
+    double number_bytes = ((double)XB * XX * (H + 2 * HALO) + (double)W * H) * 4;
+#endif
+    Padded in = pad(grid);
+    DesignBenchmark benchmark;
+    benchmark.name = "stencil";
+    benchmark.number_ops = number_ops;
+    benchmark.number_bytes = number_bytes;
+    benchmark.compute_roof = compute_roof;
+    benchmark.mem_bandwidth = mem_bandwidth;
+    benchmark.parameters = {{"TSTEPS", TSTEPS}, {"TAPS", TAPS}, {"W", W}, {"H", H}, {"D", D}, {"BX", BX}, {"BY", BY}};
+    BenchmarkReport report = benchmark_and_report(benchmark, [&]() { return stencil(in, out); });
+    assert(report.result == 0);
+    double exec_time = report.time.median;
+    roofline(mem_bandwidth, compute_roof, number_ops, number_bytes, exec_time);
+    if (fopen("roofline.png", "r") == NULL) {
+        cout << "Failed to draw roofline!\n";
+        return 1;
+    }
+    // Compare with a design of one step per pass, which reads and writes every point once per step
+    double intensity = number_ops / number_bytes;
+    double single_step_intensity = (2 * TAPS - 1) * interior / ((double)W * H * D * 2 * 4);
+    cout << "Operational intensity (ops/byte): " << intensity << " with " << TSTEPS << " fused steps, "
+         << single_step_intensity << " with 1 step per pass\n";
+    cout << "Attainable throughput (GFLOPS): " << min(compute_roof, mem_bandwidth * intensity) << " with "
+         << TSTEPS << " fused steps, " << min(compute_roof, mem_bandwidth * single_step_intensity)
+         << " with 1 step per pass\n";
+    cout << "Throughput (GFLOPS): " << number_ops / exec_time << "\n";
+    cout << "Size of the grid: " << W << ", " << H << ", " << D << "\n";
+#endif
+
+    printf("Success\n");
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "Halide.h"
+#include "util.h"
+
+// Constant parameters (inner loop bounds) of the design
+#include "const-parameters.h"
+
+// The UREs of the stencil
+#include "../../../peppers/primitives/stencil.h"
+
+using namespace Halide;
+
+// TSTEPS steps of a Jacobi stencil, fused into a linear array of TSTEPS PEs (temporal blocking). The input is
+// the grid padded by HALO points on every side, and the design tiles it along x (and y in 3-D). Every PE keeps
+// two lines (planes in 3-D) of its tile in shift registers, so the grid is read and written once per TSTEPS
+// steps, instead of once per step.
+int main()
+{
+    // Type of the data to process in C and T2S
+    #define CTYPE float
+    #define TTYPE Float(32)
+
+    Var s("s"), x("x"), y("y"), z("z"), xb("xb"), yb("yb");
+    std::vector<StencilTap> taps;
+    for (int d = -1; d <= 1; d++) {
+        taps.push_back({{d, 0}, 1.0f / TAPS});
+        if (d != 0) {
+            taps.push_back({{0, d}, 1.0f / TAPS});
+        }
+    }
+
+#ifdef DIM3
+    // Input: In(x, y, z), padded
+    ImageParam In("In", TTYPE, 3);
+
+    // Outer loop bounds, which are determined by input sizes
+    #define XB ((In.dim(0).extent() - 2 * HALO) / BX)
+    #define YB ((In.dim(1).extent() - 2 * HALO) / BY)
+    #define W  (XB * BX)
+    #define H  (YB * BY)
+    #define D  (In.dim(2).extent() - 2 * HALO)
+
+    for (auto &tap : taps) {
+        tap.offset.push_back(0);
+    }
+    taps.push_back({{0, 0, -1}, 1.0f / TAPS});
+    taps.push_back({{0, 0, 1}, 1.0f / TAPS});
+    StencilUREs st = stencil_ures(s, {x, y, z}, {xb, yb}, TSTEPS, {XX, YY, D + 2 * HALO}, taps,
+        [&](std::vector<Expr> X) { return In(xb * BX + X[0], yb * BY + X[1], X[2]); },
+        [&](std::vector<Expr> u) {
+            Expr gx = xb * BX + u[0] - HALO, gy = yb * BY + u[1] - HALO, gz = u[2] - HALO;
+            return gx >= 1 && gx <= W - 2 && gy >= 1 && gy <= H - 2 && gz >= 1 && gz <= D - 2;
+        });
+    st.head.set_bounds(xb, 0, XB, yb, 0, YB);
+#else
+    // Input: In(x, y), padded
+    ImageParam In("In", TTYPE, 2);
+
+    // Outer loop bounds, which are determined by input sizes
+    #define XB ((In.dim(0).extent() - 2 * HALO) / BX)
+    #define W  (XB * BX)
+    #define H  (In.dim(1).extent() - 2 * HALO)
+
+    StencilUREs st = stencil_ures(s, {x, y}, {xb}, TSTEPS, {XX, H + 2 * HALO}, taps,
+        [&](std::vector<Expr> X) { return In(xb * BX + X[0], X[1]); },
+        [&](std::vector<Expr> u) {
+            Expr gx = xb * BX + u[0] - HALO, gy = u[1] - HALO;
+            return gx >= 1 && gx <= W - 2 && gy >= 1 && gy <= H - 2;
+        });
+    st.head.set_bounds(xb, 0, XB);
+#endif
+
+    // Create a linear array of the time steps
+    st.head.space_time_transform(s);
+
+    // I/O network. The input is read by PE 0 only, and the output is written by the last PE only.
+    Func serializer("serializer", Place::Host), loader("loader", Place::Device);
+    Func unloader("unloader", Place::Device), deserializer("deserializer", Place::Host);
+    st.head.isolate_producer_chain(In, serializer, loader);
+    serializer.set_bounds(s, 0, 1);
+    loader.set_bounds(s, 0, 1);
+    loader.min_depth(256);
+    st.out.isolate_consumer_chain(unloader, deserializer);
+    st.out.min_depth(256);
+    unloader.min_depth(256);
+
+    // Compile the kernel to an FPGA bitstream, and expose a C interface for the host to invoke
+    Target acc = get_host_target();
+    acc.set_feature(Target::IntelFPGA);
+    acc.set_feature(Target::EnableSynthesis);
+    deserializer.compile_to_host("stencil-interface", { In }, "stencil", acc);
+    printf("Success\n");
+    return 0;
+}
@@ -22,6 +22,11 @@
 // Constant parameters (inner loop bounds) of the design
 #include "const-parameters.h"
 
+#ifdef STREAMING
+// For matrices larger than the device memory
+#include "StreamingExecution.h"
+#endif
+
 // Roofline utilities
 #include "Roofline.h"
 
@@ -45,17 +50,23 @@ int main()
     const int TOTAL_I = III * II * I;
     const int TOTAL_J = III * II * I;
     const int TOTAL_K = KKK * KK * K;
+#ifdef STREAMING
+    // A has more columns than the reduction loops of the design cover, and is streamed through the design
+    const int STREAMED_K = 2 * TOTAL_K;
+#else
+    const int STREAMED_K = TOTAL_K;
+#endif
 
     int opa;
     opa = MATRIX_OP_IDENTITY;
 
     float alpha, beta;
-    Halide::Runtime::Buffer<float> a(TOTAL_K, TOTAL_J), cc(TOTAL_J, TOTAL_I);
+    Halide::Runtime::Buffer<float> a(STREAMED_K, TOTAL_J), cc(TOTAL_J, TOTAL_I);
 
     alpha = random();
     beta = random();
     for (size_t i = 0; i < TOTAL_I; i++) {
-        for (size_t k = 0; k < TOTAL_K; k++) {
+        for (size_t k = 0; k < STREAMED_K; k++) {
             a(k, i) = random();
         }
     }
@@ -67,7 +78,15 @@ int main()
     }
 
     Halide::Runtime::Buffer<float> c(III, III, II, II, I+1, I);
+#ifdef STREAMING
+    int result = stream_syrk<float>([](int opa, float alpha, float beta, Halide::Runtime::Buffer<float> &a,
+                                       Halide::Runtime::Buffer<float> &cc, Halide::Runtime::Buffer<float> &c) {
+                                        return syrk(opa, alpha, beta, a, cc, c); },
+                                    opa, alpha, beta, a, cc, c, TOTAL_K);
+    assert(result == 0);
+#else
     syrk(opa, alpha, beta, a, cc, c);
+#endif
 
 #ifdef TINY
     // Validate the results
@@ -97,7 +116,7 @@ int main()
                 }
 
                 float golden = beta * cc(bRow, aRow);
-                for (int k = 0; k < TOTAL_K; k++) {
+                for (int k = 0; k < STREAMED_K; k++) {
                     float aa = a(k, aRow);
                     float bb = a(k, bRow);
                     // cout << aa << " " << bb << endl;
@@ -24,7 +24,7 @@ function aoc_options {
 
 function generate_fpga_kernel {
     # Compile the specification
-    g++ ${workload}.cpp -g -I ../util -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin $(libhalide_to_link) -lz -lpthread -ldl -std=c++11 -D$size
+    g++ ${workload}.cpp -g -I ../util -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin $(libhalide_to_link) -lz -lpthread -ldl -std=c++11 -D$size $DESIGN_OPTIONS
 
     # Generate a device kernel, and a C interface for the host to invoke the kernel:
     # The bitstream generated is a.aocx, as indicated by the environment variable, BITSTREAM.
@@ -41,7 +41,7 @@ function generate_fpga_kernel {
 
 function test_fpga_kernel {
     # Compile the host file (${workload}-run-fpga.cpp) and link with the C interface (${workload}-interface.cpp):
-    g++ ${workload}-run-fpga.cpp ${workload}-interface.cpp ../../../src/AOT-OpenCL-Runtime.cpp ../../../src/Roofline.cpp ../../../src/SharedUtilsInC.cpp  -g -DLINUX -DALTERA_CL -fPIC -I../../../src/ -I $T2S_PATH/Halide/include -I$INTELFPGAOCLSDKROOT/examples_aoc/common/inc $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/opencl.cpp $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/options.cpp -I$INTELFPGAOCLSDKROOT/host/include -L$INTELFPGAOCLSDKROOT/linux64/lib -L$AOCL_BOARD_PACKAGE_ROOT/linux64/lib -L$INTELFPGAOCLSDKROOT/host/linux64/lib -lOpenCL -L $T2S_PATH/Halide/bin -lelf $(libhalide_to_link) -D$size -lz -lpthread -ldl -std=c++11 -o ./b.out
+    g++ ${workload}-run-fpga.cpp ${workload}-interface.cpp ../../../src/AOT-OpenCL-Runtime.cpp ../../../src/Roofline.cpp ../../../src/SharedUtilsInC.cpp  -g -DLINUX -DALTERA_CL -fPIC -I../../../src/ -I $T2S_PATH/Halide/include -I $T2S_PATH/Halide/tools -I$INTELFPGAOCLSDKROOT/examples_aoc/common/inc $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/opencl.cpp $INTELFPGAOCLSDKROOT/examples_aoc/common/src/AOCLUtils/options.cpp -I$INTELFPGAOCLSDKROOT/host/include -L$INTELFPGAOCLSDKROOT/linux64/lib -L$AOCL_BOARD_PACKAGE_ROOT/linux64/lib -L$INTELFPGAOCLSDKROOT/host/linux64/lib -lOpenCL -L $T2S_PATH/Halide/bin -lelf $(libhalide_to_link) -D$size $DESIGN_OPTIONS -lz -lpthread -ldl -std=c++11 -o ./b.out
 
     if [ "$platform" == "emulator" ]; then
         env BITSTREAM="$bitstream" CL_CONTEXT_EMULATOR_DEVICE_INTELFPGA=1 INTEL_FPGA_OCL_PLATFORM_NAME="$EMULATOR_PLATFORM" ./b.out
@@ -83,7 +83,7 @@ function gpu_iterations {
 function generate_gpu_kernel {
     set -x
     # Compile the specification
-    g++ ${workload}.cpp -g -I ../util -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin $HW_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 -DGPU
+    g++ ${workload}.cpp -g -I ../util -I $T2S_PATH/Halide/include -L $T2S_PATH/Halide/bin $HW_LIBHALIDE_TO_LINK -lz -lpthread -ldl -std=c++11 -DGPU $DESIGN_OPTIONS
 
     # Run the specification to generate  a device kernel file ${workload}_genx.cpp
     ./a.out
@@ -98,11 +98,11 @@ function generate_gpu_kernel {
 
 function test_gpu_kernel {
     if [ "$target" == "gen9" ]; then
-        g++ ${workload}-run-gpu-cm.cpp -DITER=$(gpu_iterations) -w -g -I$CM_ROOT/runtime/include -I$CM_ROOT/examples -I$CM_ROOT/drivers/media_driver/release/extract/usr/include -msse4.1 -D__LINUX__ -DLINUX -O0 -std=gnu++11 -fPIC -c -DCM_$GPU_ARCH -rdynamic -ffloat-store -o ${workload}-run-gpu.o
+        g++ ${workload}-run-gpu-cm.cpp -DITER=$(gpu_iterations) -w -g -I$CM_ROOT/runtime/include -I$CM_ROOT/examples -I$CM_ROOT/drivers/media_driver/release/extract/usr/include -msse4.1 -D__LINUX__ -DLINUX -O0 -std=gnu++11 -fPIC -c -DCM_$GPU_ARCH $DESIGN_OPTIONS -rdynamic -ffloat-store -o ${workload}-run-gpu.o
         g++ ${workload}-run-gpu.o -L$CM_ROOT/drivers/media_driver/release/extract/usr/lib/x86_64-linux-gnu -L$CM_ROOT/drivers/IGC/extract/usr/local/lib -L$CM_ROOT/drivers/media_driver/release/extract/usr/lib/x86_64-linux-gnu/dri $CM_ROOT/runtime/lib/x64/libigfxcmrt.so -lva -ldl -fPIC -rdynamic -o ${workload}-run-gpu.out
     else
         # Link the host and kernel code:
-        g++ -DITER=$(gpu_iterations) -m64 -I../util ${workload}-run-gpu.cpp -lze_loader -std=gnu++1z -o ${workload}-run-gpu.out
+        g++ -DITER=$(gpu_iterations) -m64 -I../util ${workload}-run-gpu.cpp $DESIGN_OPTIONS -lze_loader -std=gnu++1z -o ${workload}-run-gpu.out
     fi
 
     # Run the host binary. The host offloads the kernel to a GPU:
@@ -52,14 +52,20 @@ elif [ "$target" == "a10" -o "$target" == "s10" ]; then
     # FPGA: Verify correctness with tiny problem sizes and emulator
     ./test.sh $location gemm $target tiny emulator
     ./test.sh $location conv $target tiny emulator
+    env DESIGN_OPTIONS="-DSTRIDE=2 -DDILATION=2 -DGROUPS=2" ./test.sh $location conv $target tiny emulator
+    env DESIGN_OPTIONS="-DDEPTHWISE" ./test.sh $location conv $target tiny emulator
     ./test.sh $location capsule $target tiny emulator
     ./test.sh $location pairhmm $target tiny emulator
+    ./test.sh $location winograd $target tiny emulator
+    ./test.sh $location stencil $target tiny emulator
     
     # FPGA: Test perf with large matrices on real hardware
     ./test.sh $location gemm $target large hw $3
     ./test.sh $location conv $target large hw $3
     ./test.sh $location capsule $target large hw $3
     ./test.sh $location pairhmm $target large hw $3
+    ./test.sh $location winograd $target large hw $3
+    ./test.sh $location stencil $target large hw $3
 else
     echo "Performance testing on $target not supported yet in this release"
     exit
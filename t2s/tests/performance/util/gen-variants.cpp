@@ -0,0 +1,26 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// The driver of a design written as a generator, which compiles many variants of the design in one run
+// (See variants.h). Link it with the design compiled with -DT2S_GEN_VARIANTS, e.g.
+//     g++ ../gemm/gemm.cpp gen-variants.cpp -DT2S_GEN_VARIANTS -I . -I $T2S_PATH/Halide/include ... -o gemm.generator
+#include "variants.h"
+
+int main(int argc, char **argv) {
+    return generate_variants_main(argc, argv);
+}
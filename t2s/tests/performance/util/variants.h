@@ -0,0 +1,111 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef T2S_VARIANTS_H
+#define T2S_VARIANTS_H
+
+/* Variants of a design written as a Halide::Generator. A variant specializes the GeneratorParams of the
+ * generator (tile sizes, data type, etc.) and is compiled into a function of its own name. Variants are
+ * listed in a text file, one per line, and '#' starts a comment:
+ *     <name> <param>=<value> <param>=<value> ...
+ * A variant named v is compiled for the device of the target into:
+ *     FPGA: the C interface v-interface.h and v-interface.cpp, the OpenCL source v.cl, and the bitstream v.aocx
+ *           (synthesized only if the target has enable_synthesis)
+ *     GPU:  the kernel v_genx.cpp
+ *
+ * A generator binary built with gen-variants.cpp compiles all the variants of a file in one run:
+ *     gemm.generator -g gemm -o <dir> -v a10.variants target=host-intel_fpga-enable_synthesis [param=value ...]
+ * The params on the command line apply to every variant, unless a variant sets them. The variants, with the
+ * params on the command line merged in, are written into <dir>/<generator>.variants, which the host reads
+ * to dispatch to a variant (See t2s/src/VariantLibrary.h).
+ */
+
+#include "Halide.h"
+#include "../../../src/VariantLibrary.h"
+#include <unistd.h>
+
+// Compile a variant of the generator for the target into the current directory. For FPGAs, the bitstream is
+// named by the environment variable BITSTREAM as usual.
+inline void compile_design_variant(const std::string &generator, const DesignVariant &v, const Halide::Target &target) {
+    _halide_user_assert(target.has_feature(Halide::Target::IntelFPGA) || target.has_feature(Halide::Target::IntelGPU))
+        << "Variant " << v.name << ": the target must have intel_fpga or intel_gpu\n";
+    auto gen = Halide::Internal::GeneratorRegistry::create(generator, Halide::GeneratorContext(target));
+    Halide::GeneratorParamsMap params;
+    for (auto &p : v.params) {
+        params[p.first] = p.second;
+    }
+    gen->set_generator_param_values(params);
+
+    Halide::Module m = gen->build_module(v.name);
+    std::map<Halide::Output, std::string> outputs = {{Halide::Output::dev_src, v.name}};
+    if (target.has_feature(Halide::Target::IntelFPGA)) {
+        outputs[Halide::Output::host_header] = v.name + "-interface.h";
+        outputs[Halide::Output::host_src] = v.name + "-interface.cpp";
+    }
+    m.compile(outputs);
+}
+
+inline int generate_variants_main(int argc, char **argv) {
+    const char *usage = "Usage: <generator binary> -g <generator> -o <output dir> -v <variants file> "
+                        "target=<target> [param=value ...]\n";
+    std::string generator, dir, variants_file;
+    Halide::Target target;
+    bool has_target = false;
+    std::map<std::string, std::string> shared_params;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "-g" || arg == "-o" || arg == "-v") && i + 1 < argc) {
+            (arg == "-g" ? generator : arg == "-o" ? dir : variants_file) = argv[++i];
+        } else if (arg.find('=') != std::string::npos) {
+            std::string key = arg.substr(0, arg.find('=')), value = arg.substr(arg.find('=') + 1);
+            if (key == "target") {
+                target = Halide::Target(value);
+                has_target = true;
+            } else {
+                shared_params[key] = value;
+            }
+        } else {
+            std::cerr << "Unknown argument " << arg << "\n" << usage;
+            return 1;
+        }
+    }
+    if (generator.empty() || dir.empty() || variants_file.empty() || !has_target) {
+        std::cerr << usage;
+        return 1;
+    }
+
+    std::vector<DesignVariant> variants;
+    _halide_user_assert(read_design_variants(variants_file, variants)) << "Cannot read variants from " << variants_file << "\n";
+    for (auto &v : variants) {
+        for (auto &p : shared_params) {
+            v.params.insert(p);
+        }
+    }
+    // The kernels of GPUs are written into the current directory.
+    _halide_user_assert(chdir(dir.c_str()) == 0) << "Cannot enter the output directory " << dir << "\n";
+    for (auto &v : variants) {
+        std::cout << "Compiling variant " << v.name << " of " << generator << "\n";
+        setenv("BITSTREAM", (v.name + ".aocx").c_str(), 1);
+        compile_design_variant(generator, v, target);
+    }
+    _halide_user_assert(write_design_variants(generator + ".variants", variants))
+        << "Cannot write the manifest " << dir << "/" << generator << ".variants\n";
+    return 0;
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef WINOGRAD_CONST_PARAMS_H
+#define WINOGRAD_CONST_PARAMS_H
+
+// Winograd convolution F(M x M, 3 x 3): every tile of M x M outputs is computed from a tile of
+// ALPHA x ALPHA inputs, with E = ALPHA * ALPHA multiplications per input and output channel,
+// instead of M * M * 9 multiplications of the direct convolution.
+#ifndef M
+    #define M           4       // 2 or 4
+#endif
+#define R               3
+#define ALPHA           (M + R - 1)
+#define E               (ALPHA * ALPHA)
+
+// Inner loop bounds, which are static constant parameters of the design. The systolic array has E x III PEs,
+// each with a dot product of KKK input channels.
+#ifdef TINY // For verifying correctness only
+    #define KKK         4
+    #define III         2
+    #define JJ          2
+    #define II          2
+    #define KK          2
+#elif S10
+    #define KKK         16
+    #define III         4
+    #define JJ          32
+    #define II          8
+    #define KK          16
+#else   // For A10
+    #define KKK         16
+    #define III         2
+    #define JJ          32
+    #define II          8
+    #define KK          16
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+// The header file generated by winograd.cpp
+#include "winograd-interface.h"
+
+// Constant parameters (inner loop bounds) of the design
+#include "const-parameters.h"
+
+// Roofline utilities
+#include "Roofline.h"
+
+// Benchmark harness
+#include "Benchmark.h"
+
+// The only header file needed for including T2S.
+#include "HalideBuffer.h"
+
+// For printing output
+#include <stdio.h>
+#include <iostream>
+
+// For validation of results.
+#include <assert.h>
+
+// Outer loop bounds for testing. The layer is a 3x3 convolution with stride 1, as in the conv design.
+#ifdef TINY // For verifying correctness only
+    #define N       2
+    #define TY      2
+    #define TX      2
+    #define K       1
+    #define I       1
+#else
+    // I(64, 256, 56, 56) * K(256, 256, 3, 3)
+    #define N       64
+    #define TY      (56 / M)
+    #define TX      (56 / M)
+    #define K       1
+    #define I       (256 / (III * II))
+#endif
+
+#define TOTAL_CI    (KKK * KK * K)
+#define TOTAL_CO    (III * II * I)
+#define TILES       (N * TY * TX)
+#define J           (TILES / JJ)
+#define TOTAL_OY    (M * TY)
+#define TOTAL_OX    (M * TX)
+#define TOTAL_IY    (TOTAL_OY + R - 1)
+#define TOTAL_IX    (TOTAL_OX + R - 1)
+
+using namespace std;
+
+int main()
+{
+    assert(TILES % JJ == 0);
+    Halide::Runtime::Buffer<float> i(TOTAL_CI, TOTAL_IY, TOTAL_IX, N), k(TOTAL_CI, TOTAL_CO, R, R);
+    for (size_t n = 0; n < N; n++) {
+        for (size_t ci = 0; ci < TOTAL_CI; ci++) {
+            for (size_t x = 0; x < TOTAL_IX; x++) {
+                for (size_t y = 0; y < TOTAL_IY; y++) {
+                    i(ci, y, x, n) = random() / (float)RAND_MAX;
+                }
+            }
+        }
+    }
+    for (size_t co = 0; co < TOTAL_CO; co++) {
+        for (size_t ci = 0; ci < TOTAL_CI; ci++) {
+            for (size_t kx = 0; kx < R; kx++) {
+                for (size_t ky = 0; ky < R; ky++) {
+                    k(ci, co, ky, kx) = random() / (float)RAND_MAX;
+                }
+            }
+        }
+    }
+
+    // The results are in the order of the loops that drain them. The output tile of tile t = jj + JJ * j and output
+    // channel co = iii + III * ii + III * II * i is in the first M x M of the E lanes: o(y + ALPHA * x, iii, jj, ii, j, i)
+    Halide::Runtime::Buffer<float> o(E, III, JJ, II, J, I);
+    winograd(i, k, o);
+
+#ifdef TINY
+    // Validate the results against a direct convolution
+    for (int n = 0; n < N; n++)
+    for (int x = 0; x < TOTAL_OX; x++)
+    for (int y = 0; y < TOTAL_OY; y++)
+    for (int co = 0; co < TOTAL_CO; co++) {
+        float golden = 0.0f, magnitude = 0.0f;
+        for (int ci = 0; ci < TOTAL_CI; ci++)
+        for (int kx = 0; kx < R; kx++)
+        for (int ky = 0; ky < R; ky++) {
+            float p = i(ci, y+ky, x+kx, n) * k(ci, co, ky, kx);
+            golden += p;
+            magnitude += fabs(p);
+        }
+        int t = y / M + TY * (x / M + TX * n);
+        float result = o(y % M + ALPHA * (x % M), co % III, t % JJ, co / III % II, t / JJ, co / (III * II));
+        assert(fabs(golden - result) <= 0.001*magnitude);
+    }
+#else
+    // Report performance. DSPs, FMax and ExecTime are automatically figured out from the static analysis
+    // during FPGA synthesis and and the dynamic profile during the FGPA execution.
+#ifdef S10
+    double mem_bandwidth = 75;
+#else
+    double mem_bandwidth = 33;
+#endif
+    double compute_roof = 2 * DSPs() * FMax();
+    // Operations of the batched GEMM on the device. The transforms are additions and multiplications by
+    // constants, and are not counted.
+    double number_ops = 2 * (double)E * (double)TOTAL_CO * (double)TOTAL_CI * (double)TILES;
+    // The input tiles are read for every block of output channels, the filters for every group of JJ tiles,
+    // and the outputs are written in all the E lanes
+    double number_bytes = ((double)E * TOTAL_CI * TILES * (I) + (double)R * R * TOTAL_CI * TOTAL_CO * (J) + (double)E * TOTAL_CO * TILES) * 4;
+    // Benchmark the design with warm-up runs and multiple samples, and take the median time
+    DesignBenchmark benchmark;
+    benchmark.name = "winograd";
+    benchmark.number_ops = number_ops;
+    benchmark.number_bytes = number_bytes;
+    benchmark.compute_roof = compute_roof;
+    benchmark.mem_bandwidth = mem_bandwidth;
+    benchmark.parameters = {{"M", M}, {"N", N}, {"CI", TOTAL_CI}, {"CO", TOTAL_CO}, {"OY", TOTAL_OY}, {"OX", TOTAL_OX}};
+    BenchmarkReport report = benchmark_and_report(benchmark, [&]() { return winograd(i, k, o); });
+    assert(report.result == 0);
+    double exec_time = report.time.median;
+    roofline(mem_bandwidth, compute_roof, number_ops, number_bytes, exec_time);
+    if (fopen("roofline.png", "r") == NULL) {
+        cout << "Failed to draw roofline!\n";
+        return 1;
+    }
+    // Operations of the direct convolution, to compare with the conv design
+    double direct_ops = 2 * (double)N * TOTAL_CO * TOTAL_OY * TOTAL_OX * (double)TOTAL_CI * R * R;
+    cout << "Winograd F(" << M << "x" << M << ", 3x3): " << (double)M * M * R * R / E << "x fewer multiplications than the direct convolution\n";
+    cout << "Effective throughput (direct convolution operations / device time): " << direct_ops / exec_time << " GFLOPS\n";
+    cout << "Size of tensor I: " << N << ", " << TOTAL_CI << ", " << TOTAL_IX << ", " << TOTAL_IY << "\n";
+    cout << "Size of tensor K: " << TOTAL_CI << ", " << TOTAL_CO << ", " << R << ", " << R << "\n";
+#endif
+
+    printf("Success\n");
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#ifndef WINOGRAD_TRANSFORMS_H
+#define WINOGRAD_TRANSFORMS_H
+
+// The constant matrices of Winograd convolution F(m x m, 3 x 3) [1]. With the input tile d (alpha x alpha), the
+// filter g (3 x 3), and alpha = m + 2, the output tile (m x m) is
+//     Y = AT * [(G * g * GT) .* (BT * d * B)] * A
+// where .* is element-wise multiplication. The design (winograd.cpp) does all the products on the device.
+//
+// [1] Andrew Lavin and Scott Gray. Fast algorithms for convolutional neural networks. CVPR 2016.
+
+#include <assert.h>
+#include <vector>
+
+struct WinogradMatrices {
+    int m, alpha;
+    std::vector<float> BT; // alpha x alpha
+    std::vector<float> G;  // alpha x 3
+    std::vector<float> AT; // m x alpha
+};
+
+inline WinogradMatrices winograd_matrices(int m) {
+    WinogradMatrices w;
+    w.m = m;
+    w.alpha = m + 2;
+    if (m == 2) {
+        w.BT = { 1,  0, -1,  0,
+                 0,  1,  1,  0,
+                 0, -1,  1,  0,
+                 0,  1,  0, -1 };
+        w.G  = { 1,     0,     0,
+                 0.5f,  0.5f,  0.5f,
+                 0.5f, -0.5f,  0.5f,
+                 0,     0,     1 };
+        w.AT = { 1,  1,  1,  0,
+                 0,  1, -1, -1 };
+    } else {
+        assert(m == 4 && "Only F(2x2, 3x3) and F(4x4, 3x3) are supported");
+        w.BT = { 4,  0, -5,  0,  1,  0,
+                 0, -4, -4,  1,  1,  0,
+                 0,  4, -4, -1,  1,  0,
+                 0, -2, -1,  2,  1,  0,
+                 0,  2, -1, -2,  1,  0,
+                 0,  4,  0, -5,  0,  1 };
+        w.G  = { 1.0f / 4,   0,          0,
+                -1.0f / 6,  -1.0f / 6,  -1.0f / 6,
+                -1.0f / 6,   1.0f / 6,  -1.0f / 6,
+                 1.0f / 24,  1.0f / 12,  1.0f / 6,
+                 1.0f / 24, -1.0f / 12,  1.0f / 6,
+                 0,          0,          1 };
+        w.AT = { 1,  1,  1,  1,  1,  0,
+                 0,  1, -1,  2, -2,  0,
+                 0,  1,  1,  4,  4,  0,
+                 0,  1, -1,  8, -8,  1 };
+    }
+    return w;
+}
+
+#endif
@@ -0,0 +1,180 @@
+/*******************************************************************************
+* Copyright 2021 Intel Corporation
+*
+* Licensed under the BSD-2-Clause Plus Patent License (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* https://opensource.org/licenses/BSDplusPatent
+*
+* Unless required by applicable law or agreed to in writing,
+* software distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions
+* and limitations under the License.
+*
+*
+* SPDX-License-Identifier: BSD-2-Clause-Patent
+*******************************************************************************/
+#include "Halide.h"
+#include "util.h"
+
+// Constant parameters (inner loop bounds) of the design
+#include "const-parameters.h"
+
+// The constant matrices of the transforms
+#include "winograd-transforms.h"
+
+using namespace Halide;
+
+// Winograd convolution F(M x M, 3 x 3). The E = ALPHA * ALPHA points of a tile in the Winograd domain are lanes
+// e = xi + ALPHA * nu of the systolic array, and the transforms are products of constant matrices with the
+// lanes as an ALPHA x ALPHA matrix, i.e. UREs reading other lanes of the same iteration:
+//  - The input transform (V = BT * d * B) of a tile d is isolated into the feeder of the first row of PEs,
+//    which computes V once per tile, and V flows down to the other rows.
+//  - The filter transform (U = G * g * GT) of a filter g is isolated into the feeder of the filters, which
+//    computes U once per group of JJ tiles. U then stays in the PEs for the other tiles of the group.
+//  - The batched GEMM over the input channels, M = sum_ci U .* V, is the only work of the PEs per iteration.
+//  - The output transform (Y = AT * M * A) is on the way of the results to the drain, after the last input
+//    channel. Only the M * M lanes that send out the output tile compute it.
+// In terms of GEMM, i is the output channel, j is the tile, and k is the input channel.
+int main()
+{
+    // Dependences
+    #define P               kkk,      e,  iii,  jj,   ii, kk,     k,  j, i
+    #define P_kkk_minus_1   kkk-1,    e,  iii,  jj,   ii, kk,     k,  j, i
+    #define P_kk_minus_1    kkk+KKK-1,e,  iii,  jj,   ii, kk-1,   k,  j, i
+    #define P_k_minus_1     kkk+KKK-1,e,  iii,  jj,   ii, kk+KK-1,k-1,j, i
+    #define P_jj_minus_1    kkk,      e,  iii,  jj-1, ii, kk,     k,  j, i
+    #define P_iii_minus_1   kkk,      e,  iii-1,jj,   ii, kk,     k,  j, i
+    #define P_lane(d)       kkk,      e+(d),iii,jj,   ii, kk,     k,  j, i
+    #define P_Out                     e,  iii,  jj,   ii,             j, i
+
+    // Linearized addresses
+    #define total_i         (iii + III * ii + III * II * i)
+    #define total_j         (jj + JJ * j)
+    #define total_k         (kkk + KKK * kk + KKK * KK * k)
+
+    // Outer loop bounds, which are determined by input sizes
+    #define TY              ((I.dim(1).extent() - R + 1) / M)
+    #define TX              ((I.dim(2).extent() - R + 1) / M)
+    #define N               I.dim(3).extent()
+    #define I_              (K.dim(1).extent() / (III * II))
+    #define J_              (N * TY * TX / JJ)
+    #define K_              (K.dim(0).extent() / (KKK * KK))
+
+    // Type of the data to process in C and T2S
+    #define CTYPE float
+    #define TTYPE Float(32)
+
+    // Inputs: I(ci, iy, ix, n) and K(ci, co, ky, kx)
+    ImageParam I("I", TTYPE, 4), K("K", TTYPE, 4);
+
+    // The row and the column of lane e in the Winograd domain, and the position of tile total_j
+    Var kkk("kkk"), e("e"), iii("iii"), jj("jj"), ii("ii"), kk("kk"), k("k"), j("j"), i("i");
+    Expr xi = e % ALPHA, nu = e / ALPHA;
+    Expr ty = total_j % TY, tx = total_j / TY % TX, n = total_j / (TY * TX);
+
+    // C * f or f * CT for a constant matrix C (rows x cols), where f is the lanes of a URE as an ALPHA x ALPHA
+    // matrix: out(xi, nu) = sum_c C[xi][c] * f(c, nu), or sum_c C[nu][c] * f(xi, c) if right. The coefficient
+    // of every lane is a constant after the lanes are unrolled.
+    WinogradMatrices w = winograd_matrices(M);
+    auto product = [&](const std::vector<float> &C, int rows, int cols, Func f, bool right) {
+        Expr r = right ? nu : xi;
+        int stride = right ? ALPHA : 1;
+        Expr sum = cast(TTYPE, 0);
+        for (int d = -(ALPHA - 1); d < ALPHA; d++) {
+            Expr coefficient = cast(TTYPE, 0);
+            bool zero = true;
+            for (int row = 0; row < rows; row++) {
+                int col = row + d;
+                if (col >= 0 && col < cols && C[row * cols + col] != 0) {
+                    coefficient = select(r == row, C[row * cols + col], coefficient);
+                    zero = false;
+                }
+            }
+            if (!zero) {
+                sum += select(r + d >= 0 && r + d < cols, coefficient * f(P_lane(d * stride)), 0);
+            }
+        }
+        return sum;
+    };
+
+    // UREs
+    URE D("D", TTYPE, {P}), T("T", TTYPE, {P}), VT("VT", TTYPE, {P});
+    URE F("F", TTYPE, {P}), GF("GF", TTYPE, {P}), UT("UT", TTYPE, {P});
+    URE X("X", TTYPE, {P}), Y("Y", TTYPE, {P}), Z("Z", TTYPE, {P});
+    URE AZ("AZ", TTYPE, {P}), YT("YT", TTYPE, {P}), Out("Out");
+    // Input transform: lane (a, b) reads the input d(a, b) of the tile
+    D(P)  = I(total_k, ty * M + xi, tx * M + nu, n);
+    T(P)  = product(w.BT, ALPHA, ALPHA, D, false);
+    VT(P) = product(w.BT, ALPHA, ALPHA, T, true);
+    // Filter transform: lane (ky, kx) reads the filter g(ky, kx)
+    F(P)  = select(xi < R && nu < R, K(total_k, total_i, xi, nu), 0);
+    GF(P) = product(w.G, ALPHA, R, F, false);
+    UT(P) = product(w.G, ALPHA, R, GF, true);
+    // Batched GEMM. U is read at the first tile of a group of JJ tiles, and V at the first row of PEs.
+    X(P) = select(jj == 0, UT(P), X(P_jj_minus_1));
+    Y(P) = select(iii == 0, VT(P), Y(P_iii_minus_1));
+    Z(P) = select(kkk == 0 && kk == 0 && k == 0, 0,
+                select(kkk == 0, select(kk == 0, Z(P_k_minus_1), Z(P_kk_minus_1)), Z(P_kkk_minus_1)))
+                + X(P) * Y(P);
+    // Output transform: lane (y, x) computes the output y(y, x) of the tile. The other lanes are constant 0
+    // after the lanes are unrolled.
+    AZ(P) = select(xi < M, product(w.AT, M, ALPHA, Z, false), 0);
+    YT(P) = select(xi < M && nu < M, product(w.AT, M, ALPHA, AZ, true), 0);
+    Out(P_Out) = select(kkk == KKK-1 && kk == KK-1 && k == K_-1 && xi < M && nu < M, YT(P));
+
+    // Put all the UREs inside the same loop nest of X.
+    X.merge_ures(D, T, VT, F, GF, UT, Y, Z, AZ, YT, Out);
+
+    // Explicitly set the loop bounds
+    X.set_bounds(kkk, 0, KKK, e,  0, E,  iii, 0, III)
+     .set_bounds(jj,  0, JJ,  ii, 0, II, kk,  0, KK)
+     .set_bounds(j,   0, J_,  i,  0, I_, k,   0, K_);
+
+    // Create a systolic array of E x III PEs
+    X.space_time_transform(e, iii);
+
+    // Input network. The input transform is isolated, with the input d and the intermediate product T, into a
+    // feeder of the first row of PEs, and the filter transform, with g and G * g, into a feeder of the filters.
+    // So the PEs only keep the multiply-adds of the batched GEMM.
+    Func iSerializer("iSerializer", Place::Host), iLoader("iLoader", Place::Device), iTransform("iTransform", Place::Device);
+    Func kSerializer("kSerializer", Place::Host), kLoader("kLoader", Place::Device), kTransform("kTransform", Place::Device);
+    X.isolate_producer_chain(VT, iTransform);
+    iTransform.isolate_producer_chain(I, iSerializer, iLoader);
+    X.isolate_producer_chain(UT, kTransform);
+    kTransform.isolate_producer_chain(K, kSerializer, kLoader);
+    // V is fed to the first row only
+    iSerializer.set_bounds(iii, 0, 1);
+    iLoader.set_bounds(iii, 0, 1);
+    iTransform.set_bounds(iii, 0, 1);
+    iLoader.vectorize(kkk);
+    kLoader.vectorize(kkk);
+    iLoader.min_depth(256);
+    iTransform.min_depth(256);
+    kLoader.min_depth(256);
+    kTransform.min_depth(256);
+
+    // Output network: the rows of PEs are drained one after another
+    Func drainer("drainer", Place::Device), collector("collector", Place::Device);
+    Func unloader("unloader", Place::Device), deserializer("deserializer", Place::Host);
+    Out.isolate_consumer_chain(drainer);
+    drainer.space_time_transform(e, iii);
+    drainer.isolate_consumer_chain(collector, unloader, deserializer);
+    drainer.gather(Out, iii);
+    collector.vectorize(e);
+    unloader.vectorize(e);
+    deserializer.vectorize(e);
+    Out.min_depth(256);
+    drainer.min_depth(256);
+    collector.min_depth(256);
+
+    // Compile the kernel to an FPGA bitstream, and expose a C interface for the host to invoke
+    Target acc = get_host_target();
+    acc.set_feature(Target::IntelFPGA);
+    acc.set_feature(Target::EnableSynthesis);
+    deserializer.compile_to_host("winograd-interface", { I, K }, "winograd", acc);
+    printf("Success\n");
+    return 0;
+}